@@ -31,6 +31,7 @@
 #include "cogl-pango-private.h"
 #include "cogl/cogl-atlas.h"
 #include "cogl/cogl-atlas-texture-private.h"
+#include "cogl/cogl-context-private.h"
 
 typedef struct _CoglPangoGlyphCacheKey     CoglPangoGlyphCacheKey;
 
@@ -59,6 +60,10 @@ struct _CoglPangoGlyphCache
   /* Whether mipmapping is being used for this cache. This only
      affects whether we decide to put the glyph in the global atlas */
   gboolean          use_mipmapping;
+
+  /* The format of the local atlases. This is COGL_PIXEL_FORMAT_R_8
+     if the GPU supports it and otherwise COGL_PIXEL_FORMAT_A_8 */
+  CoglPixelFormat   atlas_format;
 };
 
 struct _CoglPangoGlyphCacheKey
@@ -116,6 +121,8 @@ cogl_pango_glyph_cache_new (gboolean use_mipmapping)
 {
   CoglPangoGlyphCache *cache;
 
+  _COGL_GET_CONTEXT (ctx, NULL);
+
   cache = g_malloc (sizeof (CoglPangoGlyphCache));
 
   cache->hash_table = g_hash_table_new_full
@@ -131,6 +138,14 @@ cogl_pango_glyph_cache_new (gboolean use_mipmapping)
 
   cache->use_mipmapping = use_mipmapping;
 
+  /* Red textures need a snippet to use the red component as the
+     alpha so they can only be used with GLSL */
+  if (cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_RG) &&
+      cogl_has_feature (ctx, COGL_FEATURE_ID_GLSL))
+    cache->atlas_format = COGL_PIXEL_FORMAT_R_8;
+  else
+    cache->atlas_format = COGL_PIXEL_FORMAT_A_8;
+
   return cache;
 }
 
@@ -265,9 +280,10 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
   /* If we couldn't find one then start a new atlas */
   if (atlas == NULL)
     {
-      atlas = _cogl_atlas_new (COGL_PIXEL_FORMAT_A_8,
+      atlas = _cogl_atlas_new (cache->atlas_format,
                                COGL_ATLAS_CLEAR_TEXTURE |
-                               COGL_ATLAS_DISABLE_MIGRATION,
+                               COGL_ATLAS_DISABLE_MIGRATION |
+                               COGL_ATLAS_BATCH_UPLOADS,
                                cogl_pango_glyph_cache_update_position_cb);
       COGL_NOTE (ATLAS, "Created new atlas for glyphs: %p", atlas);
       /* If we still can't reserve space then something has gone
@@ -326,16 +342,36 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
         value->dirty = FALSE;
       else
         {
-          /* Try adding the glyph to the global atlas... */
-          if (!cogl_pango_glyph_cache_add_to_global_atlas (cache,
+          gboolean added;
+
+          /* A glyph in a red atlas only takes a quarter of the
+             memory and upload bandwidth that it would in the RGBA
+             global atlas so in that case the global atlas is only
+             used if the local atlas fails. Otherwise the global atlas
+             is preferred so that glyphs can be batched with other
+             images */
+          if (cache->atlas_format == COGL_PIXEL_FORMAT_R_8)
+            added =
+              (cogl_pango_glyph_cache_add_to_local_atlas (cache,
+                                                          font,
+                                                          glyph,
+                                                          value) ||
+               cogl_pango_glyph_cache_add_to_global_atlas (cache,
+                                                           font,
+                                                           glyph,
+                                                           value));
+          else
+            added =
+              (cogl_pango_glyph_cache_add_to_global_atlas (cache,
                                                            font,
                                                            glyph,
-                                                           value) &&
-              /* If it fails try the local atlas */
-              !cogl_pango_glyph_cache_add_to_local_atlas (cache,
+                                                           value) ||
+               cogl_pango_glyph_cache_add_to_local_atlas (cache,
                                                           font,
                                                           glyph,
-                                                          value))
+                                                          value));
+
+          if (!added)
             {
               cogl_pango_glyph_cache_value_free (value);
               return NULL;
@@ -40,6 +40,7 @@ struct _CoglPangoPipelineCache
   GHashTable *hash_table;
 
   CoglPipeline *base_texture_alpha_pipeline;
+  CoglPipeline *base_texture_red_pipeline;
   CoglPipeline *base_texture_rgba_pipeline;
 
   gboolean use_mipmapping;
@@ -92,6 +93,7 @@ _cogl_pango_pipeline_cache_new (gboolean use_mipmapping)
 
   cache->base_texture_rgba_pipeline = NULL;
   cache->base_texture_alpha_pipeline = NULL;
+  cache->base_texture_red_pipeline = NULL;
 
   cache->use_mipmapping = use_mipmapping;
 
@@ -152,6 +154,31 @@ get_base_texture_alpha_pipeline (CoglPangoPipelineCache *cache)
   return cache->base_texture_alpha_pipeline;
 }
 
+static CoglPipeline *
+get_base_texture_red_pipeline (CoglPangoPipelineCache *cache)
+{
+  if (cache->base_texture_red_pipeline == NULL)
+    {
+      CoglPipeline *pipeline;
+      CoglSnippet *snippet;
+
+      pipeline = cogl_pipeline_copy (get_base_texture_alpha_pipeline (cache));
+      cache->base_texture_red_pipeline = pipeline;
+
+      /* A red texture samples as (r, 0, 0, 1) so the texel is
+       * swizzled to look like it came from an alpha texture. This
+       * lets the combine mode of the alpha pipeline be reused */
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                                  NULL, /* declarations */
+                                  "cogl_texel = "
+                                  "vec4 (0.0, 0.0, 0.0, cogl_texel.r);\n");
+      cogl_pipeline_add_layer_snippet (pipeline, 0, snippet);
+      cogl_object_unref (snippet);
+    }
+
+  return cache->base_texture_red_pipeline;
+}
+
 typedef struct
 {
   CoglPangoPipelineCache *cache;
@@ -187,11 +214,16 @@ _cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
   if (texture)
     {
       CoglPipeline *base;
+      CoglPixelFormat format;
 
       entry->texture = cogl_object_ref (texture);
 
-      if (cogl_texture_get_format (entry->texture) == COGL_PIXEL_FORMAT_A_8)
+      format = cogl_texture_get_format (entry->texture);
+
+      if (format == COGL_PIXEL_FORMAT_A_8)
         base = get_base_texture_alpha_pipeline (cache);
+      else if (format == COGL_PIXEL_FORMAT_R_8)
+        base = get_base_texture_red_pipeline (cache);
       else
         base = get_base_texture_rgba_pipeline (cache);
 
@@ -231,6 +263,8 @@ _cogl_pango_pipeline_cache_free (CoglPangoPipelineCache *cache)
     cogl_object_unref (cache->base_texture_rgba_pipeline);
   if (cache->base_texture_alpha_pipeline)
     cogl_object_unref (cache->base_texture_alpha_pipeline);
+  if (cache->base_texture_red_pipeline)
+    cogl_object_unref (cache->base_texture_red_pipeline);
 
   g_hash_table_destroy (cache->hash_table);
 
@@ -483,6 +483,7 @@ cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
   cairo_glyph_t cairo_glyph;
   cairo_format_t format_cairo;
   CoglPixelFormat format_cogl;
+  CoglPixelFormat texture_format;
 
   COGL_NOTE (PANGO, "redrawing glyph %i", glyph);
 
@@ -491,10 +492,15 @@ cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
      here */
   g_return_if_fail (value->texture != NULL);
 
-  if (cogl_texture_get_format (value->texture) == COGL_PIXEL_FORMAT_A_8)
+  texture_format = cogl_texture_get_format (value->texture);
+
+  if (texture_format == COGL_PIXEL_FORMAT_A_8 ||
+      texture_format == COGL_PIXEL_FORMAT_R_8)
     {
+      /* The coverage values are uploaded as they are regardless of
+         which component they end up in */
       format_cairo = CAIRO_FORMAT_A8;
-      format_cogl = COGL_PIXEL_FORMAT_A_8;
+      format_cogl = texture_format;
     }
   else
     {
@@ -272,7 +272,44 @@ _cogl_atlas_create_texture (CoglAtlas *atlas,
 {
   CoglHandle tex;
 
-  if ((atlas->flags & COGL_ATLAS_CLEAR_TEXTURE))
+  if ((atlas->flags & COGL_ATLAS_BATCH_UPLOADS))
+    {
+      _COGL_GET_CONTEXT (ctx, COGL_INVALID_HANDLE);
+
+      tex = cogl_texture_2d_new_with_size (ctx,
+                                           width, height,
+                                           atlas->texture_format,
+                                           NULL);
+
+      if (tex)
+        {
+          cogl_texture_2d_set_batch_uploads (tex, TRUE);
+
+          /* Clearing through the batch makes the shadow copy complete
+           * so that later writes can be merged freely. The clear is
+           * uploaded together with the first writes */
+          if ((atlas->flags & COGL_ATLAS_CLEAR_TEXTURE))
+            {
+              int bpp = _cogl_get_format_bpp (atlas->texture_format);
+              CoglBitmap *clear_bmp =
+                _cogl_bitmap_new_from_data (g_malloc0 (width * height * bpp),
+                                            atlas->texture_format,
+                                            width,
+                                            height,
+                                            width * bpp,
+                                            (CoglBitmapDestroyNotify) g_free,
+                                            NULL);
+
+              cogl_texture_set_region_from_bitmap (tex,
+                                                   0, 0, /* src_x/y */
+                                                   0, 0, /* dst_x/y */
+                                                   width, height,
+                                                   clear_bmp);
+              cogl_object_unref (clear_bmp);
+            }
+        }
+    }
+  else if ((atlas->flags & COGL_ATLAS_CLEAR_TEXTURE))
     {
       guint8 *clear_data;
       CoglBitmap *clear_bmp;
@@ -35,7 +35,8 @@ typedef void
 typedef enum
 {
   COGL_ATLAS_CLEAR_TEXTURE     = (1 << 0),
-  COGL_ATLAS_DISABLE_MIGRATION = (1 << 1)
+  COGL_ATLAS_DISABLE_MIGRATION = (1 << 1),
+  COGL_ATLAS_BATCH_UPLOADS     = (1 << 2)
 } CoglAtlasFlags;
 
 typedef struct _CoglAtlas CoglAtlas;
@@ -45,6 +45,7 @@
 #include "cogl-pipeline-progend-glsl-private.h"
 #endif
 #include "cogl-private.h"
+#include "cogl-profile.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -59,6 +60,26 @@ static void _cogl_attribute_free (CoglAttribute *attribute);
 
 COGL_OBJECT_DEFINE (Attribute, attribute);
 
+/* The last set of overrides used to draw attributes with a pipeline
+ * is remembered as a weak copy of the pipeline so that drawing with
+ * the same pipeline again can reuse it. That way the current
+ * pipeline stays the same and the pipeline flush can take its fast
+ * path instead of treating every draw as a new pipeline */
+typedef struct
+{
+  /* The source pipeline and each weak copy that was made from it
+   * hold a reference so that the struct outlives whichever of them
+   * is destroyed last */
+  int ref_count;
+  CoglPipeline *weak_pipeline;
+  unsigned int age;
+  gboolean enable_blend;
+  CoglPipelineFlushOptions options;
+} CoglAttributeOverrides;
+
+static CoglUserDataKey overrides_key;
+static CoglUserDataKey overrides_copy_key;
+
 static gboolean
 validate_cogl_attribute_name (const char *name,
                               CoglAttributeNameID *name_id,
@@ -317,6 +338,135 @@ typedef struct
   guint32 fallback_layers;
 } ValidateLayerState;
 
+static void
+unref_overrides (CoglAttributeOverrides *overrides)
+{
+  if (--overrides->ref_count < 1)
+    g_slice_free (CoglAttributeOverrides, overrides);
+}
+
+static void
+weak_overrides_destroyed_cb (CoglPipeline *pipeline,
+                             void *user_data)
+{
+  CoglAttributeOverrides *overrides = user_data;
+
+  /* The source pipeline has been modified or destroyed so the copy
+   * is no longer valid. If the copy was already replaced then our
+   * reference on it has been dropped and it is only being kept alive
+   * by someone else, such as the current pipeline of the context */
+  if (overrides->weak_pipeline == pipeline)
+    {
+      overrides->weak_pipeline = NULL;
+      cogl_object_unref (pipeline);
+    }
+}
+
+static void
+destroy_overrides_cb (void *user_data)
+{
+  /* The reference on the weak copy is dropped by
+   * weak_overrides_destroyed_cb which is always called when the
+   * source pipeline is destroyed */
+  unref_overrides (user_data);
+}
+
+static gboolean
+flush_options_equal (const CoglPipelineFlushOptions *options0,
+                     const CoglPipelineFlushOptions *options1)
+{
+  if (options0->flags != options1->flags)
+    return FALSE;
+
+  if ((options0->flags & COGL_PIPELINE_FLUSH_FALLBACK_MASK) &&
+      options0->fallback_layers != options1->fallback_layers)
+    return FALSE;
+
+  if ((options0->flags & COGL_PIPELINE_FLUSH_DISABLE_MASK) &&
+      options0->disable_layers != options1->disable_layers)
+    return FALSE;
+
+  if ((options0->flags & COGL_PIPELINE_FLUSH_LAYER0_OVERRIDE) &&
+      options0->layer0_override_texture != options1->layer0_override_texture)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Returns a weak copy of @pipeline with the given overrides applied.
+ * The copy is owned by @pipeline and is only valid until the next
+ * time @pipeline is modified or flushed with different overrides */
+static CoglPipeline *
+get_overrides_pipeline (CoglPipeline *pipeline,
+                        gboolean enable_blend,
+                        CoglPipelineFlushOptions *options)
+{
+  CoglAttributeOverrides *overrides;
+  unsigned int age = _cogl_pipeline_get_age (pipeline);
+
+  COGL_STATIC_COUNTER (attribute_overrides_counter,
+                       "attribute overrides pipeline counter",
+                       "Increments each time a new pipeline has to be "
+                       "derived to apply overrides for drawing attributes",
+                       0 /* no application private data */);
+
+  overrides = cogl_object_get_user_data (COGL_OBJECT (pipeline),
+                                         &overrides_key);
+
+  if (overrides == NULL)
+    {
+      overrides = g_slice_new0 (CoglAttributeOverrides);
+      overrides->ref_count = 1;
+      cogl_object_set_user_data (COGL_OBJECT (pipeline),
+                                 &overrides_key,
+                                 overrides,
+                                 destroy_overrides_cb);
+    }
+  else if (overrides->weak_pipeline)
+    {
+      CoglPipeline *old_pipeline;
+
+      if (overrides->age == age &&
+          overrides->enable_blend == enable_blend &&
+          flush_options_equal (&overrides->options, options))
+        return overrides->weak_pipeline;
+
+      old_pipeline = overrides->weak_pipeline;
+
+      /* Clear the pointer first so that weak_overrides_destroyed_cb
+       * won't drop the reference again if the old copy is still
+       * alive when the source is modified */
+      overrides->weak_pipeline = NULL;
+      cogl_object_unref (old_pipeline);
+    }
+
+  COGL_COUNTER_INC (_cogl_uprof_context, attribute_overrides_counter);
+
+  overrides->weak_pipeline =
+    _cogl_pipeline_weak_copy (pipeline,
+                              weak_overrides_destroyed_cb,
+                              overrides);
+  /* The copy keeps the struct alive until it is freed because its
+   * destroy callback may still be called after the source pipeline
+   * has dropped its reference */
+  overrides->ref_count++;
+  cogl_object_set_user_data (COGL_OBJECT (overrides->weak_pipeline),
+                             &overrides_copy_key,
+                             overrides,
+                             (CoglUserDataDestroyCallback) unref_overrides);
+  overrides->age = age;
+  overrides->enable_blend = enable_blend;
+  overrides->options = *options;
+
+  if (enable_blend)
+    _cogl_pipeline_set_blend_enabled (overrides->weak_pipeline,
+                                      COGL_PIPELINE_BLEND_ENABLE_ENABLED);
+  if (options->flags)
+    _cogl_pipeline_apply_overrides (overrides->weak_pipeline, options);
+
+  return overrides->weak_pipeline;
+}
+
 static gboolean
 validate_layer_cb (CoglPipeline *pipeline,
                    int layer_index,
@@ -547,6 +697,7 @@ _cogl_flush_attributes_state (CoglFramebuffer *framebuffer,
 {
   int i;
   gboolean skip_gl_color = FALSE;
+  gboolean enable_blend = FALSE;
   CoglPipeline *copy = NULL;
   int n_tex_coord_attribs = 0;
   ValidateLayerState layers_state;
@@ -590,13 +741,7 @@ _cogl_flush_attributes_state (CoglFramebuffer *framebuffer,
       case COGL_ATTRIBUTE_NAME_ID_COLOR_ARRAY:
         if ((flags & COGL_DRAW_COLOR_ATTRIBUTE_IS_OPAQUE) == 0 &&
             !_cogl_pipeline_get_real_blend_enabled (pipeline))
-          {
-            CoglPipelineBlendEnable blend_enable =
-              COGL_PIPELINE_BLEND_ENABLE_ENABLED;
-            copy = cogl_pipeline_copy (pipeline);
-            _cogl_pipeline_set_blend_enabled (copy, blend_enable);
-            pipeline = copy;
-          }
+          enable_blend = TRUE;
         skip_gl_color = TRUE;
         break;
 
@@ -608,48 +753,12 @@ _cogl_flush_attributes_state (CoglFramebuffer *framebuffer,
         break;
       }
 
-  if (G_UNLIKELY (layers_state.options.flags))
+  if (G_UNLIKELY (enable_blend || layers_state.options.flags))
     {
-      /* If we haven't already created a derived pipeline... */
-      if (!copy)
-        {
-          copy = cogl_pipeline_copy (pipeline);
-          pipeline = copy;
-        }
-      _cogl_pipeline_apply_overrides (pipeline, &layers_state.options);
-
-      /* TODO:
-       * overrides = cogl_pipeline_get_data (pipeline,
-       *                                     last_overrides_key);
-       * if (overrides)
-       *   {
-       *     age = cogl_pipeline_get_age (pipeline);
-       *     XXX: actually we also need to check for legacy_state
-       *     and blending overrides for use of glColorPointer...
-       *     if (overrides->ags != age ||
-       *         memcmp (&overrides->options, &options,
-       *                 sizeof (options) != 0)
-       *       {
-       *         cogl_object_unref (overrides->weak_pipeline);
-       *         g_slice_free (Overrides, overrides);
-       *         overrides = NULL;
-       *       }
-       *   }
-       * if (!overrides)
-       *   {
-       *     overrides = g_slice_new (Overrides);
-       *     overrides->weak_pipeline =
-       *       cogl_pipeline_weak_copy (pipeline);
-       *     _cogl_pipeline_apply_overrides (overrides->weak_pipeline,
-       *                                     &options);
-       *
-       *     cogl_pipeline_set_data (pipeline, last_overrides_key,
-       *                             weak_overrides,
-       *                             free_overrides_cb,
-       *                             NULL);
-       *   }
-       * pipeline = overrides->weak_pipeline;
-       */
+      layers_state.options.fallback_layers = layers_state.fallback_layers;
+      pipeline = get_overrides_pipeline (pipeline,
+                                         enable_blend,
+                                         &layers_state.options);
     }
 
   if (G_UNLIKELY (!(flags & COGL_DRAW_SKIP_LEGACY_STATE)) &&
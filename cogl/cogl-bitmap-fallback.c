@@ -42,6 +42,24 @@ _cogl_g_to_rgba (const guint8 *src, guint8 *dst)
   dst[3] = 255;
 }
 
+inline static void
+_cogl_r_to_rgba (const guint8 *src, guint8 *dst)
+{
+  dst[0] = src[0];
+  dst[1] = 0;
+  dst[2] = 0;
+  dst[3] = 255;
+}
+
+inline static void
+_cogl_rg_to_rgba (const guint8 *src, guint8 *dst)
+{
+  dst[0] = src[0];
+  dst[1] = src[1];
+  dst[2] = 0;
+  dst[3] = 255;
+}
+
 inline static void
 _cogl_rgb_to_rgba (const guint8 *src, guint8 *dst)
 {
@@ -104,6 +122,19 @@ _cogl_rgba_to_g (const guint8 *src, guint8 *dst)
   dst[0] = (src[0] + src[1] + src[2]) / 3;
 }
 
+inline static void
+_cogl_rgba_to_r (const guint8 *src, guint8 *dst)
+{
+  dst[0] = src[0];
+}
+
+inline static void
+_cogl_rgba_to_rg (const guint8 *src, guint8 *dst)
+{
+  dst[0] = src[0];
+  dst[1] = src[1];
+}
+
 inline static void
 _cogl_rgba_to_rgb (const guint8 *src, guint8 *dst)
 {
@@ -147,6 +178,337 @@ _cogl_rgba_to_abgr (const guint8 *src, guint8 *dst)
   dst[3] = src[0];
 }
 
+inline static void
+_cogl_to_rgba (CoglPixelFormat format, const guint8 *src, guint8 *dst)
+{
+  switch (format & COGL_UNPREMULT_MASK)
+    {
+    case COGL_PIXEL_FORMAT_G_8:
+      _cogl_g_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_R_8:
+      _cogl_r_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_RG_88:
+      _cogl_rg_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_RGB_888:
+      _cogl_rgb_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_BGR_888:
+      _cogl_bgr_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+      _cogl_rgba_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      _cogl_bgra_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+      _cogl_argb_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      _cogl_abgr_to_rgba (src, dst); break;
+    default:
+      break;
+    }
+}
+
+inline static void
+_cogl_from_rgba (CoglPixelFormat format, const guint8 *src, guint8 *dst)
+{
+  switch (format & COGL_UNPREMULT_MASK)
+    {
+    case COGL_PIXEL_FORMAT_G_8:
+      _cogl_rgba_to_g (src, dst); break;
+    case COGL_PIXEL_FORMAT_R_8:
+      _cogl_rgba_to_r (src, dst); break;
+    case COGL_PIXEL_FORMAT_RG_88:
+      _cogl_rgba_to_rg (src, dst); break;
+    case COGL_PIXEL_FORMAT_RGB_888:
+      _cogl_rgba_to_rgb (src, dst); break;
+    case COGL_PIXEL_FORMAT_BGR_888:
+      _cogl_rgba_to_bgr (src, dst); break;
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+      _cogl_rgba_to_rgba (src, dst); break;
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      _cogl_rgba_to_bgra (src, dst); break;
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+      _cogl_rgba_to_argb (src, dst); break;
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      _cogl_rgba_to_abgr (src, dst); break;
+    default:
+      break;
+    }
+}
+
+/* Floating point formats */
+
+static gboolean
+_cogl_format_is_float (CoglPixelFormat format)
+{
+  switch (format & COGL_UNPREMULT_MASK)
+    {
+    case COGL_PIXEL_FORMAT_R_16F:
+    case COGL_PIXEL_FORMAT_RG_16F:
+    case COGL_PIXEL_FORMAT_RGBA_16F:
+    case COGL_PIXEL_FORMAT_RGBA_32F:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+typedef union
+{
+  float f;
+  guint32 i;
+} CoglFloatBits;
+
+inline static float
+_cogl_half_to_float (guint16 h)
+{
+  guint32 sign = (h & 0x8000) << 16;
+  guint32 exponent = (h >> 10) & 0x1f;
+  guint32 mantissa = h & 0x3ff;
+  CoglFloatBits bits;
+
+  if (exponent == 0x1f)
+    /* Infinity or NaN */
+    bits.i = sign | 0x7f800000 | (mantissa << 13);
+  else if (exponent == 0)
+    {
+      /* Zero or a denormal which is the mantissa × 2⁻²⁴ */
+      bits.f = mantissa * (1.0f / 16777216.0f);
+      bits.i |= sign;
+    }
+  else
+    /* Rebias the exponent from 15 to 127 */
+    bits.i = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+  return bits.f;
+}
+
+inline static guint16
+_cogl_float_to_half (float f)
+{
+  CoglFloatBits bits;
+  guint32 sign, exponent, mantissa;
+  guint32 half;
+
+  bits.f = f;
+  sign = (bits.i >> 16) & 0x8000;
+  exponent = (bits.i >> 23) & 0xff;
+  mantissa = bits.i & 0x7fffff;
+
+  if (exponent == 0xff)
+    /* Infinity or NaN. Keep a bit of the mantissa so that NaN
+       doesn't become infinity */
+    return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+  /* Too big to represent so it becomes infinity */
+  if (exponent > 127 + 15)
+    return sign | 0x7c00;
+
+  if (exponent < 127 - 14)
+    {
+      int shift;
+
+      /* Anything smaller than half of the smallest denormal rounds
+         to zero */
+      if (exponent < 127 - 25)
+        return sign;
+
+      /* Otherwise it becomes a denormal */
+      mantissa |= 0x800000;
+      shift = 126 - exponent;
+      half = mantissa >> shift;
+
+      /* Round to nearest even */
+      if ((mantissa & (1 << (shift - 1))) &&
+          ((mantissa & ((1 << (shift - 1)) - 1)) || (half & 1)))
+        half++;
+
+      return sign | half;
+    }
+
+  half = sign | ((exponent - 112) << 10) | (mantissa >> 13);
+
+  /* Round to nearest even. If this overflows the mantissa it
+     correctly carries into the exponent */
+  if ((mantissa & 0x1000) && ((mantissa & 0xfff) || (half & 1)))
+    half++;
+
+  return half;
+}
+
+/* Use the F16C instructions to convert four components at once when
+   they are available */
+#if defined(__F16C__) && defined(__GNUC__) \
+  && (defined(__x86_64) || defined(__i386))
+#define COGL_USE_F16C
+#endif
+
+static void
+_cogl_half_to_float_n (const guint16 *src, float *dst, int n)
+{
+#ifdef COGL_USE_F16C
+  while (n >= 4)
+    {
+      asm (/* Convert four halfs from src to floats in xmm0 */
+           "vcvtph2ps (%0), %%xmm0\n"
+           /* Write them to dst */
+           "vmovups %%xmm0, (%1)\n"
+           : /* no outputs */
+           : "r" (src), "r" (dst)
+           : "xmm0", "memory");
+      src += 4;
+      dst += 4;
+      n -= 4;
+    }
+#endif /* COGL_USE_F16C */
+
+  while (n-- > 0)
+    *(dst++) = _cogl_half_to_float (*(src++));
+}
+
+static void
+_cogl_float_to_half_n (const float *src, guint16 *dst, int n)
+{
+#ifdef COGL_USE_F16C
+  while (n >= 4)
+    {
+      asm (/* Load four floats from src */
+           "vmovups (%0), %%xmm0\n"
+           /* Convert them to halfs with rounding to nearest even and
+              write them to dst */
+           "vcvtps2ph $0, %%xmm0, (%1)\n"
+           : /* no outputs */
+           : "r" (src), "r" (dst)
+           : "xmm0", "memory");
+      src += 4;
+      dst += 4;
+      n -= 4;
+    }
+#endif /* COGL_USE_F16C */
+
+  while (n-- > 0)
+    *(dst++) = _cogl_float_to_half (*(src++));
+}
+
+/* Expands a row of pixels in any format that the fallback code
+   supports to floating point RGBA */
+static void
+_cogl_unpack_float_row (CoglPixelFormat format,
+                        const guint8 *src,
+                        float *dst,
+                        int width)
+{
+  const guint16 *half_src = (const guint16 *) src;
+  guint8 temp_rgba[4];
+  int bpp;
+  int x;
+
+  switch (format & COGL_UNPREMULT_MASK)
+    {
+    case COGL_PIXEL_FORMAT_R_16F:
+      for (x = 0; x < width; x++, dst += 4)
+        {
+          dst[0] = _cogl_half_to_float (half_src[x]);
+          dst[1] = 0.0f;
+          dst[2] = 0.0f;
+          dst[3] = 1.0f;
+        }
+      break;
+
+    case COGL_PIXEL_FORMAT_RG_16F:
+      for (x = 0; x < width; x++, dst += 4)
+        {
+          dst[0] = _cogl_half_to_float (half_src[x * 2]);
+          dst[1] = _cogl_half_to_float (half_src[x * 2 + 1]);
+          dst[2] = 0.0f;
+          dst[3] = 1.0f;
+        }
+      break;
+
+    case COGL_PIXEL_FORMAT_RGBA_16F:
+      _cogl_half_to_float_n (half_src, dst, width * 4);
+      break;
+
+    case COGL_PIXEL_FORMAT_RGBA_32F:
+      memcpy (dst, src, width * 4 * sizeof (float));
+      break;
+
+    default:
+      bpp = _cogl_get_format_bpp (format);
+
+      for (x = 0; x < width; x++, src += bpp, dst += 4)
+        {
+          _cogl_to_rgba (format, src, temp_rgba);
+          dst[0] = temp_rgba[0] * (1.0f / 255.0f);
+          dst[1] = temp_rgba[1] * (1.0f / 255.0f);
+          dst[2] = temp_rgba[2] * (1.0f / 255.0f);
+          dst[3] = temp_rgba[3] * (1.0f / 255.0f);
+        }
+      break;
+    }
+}
+
+inline static guint8
+_cogl_float_to_byte (float f)
+{
+  if (f <= 0.0f)
+    return 0;
+  else if (f >= 1.0f)
+    return 255;
+  else
+    return f * 255.0f + 0.5f;
+}
+
+/* Packs a row of floating point RGBA pixels into any format that the
+   fallback code supports */
+static void
+_cogl_pack_float_row (CoglPixelFormat format,
+                      const float *src,
+                      guint8 *dst,
+                      int width)
+{
+  guint16 *half_dst = (guint16 *) dst;
+  guint8 temp_rgba[4];
+  int bpp;
+  int x;
+
+  switch (format & COGL_UNPREMULT_MASK)
+    {
+    case COGL_PIXEL_FORMAT_R_16F:
+      for (x = 0; x < width; x++, src += 4)
+        half_dst[x] = _cogl_float_to_half (src[0]);
+      break;
+
+    case COGL_PIXEL_FORMAT_RG_16F:
+      for (x = 0; x < width; x++, src += 4)
+        {
+          half_dst[x * 2] = _cogl_float_to_half (src[0]);
+          half_dst[x * 2 + 1] = _cogl_float_to_half (src[1]);
+        }
+      break;
+
+    case COGL_PIXEL_FORMAT_RGBA_16F:
+      _cogl_float_to_half_n (src, half_dst, width * 4);
+      break;
+
+    case COGL_PIXEL_FORMAT_RGBA_32F:
+      memcpy (dst, src, width * 4 * sizeof (float));
+      break;
+
+    default:
+      bpp = _cogl_get_format_bpp (format);
+
+      for (x = 0; x < width; x++, src += 4, dst += bpp)
+        {
+          temp_rgba[0] = _cogl_float_to_byte (src[0]);
+          temp_rgba[1] = _cogl_float_to_byte (src[1]);
+          temp_rgba[2] = _cogl_float_to_byte (src[2]);
+          temp_rgba[3] = _cogl_float_to_byte (src[3]);
+          _cogl_from_rgba (format, temp_rgba, dst);
+        }
+      break;
+    }
+}
+
 /* (Un)Premultiplication */
 
 inline static void
@@ -300,6 +662,50 @@ _cogl_premult_alpha_last_four_pixels_sse2 (guint8 *p)
 
 #endif /* COGL_USE_PREMULT_SSE2 */
 
+/* Floating point pixels are (un)premultiplied by expanding each row
+   to floats and packing it again in place */
+static void
+_cogl_bitmap_fallback_premult_float (CoglPixelFormat format,
+                                     guint8 *data,
+                                     int width,
+                                     int height,
+                                     int rowstride,
+                                     gboolean premult)
+{
+  float *row = g_new (float, width * 4);
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      guint8 *p = data + y * rowstride;
+      float *f = row;
+
+      _cogl_unpack_float_row (format, p, row, width);
+
+      for (x = 0; x < width; x++, f += 4)
+        {
+          if (premult)
+            {
+              f[0] *= f[3];
+              f[1] *= f[3];
+              f[2] *= f[3];
+            }
+          else if (f[3] == 0.0f)
+            f[0] = f[1] = f[2] = 0.0f;
+          else
+            {
+              f[0] /= f[3];
+              f[1] /= f[3];
+              f[2] /= f[3];
+            }
+        }
+
+      _cogl_pack_float_row (format, row, p, width);
+    }
+
+  g_free (row);
+}
+
 gboolean
 _cogl_bitmap_fallback_can_convert (CoglPixelFormat src, CoglPixelFormat dst)
 {
@@ -309,12 +715,21 @@ _cogl_bitmap_fallback_can_convert (CoglPixelFormat src, CoglPixelFormat dst)
   switch (src & COGL_UNORDERED_MASK)
     {
     case COGL_PIXEL_FORMAT_G_8:
+    case COGL_PIXEL_FORMAT_R_8:
+    case COGL_PIXEL_FORMAT_RG_88:
     case COGL_PIXEL_FORMAT_24:
     case COGL_PIXEL_FORMAT_32:
+    case COGL_PIXEL_FORMAT_R_16F:
+    case COGL_PIXEL_FORMAT_RG_16F:
+    case COGL_PIXEL_FORMAT_RGBA_16F & COGL_UNORDERED_MASK:
+    case COGL_PIXEL_FORMAT_RGBA_32F & COGL_UNORDERED_MASK:
 
       if ((dst & COGL_UNORDERED_MASK) != COGL_PIXEL_FORMAT_24 &&
 	  (dst & COGL_UNORDERED_MASK) != COGL_PIXEL_FORMAT_32 &&
-	  (dst & COGL_UNORDERED_MASK) != COGL_PIXEL_FORMAT_G_8)
+	  (dst & COGL_UNORDERED_MASK) != COGL_PIXEL_FORMAT_G_8 &&
+	  (dst & COGL_UNORDERED_MASK) != COGL_PIXEL_FORMAT_R_8 &&
+	  (dst & COGL_UNORDERED_MASK) != COGL_PIXEL_FORMAT_RG_88 &&
+          !_cogl_format_is_float (dst))
 	return FALSE;
       break;
 
@@ -328,13 +743,52 @@ _cogl_bitmap_fallback_can_convert (CoglPixelFormat src, CoglPixelFormat dst)
 gboolean
 _cogl_bitmap_fallback_can_unpremult (CoglPixelFormat format)
 {
-  return ((format & COGL_UNORDERED_MASK) == COGL_PIXEL_FORMAT_32);
+  return ((format & COGL_UNORDERED_MASK) == COGL_PIXEL_FORMAT_32 ||
+          (format & COGL_UNPREMULT_MASK) == COGL_PIXEL_FORMAT_RGBA_16F ||
+          (format & COGL_UNPREMULT_MASK) == COGL_PIXEL_FORMAT_RGBA_32F);
 }
 
 gboolean
 _cogl_bitmap_fallback_can_premult (CoglPixelFormat format)
 {
-  return ((format & COGL_UNORDERED_MASK) == COGL_PIXEL_FORMAT_32);
+  return _cogl_bitmap_fallback_can_unpremult (format);
+}
+
+static CoglBitmap *
+_cogl_bitmap_fallback_convert_float (CoglBitmap *src_bmp,
+                                     const guint8 *src_data,
+                                     CoglPixelFormat dst_format)
+{
+  CoglPixelFormat src_format = _cogl_bitmap_get_format (src_bmp);
+  int src_rowstride = _cogl_bitmap_get_rowstride (src_bmp);
+  int width = _cogl_bitmap_get_width (src_bmp);
+  int height = _cogl_bitmap_get_height (src_bmp);
+  int dst_rowstride = _cogl_get_format_bpp (dst_format) * width;
+  guint8 *dst_data = g_malloc (height * dst_rowstride);
+  float *row = g_new (float, width * 4);
+  int y;
+
+  /* Each row is expanded to floating point RGBA so that no precision
+     is lost when converting between two floating point formats */
+  for (y = 0; y < height; y++)
+    {
+      _cogl_unpack_float_row (src_format,
+                              src_data + y * src_rowstride,
+                              row,
+                              width);
+      _cogl_pack_float_row (dst_format,
+                            row,
+                            dst_data + y * dst_rowstride,
+                            width);
+    }
+
+  g_free (row);
+
+  return _cogl_bitmap_new_from_data (dst_data,
+                                     dst_format,
+                                     width, height, dst_rowstride,
+                                     (CoglBitmapDestroyNotify) g_free,
+                                     NULL);
 }
 
 CoglBitmap *
@@ -377,6 +831,17 @@ _cogl_bitmap_fallback_convert (CoglBitmap      *src_bmp,
     dst_format = ((src_format & COGL_PREMULT_BIT) |
                   (dst_format & COGL_UNPREMULT_MASK));
 
+  if (_cogl_format_is_float (src_format) ||
+      _cogl_format_is_float (dst_format))
+    {
+      CoglBitmap *dst_bmp =
+        _cogl_bitmap_fallback_convert_float (src_bmp, src_data, dst_format);
+
+      _cogl_bitmap_unmap (src_bmp);
+
+      return dst_bmp;
+    }
+
   /* Allocate a new buffer to hold converted data */
   dst_data = g_malloc (height * dst_rowstride);
 
@@ -391,45 +856,8 @@ _cogl_bitmap_fallback_convert (CoglBitmap      *src_bmp,
 	  /* FIXME: Would be nice to at least remove this inner
            * branching, but not sure it can be done without
            * rewriting of the whole loop */
-          switch (src_format & COGL_UNPREMULT_MASK)
-	    {
-	    case COGL_PIXEL_FORMAT_G_8:
-	      _cogl_g_to_rgba (src, temp_rgba); break;
-	    case COGL_PIXEL_FORMAT_RGB_888:
-	      _cogl_rgb_to_rgba (src, temp_rgba); break;
-	    case COGL_PIXEL_FORMAT_BGR_888:
-	      _cogl_bgr_to_rgba (src, temp_rgba); break;
-	    case COGL_PIXEL_FORMAT_RGBA_8888:
-	      _cogl_rgba_to_rgba (src, temp_rgba); break;
-	    case COGL_PIXEL_FORMAT_BGRA_8888:
-	      _cogl_bgra_to_rgba (src, temp_rgba); break;
-	    case COGL_PIXEL_FORMAT_ARGB_8888:
-	      _cogl_argb_to_rgba (src, temp_rgba); break;
-	    case COGL_PIXEL_FORMAT_ABGR_8888:
-	      _cogl_abgr_to_rgba (src, temp_rgba); break;
-	    default:
-	      break;
-	    }
-
-	  switch (dst_format & COGL_UNPREMULT_MASK)
-	    {
-	    case COGL_PIXEL_FORMAT_G_8:
-	      _cogl_rgba_to_g (temp_rgba, dst); break;
-	    case COGL_PIXEL_FORMAT_RGB_888:
-	      _cogl_rgba_to_rgb (temp_rgba, dst); break;
-	    case COGL_PIXEL_FORMAT_BGR_888:
-	      _cogl_rgba_to_bgr (temp_rgba, dst); break;
-	    case COGL_PIXEL_FORMAT_RGBA_8888:
-	      _cogl_rgba_to_rgba (temp_rgba, dst); break;
-	    case COGL_PIXEL_FORMAT_BGRA_8888:
-	      _cogl_rgba_to_bgra (temp_rgba, dst); break;
-	    case COGL_PIXEL_FORMAT_ARGB_8888:
-	      _cogl_rgba_to_argb (temp_rgba, dst); break;
-	    case COGL_PIXEL_FORMAT_ABGR_8888:
-	      _cogl_rgba_to_abgr (temp_rgba, dst); break;
-	    default:
-	      break;
-	    }
+          _cogl_to_rgba (src_format, src, temp_rgba);
+          _cogl_from_rgba (dst_format, temp_rgba, dst);
 
 	  src += src_bpp;
 	  dst += dst_bpp;
@@ -469,6 +897,16 @@ _cogl_bitmap_fallback_unpremult (CoglBitmap *bmp)
                                 0)) == NULL)
     return FALSE;
 
+  if (_cogl_format_is_float (format))
+    {
+      _cogl_bitmap_fallback_premult_float (format, data,
+                                           width, height, rowstride,
+                                           FALSE);
+      _cogl_bitmap_unmap (bmp);
+      _cogl_bitmap_set_format (bmp, format & ~COGL_PREMULT_BIT);
+      return TRUE;
+    }
+
   for (y = 0; y < height; y++)
     {
       p = (guint8*) data + y * rowstride;
@@ -528,6 +966,16 @@ _cogl_bitmap_fallback_premult (CoglBitmap *bmp)
                                 0)) == NULL)
     return FALSE;
 
+  if (_cogl_format_is_float (format))
+    {
+      _cogl_bitmap_fallback_premult_float (format, data,
+                                           width, height, rowstride,
+                                           TRUE);
+      _cogl_bitmap_unmap (bmp);
+      _cogl_bitmap_set_format (bmp, format | COGL_PREMULT_BIT);
+      return TRUE;
+    }
+
   for (y = 0; y < height; y++)
     {
       p = (guint8*) data + y * rowstride;
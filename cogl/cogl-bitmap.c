@@ -92,7 +92,14 @@ _cogl_get_format_bpp (CoglPixelFormat format)
     2, /* 4444     */
     2, /* 5551     */
     2, /* YUV      */
-    1  /* G_8      */
+    1, /* G_8      */
+    2, /* R_16F    */
+    4, /* RG_16F   */
+    8, /* RGBA_16F */
+    16, /* RGBA_32F */
+    1, /* R_8      */
+    2, /* RG_88    */
+    0  /* invalid  */
   };
 
   return bpp_lut [format & COGL_UNORDERED_MASK];
@@ -36,31 +36,191 @@
 #include "cogl-context-private.h"
 #include "cogl-framebuffer-private.h"
 #include "cogl-texture-2d-private.h"
+#include "cogl-texture-private.h"
+#include "cogl-profile.h"
 #include "cogl-private.h"
 
+/* The maximum number of offscreen framebuffers kept in
+   ctx->blit_fbo_cache */
+#define COGL_BLIT_FBO_CACHE_SIZE 4
+
 static const CoglBlitMode *_cogl_blit_default_mode = NULL;
 
-static gboolean
-_cogl_blit_texture_render_begin (CoglBlitData *data)
+static CoglUserDataKey blit_fbo_key;
+
+/* This is called either when the texture of a cached framebuffer is
+   destroyed or when the cache entry is cleared with
+   _cogl_object_set_user_data(). The cache doesn't own a reference on
+   the texture so the framebuffer must not unref it when it is
+   freed */
+static void
+_cogl_blit_fbo_texture_destroy_cb (void *user_data,
+                                   void *instance)
+{
+  CoglOffscreen *offscreen = user_data;
+  CoglContext *ctx = COGL_FRAMEBUFFER (offscreen)->context;
+
+  ctx->blit_fbo_cache = g_list_remove (ctx->blit_fbo_cache, offscreen);
+
+  offscreen->texture = COGL_INVALID_HANDLE;
+  cogl_object_unref (offscreen);
+}
+
+static void
+_cogl_blit_drop_cached_fbo (CoglOffscreen *offscreen)
+{
+  /* Clearing the user data invokes the destroy callback which does
+     the rest */
+  _cogl_object_set_user_data (COGL_OBJECT (offscreen->texture),
+                              &blit_fbo_key,
+                              NULL,
+                              NULL);
+}
+
+void
+_cogl_blit_clear_fbo_cache (CoglContext *ctx)
+{
+  while (ctx->blit_fbo_cache)
+    _cogl_blit_drop_cached_fbo (ctx->blit_fbo_cache->data);
+}
+
+/* Returns an allocated offscreen framebuffer for the texture or
+   COGL_INVALID_HANDLE. The caller owns the returned reference.
+
+   Framebuffers for source textures are cached on the context so
+   that repeatedly blitting from the same texture doesn't create a
+   new FBO each time. The cache doesn't keep the texture or the
+   context alive. Framebuffers for destination textures aren't
+   cached because a texture that has a framebuffer can no longer
+   batch its uploads or be evicted, and the destination of an atlas
+   migration is the texture that stays around */
+static CoglHandle
+_cogl_blit_get_fbo (CoglHandle texture,
+                    gboolean cache)
 {
   CoglHandle fbo;
-  CoglPipeline *pipeline;
-  unsigned int dst_width, dst_height;
+  GList *l;
 
-  _COGL_GET_CONTEXT (ctx, FALSE);
+  COGL_STATIC_COUNTER (blit_fbo_counter,
+                       "Blit FBO counter",
+                       "Increments each time a blit has to create a "
+                       "new offscreen framebuffer",
+                       0 /* no application private data */);
+
+  _COGL_GET_CONTEXT (ctx, COGL_INVALID_HANDLE);
+
+  for (l = ctx->blit_fbo_cache; l; l = l->next)
+    {
+      CoglOffscreen *offscreen = l->data;
+
+      if (offscreen->texture == texture)
+        {
+          /* Move the framebuffer to the front of the list */
+          ctx->blit_fbo_cache =
+            g_list_remove_link (ctx->blit_fbo_cache, l);
+          ctx->blit_fbo_cache = g_list_concat (l, ctx->blit_fbo_cache);
+
+          return cogl_handle_ref (offscreen);
+        }
+    }
+
+  COGL_COUNTER_INC (_cogl_uprof_context, blit_fbo_counter);
 
   fbo = _cogl_offscreen_new_to_texture_full
-    (data->dst_tex, COGL_OFFSCREEN_DISABLE_DEPTH_AND_STENCIL, 0 /* level */);
+    (texture, COGL_OFFSCREEN_DISABLE_DEPTH_AND_STENCIL, 0 /* level */);
 
   if (fbo == COGL_INVALID_HANDLE)
-    return FALSE;
+    return COGL_INVALID_HANDLE;
 
   if (!cogl_framebuffer_allocate (fbo, NULL))
     {
       cogl_handle_unref (fbo);
-      return FALSE;
+      return COGL_INVALID_HANDLE;
     }
 
+  if (cache)
+    {
+      /* The cache must keep neither the context nor the texture
+         alive. The texture reference is given up here and instead
+         the framebuffer is dropped from the texture's destroy
+         notification */
+      _cogl_framebuffer_release_context_ref (fbo);
+      cogl_object_unref (texture);
+      _cogl_object_set_user_data (COGL_OBJECT (texture),
+                                  &blit_fbo_key,
+                                  fbo,
+                                  _cogl_blit_fbo_texture_destroy_cb);
+
+      ctx->blit_fbo_cache = g_list_prepend (ctx->blit_fbo_cache, fbo);
+
+      if (g_list_length (ctx->blit_fbo_cache) > COGL_BLIT_FBO_CACHE_SIZE)
+        _cogl_blit_drop_cached_fbo (g_list_last (ctx->blit_fbo_cache)->data);
+
+      cogl_handle_ref (fbo);
+    }
+
+  return fbo;
+}
+
+static gboolean
+_cogl_blit_copy_image_begin (CoglBlitData *data)
+{
+  _COGL_GET_CONTEXT (ctx, FALSE);
+
+  /* glCopyImageSubData can only copy between textures with
+     compatible internal formats so we require them to be exactly the
+     same. The copy is done directly on the GL textures so they both
+     need to be CoglTexture2Ds */
+  if (!(ctx->private_feature_flags & COGL_PRIVATE_FEATURE_COPY_IMAGE) ||
+      !cogl_is_texture_2d (data->src_tex) ||
+      !cogl_is_texture_2d (data->dst_tex) ||
+      cogl_texture_get_format (data->src_tex) !=
+      cogl_texture_get_format (data->dst_tex))
+    return FALSE;
+
+  /* The copy bypasses the journal so any rendering to either texture
+     must be flushed first */
+  _cogl_texture_flush_journal_rendering (data->src_tex);
+  _cogl_texture_flush_journal_rendering (data->dst_tex);
+
+  return TRUE;
+}
+
+static void
+_cogl_blit_copy_image_blit (CoglBlitData *data,
+                            unsigned int src_x,
+                            unsigned int src_y,
+                            unsigned int dst_x,
+                            unsigned int dst_y,
+                            unsigned int width,
+                            unsigned int height)
+{
+  _cogl_texture_2d_copy_from_texture_2d (data->dst_tex,
+                                         dst_x, dst_y,
+                                         data->src_tex,
+                                         src_x, src_y,
+                                         width, height);
+}
+
+static void
+_cogl_blit_copy_image_end (CoglBlitData *data)
+{
+}
+
+static gboolean
+_cogl_blit_texture_render_begin (CoglBlitData *data)
+{
+  CoglHandle fbo;
+  CoglPipeline *pipeline;
+  unsigned int dst_width, dst_height;
+
+  _COGL_GET_CONTEXT (ctx, FALSE);
+
+  fbo = _cogl_blit_get_fbo (data->dst_tex, FALSE);
+
+  if (fbo == COGL_INVALID_HANDLE)
+    return FALSE;
+
   cogl_push_framebuffer (fbo);
   cogl_handle_unref (fbo);
 
@@ -158,33 +318,22 @@ _cogl_blit_framebuffer_begin (CoglBlitData *data)
       !(ctx->private_feature_flags & COGL_PRIVATE_FEATURE_OFFSCREEN_BLIT))
     return FALSE;
 
-  dst_fbo = _cogl_offscreen_new_to_texture_full
-    (data->dst_tex, COGL_OFFSCREEN_DISABLE_DEPTH_AND_STENCIL, 0 /* level */);
+  dst_fbo = _cogl_blit_get_fbo (data->dst_tex, FALSE);
 
   if (dst_fbo == COGL_INVALID_HANDLE)
     ret = FALSE;
   else
     {
-      if (!cogl_framebuffer_allocate (dst_fbo, NULL))
+      src_fbo = _cogl_blit_get_fbo (data->src_tex, TRUE);
+
+      if (src_fbo == COGL_INVALID_HANDLE)
         ret = FALSE;
       else
         {
-          src_fbo = _cogl_offscreen_new_to_texture_full
-            (data->src_tex,
-             COGL_OFFSCREEN_DISABLE_DEPTH_AND_STENCIL,
-             0 /* level */);
-
-          if (src_fbo == COGL_INVALID_HANDLE)
-            ret = FALSE;
-          else
-            {
-              if (!cogl_framebuffer_allocate (src_fbo, NULL))
-                ret = FALSE;
-              else
-                _cogl_push_framebuffers (dst_fbo, src_fbo);
+          _cogl_push_framebuffers (dst_fbo, src_fbo);
+          ret = TRUE;
 
-              cogl_handle_unref (src_fbo);
-            }
+          cogl_handle_unref (src_fbo);
         }
 
       cogl_handle_unref (dst_fbo);
@@ -224,18 +373,11 @@ _cogl_blit_copy_tex_sub_image_begin (CoglBlitData *data)
   if (!cogl_is_texture_2d (data->dst_tex))
     return FALSE;
 
-  fbo = _cogl_offscreen_new_to_texture_full
-    (data->src_tex, COGL_OFFSCREEN_DISABLE_DEPTH_AND_STENCIL, 0 /* level */);
+  fbo = _cogl_blit_get_fbo (data->src_tex, TRUE);
 
   if (fbo == COGL_INVALID_HANDLE)
     return FALSE;
 
-  if (!cogl_framebuffer_allocate (fbo, NULL))
-    {
-      cogl_handle_unref (fbo);
-      return FALSE;
-    }
-
   cogl_push_framebuffer (fbo);
   cogl_handle_unref (fbo);
 
@@ -306,6 +448,12 @@ _cogl_blit_get_tex_data_end (CoglBlitData *data)
 static const CoglBlitMode
 _cogl_blit_modes[] =
   {
+    {
+      "copy-image",
+      _cogl_blit_copy_image_begin,
+      _cogl_blit_copy_image_blit,
+      _cogl_blit_copy_image_end
+    },
     {
       "texture-render",
       _cogl_blit_texture_render_begin,
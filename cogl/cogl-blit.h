@@ -26,6 +26,7 @@
 
 #include <glib.h>
 #include "cogl-handle.h"
+#include "cogl-context.h"
 
 /* This structures and functions are used when a series of blits needs
    to be performed between two textures. In this case there are
@@ -86,4 +87,10 @@ _cogl_blit (CoglBlitData *data,
 void
 _cogl_blit_end (CoglBlitData *data);
 
+/* Drops all of the framebuffers that are cached for blitting. This
+   is used when the context is destroyed and to let the textures be
+   evicted when over the memory budget */
+void
+_cogl_blit_clear_fbo_cache (CoglContext *ctx);
+
 #endif /* __COGL_BLIT_H */
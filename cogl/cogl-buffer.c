@@ -174,6 +174,11 @@ bo_map (CoglBuffer       *buffer,
                              buffer->size,
                              NULL,
                              gl_enum) );
+
+      if (!buffer->store_created)
+        _cogl_context_add_memory_usage (ctx,
+                                        COGL_MEMORY_USAGE_TYPE_BUFFER,
+                                        buffer->size);
       buffer->store_created = TRUE;
     }
 
@@ -227,6 +232,9 @@ bo_set_data (CoglBuffer   *buffer,
                              buffer->size,
                              NULL,
                              gl_enum) );
+      _cogl_context_add_memory_usage (ctx,
+                                      COGL_MEMORY_USAGE_TYPE_BUFFER,
+                                      buffer->size);
       buffer->store_created = TRUE;
     }
 
@@ -311,7 +319,14 @@ _cogl_buffer_fini (CoglBuffer *buffer)
   _COGL_RETURN_IF_FAIL (buffer->immutable_ref == 0);
 
   if (buffer->flags & COGL_BUFFER_FLAG_BUFFER_OBJECT)
-    GE( buffer->context, glDeleteBuffers (1, &buffer->gl_handle) );
+    {
+      GE( buffer->context, glDeleteBuffers (1, &buffer->gl_handle) );
+
+      if (buffer->store_created)
+        _cogl_context_remove_memory_usage (buffer->context,
+                                           COGL_MEMORY_USAGE_TYPE_BUFFER,
+                                           buffer->size);
+    }
   else
     g_free (buffer->data);
 
@@ -45,6 +45,7 @@
 #include "cogl-pipeline-opengl-private.h"
 #include "cogl-attribute-private.h"
 #include "cogl-primitive-private.h"
+#include "cogl-profile.h"
 
 #ifndef GL_CLIP_PLANE0
 #define GL_CLIP_PLANE0 0x3000
@@ -484,6 +485,8 @@ _cogl_clip_stack_push_entry (CoglClipStack *clip_stack,
   entry->ref_count = 1;
   entry->type = type;
   entry->parent = clip_stack;
+  entry->bounds_valid = FALSE;
+  entry->stack_bounds_valid = FALSE;
 
   /* We don't need to take a reference to the parent from the entry
      because the we are stealing the ref in the new stack top */
@@ -491,6 +494,15 @@ _cogl_clip_stack_push_entry (CoglClipStack *clip_stack,
   return entry;
 }
 
+/* Remembers the current projection and viewport so that the bounds
+   of the entry can be calculated later */
+static void
+_cogl_clip_stack_entry_save_projection (CoglClipStack *entry)
+{
+  cogl_get_projection_matrix (&entry->projection);
+  cogl_get_viewport (entry->viewport);
+}
+
 /* Sets the window-space bounds of the entry based on the projected
    coordinates of the given rectangle */
 static void
@@ -501,22 +513,18 @@ _cogl_clip_stack_entry_set_bounds (CoglClipStack *entry,
                                    float y_2,
                                    const CoglMatrix *modelview)
 {
-  CoglMatrix projection;
-  float viewport[4];
   float verts[4 * 2] = { x_1, y_1, x_2, y_1, x_2, y_2, x_1, y_2 };
   float min_x = G_MAXFLOAT, min_y = G_MAXFLOAT;
   float max_x = -G_MAXFLOAT, max_y = -G_MAXFLOAT;
   int i;
 
-  cogl_get_projection_matrix (&projection);
-  cogl_get_viewport (viewport);
-
   for (i = 0; i < 4; i++)
     {
       float *v = verts + i * 2;
 
       /* Project the coordinates to window space coordinates */
-      _cogl_transform_point (modelview, &projection, viewport, v, v + 1);
+      _cogl_transform_point (modelview, &entry->projection, entry->viewport,
+                             v, v + 1);
 
       if (v[0] > max_x)
         max_x = v[0];
@@ -551,6 +559,7 @@ _cogl_clip_stack_push_window_rectangle (CoglClipStack *stack,
   entry->bounds_x1 = x_offset + width;
   entry->bounds_y0 = y_offset;
   entry->bounds_y1 = y_offset + height;
+  entry->bounds_valid = TRUE;
 
   return entry;
 }
@@ -564,8 +573,6 @@ _cogl_clip_stack_push_rectangle (CoglClipStack *stack,
                                  const CoglMatrix *modelview_matrix)
 {
   CoglClipStackRect *entry;
-  CoglMatrix matrix_p;
-  float v[4];
 
   /* Make a new entry */
   entry = _cogl_clip_stack_push_entry (stack,
@@ -579,6 +586,8 @@ _cogl_clip_stack_push_rectangle (CoglClipStack *stack,
 
   entry->matrix = *modelview_matrix;
 
+  _cogl_clip_stack_entry_save_projection ((CoglClipStack *) entry);
+
   /* If the modelview meets these constraints then a transformed rectangle
    * should still be a rectangle when it reaches screen coordinates.
    *
@@ -591,38 +600,46 @@ _cogl_clip_stack_push_rectangle (CoglClipStack *stack,
   if (modelview_matrix->xy != 0 || modelview_matrix->xz != 0 ||
       modelview_matrix->yx != 0 || modelview_matrix->yz != 0 ||
       modelview_matrix->zx != 0 || modelview_matrix->zy != 0)
-    {
-      entry->can_be_scissor = FALSE;
-      _cogl_clip_stack_entry_set_bounds ((CoglClipStack *) entry,
-                                         x_1, y_1, x_2, y_2, modelview_matrix);
-    }
+    entry->can_be_scissor = FALSE;
   else
-    {
-      CoglClipStack *base_entry = (CoglClipStack *) entry;
+    entry->can_be_scissor = TRUE;
 
-      cogl_get_projection_matrix (&matrix_p);
-      cogl_get_viewport (v);
+  return (CoglClipStack *) entry;
+}
 
-      _cogl_transform_point (modelview_matrix, &matrix_p, v, &x_1, &y_1);
-      _cogl_transform_point (modelview_matrix, &matrix_p, v, &x_2, &y_2);
+static void
+_cogl_clip_stack_rect_set_bounds (CoglClipStackRect *entry)
+{
+  CoglClipStack *base_entry = (CoglClipStack *) entry;
+  float x_1 = entry->x0, y_1 = entry->y0;
+  float x_2 = entry->x1, y_2 = entry->y1;
+
+  if (!entry->can_be_scissor)
+    {
+      _cogl_clip_stack_entry_set_bounds (base_entry,
+                                         x_1, y_1, x_2, y_2,
+                                         &entry->matrix);
+      return;
+    }
+
+  _cogl_transform_point (&entry->matrix, &base_entry->projection,
+                         base_entry->viewport, &x_1, &y_1);
+  _cogl_transform_point (&entry->matrix, &base_entry->projection,
+                         base_entry->viewport, &x_2, &y_2);
 
-      /* Consider that the modelview matrix may flip the rectangle
-       * along the x or y axis... */
+  /* Consider that the modelview matrix may flip the rectangle
+   * along the x or y axis... */
 #define SWAP(A,B) do { float tmp = B; B = A; A = tmp; } while (0)
-      if (x_1 > x_2)
-        SWAP (x_1, x_2);
-      if (y_1 > y_2)
-        SWAP (y_1, y_2);
+  if (x_1 > x_2)
+    SWAP (x_1, x_2);
+  if (y_1 > y_2)
+    SWAP (y_1, y_2);
 #undef SWAP
 
-      base_entry->bounds_x0 = COGL_UTIL_NEARBYINT (x_1);
-      base_entry->bounds_y0 = COGL_UTIL_NEARBYINT (y_1);
-      base_entry->bounds_x1 = COGL_UTIL_NEARBYINT (x_2);
-      base_entry->bounds_y1 = COGL_UTIL_NEARBYINT (y_2);
-      entry->can_be_scissor = TRUE;
-    }
-
-  return (CoglClipStack *) entry;
+  base_entry->bounds_x0 = COGL_UTIL_NEARBYINT (x_1);
+  base_entry->bounds_y0 = COGL_UTIL_NEARBYINT (y_1);
+  base_entry->bounds_x1 = COGL_UTIL_NEARBYINT (x_2);
+  base_entry->bounds_y1 = COGL_UTIL_NEARBYINT (y_2);
 }
 
 CoglClipStack *
@@ -654,8 +671,7 @@ _cogl_clip_stack_push_from_path (CoglClipStack *stack,
 
       entry->matrix = *modelview_matrix;
 
-      _cogl_clip_stack_entry_set_bounds ((CoglClipStack *) entry,
-                                         x_1, y_1, x_2, y_2, modelview_matrix);
+      _cogl_clip_stack_entry_save_projection ((CoglClipStack *) entry);
 
       return (CoglClipStack *) entry;
     }
@@ -685,15 +701,218 @@ _cogl_clip_stack_push_primitive (CoglClipStack *stack,
   entry->bounds_x2 = bounds_x2;
   entry->bounds_y2 = bounds_y2;
 
-  /* NB: this is referring to the bounds in window coordinates as opposed
-   * to the bounds above in primitive local coordinates. */
-  _cogl_clip_stack_entry_set_bounds ((CoglClipStack *) entry,
-                                     bounds_x1, bounds_y1, bounds_x2, bounds_y2,
-                                     modelview_matrix);
+  _cogl_clip_stack_entry_save_projection ((CoglClipStack *) entry);
 
   return (CoglClipStack *) entry;
 }
 
+static int
+compare_ints (const void *a, const void *b)
+{
+  int ia = *(const int *) a;
+  int ib = *(const int *) b;
+
+  return (ia > ib) - (ia < ib);
+}
+
+static int
+compare_rects_x (const void *a, const void *b)
+{
+  const CoglClipStackRegionRect *ra = a;
+  const CoglClipStackRegionRect *rb = b;
+
+  return (ra->x0 > rb->x0) - (ra->x0 < rb->x0);
+}
+
+/* Converts a list of possibly overlapping rectangles to the banded
+   representation of their union. The result is appended to
+   @region */
+static void
+_cogl_clip_region_union_rects (const CoglClipStackRegionRect *rects,
+                               int n_rects,
+                               GArray *region)
+{
+  int *edges = g_new (int, n_rects * 2);
+  CoglClipStackRegionRect *spans = g_new (CoglClipStackRegionRect, n_rects);
+  int prev_band_start = region->len;
+  int prev_band_len = 0;
+  int n_edges = 0;
+  int i, j;
+
+  for (i = 0; i < n_rects; i++)
+    if (rects[i].x0 < rects[i].x1 && rects[i].y0 < rects[i].y1)
+      {
+        edges[n_edges++] = rects[i].y0;
+        edges[n_edges++] = rects[i].y1;
+      }
+
+  qsort (edges, n_edges, sizeof (int), compare_ints);
+
+  for (i = 0; i + 1 < n_edges; i++)
+    {
+      int band_y0 = edges[i], band_y1 = edges[i + 1];
+      int n_spans = 0, n_merged = 0;
+      CoglClipStackRegionRect *prev_band;
+
+      if (band_y0 == band_y1)
+        continue;
+
+      for (j = 0; j < n_rects; j++)
+        if (rects[j].x0 < rects[j].x1 &&
+            rects[j].y0 <= band_y0 && rects[j].y1 >= band_y1)
+          spans[n_spans++] = rects[j];
+
+      if (n_spans == 0)
+        {
+          /* A gap means the next band can't be merged */
+          prev_band_len = 0;
+          continue;
+        }
+
+      qsort (spans, n_spans, sizeof (CoglClipStackRegionRect),
+             compare_rects_x);
+
+      /* Merge the overlapping or touching spans */
+      for (j = 0; j < n_spans; j++)
+        {
+          if (n_merged > 0 && spans[j].x0 <= spans[n_merged - 1].x1)
+            spans[n_merged - 1].x1 = MAX (spans[n_merged - 1].x1,
+                                          spans[j].x1);
+          else
+            spans[n_merged++] = spans[j];
+        }
+
+      for (j = 0; j < n_merged; j++)
+        {
+          spans[j].y0 = band_y0;
+          spans[j].y1 = band_y1;
+        }
+
+      /* If this band has the same spans as the previous band then we
+         can just extend the previous band downwards */
+      prev_band = &g_array_index (region, CoglClipStackRegionRect,
+                                  prev_band_start);
+      if (prev_band_len == n_merged && prev_band->y1 == band_y0)
+        {
+          for (j = 0; j < n_merged; j++)
+            if (prev_band[j].x0 != spans[j].x0 ||
+                prev_band[j].x1 != spans[j].x1)
+              break;
+
+          if (j == n_merged)
+            {
+              for (j = 0; j < n_merged; j++)
+                prev_band[j].y1 = band_y1;
+              continue;
+            }
+        }
+
+      prev_band_start = region->len;
+      prev_band_len = n_merged;
+      g_array_append_vals (region, spans, n_merged);
+    }
+
+  g_free (spans);
+  g_free (edges);
+}
+
+/* Replaces the contents of @region with its intersection with the
+   given banded rectangles */
+static void
+_cogl_clip_region_intersect (GArray *region,
+                             const CoglClipStackRegionRect *rects,
+                             int n_rects)
+{
+  int n_region_rects = region->len;
+  CoglClipStackRegionRect *pieces =
+    g_new (CoglClipStackRegionRect, MAX (1, n_region_rects * n_rects));
+  int n_pieces = 0;
+  int i, j;
+
+  for (i = 0; i < n_region_rects; i++)
+    {
+      const CoglClipStackRegionRect *a =
+        &g_array_index (region, CoglClipStackRegionRect, i);
+
+      for (j = 0; j < n_rects; j++)
+        {
+          const CoglClipStackRegionRect *b = rects + j;
+          CoglClipStackRegionRect *piece = pieces + n_pieces;
+
+          piece->x0 = MAX (a->x0, b->x0);
+          piece->y0 = MAX (a->y0, b->y0);
+          piece->x1 = MIN (a->x1, b->x1);
+          piece->y1 = MIN (a->y1, b->y1);
+
+          if (piece->x0 < piece->x1 && piece->y0 < piece->y1)
+            n_pieces++;
+        }
+    }
+
+  g_array_set_size (region, 0);
+  _cogl_clip_region_union_rects (pieces, n_pieces, region);
+
+  g_free (pieces);
+}
+
+CoglClipStack *
+_cogl_clip_stack_push_region (CoglClipStack *stack,
+                              const int *rectangles,
+                              int n_rectangles)
+{
+  CoglClipStackRegion *entry;
+  CoglClipStack *base_entry;
+  CoglClipStackRegionRect *rects;
+  GArray *region;
+  int i;
+
+  entry = _cogl_clip_stack_push_entry (stack,
+                                       sizeof (CoglClipStackRegion),
+                                       COGL_CLIP_STACK_REGION);
+  base_entry = (CoglClipStack *) entry;
+
+  rects = g_new (CoglClipStackRegionRect, MAX (1, n_rectangles));
+  for (i = 0; i < n_rectangles; i++)
+    {
+      rects[i].x0 = rectangles[i * 4];
+      rects[i].y0 = rectangles[i * 4 + 1];
+      rects[i].x1 = rectangles[i * 4] + rectangles[i * 4 + 2];
+      rects[i].y1 = rectangles[i * 4 + 1] + rectangles[i * 4 + 3];
+    }
+
+  region = g_array_new (FALSE, FALSE, sizeof (CoglClipStackRegionRect));
+  _cogl_clip_region_union_rects (rects, n_rectangles, region);
+  g_free (rects);
+
+  entry->n_rectangles = region->len;
+  entry->rectangles =
+    (CoglClipStackRegionRect *) g_array_free (region, FALSE);
+
+  /* The bounds are the extents of the region */
+  base_entry->bounds_x0 = G_MAXINT;
+  base_entry->bounds_y0 = G_MAXINT;
+  base_entry->bounds_x1 = G_MININT;
+  base_entry->bounds_y1 = G_MININT;
+
+  for (i = 0; i < entry->n_rectangles; i++)
+    {
+      const CoglClipStackRegionRect *rect = entry->rectangles + i;
+
+      base_entry->bounds_x0 = MIN (base_entry->bounds_x0, rect->x0);
+      base_entry->bounds_y0 = MIN (base_entry->bounds_y0, rect->y0);
+      base_entry->bounds_x1 = MAX (base_entry->bounds_x1, rect->x1);
+      base_entry->bounds_y1 = MAX (base_entry->bounds_y1, rect->y1);
+    }
+
+  if (entry->n_rectangles == 0)
+    base_entry->bounds_x0 = base_entry->bounds_y0 =
+      base_entry->bounds_x1 = base_entry->bounds_y1 = 0;
+
+  base_entry->bounds_valid = TRUE;
+
+  return base_entry;
+}
+
 CoglClipStack *
 _cogl_clip_stack_ref (CoglClipStack *entry)
 {
@@ -734,6 +953,11 @@ _cogl_clip_stack_unref (CoglClipStack *entry)
           g_slice_free1 (sizeof (CoglClipStackPrimitive), entry);
           break;
 
+        case COGL_CLIP_STACK_REGION:
+          g_free (((CoglClipStackRegion *) entry)->rectangles);
+          g_slice_free1 (sizeof (CoglClipStackRegion), entry);
+          break;
+
         default:
           g_assert_not_reached ();
         }
@@ -766,6 +990,99 @@ _cogl_clip_stack_pop (CoglClipStack *stack)
   return new_top;
 }
 
+void
+_cogl_clip_stack_ensure_bounds (CoglClipStack *entry)
+{
+  COGL_STATIC_COUNTER (clip_stack_bounds_counter,
+                       "Clip stack bounds counter",
+                       "Increments each time the window-space bounds of a "
+                       "clip stack entry are calculated",
+                       0 /* no application private data */);
+
+  if (entry->bounds_valid)
+    return;
+
+  COGL_COUNTER_INC (_cogl_uprof_context, clip_stack_bounds_counter);
+
+  switch (entry->type)
+    {
+    case COGL_CLIP_STACK_RECT:
+      _cogl_clip_stack_rect_set_bounds ((CoglClipStackRect *) entry);
+      break;
+
+    case COGL_CLIP_STACK_PATH:
+      {
+        CoglClipStackPath *path_entry = (CoglClipStackPath *) entry;
+        float x_1, y_1, x_2, y_2;
+
+        _cogl_path_get_bounds (path_entry->path, &x_1, &y_1, &x_2, &y_2);
+
+        _cogl_clip_stack_entry_set_bounds (entry,
+                                           x_1, y_1, x_2, y_2,
+                                           &path_entry->matrix);
+      }
+      break;
+
+    case COGL_CLIP_STACK_PRIMITIVE:
+      {
+        CoglClipStackPrimitive *primitive_entry =
+          (CoglClipStackPrimitive *) entry;
+
+        /* NB: the entry's bounds are in window coordinates as opposed
+         * to the bounds of the primitive which are in local
+         * coordinates. */
+        _cogl_clip_stack_entry_set_bounds (entry,
+                                           primitive_entry->bounds_x1,
+                                           primitive_entry->bounds_y1,
+                                           primitive_entry->bounds_x2,
+                                           primitive_entry->bounds_y2,
+                                           &primitive_entry->matrix);
+      }
+      break;
+
+    case COGL_CLIP_STACK_WINDOW_RECT:
+    case COGL_CLIP_STACK_REGION:
+      /* The bounds of window rectangles and regions are always
+         valid */
+      g_assert_not_reached ();
+    }
+
+  entry->bounds_valid = TRUE;
+}
+
+static void
+_cogl_clip_stack_ensure_stack_bounds (CoglClipStack *entry)
+{
+  if (entry->stack_bounds_valid)
+    return;
+
+  _cogl_clip_stack_ensure_bounds (entry);
+
+  /* Get the intersection of the bounds of the parent and the bounding
+     box of this clip. The entries are immutable so the result can be
+     kept for as long as the entry is alive */
+  if (entry->parent)
+    {
+      CoglClipStack *parent = entry->parent;
+
+      _cogl_clip_stack_ensure_stack_bounds (parent);
+
+      entry->stack_bounds_x0 = MAX (parent->stack_bounds_x0, entry->bounds_x0);
+      entry->stack_bounds_y0 = MAX (parent->stack_bounds_y0, entry->bounds_y0);
+      entry->stack_bounds_x1 = MIN (parent->stack_bounds_x1, entry->bounds_x1);
+      entry->stack_bounds_y1 = MIN (parent->stack_bounds_y1, entry->bounds_y1);
+    }
+  else
+    {
+      entry->stack_bounds_x0 = MAX (0, entry->bounds_x0);
+      entry->stack_bounds_y0 = MAX (0, entry->bounds_y0);
+      entry->stack_bounds_x1 = entry->bounds_x1;
+      entry->stack_bounds_y1 = entry->bounds_y1;
+    }
+
+  entry->stack_bounds_valid = TRUE;
+}
+
 void
 _cogl_clip_stack_get_bounds (CoglClipStack *stack,
                              int *scissor_x0,
@@ -773,22 +1090,109 @@ _cogl_clip_stack_get_bounds (CoglClipStack *stack,
                              int *scissor_x1,
                              int *scissor_y1)
 {
+  if (stack == NULL)
+    {
+      *scissor_x0 = 0;
+      *scissor_y0 = 0;
+      *scissor_x1 = G_MAXINT;
+      *scissor_y1 = G_MAXINT;
+      return;
+    }
+
+  _cogl_clip_stack_ensure_stack_bounds (stack);
+
+  *scissor_x0 = stack->stack_bounds_x0;
+  *scissor_y0 = stack->stack_bounds_y0;
+  *scissor_x1 = stack->stack_bounds_x1;
+  *scissor_y1 = stack->stack_bounds_y1;
+}
+
+gboolean
+_cogl_clip_stack_has_region (CoglClipStack *stack)
+{
+  CoglClipStack *entry;
+
+  for (entry = stack; entry; entry = entry->parent)
+    if (entry->type == COGL_CLIP_STACK_REGION)
+      return TRUE;
+
+  return FALSE;
+}
+
+/* Works out the intersection of all of the region entries in the
+   stack within the given scissor bounds and stores it in
+   ctx->current_clip_region. Returns FALSE if there are no region
+   entries */
+static gboolean
+_cogl_clip_stack_flatten_regions (CoglContext *ctx,
+                                  CoglClipStack *stack,
+                                  int scissor_x0,
+                                  int scissor_y0,
+                                  int scissor_x1,
+                                  int scissor_y1)
+{
+  CoglClipStackRegionRect scissor;
   CoglClipStack *entry;
+  gboolean has_region = FALSE;
+
+  scissor.x0 = scissor_x0;
+  scissor.y0 = scissor_y0;
+  scissor.x1 = scissor_x1;
+  scissor.y1 = scissor_y1;
 
-  *scissor_x0 = 0;
-  *scissor_y0 = 0;
-  *scissor_x1 = G_MAXINT;
-  *scissor_y1 = G_MAXINT;
+  g_array_set_size (ctx->current_clip_region, 0);
+  g_array_append_val (ctx->current_clip_region, scissor);
 
   for (entry = stack; entry; entry = entry->parent)
-    {
-      /* Get the intersection of the current scissor and the bounding
-         box of this clip */
-      *scissor_x0 = MAX (*scissor_x0, entry->bounds_x0);
-      *scissor_y0 = MAX (*scissor_y0, entry->bounds_y0);
-      *scissor_x1 = MIN (*scissor_x1, entry->bounds_x1);
-      *scissor_y1 = MIN (*scissor_y1, entry->bounds_y1);
-    }
+    if (entry->type == COGL_CLIP_STACK_REGION)
+      {
+        CoglClipStackRegion *region = (CoglClipStackRegion *) entry;
+
+        _cogl_clip_region_intersect (ctx->current_clip_region,
+                                     region->rectangles,
+                                     region->n_rectangles);
+        has_region = TRUE;
+      }
+
+  if (!has_region)
+    g_array_set_size (ctx->current_clip_region, 0);
+
+  return has_region;
+}
+
+int
+_cogl_clip_stack_get_n_region_passes (CoglContext *ctx)
+{
+  return MAX (1, ctx->current_clip_region->len);
+}
+
+void
+_cogl_clip_stack_begin_region_pass (CoglContext *ctx,
+                                    int pass)
+{
+  CoglClipStackRegionRect *rect;
+
+  if (ctx->current_clip_region->len == 0)
+    return;
+
+  rect = &g_array_index (ctx->current_clip_region,
+                         CoglClipStackRegionRect, pass);
+
+  GE (ctx, glScissor (rect->x0, rect->y0,
+                      rect->x1 - rect->x0,
+                      rect->y1 - rect->y0));
+}
+
+void
+_cogl_clip_stack_end_region_passes (CoglContext *ctx)
+{
+  /* Put back the scissor for the bounds of the whole clip stack so
+     that anything else using the scissor sees the expected state */
+  if (ctx->current_clip_region->len > 0)
+    GE (ctx, glScissor (ctx->current_clip_scissor[0],
+                        ctx->current_clip_scissor[1],
+                        ctx->current_clip_scissor[2],
+                        ctx->current_clip_scissor[3]));
 }
 
 void
@@ -805,14 +1209,30 @@ _cogl_clip_stack_flush (CoglClipStack *stack,
   CoglMatrixStack *modelview_stack;
   CoglClipStack *entry;
   int scissor_y_start;
+  int repaint_x0 = 0;
+  int repaint_y0 = 0;
+  int repaint_x1 = G_MAXINT;
+  int repaint_y1 = G_MAXINT;
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
+  if (framebuffer->repaint_clip_enabled)
+    {
+      repaint_x0 = framebuffer->repaint_clip_x0;
+      repaint_y0 = framebuffer->repaint_clip_y0;
+      repaint_x1 = framebuffer->repaint_clip_x1;
+      repaint_y1 = framebuffer->repaint_clip_y1;
+    }
+
   /* If we have already flushed this state then we don't need to do
      anything */
   if (ctx->current_clip_stack_valid)
     {
-      if (ctx->current_clip_stack == stack)
+      if (ctx->current_clip_stack == stack &&
+          ctx->current_clip_repaint_x0 == repaint_x0 &&
+          ctx->current_clip_repaint_y0 == repaint_y0 &&
+          ctx->current_clip_repaint_x1 == repaint_x1 &&
+          ctx->current_clip_repaint_y1 == repaint_y1)
         return;
 
       _cogl_clip_stack_unref (ctx->current_clip_stack);
@@ -820,6 +1240,11 @@ _cogl_clip_stack_flush (CoglClipStack *stack,
 
   ctx->current_clip_stack_valid = TRUE;
   ctx->current_clip_stack = _cogl_clip_stack_ref (stack);
+  g_array_set_size (ctx->current_clip_region, 0);
+  ctx->current_clip_repaint_x0 = repaint_x0;
+  ctx->current_clip_repaint_y0 = repaint_y0;
+  ctx->current_clip_repaint_x1 = repaint_x1;
+  ctx->current_clip_repaint_y1 = repaint_y1;
 
   modelview_stack =
     _cogl_framebuffer_get_modelview_stack (framebuffer);
@@ -831,8 +1256,9 @@ _cogl_clip_stack_flush (CoglClipStack *stack,
     disable_clip_planes ();
   disable_stencil_buffer ();
 
-  /* If the stack is empty then there's nothing else to do */
-  if (stack == NULL)
+  /* If the stack is empty and we aren't limited to a repaint region
+     then there's nothing else to do */
+  if (stack == NULL && !framebuffer->repaint_clip_enabled)
     {
       COGL_NOTE (CLIPPING, "Flushed empty clip stack");
 
@@ -849,6 +1275,63 @@ _cogl_clip_stack_flush (CoglClipStack *stack,
                                &scissor_x0, &scissor_y0,
                                &scissor_x1, &scissor_y1);
 
+  /* Only the region that needs repainting may be touched. The
+     repaint region is already in window coordinates so it can simply
+     be intersected with the bounds of the stack */
+  scissor_x0 = MAX (scissor_x0, repaint_x0);
+  scissor_y0 = MAX (scissor_y0, repaint_y0);
+  scissor_x1 = MIN (scissor_x1, repaint_x1);
+  scissor_y1 = MIN (scissor_y1, repaint_y1);
+
+  /* Regions are implemented entirely with the scissor. If the region
+     within the bounds is a single rectangle then it can just replace
+     the scissor. Otherwise each draw will be repeated with the
+     scissor set to each rectangle in turn */
+  if (scissor_x0 < scissor_x1 && scissor_y0 < scissor_y1 &&
+      _cogl_clip_stack_flatten_regions (ctx, stack,
+                                        scissor_x0, scissor_y0,
+                                        scissor_x1, scissor_y1))
+    {
+      GArray *region = ctx->current_clip_region;
+
+      if (region->len <= 1)
+        {
+          if (region->len == 1)
+            {
+              CoglClipStackRegionRect *rect =
+                &g_array_index (region, CoglClipStackRegionRect, 0);
+
+              scissor_x0 = rect->x0;
+              scissor_y0 = rect->y0;
+              scissor_x1 = rect->x1;
+              scissor_y1 = rect->y1;
+            }
+          else
+            scissor_x0 = scissor_y0 = scissor_x1 = scissor_y1 = 0;
+
+          g_array_set_size (region, 0);
+        }
+      else if (!cogl_is_offscreen (framebuffer))
+        {
+          int framebuffer_height = cogl_framebuffer_get_height (framebuffer);
+          int i;
+
+          /* Convert the rectangles to GL's bottom-left origin */
+          for (i = 0; i < region->len; i++)
+            {
+              CoglClipStackRegionRect *rect =
+                &g_array_index (region, CoglClipStackRegionRect, i);
+              int y0 = framebuffer_height - rect->y1;
+
+              rect->y1 = framebuffer_height - rect->y0;
+              rect->y0 = y0;
+            }
+        }
+
+      COGL_NOTE (CLIPPING, "Flushing region of %i rectangles",
+                 region->len);
+    }
+
   /* Enable scissoring as soon as possible */
   if (scissor_x0 >= scissor_x1 || scissor_y0 >= scissor_y1)
     scissor_x0 = scissor_y0 = scissor_x1 = scissor_y1 = scissor_y_start = 0;
@@ -877,6 +1360,11 @@ _cogl_clip_stack_flush (CoglClipStack *stack,
              scissor_x0, scissor_y0,
              scissor_x1, scissor_y1);
 
+  ctx->current_clip_scissor[0] = scissor_x0;
+  ctx->current_clip_scissor[1] = scissor_y_start;
+  ctx->current_clip_scissor[2] = scissor_x1 - scissor_x0;
+  ctx->current_clip_scissor[3] = scissor_y1 - scissor_y0;
+
   GE (ctx, glEnable (GL_SCISSOR_TEST));
   GE (ctx, glScissor (scissor_x0, scissor_y_start,
                       scissor_x1 - scissor_x0,
@@ -978,10 +1466,11 @@ _cogl_clip_stack_flush (CoglClipStack *stack,
               break;
             }
         case COGL_CLIP_STACK_WINDOW_RECT:
+        case COGL_CLIP_STACK_REGION:
           break;
           /* We don't need to do anything for window space rectangles because
            * their functionality is entirely implemented by the entry bounding
-           * box */
+           * box. Regions have already been applied to the scissor */
         }
     }
 
@@ -41,15 +41,25 @@ typedef struct _CoglClipStackRect CoglClipStackRect;
 typedef struct _CoglClipStackWindowRect CoglClipStackWindowRect;
 typedef struct _CoglClipStackPath CoglClipStackPath;
 typedef struct _CoglClipStackPrimitive CoglClipStackPrimitive;
+typedef struct _CoglClipStackRegion CoglClipStackRegion;
 
 typedef enum
   {
     COGL_CLIP_STACK_RECT,
     COGL_CLIP_STACK_WINDOW_RECT,
     COGL_CLIP_STACK_PATH,
-    COGL_CLIP_STACK_PRIMITIVE
+    COGL_CLIP_STACK_PRIMITIVE,
+    COGL_CLIP_STACK_REGION
   } CoglClipStackType;
 
+typedef struct
+{
+  int x0;
+  int y0;
+  int x1;
+  int y1;
+} CoglClipStackRegionRect;
+
 /* A clip stack consists a list of entries. Each entry has a reference
  * count and a link to its parent node. The child takes a reference on
  * the parent and the CoglClipStack holds a reference to the top of
@@ -100,12 +110,30 @@ struct _CoglClipStack
      use to calculate a scissor. The scissor limits the clip so that
      we don't need to do a full stencil clear if the stencil buffer is
      needed. This is stored in Cogl's coordinate space (ie, 0,0 is the
-     top left) */
+     top left). Toolkits often push clips without drawing anything
+     inside them so the bounds are only calculated when they are first
+     needed. Use _cogl_clip_stack_ensure_bounds() before accessing
+     them */
   int                     bounds_x0;
   int                     bounds_y0;
   int                     bounds_x1;
   int                     bounds_y1;
 
+  /* The intersection of the bounds of this entry and all of its
+     ancestors. This is also calculated lazily */
+  int                     stack_bounds_x0;
+  int                     stack_bounds_y0;
+  int                     stack_bounds_x1;
+  int                     stack_bounds_y1;
+
+  unsigned int            bounds_valid : 1;
+  unsigned int            stack_bounds_valid : 1;
+
+  /* The projection matrix and viewport that were current when the
+     clip was pushed. These are needed to calculate the bounds */
+  CoglMatrix              projection;
+  float                   viewport[4];
+
   unsigned int            ref_count;
 };
 
@@ -166,6 +194,19 @@ struct _CoglClipStackPrimitive
   float bounds_y2;
 };
 
+struct _CoglClipStackRegion
+{
+  CoglClipStack _parent_data;
+
+  /* The union of the rectangles is stored in window coordinates as a
+     list of non-overlapping rectangles sorted into horizontal bands
+     in the same way as a pixman region. The rectangles within a band
+     are sorted by x and touching bands with the same rectangles are
+     merged */
+  int n_rectangles;
+  CoglClipStackRegionRect *rectangles;
+};
+
 CoglClipStack *
 _cogl_clip_stack_push_window_rectangle (CoglClipStack *stack,
                                         int x_offset,
@@ -195,9 +236,30 @@ _cogl_clip_stack_push_primitive (CoglClipStack *stack,
                                  float bounds_y2,
                                  const CoglMatrix *modelview_matrix);
 
+CoglClipStack *
+_cogl_clip_stack_push_region (CoglClipStack *stack,
+                              const int *rectangles,
+                              int n_rectangles);
+
 CoglClipStack *
 _cogl_clip_stack_pop (CoglClipStack *stack);
 
+gboolean
+_cogl_clip_stack_has_region (CoglClipStack *stack);
+
+int
+_cogl_clip_stack_get_n_region_passes (CoglContext *ctx);
+
+void
+_cogl_clip_stack_begin_region_pass (CoglContext *ctx,
+                                    int pass);
+
+void
+_cogl_clip_stack_end_region_passes (CoglContext *ctx);
+
+void
+_cogl_clip_stack_ensure_bounds (CoglClipStack *entry);
+
 void
 _cogl_clip_stack_get_bounds (CoglClipStack *stack,
                              int *scissor_x0,
@@ -43,6 +43,9 @@
 #include "cogl-atlas.h"
 #include "cogl-texture-driver.h"
 #include "cogl-pipeline-cache.h"
+#include "cogl-sampler-cache-private.h"
+#include "cogl-fence-private.h"
+#include "cogl-transient-offscreen-private.h"
 
 typedef struct
 {
@@ -124,6 +127,41 @@ struct _CoglContext
 
   CoglPipelineCache *pipeline_cache;
 
+  /* Sampler objects for each combination of filters and wrap modes
+   * used so far or NULL if GL_ARB_sampler_objects isn't available */
+  CoglSamplerCache *sampler_cache;
+
+  /* Fences that have been inserted into the GL command stream and
+   * are waiting to be dispatched by cogl_poll_dispatch() */
+  CoglFenceList     fences;
+  GArray           *fence_poll_fds;
+
+  /* Pool of CoglTransientOffscreens. The frame counter is incremented
+   * every time an onscreen framebuffer is swapped and is used to age
+   * the unused framebuffers */
+  GList            *transient_offscreens;
+  unsigned int      transient_offscreen_frame;
+  size_t            transient_offscreen_budget;
+  size_t            transient_offscreen_unused_size;
+
+  /* Estimated GPU memory used by each CoglMemoryUsageType */
+  size_t            memory_usage[COGL_N_MEMORY_USAGE_TYPES];
+  /* The maximum total texture memory or 0 if there is no budget */
+  size_t            texture_memory_budget;
+  /* CoglTexture2Ds that have a regenerate callback and so can have
+   * their storage evicted to get under the budget */
+  GList            *evictable_textures;
+  /* Incremented every time an evictable texture is used so that the
+   * least recently used texture can be found */
+  unsigned int      texture_use_age;
+  /* The value of texture_use_age when the last frame was finished */
+  unsigned int      texture_frame_use_age;
+
+  /* Immutable snippets interned by their source so that identical
+     snippets share an id */
+  GHashTable       *snippet_table;
+  unsigned int      next_snippet_id;
+
   /* Textures */
   CoglHandle        default_gl_texture_2d_tex;
   CoglHandle        default_gl_texture_rect_tex;
@@ -135,6 +173,13 @@ struct _CoglContext
   /* Global journal buffers */
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
+  /* Set while the journal is flushing entries that have been
+     reordered and projected in software for depth sorting */
+  gboolean          journal_depth_sorting;
+  /* Set while the journal is flushing untransformed entries that are
+     transformed in the vertex shader using journal_palette */
+  gboolean          journal_gpu_transform;
+  GArray           *journal_palette;
 
   GArray           *polygon_vertices;
 
@@ -183,7 +228,17 @@ struct _CoglContext
   gboolean          in_begin_gl_block;
 
   CoglPipeline     *texture_download_pipeline;
+  /* An fbo that textures are temporarily attached to so that they
+     can be read with glReadPixels. This is 0 until it is first
+     needed */
+  GLuint            texture_download_fbo;
   CoglPipeline     *blit_texture_pipeline;
+  /* A short list of offscreen framebuffers wrapping textures that
+     have recently been used as the source of a blit so that repeated
+     blits from the same texture don't have to create a new FBO. The
+     entries don't hold a reference on the context or the texture.
+     The most recently used framebuffer is at the front */
+  GList            *blit_fbo_cache;
 
   GSList           *atlases;
   GHookList         atlas_reorganize_callbacks;
@@ -234,11 +289,27 @@ struct _CoglContext
      same state multiple times. When the clip state is flushed this
      will hold a reference */
   CoglClipStack    *current_clip_stack;
+  /* The repaint clip of the framebuffer that the clip stack was
+     flushed for. The flushed scissor depends on this as well as on
+     the stack. This is the full range of ints if there was no
+     repaint clip */
+  int               current_clip_repaint_x0;
+  int               current_clip_repaint_y0;
+  int               current_clip_repaint_x1;
+  int               current_clip_repaint_y1;
   /* Whether the stencil buffer was used as part of the current clip
      state. If TRUE then any further use of the stencil buffer (such
      as for drawing paths) would need to be merged with the existing
      stencil buffer */
   gboolean          current_clip_stack_uses_stencil;
+  /* If the current clip stack contains region entries that can't be
+     described by a single scissor then this holds the rectangles of
+     the flushed region in GL window coordinates. Each draw is
+     repeated once for each rectangle. Otherwise it is empty */
+  GArray           *current_clip_region;
+  /* The scissor that was flushed for the clip stack in GL window
+     coordinates as x, y, width and height */
+  int               current_clip_scissor[4];
 
   /* This is used as a temporary buffer to fill a CoglBuffer when
      cogl_buffer_map fails and we only want to map to fill it with new
@@ -330,4 +401,22 @@ void
 _cogl_context_set_current_modelview (CoglContext *context,
                                      CoglMatrixStack *stack);
 
+/* Used by the texture and buffer backends to keep track of how much
+ * memory they have allocated. Adding texture memory may evict the
+ * storage of textures that haven't been used in the current frame if
+ * it takes the context over its texture memory budget */
+void
+_cogl_context_add_memory_usage (CoglContext *context,
+                                CoglMemoryUsageType type,
+                                size_t size);
+
+void
+_cogl_context_remove_memory_usage (CoglContext *context,
+                                   CoglMemoryUsageType type,
+                                   size_t size);
+
+/* Returns the total of all of the texture memory usage types */
+size_t
+_cogl_context_get_texture_memory_usage (CoglContext *context);
+
 #endif /* __COGL_CONTEXT_PRIVATE_H */
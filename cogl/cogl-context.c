@@ -38,9 +38,12 @@
 #include "cogl-renderer-private.h"
 #include "cogl-journal-private.h"
 #include "cogl-texture-private.h"
+#include "cogl-texture-2d-private.h"
 #include "cogl-pipeline-private.h"
 #include "cogl-pipeline-opengl-private.h"
+#include "cogl-snippet-private.h"
 #include "cogl-framebuffer-private.h"
+#include "cogl-blit.h"
 #include "cogl-onscreen-private.h"
 #include "cogl2-path.h"
 #include "cogl-attribute-private.h"
@@ -81,6 +84,9 @@ _cogl_init_feature_overrides (CoglContext *ctx)
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PBOS)))
     ctx->private_feature_flags &= ~COGL_PRIVATE_FEATURE_PBOS;
 
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SAMPLER_OBJECTS)))
+    ctx->private_feature_flags &= ~COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS;
+
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_ARBFP)))
     {
       ctx->feature_flags &= ~COGL_FEATURE_SHADERS_ARBFP;
@@ -246,6 +252,8 @@ cogl_context_new (CoglDisplay *display,
 
   context->current_clip_stack_valid = FALSE;
   context->current_clip_stack = NULL;
+  context->current_clip_region =
+    g_array_new (FALSE, FALSE, sizeof (CoglClipStackRegionRect));
 
   context->legacy_backface_culling_enabled = FALSE;
 
@@ -286,6 +294,7 @@ cogl_context_new (CoglDisplay *display,
   context->journal_flush_attributes_array =
     g_array_new (TRUE, FALSE, sizeof (CoglAttribute *));
   context->journal_clip_bounds = NULL;
+  context->journal_palette = NULL;
 
   context->polygon_vertices = g_array_new (FALSE, FALSE, sizeof (float));
 
@@ -327,6 +336,31 @@ cogl_context_new (CoglDisplay *display,
 
   context->pipeline_cache = cogl_pipeline_cache_new ();
 
+  if ((context->private_feature_flags &
+       COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS))
+    context->sampler_cache = _cogl_sampler_cache_new (context);
+  else
+    context->sampler_cache = NULL;
+
+  COGL_TAILQ_INIT (&context->fences);
+  context->fence_poll_fds = g_array_new (FALSE, FALSE, sizeof (CoglPollFD));
+
+  context->transient_offscreens = NULL;
+  context->transient_offscreen_frame = 0;
+  context->transient_offscreen_budget =
+    COGL_TRANSIENT_OFFSCREEN_DEFAULT_BUDGET;
+  context->transient_offscreen_unused_size = 0;
+
+  memset (context->memory_usage, 0, sizeof (context->memory_usage));
+  context->texture_memory_budget = 0;
+  context->evictable_textures = NULL;
+  context->texture_use_age = 0;
+  context->texture_frame_use_age = 0;
+
+  context->snippet_table = g_hash_table_new (_cogl_snippet_hash,
+                                             _cogl_snippet_equal);
+  context->next_snippet_id = 1;
+
   for (i = 0; i < COGL_BUFFER_BIND_TARGET_COUNT; i++)
     context->current_buffer[i] = NULL;
 
@@ -358,7 +392,9 @@ cogl_context_new (CoglDisplay *display,
   context->rectangle_short_indices_len = 0;
 
   context->texture_download_pipeline = COGL_INVALID_HANDLE;
+  context->texture_download_fbo = 0;
   context->blit_texture_pipeline = COGL_INVALID_HANDLE;
+  context->blit_fbo_cache = NULL;
 
 #if defined (HAVE_COGL_GL) || defined (HAVE_COGL_GLES)
   if (context->driver != COGL_DRIVER_GLES2)
@@ -446,10 +482,21 @@ _cogl_context_free (CoglContext *context)
   if (context->blit_texture_pipeline)
     cogl_handle_unref (context->blit_texture_pipeline);
 
+  _cogl_blit_clear_fbo_cache (context);
+
+  if (context->texture_download_fbo)
+    GE (context, glDeleteFramebuffers (1, &context->texture_download_fbo));
+
+  _cogl_transient_offscreen_pool_free (context);
+
+  g_list_free (context->evictable_textures);
+
   if (context->journal_flush_attributes_array)
     g_array_free (context->journal_flush_attributes_array, TRUE);
   if (context->journal_clip_bounds)
     g_array_free (context->journal_clip_bounds, TRUE);
+  if (context->journal_palette)
+    g_array_free (context->journal_palette, TRUE);
 
   if (context->polygon_vertices)
     g_array_free (context->polygon_vertices, TRUE);
@@ -476,6 +523,7 @@ _cogl_context_free (CoglContext *context)
 
   if (context->current_clip_stack_valid)
     _cogl_clip_stack_unref (context->current_clip_stack);
+  g_array_free (context->current_clip_region, TRUE);
 
   g_slist_free (context->atlases);
   g_hook_list_clear (&context->atlas_reorganize_callbacks);
@@ -500,6 +548,12 @@ _cogl_context_free (CoglContext *context)
 
   cogl_pipeline_cache_free (context->pipeline_cache);
 
+  if (context->sampler_cache)
+    _cogl_sampler_cache_free (context->sampler_cache);
+
+  g_array_free (context->fence_poll_fds, TRUE);
+
+  _cogl_snippet_destroy_table (context);
 
   _cogl_destroy_texture_units ();
 
@@ -541,6 +595,53 @@ cogl_context_get_display (CoglContext *context)
   return context->display;
 }
 
+size_t
+cogl_context_get_memory_usage (CoglContext *context,
+                               CoglMemoryUsageType type)
+{
+  _COGL_RETURN_VAL_IF_FAIL (type >= 0 && type < COGL_N_MEMORY_USAGE_TYPES, 0);
+
+  return context->memory_usage[type];
+}
+
+size_t
+_cogl_context_get_texture_memory_usage (CoglContext *context)
+{
+  return (context->memory_usage[COGL_MEMORY_USAGE_TYPE_TEXTURE_2D] +
+          context->memory_usage[COGL_MEMORY_USAGE_TYPE_TEXTURE_RECTANGLE] +
+          context->memory_usage[COGL_MEMORY_USAGE_TYPE_TEXTURE_3D]);
+}
+
+void
+cogl_context_set_texture_memory_budget (CoglContext *context,
+                                        size_t max_bytes)
+{
+  context->texture_memory_budget = max_bytes;
+
+  _cogl_texture_2d_evict_to_budget (context);
+}
+
+void
+_cogl_context_add_memory_usage (CoglContext *context,
+                                CoglMemoryUsageType type,
+                                size_t size)
+{
+  context->memory_usage[type] += size;
+
+  if (type != COGL_MEMORY_USAGE_TYPE_BUFFER)
+    _cogl_texture_2d_evict_to_budget (context);
+}
+
+void
+_cogl_context_remove_memory_usage (CoglContext *context,
+                                   CoglMemoryUsageType type,
+                                   size_t size)
+{
+  g_assert (context->memory_usage[type] >= size);
+
+  context->memory_usage[type] -= size;
+}
+
 #ifdef COGL_HAS_EGL_SUPPORT
 EGLDisplay
 cogl_egl_context_get_egl_display (CoglContext *context)
@@ -150,6 +150,81 @@ cogl_android_set_native_window (ANativeWindow *window);
 gboolean
 cogl_is_context (void *object);
 
+/**
+ * CoglMemoryUsageType:
+ * @COGL_MEMORY_USAGE_TYPE_TEXTURE_2D: Storage for #CoglTexture2D
+ *   textures. This includes the textures used internally for sliced
+ *   textures and texture atlases.
+ * @COGL_MEMORY_USAGE_TYPE_TEXTURE_RECTANGLE: Storage for
+ *   #CoglTextureRectangle textures
+ * @COGL_MEMORY_USAGE_TYPE_TEXTURE_3D: Storage for #CoglTexture3D
+ *   textures
+ * @COGL_MEMORY_USAGE_TYPE_BUFFER: Storage for buffer objects such as
+ *   #CoglAttributeBuffer, #CoglIndexBuffer and #CoglPixelBuffer
+ *
+ * The categories of GPU memory that Cogl keeps track of. See
+ * cogl_context_get_memory_usage().
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+typedef enum
+{
+  COGL_MEMORY_USAGE_TYPE_TEXTURE_2D,
+  COGL_MEMORY_USAGE_TYPE_TEXTURE_RECTANGLE,
+  COGL_MEMORY_USAGE_TYPE_TEXTURE_3D,
+  COGL_MEMORY_USAGE_TYPE_BUFFER,
+
+  /*< private >*/
+  COGL_N_MEMORY_USAGE_TYPES
+} CoglMemoryUsageType;
+
+/**
+ * cogl_context_get_memory_usage:
+ * @context: A #CoglContext pointer
+ * @type: The category of memory to query
+ *
+ * Queries how much GPU memory the textures or buffers of the given
+ * type created with @context are using. The size is calculated from
+ * the format and dimensions of each object so it is only an estimate
+ * of what the driver actually allocates. For example it doesn't
+ * include mipmaps or any padding. Textures wrapping a GL texture
+ * object created outside of Cogl are not counted.
+ *
+ * Return value: The estimated number of bytes used
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+size_t
+cogl_context_get_memory_usage (CoglContext *context,
+                               CoglMemoryUsageType type);
+
+/**
+ * cogl_context_set_texture_memory_budget:
+ * @context: A #CoglContext pointer
+ * @max_bytes: The maximum number of bytes for textures or 0 for no
+ *   limit
+ *
+ * Sets a budget for the total texture memory used by @context. While
+ * the total of all the texture types reported by
+ * cogl_context_get_memory_usage() is over the budget, Cogl will free
+ * the storage of the least recently used textures that can be
+ * recreated. These are textures loaded with
+ * cogl_texture_new_from_file() that ended up as a #CoglTexture2D and
+ * textures given a callback with
+ * cogl_texture_2d_set_regenerate_callback(). A texture that has been
+ * evicted is transparently recreated the next time it is used.
+ *
+ * There is no budget by default.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_context_set_texture_memory_budget (CoglContext *context,
+                                        size_t max_bytes);
+
 G_END_DECLS
 
 #endif /* __COGL_CONTEXT_H__ */
@@ -185,3 +185,39 @@ OPT (CLIPPING,
      "clipping",
      N_("Trace clipping"),
      N_("Logs information about how Cogl is implementing clipping"))
+OPT (CULLING,
+     N_("Cogl Tracing"),
+     "culling",
+     N_("Trace culling"),
+     N_("Counts the journal entries that are skipped because they "
+        "wouldn't be visible"))
+OPT (DISABLE_OCCLUSION_CULLING,
+     N_("Root Cause"),
+     "disable-occlusion-culling",
+     N_("Disable occlusion culling"),
+     N_("Disable skipping journal entries that are completely covered "
+        "by opaque rectangles drawn later"))
+OPT (DISABLE_FRUSTUM_CULLING,
+     N_("Root Cause"),
+     "disable-frustum-culling",
+     N_("Disable frustum culling"),
+     N_("Disable skipping rectangles and primitives with bounds that "
+        "lie outside of the viewport or clip"))
+OPT (DISABLE_SAMPLER_OBJECTS,
+     N_("Root Cause"),
+     "disable-sampler-objects",
+     N_("Disable GL sampler objects"),
+     N_("Disable use of OpenGL sampler objects for texture filters and "
+        "wrap modes"))
+OPT (DISABLE_GPU_TRANSFORM,
+     N_("Root Cause"),
+     "disable-gpu-transform",
+     N_("Disable journal GPU transform"),
+     N_("Always transform large batches of rectangles in software instead "
+        "of using a matrix palette in the vertex shader"))
+OPT (DISABLE_COMPACT_VERTICES,
+     N_("Root Cause"),
+     "disable-compact-vertices",
+     N_("Disable compact journal vertices"),
+     N_("Always upload rectangles using floats even if their coordinates "
+        "would fit in 16-bit integers"))
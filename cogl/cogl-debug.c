@@ -56,7 +56,8 @@ static const GDebugKey cogl_log_debug_keys[] = {
   { "texture-pixmap", COGL_DEBUG_TEXTURE_PIXMAP },
   { "bitmap", COGL_DEBUG_BITMAP },
   { "clipping", COGL_DEBUG_CLIPPING },
-  { "winsys", COGL_DEBUG_WINSYS }
+  { "winsys", COGL_DEBUG_WINSYS },
+  { "culling", COGL_DEBUG_CULLING }
 };
 static const int n_cogl_log_debug_keys =
   G_N_ELEMENTS (cogl_log_debug_keys);
@@ -79,7 +80,12 @@ static const GDebugKey cogl_behavioural_debug_keys[] = {
   { "wireframe", COGL_DEBUG_WIREFRAME},
   { "disable-software-clip", COGL_DEBUG_DISABLE_SOFTWARE_CLIP},
   { "disable-program-caches", COGL_DEBUG_DISABLE_PROGRAM_CACHES},
-  { "disable-fast-read-pixel", COGL_DEBUG_DISABLE_FAST_READ_PIXEL}
+  { "disable-fast-read-pixel", COGL_DEBUG_DISABLE_FAST_READ_PIXEL},
+  { "disable-occlusion-culling", COGL_DEBUG_DISABLE_OCCLUSION_CULLING},
+  { "disable-frustum-culling", COGL_DEBUG_DISABLE_FRUSTUM_CULLING},
+  { "disable-sampler-objects", COGL_DEBUG_DISABLE_SAMPLER_OBJECTS},
+  { "disable-gpu-transform", COGL_DEBUG_DISABLE_GPU_TRANSFORM},
+  { "disable-compact-vertices", COGL_DEBUG_DISABLE_COMPACT_VERTICES}
 };
 static const int n_cogl_behavioural_debug_keys =
   G_N_ELEMENTS (cogl_behavioural_debug_keys);
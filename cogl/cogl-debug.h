@@ -67,6 +67,12 @@ typedef enum {
   COGL_DEBUG_DISABLE_FAST_READ_PIXEL,
   COGL_DEBUG_CLIPPING,
   COGL_DEBUG_WINSYS,
+  COGL_DEBUG_CULLING,
+  COGL_DEBUG_DISABLE_OCCLUSION_CULLING,
+  COGL_DEBUG_DISABLE_FRUSTUM_CULLING,
+  COGL_DEBUG_DISABLE_SAMPLER_OBJECTS,
+  COGL_DEBUG_DISABLE_GPU_TRANSFORM,
+  COGL_DEBUG_DISABLE_COMPACT_VERTICES,
 
   COGL_DEBUG_N_FLAGS
 } CoglDebugFlags;
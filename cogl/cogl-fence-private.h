@@ -0,0 +1,93 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef __COGL_FENCE_PRIVATE_H
+#define __COGL_FENCE_PRIVATE_H
+
+#include "cogl-fence.h"
+#include "cogl-queue.h"
+#include "cogl-poll.h"
+
+/* How often we check fences that can't wake up the main loop by
+ * themselves, in microseconds */
+#define COGL_FENCE_CHECK_TIMEOUT 5000
+
+typedef enum
+{
+  /* Waiting for the journal to be flushed */
+  COGL_FENCE_TYPE_PENDING,
+  /* No fence could be created so the commands were finished with
+   * glFinish instead */
+  COGL_FENCE_TYPE_FINISHED,
+  COGL_FENCE_TYPE_GL_ARB,
+  COGL_FENCE_TYPE_WINSYS
+} CoglFenceType;
+
+COGL_TAILQ_HEAD (CoglFenceList, CoglFence);
+
+struct _CoglFence
+{
+  COGL_TAILQ_ENTRY (CoglFence) list;
+
+  /* The framebuffer is only used to find the fences to cancel when
+   * it is destroyed */
+  CoglContext *context;
+  CoglFramebuffer *framebuffer;
+  CoglFenceCallback callback;
+  void *user_data;
+
+  CoglFenceType type;
+  void *fence_obj;
+
+  /* A file descriptor that becomes readable when the fence signals or
+   * -1 if the winsys can't give us one. It is owned by the winsys
+   * fence */
+  int fd;
+
+  /* Set while dispatching once the fence is known to have signalled */
+  gboolean complete;
+};
+
+/* Inserts the fence into the GL command stream */
+void
+_cogl_fence_submit (CoglFence *fence);
+
+void
+_cogl_fence_cancel_fences_for_framebuffer (CoglFramebuffer *framebuffer);
+
+/*
+ * Adds the file descriptors of any submitted fences to the poll
+ * information returned by the winsys and shortens the timeout if any
+ * fences have to be checked periodically.
+ */
+void
+_cogl_fence_poll_prepare (CoglContext *context,
+                          CoglPollFD **poll_fds,
+                          int *n_poll_fds,
+                          gint64 *timeout);
+
+/* Invokes the callbacks of all fences that have completed */
+void
+_cogl_fence_poll_dispatch (CoglContext *context);
+
+#endif /* __COGL_FENCE_PRIVATE_H */
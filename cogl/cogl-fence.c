@@ -0,0 +1,313 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cogl-fence-private.h"
+#include "cogl-context-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-journal-private.h"
+#include "cogl-winsys-private.h"
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+
+void *
+cogl_fence_get_user_data (CoglFence *fence)
+{
+  return fence->user_data;
+}
+
+void
+_cogl_fence_submit (CoglFence *fence)
+{
+  CoglContext *context = fence->context;
+  const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
+
+  fence->fd = -1;
+
+  /* A winsys fence is only preferred over a GL one when it can give
+   * us a file descriptor to sleep on */
+  if (winsys->fence_add)
+    {
+      fence->fence_obj = winsys->fence_add (context, &fence->fd);
+
+      if (fence->fence_obj)
+        {
+          if (fence->fd >= 0 || context->glFenceSync == NULL)
+            {
+              fence->type = COGL_FENCE_TYPE_WINSYS;
+              goto done;
+            }
+
+          winsys->fence_destroy (context, fence->fence_obj);
+        }
+    }
+
+  if (context->glFenceSync)
+    {
+      fence->fence_obj = context->glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE,
+                                               0);
+      if (fence->fence_obj)
+        {
+          fence->type = COGL_FENCE_TYPE_GL_ARB;
+          goto done;
+        }
+    }
+
+  /* If creating a fence failed then all we can do is wait for the
+   * commands to finish so the callback is at least called at the
+   * right time */
+  GE (context, glFinish ());
+  fence->fence_obj = NULL;
+  fence->type = COGL_FENCE_TYPE_FINISHED;
+
+ done:
+  COGL_TAILQ_INSERT_TAIL (&context->fences, fence, list);
+}
+
+CoglFence *
+cogl_framebuffer_add_fence_callback (CoglFramebuffer *framebuffer,
+                                     CoglFenceCallback callback,
+                                     void *user_data)
+{
+  CoglContext *context = framebuffer->context;
+  CoglJournal *journal = framebuffer->journal;
+  CoglFence *fence;
+
+  if (!cogl_has_feature (context, COGL_FEATURE_ID_FENCE))
+    return NULL;
+
+  fence = g_slice_new (CoglFence);
+  fence->context = context;
+  fence->framebuffer = framebuffer;
+  fence->callback = callback;
+  fence->user_data = user_data;
+  fence->fence_obj = NULL;
+  fence->fd = -1;
+  fence->complete = FALSE;
+
+  /* If there is batched up geometry then the fence is inserted when
+   * the journal is flushed rather than forcing a flush now */
+  if (journal->entries->len)
+    {
+      fence->type = COGL_FENCE_TYPE_PENDING;
+      COGL_TAILQ_INSERT_TAIL (&journal->pending_fences, fence, list);
+    }
+  else
+    _cogl_fence_submit (fence);
+
+  return fence;
+}
+
+static void
+_cogl_fence_free (CoglFence *fence)
+{
+  CoglContext *context = fence->context;
+
+  switch (fence->type)
+    {
+    case COGL_FENCE_TYPE_GL_ARB:
+      context->glDeleteSync (fence->fence_obj);
+      break;
+
+    case COGL_FENCE_TYPE_WINSYS:
+      {
+        const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
+
+        /* This also closes the file descriptor */
+        winsys->fence_destroy (context, fence->fence_obj);
+      }
+      break;
+
+    case COGL_FENCE_TYPE_PENDING:
+    case COGL_FENCE_TYPE_FINISHED:
+      break;
+    }
+
+  g_slice_free (CoglFence, fence);
+}
+
+void
+cogl_framebuffer_cancel_fence_callback (CoglFramebuffer *framebuffer,
+                                        CoglFence *fence)
+{
+  CoglJournal *journal = framebuffer->journal;
+  CoglContext *context = framebuffer->context;
+
+  _COGL_RETURN_IF_FAIL (fence->framebuffer == framebuffer);
+
+  if (fence->type == COGL_FENCE_TYPE_PENDING)
+    COGL_TAILQ_REMOVE (&journal->pending_fences, fence, list);
+  else
+    COGL_TAILQ_REMOVE (&context->fences, fence, list);
+
+  _cogl_fence_free (fence);
+}
+
+void
+_cogl_fence_cancel_fences_for_framebuffer (CoglFramebuffer *framebuffer)
+{
+  CoglJournal *journal = framebuffer->journal;
+  CoglContext *context = framebuffer->context;
+  CoglFence *fence, *tmp;
+
+  while (!COGL_TAILQ_EMPTY (&journal->pending_fences))
+    {
+      fence = COGL_TAILQ_FIRST (&journal->pending_fences);
+      COGL_TAILQ_REMOVE (&journal->pending_fences, fence, list);
+      _cogl_fence_free (fence);
+    }
+
+  COGL_TAILQ_FOREACH_SAFE (fence, &context->fences, list, tmp)
+    {
+      if (fence->framebuffer == framebuffer)
+        {
+          COGL_TAILQ_REMOVE (&context->fences, fence, list);
+          _cogl_fence_free (fence);
+        }
+    }
+}
+
+void
+_cogl_fence_poll_prepare (CoglContext *context,
+                          CoglPollFD **poll_fds,
+                          int *n_poll_fds,
+                          gint64 *timeout)
+{
+  CoglFence *fence;
+  gboolean have_fds = FALSE;
+
+  if (COGL_TAILQ_EMPTY (&context->fences))
+    return;
+
+  COGL_TAILQ_FOREACH (fence, &context->fences, list)
+    {
+      if (fence->fd >= 0)
+        have_fds = TRUE;
+      else if (*timeout == -1 || *timeout > COGL_FENCE_CHECK_TIMEOUT)
+        {
+          /* A fence created with glFinish has already completed */
+          if (fence->type == COGL_FENCE_TYPE_FINISHED)
+            *timeout = 0;
+          else
+            *timeout = COGL_FENCE_CHECK_TIMEOUT;
+        }
+    }
+
+  /* The winsys owns the array it returned so the fence file
+   * descriptors are appended to a copy of it */
+  if (have_fds)
+    {
+      GArray *fds = context->fence_poll_fds;
+
+      g_array_set_size (fds, 0);
+      g_array_append_vals (fds, *poll_fds, *n_poll_fds);
+
+      COGL_TAILQ_FOREACH (fence, &context->fences, list)
+        if (fence->fd >= 0)
+          {
+            CoglPollFD poll_fd;
+
+            poll_fd.fd = fence->fd;
+            poll_fd.events = COGL_POLL_FD_EVENT_IN;
+            poll_fd.revents = 0;
+
+            g_array_append_val (fds, poll_fd);
+          }
+
+      *poll_fds = (CoglPollFD *) fds->data;
+      *n_poll_fds = fds->len;
+    }
+}
+
+static gboolean
+_cogl_fence_check (CoglFence *fence)
+{
+  CoglContext *context = fence->context;
+
+  switch (fence->type)
+    {
+    case COGL_FENCE_TYPE_GL_ARB:
+      {
+        GLenum ret = context->glClientWaitSync (fence->fence_obj,
+                                                GL_SYNC_FLUSH_COMMANDS_BIT,
+                                                0);
+        return ret == GL_ALREADY_SIGNALED || ret == GL_CONDITION_SATISFIED;
+      }
+
+    case COGL_FENCE_TYPE_WINSYS:
+      {
+        const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
+
+        return winsys->fence_is_complete (context, fence->fence_obj);
+      }
+
+    case COGL_FENCE_TYPE_FINISHED:
+      return TRUE;
+
+    case COGL_FENCE_TYPE_PENDING:
+      break;
+    }
+
+  return FALSE;
+}
+
+void
+_cogl_fence_poll_dispatch (CoglContext *context)
+{
+  CoglFence *fence;
+
+  /* The completed fences are marked first so that a callback can
+   * safely cancel any other fence, including one that has also
+   * completed */
+  COGL_TAILQ_FOREACH (fence, &context->fences, list)
+    fence->complete = _cogl_fence_check (fence);
+
+  for (;;)
+    {
+      COGL_TAILQ_FOREACH (fence, &context->fences, list)
+        if (fence->complete)
+          break;
+
+      if (fence == NULL)
+        break;
+
+      COGL_TAILQ_REMOVE (&context->fences, fence, list);
+      fence->callback (fence, fence->user_data);
+      _cogl_fence_free (fence);
+    }
+}
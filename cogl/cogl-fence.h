@@ -0,0 +1,143 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_FENCE_H__
+#define __COGL_FENCE_H__
+
+#include <glib.h>
+#include <cogl/cogl-framebuffer.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-fence
+ * @short_description: Functions for notification of command completion
+ *
+ * Cogl allows notification of GPU command completion so that an
+ * application can find out when work it has queued is finished
+ * without blocking in cogl_framebuffer_finish(). This can be used to
+ * read back results, recycle buffers or upload new data once the GPU
+ * is no longer using the old contents.
+ *
+ * Completion is reported through the main loop integration so the
+ * application must be using cogl_poll_get_info() and
+ * cogl_poll_dispatch() or a #GSource from cogl_glib_source_new().
+ */
+
+/**
+ * CoglFence:
+ *
+ * An opaque type representing a request for notification when the
+ * GPU has finished the commands that were queued before it.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+typedef struct _CoglFence CoglFence;
+
+/**
+ * CoglFenceCallback:
+ * @fence: The #CoglFence that has completed
+ * @user_data: The private pointer passed to
+ *             cogl_framebuffer_add_fence_callback()
+ *
+ * The type of the callbacks that are called when the commands that
+ * were queued before a fence have completed. The @fence is freed as
+ * soon as the callback returns.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+typedef void (*CoglFenceCallback) (CoglFence *fence,
+                                   void *user_data);
+
+/**
+ * cogl_fence_get_user_data:
+ * @fence: A #CoglFence
+ *
+ * Return value: the private pointer that was passed to
+ *               cogl_framebuffer_add_fence_callback() when @fence was
+ *               created.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void *
+cogl_fence_get_user_data (CoglFence *fence);
+
+/**
+ * cogl_framebuffer_add_fence_callback:
+ * @framebuffer: The #CoglFramebuffer the commands have been submitted to
+ * @callback: A #CoglFenceCallback to be called when all commands
+ *            submitted to Cogl so far have been completed
+ * @user_data: Private data that will be passed to @callback
+ *
+ * Calls the provided @callback when all previously-submitted commands
+ * have been executed by the GPU. Commands that are still batched up
+ * in the @framebuffer's journal are included but they aren't flushed
+ * early just because a fence was added.
+ *
+ * Where the window system supports native fence file descriptors the
+ * application's main loop sleeps until the fence signals. Otherwise
+ * Cogl asks to be woken up periodically to check the fence.
+ *
+ * The callback won't be called if @framebuffer is destroyed first.
+ *
+ * Return value: a #CoglFence that can be used to cancel the callback
+ *               or %NULL if the %COGL_FEATURE_ID_FENCE feature isn't
+ *               available.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+CoglFence *
+cogl_framebuffer_add_fence_callback (CoglFramebuffer *framebuffer,
+                                     CoglFenceCallback callback,
+                                     void *user_data);
+
+/**
+ * cogl_framebuffer_cancel_fence_callback:
+ * @framebuffer: The #CoglFramebuffer the fence was added to
+ * @fence: The #CoglFence returned from
+ *         cogl_framebuffer_add_fence_callback()
+ *
+ * Removes a fence previously added with
+ * cogl_framebuffer_add_fence_callback() so that its callback will
+ * never be called. This must not be called after the callback has
+ * been invoked.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_cancel_fence_callback (CoglFramebuffer *framebuffer,
+                                        CoglFence *fence);
+
+G_END_DECLS
+
+#endif /* __COGL_FENCE_H__ */
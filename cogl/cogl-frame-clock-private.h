@@ -0,0 +1,106 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef __COGL_FRAME_CLOCK_PRIVATE_H
+#define __COGL_FRAME_CLOCK_PRIVATE_H
+
+#include <glib.h>
+
+/* The refresh interval assumed until we have seen enough swap
+ * completions to measure it, in microseconds */
+#define COGL_FRAME_CLOCK_DEFAULT_INTERVAL 16667
+
+/* The smallest amount of time we leave between the predicted end of
+ * a frame and the vblank it is aiming for, in microseconds */
+#define COGL_FRAME_CLOCK_MIN_MARGIN 1000
+
+/* The number of refresh intervals we wait for a swap to complete
+ * before giving up on the notification */
+#define COGL_FRAME_CLOCK_SWAP_TIMEOUT_INTERVALS 4
+
+/* All times are in microseconds from g_get_monotonic_time () */
+typedef struct _CoglFrameClock
+{
+  /* Whether the application has asked for a frame and, once we have
+   * worked it out, the presentation time that frame will aim for */
+  gboolean frame_scheduled;
+  gint64 scheduled_target_time;
+
+  /* Whether a frame has been swapped but it hasn't been presented
+   * yet. We don't start a new frame while one is in flight */
+  gboolean swap_pending;
+  gint64 swap_time;
+
+  /* The last time a frame reached the screen or -1 if we have never
+   * seen one */
+  gint64 last_presentation_time;
+  gint64 refresh_interval;
+
+  /* The time at which the current frame started or -1 if we aren't
+   * in a frame and the presentation time it is aiming for */
+  gint64 frame_start_time;
+  gint64 target_time;
+
+  /* The estimated time between starting a frame and finishing the
+   * swap and the extra time we leave to cover the GPU work and
+   * scheduling jitter. The margin grows whenever a frame misses its
+   * target and slowly shrinks again while frames arrive on time */
+  gint64 frame_cost;
+  gint64 safety_margin;
+} CoglFrameClock;
+
+void
+_cogl_frame_clock_init (CoglFrameClock *clock);
+
+/*
+ * Returns the time at which the next frame should be started so that
+ * it is drawn as late as possible while still making the next vblank
+ * or -1 if no frame needs to be drawn.
+ */
+gint64
+_cogl_frame_clock_get_deadline (CoglFrameClock *clock,
+                                gint64 now);
+
+/*
+ * Marks the start of a frame and returns the time at which it is
+ * expected to be presented.
+ */
+gint64
+_cogl_frame_clock_begin_frame (CoglFrameClock *clock,
+                               gint64 now);
+
+/*
+ * Records that a frame has been swapped. If @wait_for_presentation
+ * is FALSE then the winsys can't tell us when the swap completes so
+ * we assume the frame made its target.
+ */
+void
+_cogl_frame_clock_notify_swap (CoglFrameClock *clock,
+                               gint64 now,
+                               gboolean wait_for_presentation);
+
+void
+_cogl_frame_clock_notify_presented (CoglFrameClock *clock,
+                                    gint64 now);
+
+#endif /* __COGL_FRAME_CLOCK_PRIVATE_H */
@@ -0,0 +1,213 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cogl-frame-clock-private.h"
+
+/* The frame clock tries to start each frame as late as possible so
+ * that whatever input the application samples when it starts drawing
+ * is as fresh as possible when the frame reaches the screen. Starting
+ * a frame straight after the previous one was presented would add up
+ * to a whole refresh interval of latency while starting it too late
+ * misses the vblank entirely.
+ *
+ * The vblanks are predicted from the times that swaps complete and
+ * the time needed for a frame is the measured time between the start
+ * of the frame and the end of the swap plus a safety margin. We can't
+ * directly measure how long the GPU takes so instead the margin grows
+ * whenever a frame is presented later than its target and slowly
+ * shrinks back while frames arrive on time. */
+
+void
+_cogl_frame_clock_init (CoglFrameClock *clock)
+{
+  clock->frame_scheduled = FALSE;
+  clock->scheduled_target_time = -1;
+  clock->swap_pending = FALSE;
+  clock->swap_time = -1;
+  clock->last_presentation_time = -1;
+  clock->refresh_interval = COGL_FRAME_CLOCK_DEFAULT_INTERVAL;
+  clock->frame_start_time = -1;
+  clock->target_time = -1;
+  clock->frame_cost = 0;
+  clock->safety_margin = COGL_FRAME_CLOCK_DEFAULT_INTERVAL / 4;
+}
+
+gint64
+_cogl_frame_clock_get_deadline (CoglFrameClock *clock,
+                                gint64 now)
+{
+  gint64 budget;
+
+  if (!clock->frame_scheduled)
+    return -1;
+
+  /* Don't queue up another frame while the last one is still on its
+   * way to the screen but don't wait forever if the winsys never
+   * tells us the swap completed */
+  if (clock->swap_pending)
+    return (clock->swap_time +
+            clock->refresh_interval *
+            COGL_FRAME_CLOCK_SWAP_TIMEOUT_INTERVALS);
+
+  /* Without any idea of when the vblanks are we just draw straight
+   * away */
+  if (clock->last_presentation_time < 0)
+    return now;
+
+  budget = clock->frame_cost + clock->safety_margin;
+
+  /* The target is remembered so that waking up slightly after the
+   * deadline doesn't make us push the frame back to the following
+   * vblank */
+  if (clock->scheduled_target_time < 0)
+    {
+      gint64 target = (clock->last_presentation_time +
+                       clock->refresh_interval);
+
+      /* If we have already missed the chance to make the next vblank
+       * then aim for the first one we can make */
+      if (target - budget < now)
+        {
+          gint64 n_intervals = ((now + budget -
+                                 clock->last_presentation_time) /
+                                clock->refresh_interval + 1);
+          target = (clock->last_presentation_time +
+                    n_intervals * clock->refresh_interval);
+        }
+
+      clock->scheduled_target_time = target;
+    }
+
+  return clock->scheduled_target_time - budget;
+}
+
+gint64
+_cogl_frame_clock_begin_frame (CoglFrameClock *clock,
+                               gint64 now)
+{
+  if (clock->scheduled_target_time >= 0)
+    clock->target_time = clock->scheduled_target_time;
+  else
+    clock->target_time = now + clock->frame_cost + clock->safety_margin;
+
+  clock->frame_scheduled = FALSE;
+  clock->scheduled_target_time = -1;
+  clock->frame_start_time = now;
+
+  /* If we get here with a swap still pending then we have given up
+   * waiting for it */
+  clock->swap_pending = FALSE;
+
+  return clock->target_time;
+}
+
+static void
+update_safety_margin (CoglFrameClock *clock,
+                      gint64 presentation_time)
+{
+  if (clock->target_time < 0)
+    return;
+
+  if (presentation_time > clock->target_time + clock->refresh_interval / 2)
+    clock->safety_margin = MIN (clock->safety_margin * 2,
+                                clock->refresh_interval);
+  else
+    clock->safety_margin = MAX (clock->safety_margin -
+                                clock->safety_margin / 8,
+                                COGL_FRAME_CLOCK_MIN_MARGIN);
+
+  clock->target_time = -1;
+}
+
+void
+_cogl_frame_clock_notify_swap (CoglFrameClock *clock,
+                               gint64 now,
+                               gboolean wait_for_presentation)
+{
+  /* Only swaps made from within a frame tell us how long a frame
+   * takes. A frame that took longer than we thought is used straight
+   * away so that the next one doesn't miss its target too */
+  if (clock->frame_start_time >= 0)
+    {
+      gint64 cost = now - clock->frame_start_time;
+
+      if (cost > clock->frame_cost)
+        clock->frame_cost = cost;
+      else
+        clock->frame_cost = (clock->frame_cost * 3 + cost) / 4;
+
+      clock->frame_start_time = -1;
+    }
+
+  if (wait_for_presentation)
+    {
+      clock->swap_pending = TRUE;
+      clock->swap_time = now;
+    }
+  else
+    {
+      /* We have no way of knowing when the frame will be shown so we
+       * assume it makes the vblank it was aiming for */
+      gint64 presentation_time = now;
+
+      if (clock->target_time > now)
+        presentation_time = clock->target_time;
+
+      update_safety_margin (clock, presentation_time);
+
+      clock->swap_pending = FALSE;
+      clock->last_presentation_time = presentation_time;
+    }
+}
+
+void
+_cogl_frame_clock_notify_presented (CoglFrameClock *clock,
+                                    gint64 now)
+{
+  if (clock->swap_pending)
+    {
+      /* Consecutive presentations are one refresh interval apart.
+       * Anything much longer is a missed vblank or an idle period so
+       * it doesn't tell us anything */
+      if (clock->last_presentation_time >= 0)
+        {
+          gint64 delta = now - clock->last_presentation_time;
+
+          if (delta >= COGL_FRAME_CLOCK_MIN_MARGIN &&
+              delta < clock->refresh_interval * 3 / 2)
+            clock->refresh_interval = ((clock->refresh_interval * 3 + delta) /
+                                       4);
+        }
+
+      update_safety_margin (clock, now);
+
+      clock->swap_pending = FALSE;
+    }
+
+  clock->last_presentation_time = now;
+}
@@ -96,6 +96,9 @@ struct _CoglFramebuffer
 {
   CoglObject          _parent;
   CoglContext        *context;
+  /* Framebuffers that are cached by the context itself don't hold a
+     reference on it, otherwise it could never be freed */
+  gboolean            holds_context_ref;
   CoglFramebufferType  type;
 
   /* The user configuration before allocation... */
@@ -122,10 +125,29 @@ struct _CoglFramebuffer
   int                 blue_bits;
   int                 green_bits;
   int                 alpha_bits;
+  int                 depth_bits;
 
   gboolean            dither_enabled;
   CoglColorMask       color_mask;
 
+  /* Whether journal entries hidden by later opaque rectangles are
+   * dropped when the journal is flushed */
+  gboolean            occlusion_culling_enabled;
+
+  /* When depth sorting is enabled every journal entry is given a
+   * serial number that determines its depth. This counts the entries
+   * logged since the whole depth buffer was last cleared */
+  gboolean            depth_sorting_enabled;
+  int                 depth_sort_serial;
+
+  /* The combined modelview and projection matrix used to cull
+   * geometry. This is recalculated whenever the age of either matrix
+   * stack changes */
+  CoglMatrix          cull_matrix;
+  gboolean            cull_matrix_valid;
+  unsigned int        cull_modelview_age;
+  unsigned int        cull_projection_age;
+
   int                 samples_per_pixel;
 
   /* We journal the textured rectangles we want to submit to OpenGL so
@@ -152,6 +174,16 @@ struct _CoglFramebuffer
   int                 clear_clip_x1;
   int                 clear_clip_y1;
   gboolean            clear_clip_dirty;
+
+  /* If the damage for the current frame of an onscreen framebuffer
+   * is known then all clears and drawing are implicitly scissored to
+   * the region that needs repainting. This is in window coordinates
+   * and is combined with the clip stack whenever it is flushed. */
+  gboolean            repaint_clip_enabled;
+  int                 repaint_clip_x0;
+  int                 repaint_clip_y0;
+  int                 repaint_clip_x1;
+  int                 repaint_clip_y1;
 };
 
 typedef struct _CoglOffscreen
@@ -165,6 +197,19 @@ typedef struct _CoglOffscreen
   int             texture_level_width;
   int             texture_level_height;
 
+  /* If the framebuffer is multisampled but the driver can't resolve
+   * the samples implicitly then fbo_handle renders to multisampled
+   * renderbuffers and the texture is attached to this separate fbo
+   * instead. The samples are blitted to it when the texture is
+   * needed. Otherwise this is 0 */
+  GLuint          resolve_fbo_handle;
+  /* The region that has been drawn to since the samples were last
+   * resolved. It is empty if damage_x0 >= damage_x1 */
+  int             damage_x0;
+  int             damage_y0;
+  int             damage_x1;
+  int             damage_y1;
+
   /* FIXME: _cogl_offscreen_new_to_texture_full should be made to use
    * fb->config to configure if we want a depth or stencil buffer so
    * we can get rid of these flags */
@@ -183,6 +228,19 @@ _cogl_framebuffer_init (CoglFramebuffer *framebuffer,
 
 void _cogl_framebuffer_free (CoglFramebuffer *framebuffer);
 
+/*
+ * _cogl_framebuffer_release_context_ref:
+ * @framebuffer: A #CoglFramebuffer
+ *
+ * Drops the reference that @framebuffer holds on its context. This
+ * is used for framebuffers that are owned by the context, such as
+ * the pool of transient offscreens, so that they don't keep the
+ * context alive. The framebuffer must then be destroyed before the
+ * context finishes being freed.
+ */
+void
+_cogl_framebuffer_release_context_ref (CoglFramebuffer *framebuffer);
+
 const CoglWinsysVtable *
 _cogl_framebuffer_get_winsys (CoglFramebuffer *framebuffer);
 
@@ -197,6 +255,30 @@ _cogl_framebuffer_clear_without_flush4f (CoglFramebuffer *framebuffer,
 void
 _cogl_framebuffer_dirty (CoglFramebuffer *framebuffer);
 
+/*
+ * _cogl_framebuffer_resolve_damage:
+ * @framebuffer: A #CoglFramebuffer
+ *
+ * Flushes the journal of @framebuffer and, if it is a multisampled
+ * offscreen framebuffer that needs an explicit resolve, resolves the
+ * samples in the region that has been drawn to since the last
+ * resolve so that the texture can be used as a source.
+ */
+void
+_cogl_framebuffer_resolve_damage (CoglFramebuffer *framebuffer);
+
+/*
+ * _cogl_framebuffer_bind_resolved_read_buffer:
+ * @framebuffer: The #CoglFramebuffer that is bound for reading
+ *
+ * Multisampled renderbuffers can't be read with glReadPixels so if
+ * @framebuffer needs an explicit resolve this resolves any damage and
+ * binds the single-sampled fbo for reading instead. This should be
+ * called after the framebuffer state has been flushed.
+ */
+void
+_cogl_framebuffer_bind_resolved_read_buffer (CoglFramebuffer *framebuffer);
+
 CoglClipState *
 _cogl_framebuffer_get_clip_state (CoglFramebuffer *framebuffer);
 
@@ -226,6 +308,58 @@ void
 _cogl_framebuffer_set_clip_stack (CoglFramebuffer *framebuffer,
                                   CoglClipStack *stack);
 
+/*
+ * _cogl_framebuffer_set_repaint_clip:
+ * @framebuffer: A #CoglFramebuffer
+ * @x0: The left edge of the region in window coordinates
+ * @y0: The top edge of the region in window coordinates
+ * @x1: The right edge of the region in window coordinates
+ * @y1: The bottom edge of the region in window coordinates
+ *
+ * Implicitly scissors all further clears and drawing on @framebuffer
+ * to the given region in addition to the clip stack until
+ * _cogl_framebuffer_disable_repaint_clip() is called.
+ */
+void
+_cogl_framebuffer_set_repaint_clip (CoglFramebuffer *framebuffer,
+                                    int x0,
+                                    int y0,
+                                    int x1,
+                                    int y1);
+
+void
+_cogl_framebuffer_disable_repaint_clip (CoglFramebuffer *framebuffer);
+
+/*
+ * _cogl_framebuffer_points_are_culled:
+ * @framebuffer: A #CoglFramebuffer
+ * @points: An array of points with x, y and z components
+ * @n_points: The number of points, at most 8
+ *
+ * Checks whether geometry contained within @points would be entirely
+ * outside of the view frustum, the clip bounds and the repaint clip
+ * of @framebuffer when drawn with its current matrices.
+ *
+ * Return value: %TRUE if nothing would be drawn
+ */
+gboolean
+_cogl_framebuffer_points_are_culled (CoglFramebuffer *framebuffer,
+                                     const float *points,
+                                     int n_points);
+
+/*
+ * _cogl_framebuffer_get_depth_bits:
+ * @framebuffer: A #CoglFramebuffer
+ *
+ * Queries the number of depth bits of @framebuffer, allocating it if
+ * necessary.
+ *
+ * Return value: the number of depth bits or 0 if @framebuffer has no
+ *   depth buffer
+ */
+int
+_cogl_framebuffer_get_depth_bits (CoglFramebuffer *framebuffer);
+
 CoglMatrixStack *
 _cogl_framebuffer_get_modelview_stack (CoglFramebuffer *framebuffer);
 
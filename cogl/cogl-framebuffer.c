@@ -42,6 +42,7 @@
 #include "cogl-pipeline-state-private.h"
 #include "cogl-matrix-private.h"
 #include "cogl-primitive-private.h"
+#include "cogl-profile.h"
 
 #ifndef GL_FRAMEBUFFER
 #define GL_FRAMEBUFFER		0x8D40
@@ -97,6 +98,9 @@
 #ifndef GL_TEXTURE_SAMPLES_IMG
 #define GL_TEXTURE_SAMPLES_IMG            0x9136
 #endif
+#ifndef GL_RENDERBUFFER_SAMPLES
+#define GL_RENDERBUFFER_SAMPLES           0x8CAB
+#endif
 
 typedef enum {
   _TRY_DEPTH_STENCIL = 1L<<0,
@@ -152,6 +156,7 @@ _cogl_framebuffer_init (CoglFramebuffer *framebuffer,
                         int height)
 {
   framebuffer->context = cogl_object_ref (ctx);
+  framebuffer->holds_context_ref = TRUE;
 
   framebuffer->type             = type;
   framebuffer->width            = width;
@@ -226,15 +231,30 @@ _cogl_framebuffer_free (CoglFramebuffer *framebuffer)
   cogl_object_unref (framebuffer->projection_stack);
   framebuffer->projection_stack = NULL;
 
+  /* Fence callbacks are never called for a destroyed framebuffer */
+  _cogl_fence_cancel_fences_for_framebuffer (framebuffer);
+
   cogl_object_unref (framebuffer->journal);
 
   ctx->framebuffers = g_list_remove (ctx->framebuffers, framebuffer);
-  cogl_object_unref (ctx);
 
   if (ctx->current_draw_buffer == framebuffer)
     ctx->current_draw_buffer = NULL;
   if (ctx->current_read_buffer == framebuffer)
     ctx->current_read_buffer = NULL;
+
+  if (framebuffer->holds_context_ref)
+    cogl_object_unref (ctx);
+}
+
+void
+_cogl_framebuffer_release_context_ref (CoglFramebuffer *framebuffer)
+{
+  if (framebuffer->holds_context_ref)
+    {
+      framebuffer->holds_context_ref = FALSE;
+      cogl_object_unref (framebuffer->context);
+    }
 }
 
 const CoglWinsysVtable *
@@ -243,6 +263,60 @@ _cogl_framebuffer_get_winsys (CoglFramebuffer *framebuffer)
   return framebuffer->context->display->renderer->winsys_vtable;
 }
 
+/* Records that the scissored region of the framebuffer has been
+ * drawn to so that it will be resolved the next time the samples are
+ * needed. This should be called after the clip state has been flushed
+ * for the framebuffer. */
+static void
+_cogl_framebuffer_add_clip_damage (CoglFramebuffer *framebuffer)
+{
+  CoglContext *ctx = framebuffer->context;
+  CoglOffscreen *offscreen;
+  int x0 = 0, y0 = 0;
+  int x1 = framebuffer->width, y1 = framebuffer->height;
+
+  if (framebuffer->type != COGL_FRAMEBUFFER_TYPE_OFFSCREEN)
+    return;
+
+  offscreen = COGL_OFFSCREEN (framebuffer);
+  if (!offscreen->resolve_fbo_handle)
+    return;
+
+  /* Offscreen framebuffers are rendered upside down so the clip
+   * bounds are already in GL window coordinates */
+  if (ctx->current_clip_stack_valid)
+    {
+      int clip_x0, clip_y0, clip_x1, clip_y1;
+
+      _cogl_clip_stack_get_bounds (ctx->current_clip_stack,
+                                   &clip_x0, &clip_y0,
+                                   &clip_x1, &clip_y1);
+
+      x0 = MAX (x0, MAX (clip_x0, ctx->current_clip_repaint_x0));
+      y0 = MAX (y0, MAX (clip_y0, ctx->current_clip_repaint_y0));
+      x1 = MIN (x1, MIN (clip_x1, ctx->current_clip_repaint_x1));
+      y1 = MIN (y1, MIN (clip_y1, ctx->current_clip_repaint_y1));
+    }
+
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  if (offscreen->damage_x0 >= offscreen->damage_x1)
+    {
+      offscreen->damage_x0 = x0;
+      offscreen->damage_y0 = y0;
+      offscreen->damage_x1 = x1;
+      offscreen->damage_y1 = y1;
+    }
+  else
+    {
+      offscreen->damage_x0 = MIN (offscreen->damage_x0, x0);
+      offscreen->damage_y0 = MIN (offscreen->damage_y0, y0);
+      offscreen->damage_x1 = MAX (offscreen->damage_x1, x1);
+      offscreen->damage_y1 = MAX (offscreen->damage_y1, y1);
+    }
+}
+
 /* This version of cogl_clear can be used internally as an alternative
  * to avoid flushing the journal or the framebuffer state. This is
  * needed when doing operations that may be called whiling flushing
@@ -256,6 +330,7 @@ _cogl_framebuffer_clear_without_flush4f (CoglFramebuffer *framebuffer,
                                          float alpha)
 {
   GLbitfield gl_buffers = 0;
+  int n_passes, pass;
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
@@ -298,13 +373,24 @@ _cogl_framebuffer_clear_without_flush4f (CoglFramebuffer *framebuffer,
       return;
     }
 
-  GE (ctx, glClear (gl_buffers));
+  n_passes = _cogl_clip_stack_get_n_region_passes (ctx);
+  for (pass = 0; pass < n_passes; pass++)
+    {
+      _cogl_clip_stack_begin_region_pass (ctx, pass);
+      GE (ctx, glClear (gl_buffers));
+    }
+  _cogl_clip_stack_end_region_passes (ctx);
+
+  if (buffers & COGL_BUFFER_BIT_COLOR)
+    _cogl_framebuffer_add_clip_damage (framebuffer);
 }
 
 void
 _cogl_framebuffer_dirty (CoglFramebuffer *framebuffer)
 {
   framebuffer->clear_clip_dirty = TRUE;
+
+  _cogl_framebuffer_add_clip_damage (framebuffer);
 }
 
 void
@@ -316,6 +402,10 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
                           float alpha)
 {
   CoglClipStack *clip_stack = _cogl_framebuffer_get_clip_stack (framebuffer);
+  gboolean clipped = clip_stack || framebuffer->repaint_clip_enabled;
+  /* The bounds of a region clip don't describe which pixels are
+   * affected by the clear so we can't track them */
+  gboolean has_region = _cogl_clip_stack_has_region (clip_stack);
   int scissor_x0;
   int scissor_y0;
   int scissor_x1;
@@ -325,6 +415,15 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
                                &scissor_x0, &scissor_y0,
                                &scissor_x1, &scissor_y1);
 
+  /* The clear will also be scissored to the region being repainted */
+  if (framebuffer->repaint_clip_enabled)
+    {
+      scissor_x0 = MAX (scissor_x0, framebuffer->repaint_clip_x0);
+      scissor_y0 = MAX (scissor_y0, framebuffer->repaint_clip_y0);
+      scissor_x1 = MIN (scissor_x1, framebuffer->repaint_clip_x1);
+      scissor_y1 = MIN (scissor_y1, framebuffer->repaint_clip_y1);
+    }
+
   /* NB: the previous clear could have had an arbitrary clip.
    * NB: everything for the last frame might still be in the journal
    *     but we can't assume anything about how each entry was
@@ -361,6 +460,7 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
    */
   if (buffers & COGL_BUFFER_BIT_COLOR &&
       buffers & COGL_BUFFER_BIT_DEPTH &&
+      !has_region &&
       !framebuffer->clear_clip_dirty &&
       framebuffer->clear_color_red == red &&
       framebuffer->clear_color_green == green &&
@@ -377,7 +477,7 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
        * and so all journal entries become redundant and can simply be
        * discarded.
        */
-      if (clip_stack)
+      if (clipped)
         {
           /*
            * Note: the function for checking the journal entries is
@@ -430,7 +530,14 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
 
 cleared:
 
-  if (buffers & COGL_BUFFER_BIT_COLOR && buffers & COGL_BUFFER_BIT_DEPTH)
+  /* Journal entries that are depth sorted only need to be nearer than
+   * anything drawn since the last time the whole depth buffer was
+   * cleared so we can start handing out depth values again */
+  if (buffers & COGL_BUFFER_BIT_DEPTH && clip_stack == NULL)
+    framebuffer->depth_sort_serial = 0;
+
+  if (buffers & COGL_BUFFER_BIT_COLOR && buffers & COGL_BUFFER_BIT_DEPTH &&
+      !has_region)
     {
       /* For our fast-path for reading back a single pixel of simple
        * scenes where the whole frame is in the journal we need to
@@ -444,13 +551,12 @@ cleared:
 
       /* NB: A clear may be scissored so we need to track the extents
        * that the clear is applicable too... */
-      if (clip_stack)
+      if (clipped)
         {
-          _cogl_clip_stack_get_bounds (clip_stack,
-                                       &framebuffer->clear_clip_x0,
-                                       &framebuffer->clear_clip_y0,
-                                       &framebuffer->clear_clip_x1,
-                                       &framebuffer->clear_clip_y1);
+          framebuffer->clear_clip_x0 = scissor_x0;
+          framebuffer->clear_clip_y0 = scissor_y0;
+          framebuffer->clear_clip_x1 = scissor_x1;
+          framebuffer->clear_clip_y1 = scissor_y1;
         }
       else
         {
@@ -513,6 +619,195 @@ _cogl_framebuffer_set_clip_stack (CoglFramebuffer *framebuffer,
   _cogl_clip_state_set_stack (clip_state, stack);
 }
 
+static void
+_cogl_framebuffer_repaint_clip_changed (CoglFramebuffer *framebuffer)
+{
+  /* The last clear no longer necessarily matches what a clear would
+   * touch now so the read-pixel and clear fast paths can't rely on it */
+  framebuffer->clear_clip_dirty = TRUE;
+
+  if (framebuffer->context->current_draw_buffer == framebuffer)
+    framebuffer->context->current_draw_buffer_changes |=
+      COGL_FRAMEBUFFER_STATE_CLIP;
+}
+
+void
+_cogl_framebuffer_set_repaint_clip (CoglFramebuffer *framebuffer,
+                                    int x0,
+                                    int y0,
+                                    int x1,
+                                    int y1)
+{
+  if (framebuffer->repaint_clip_enabled &&
+      framebuffer->repaint_clip_x0 == x0 &&
+      framebuffer->repaint_clip_y0 == y0 &&
+      framebuffer->repaint_clip_x1 == x1 &&
+      framebuffer->repaint_clip_y1 == y1)
+    return;
+
+  /* Anything already logged was drawn with the previous clip */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  framebuffer->repaint_clip_enabled = TRUE;
+  framebuffer->repaint_clip_x0 = x0;
+  framebuffer->repaint_clip_y0 = y0;
+  framebuffer->repaint_clip_x1 = x1;
+  framebuffer->repaint_clip_y1 = y1;
+
+  _cogl_framebuffer_repaint_clip_changed (framebuffer);
+}
+
+void
+_cogl_framebuffer_disable_repaint_clip (CoglFramebuffer *framebuffer)
+{
+  if (!framebuffer->repaint_clip_enabled)
+    return;
+
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  framebuffer->repaint_clip_enabled = FALSE;
+
+  _cogl_framebuffer_repaint_clip_changed (framebuffer);
+}
+
+static const CoglMatrix *
+get_cull_matrix (CoglFramebuffer *framebuffer)
+{
+  unsigned int modelview_age =
+    _cogl_matrix_stack_get_age (framebuffer->modelview_stack);
+  unsigned int projection_age =
+    _cogl_matrix_stack_get_age (framebuffer->projection_stack);
+
+  if (!framebuffer->cull_matrix_valid ||
+      framebuffer->cull_modelview_age != modelview_age ||
+      framebuffer->cull_projection_age != projection_age)
+    {
+      CoglMatrix modelview;
+      CoglMatrix projection;
+
+      _cogl_matrix_stack_get (framebuffer->modelview_stack, &modelview);
+      _cogl_matrix_stack_get (framebuffer->projection_stack, &projection);
+      cogl_matrix_multiply (&framebuffer->cull_matrix,
+                            &projection, &modelview);
+
+      framebuffer->cull_matrix_valid = TRUE;
+      framebuffer->cull_modelview_age = modelview_age;
+      framebuffer->cull_projection_age = projection_age;
+    }
+
+  return &framebuffer->cull_matrix;
+}
+
+/* Out codes for each of the clip planes of the view frustum */
+#define CULL_LEFT   (1 << 0)
+#define CULL_RIGHT  (1 << 1)
+#define CULL_BOTTOM (1 << 2)
+#define CULL_TOP    (1 << 3)
+#define CULL_NEAR   (1 << 4)
+#define CULL_FAR    (1 << 5)
+
+/* Checks whether the convex hull of the given points, which are
+ * transformed by the current modelview and projection of
+ * @framebuffer, definitely can't touch any pixels. The points have
+ * three components each. This returns FALSE whenever it isn't sure */
+gboolean
+_cogl_framebuffer_points_are_culled (CoglFramebuffer *framebuffer,
+                                     const float *points,
+                                     int n_points)
+{
+  float projected[4 * 8];
+  unsigned int all_out = ~0U;
+  gboolean all_in_front = TRUE;
+  float x0 = G_MAXFLOAT, y0 = G_MAXFLOAT;
+  float x1 = -G_MAXFLOAT, y1 = -G_MAXFLOAT;
+  int clip_x0, clip_y0, clip_x1, clip_y1;
+  int i;
+
+  _COGL_RETURN_VAL_IF_FAIL (n_points <= 8, FALSE);
+
+  cogl_matrix_project_points (get_cull_matrix (framebuffer),
+                              3, /* n_components */
+                              sizeof (float) * 3, /* stride_in */
+                              points,
+                              sizeof (float) * 4, /* stride_out */
+                              projected,
+                              n_points);
+
+  for (i = 0; i < n_points; i++)
+    {
+      float x = projected[i * 4];
+      float y = projected[i * 4 + 1];
+      float z = projected[i * 4 + 2];
+      float w = projected[i * 4 + 3];
+      unsigned int out = 0;
+
+      if (x < -w)
+        out |= CULL_LEFT;
+      if (x > w)
+        out |= CULL_RIGHT;
+      if (y < -w)
+        out |= CULL_BOTTOM;
+      if (y > w)
+        out |= CULL_TOP;
+      if (z < -w)
+        out |= CULL_NEAR;
+      if (z > w)
+        out |= CULL_FAR;
+
+      all_out &= out;
+
+      if (w <= 0)
+        all_in_front = FALSE;
+      else
+        {
+          /* Window coordinates with the origin at the top left */
+          x = (x / w + 1.0f) * framebuffer->viewport_width / 2.0f +
+            framebuffer->viewport_x;
+          y = (1.0f - y / w) * framebuffer->viewport_height / 2.0f +
+            framebuffer->viewport_y;
+
+          x0 = MIN (x0, x);
+          y0 = MIN (y0, y);
+          x1 = MAX (x1, x);
+          y1 = MAX (y1, y);
+        }
+    }
+
+  /* All of the points are on the outside of one of the planes of the
+     view frustum */
+  if (all_out)
+    return TRUE;
+
+  /* Points behind the viewer would project to the wrong side of the
+     screen so we can only look at the window bounds without them */
+  if (!all_in_front)
+    return FALSE;
+
+  _cogl_clip_stack_get_bounds (_cogl_framebuffer_get_clip_stack (framebuffer),
+                               &clip_x0, &clip_y0, &clip_x1, &clip_y1);
+
+  clip_x1 = MIN (clip_x1, framebuffer->width);
+  clip_y1 = MIN (clip_y1, framebuffer->height);
+
+  if (framebuffer->repaint_clip_enabled)
+    {
+      clip_x0 = MAX (clip_x0, framebuffer->repaint_clip_x0);
+      clip_y0 = MAX (clip_y0, framebuffer->repaint_clip_y0);
+      clip_x1 = MIN (clip_x1, framebuffer->repaint_clip_x1);
+      clip_y1 = MIN (clip_y1, framebuffer->repaint_clip_y1);
+    }
+
+  return (x1 <= clip_x0 || y1 <= clip_y0 ||
+          x0 >= clip_x1 || y0 >= clip_y1);
+}
+
+#undef CULL_LEFT
+#undef CULL_RIGHT
+#undef CULL_BOTTOM
+#undef CULL_TOP
+#undef CULL_NEAR
+#undef CULL_FAR
+
 void
 cogl_framebuffer_set_viewport (CoglFramebuffer *framebuffer,
                                float x,
@@ -626,8 +921,10 @@ void
 _cogl_framebuffer_flush_dependency_journals (CoglFramebuffer *framebuffer)
 {
   GList *l;
+  /* The dependencies are going to be used as a source so any
+   * multisampled rendering must also be resolved */
   for (l = framebuffer->deps; l; l = l->next)
-    _cogl_framebuffer_flush_journal (l->data);
+    _cogl_framebuffer_resolve_damage (l->data);
   _cogl_framebuffer_remove_all_dependencies (framebuffer);
 }
 
@@ -635,12 +932,19 @@ static inline void
 _cogl_framebuffer_init_bits (CoglFramebuffer *framebuffer)
 {
   CoglContext *ctx = framebuffer->context;
+#ifdef HAVE_COGL_GL
+  GLint object_type;
+#endif
 
   cogl_framebuffer_allocate (framebuffer, NULL);
 
   if (G_LIKELY (!framebuffer->dirty_bitmasks))
     return;
 
+  /* The queries apply to whichever framebuffer is bound */
+  _cogl_framebuffer_flush_state (framebuffer, framebuffer,
+                                 COGL_FRAMEBUFFER_STATE_BIND);
+
 #ifdef HAVE_COGL_GL
   if (ctx->driver == COGL_DRIVER_GL &&
       cogl_has_feature (ctx, COGL_FEATURE_ID_OFFSCREEN) &&
@@ -676,6 +980,26 @@ _cogl_framebuffer_init_bits (CoglFramebuffer *framebuffer)
                                                       pname,
                                                       &framebuffer->alpha_bits)
           );
+
+      /* The size of a missing attachment can't be queried */
+      attachment = GL_DEPTH_ATTACHMENT;
+      pname = GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE;
+      GE( ctx, glGetFramebufferAttachmentParameteriv (GL_FRAMEBUFFER,
+                                                      attachment,
+                                                      pname,
+                                                      &object_type) );
+
+      if (object_type == GL_NONE)
+        framebuffer->depth_bits = 0;
+      else
+        {
+          pname = GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE;
+          GE( ctx, glGetFramebufferAttachmentParameteriv
+              (GL_FRAMEBUFFER,
+               attachment,
+               pname,
+               &framebuffer->depth_bits) );
+        }
     }
   else
 #endif /* HAVE_COGL_GL */
@@ -684,11 +1008,12 @@ _cogl_framebuffer_init_bits (CoglFramebuffer *framebuffer)
       GE( ctx, glGetIntegerv (GL_GREEN_BITS, &framebuffer->green_bits) );
       GE( ctx, glGetIntegerv (GL_BLUE_BITS,  &framebuffer->blue_bits)  );
       GE( ctx, glGetIntegerv (GL_ALPHA_BITS, &framebuffer->alpha_bits) );
+      GE( ctx, glGetIntegerv (GL_DEPTH_BITS, &framebuffer->depth_bits) );
     }
 
 
   COGL_NOTE (OFFSCREEN,
-             "RGBA Bits for framebuffer[%p, %s]: %d, %d, %d, %d",
+             "RGBA Bits for framebuffer[%p, %s]: %d, %d, %d, %d, depth: %d",
              framebuffer,
              framebuffer->type == COGL_FRAMEBUFFER_TYPE_OFFSCREEN
                ? "offscreen"
@@ -696,7 +1021,8 @@ _cogl_framebuffer_init_bits (CoglFramebuffer *framebuffer)
              framebuffer->red_bits,
              framebuffer->blue_bits,
              framebuffer->green_bits,
-             framebuffer->alpha_bits);
+             framebuffer->alpha_bits,
+             framebuffer->depth_bits);
 
   framebuffer->dirty_bitmasks = FALSE;
 }
@@ -784,6 +1110,10 @@ _cogl_offscreen_free (CoglOffscreen *offscreen)
   CoglContext *ctx = framebuffer->context;
   GSList *l;
 
+  /* Anything drawn since the last resolve would otherwise never reach
+   * the texture */
+  _cogl_framebuffer_resolve_damage (framebuffer);
+
   /* Chain up to parent */
   _cogl_framebuffer_free (framebuffer);
 
@@ -795,6 +1125,8 @@ _cogl_offscreen_free (CoglOffscreen *offscreen)
   g_slist_free (offscreen->renderbuffers);
 
   GE (ctx, glDeleteFramebuffers (1, &offscreen->fbo_handle));
+  if (offscreen->resolve_fbo_handle)
+    GE (ctx, glDeleteFramebuffers (1, &offscreen->resolve_fbo_handle));
 
   if (offscreen->texture != COGL_INVALID_HANDLE)
     cogl_object_unref (offscreen->texture);
@@ -802,6 +1134,28 @@ _cogl_offscreen_free (CoglOffscreen *offscreen)
   g_free (offscreen);
 }
 
+static void
+renderbuffer_storage (CoglContext *ctx,
+                      int n_samples,
+                      GLenum internal_format,
+                      int width,
+                      int height)
+{
+  if (n_samples == 0)
+    GE (ctx, glRenderbufferStorage (GL_RENDERBUFFER, internal_format,
+                                    width, height));
+  else if (ctx->glRenderbufferStorageMultisampleIMG)
+    GE (ctx, glRenderbufferStorageMultisampleIMG (GL_RENDERBUFFER,
+                                                  n_samples,
+                                                  internal_format,
+                                                  width, height));
+  else
+    GE (ctx, glRenderbufferStorageMultisample (GL_RENDERBUFFER,
+                                               n_samples,
+                                               internal_format,
+                                               width, height));
+}
+
 static gboolean
 try_creating_fbo (CoglOffscreen *offscreen,
                   TryFBOFlags flags)
@@ -811,11 +1165,15 @@ try_creating_fbo (CoglOffscreen *offscreen,
   GLuint gl_depth_stencil_handle;
   GLuint gl_depth_handle;
   GLuint gl_stencil_handle;
+  GLuint gl_color_handle;
   GLuint tex_gl_handle;
   GLenum tex_gl_target;
   GLuint fbo_gl_handle;
+  GLuint resolve_fbo_gl_handle = 0;
   GLenum status;
+  gboolean explicit_resolve = FALSE;
   int n_samples;
+  int texture_samples = 0;
   int height;
   int width;
 
@@ -832,8 +1190,16 @@ try_creating_fbo (CoglOffscreen *offscreen,
 
   if (fb->config.samples_per_pixel)
     {
+      /* If the samples can't be resolved implicitly while rendering
+       * to the texture then we can render to multisampled
+       * renderbuffers and blit them to the texture instead */
       if (!ctx->glFramebufferTexture2DMultisampleIMG)
-        return FALSE;
+        {
+          if (!(ctx->private_feature_flags &
+                COGL_PRIVATE_FEATURE_OFFSCREEN_MULTISAMPLE_RESOLVE))
+            return FALSE;
+          explicit_resolve = TRUE;
+        }
       n_samples = fb->config.samples_per_pixel;
     }
   else
@@ -847,12 +1213,54 @@ try_creating_fbo (CoglOffscreen *offscreen,
    * rebound again before drawing. */
   ctx->current_draw_buffer_changes |= COGL_FRAMEBUFFER_STATE_BIND;
 
+  if (explicit_resolve)
+    {
+      /* The texture is only ever written to by resolving the samples
+       * so it doesn't need any ancillary buffers */
+      ctx->glGenFramebuffers (1, &resolve_fbo_gl_handle);
+      GE (ctx, glBindFramebuffer (GL_FRAMEBUFFER, resolve_fbo_gl_handle));
+      GE (ctx, glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                       tex_gl_target, tex_gl_handle,
+                                       offscreen->texture_level));
+
+      if (ctx->glCheckFramebufferStatus (GL_FRAMEBUFFER) !=
+          GL_FRAMEBUFFER_COMPLETE)
+        {
+          GE (ctx, glDeleteFramebuffers (1, &resolve_fbo_gl_handle));
+          return FALSE;
+        }
+    }
+
   /* Generate framebuffer */
   ctx->glGenFramebuffers (1, &fbo_gl_handle);
   GE (ctx, glBindFramebuffer (GL_FRAMEBUFFER, fbo_gl_handle));
   offscreen->fbo_handle = fbo_gl_handle;
 
-  if (n_samples)
+  if (explicit_resolve)
+    {
+      GLenum gl_intformat;
+
+      ctx->texture_driver->pixel_format_to_gl (fb->format,
+                                               &gl_intformat,
+                                               NULL,
+                                               NULL);
+
+      GE (ctx, glGenRenderbuffers (1, &gl_color_handle));
+      GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, gl_color_handle));
+      renderbuffer_storage (ctx, n_samples, gl_intformat, width, height);
+      GE (ctx, glGetRenderbufferParameteriv (GL_RENDERBUFFER,
+                                             GL_RENDERBUFFER_SAMPLES,
+                                             &texture_samples));
+      GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, 0));
+      GE (ctx, glFramebufferRenderbuffer (GL_FRAMEBUFFER,
+                                          GL_COLOR_ATTACHMENT0,
+                                          GL_RENDERBUFFER,
+                                          gl_color_handle));
+      offscreen->renderbuffers =
+        g_slist_prepend (offscreen->renderbuffers,
+                         GUINT_TO_POINTER (gl_color_handle));
+    }
+  else if (n_samples)
     {
       GE (ctx, glFramebufferTexture2DMultisampleIMG (GL_FRAMEBUFFER,
                                                      GL_COLOR_ATTACHMENT0,
@@ -870,14 +1278,8 @@ try_creating_fbo (CoglOffscreen *offscreen,
       /* Create a renderbuffer for depth and stenciling */
       GE (ctx, glGenRenderbuffers (1, &gl_depth_stencil_handle));
       GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, gl_depth_stencil_handle));
-      if (n_samples)
-        GE (ctx, glRenderbufferStorageMultisampleIMG (GL_RENDERBUFFER,
-                                                      n_samples,
-                                                      GL_DEPTH_STENCIL,
-                                                      width, height));
-      else
-        GE (ctx, glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_STENCIL,
-                                        width, height));
+      renderbuffer_storage (ctx, n_samples, GL_DEPTH_STENCIL,
+                            width, height);
       GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, 0));
       GE (ctx, glFramebufferRenderbuffer (GL_FRAMEBUFFER,
                                           GL_STENCIL_ATTACHMENT,
@@ -898,14 +1300,8 @@ try_creating_fbo (CoglOffscreen *offscreen,
       GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, gl_depth_handle));
       /* For now we just ask for GL_DEPTH_COMPONENT16 since this is all that's
        * available under GLES */
-      if (n_samples)
-        GE (ctx, glRenderbufferStorageMultisampleIMG (GL_RENDERBUFFER,
-                                                      n_samples,
-                                                      GL_DEPTH_COMPONENT16,
-                                                      width, height));
-      else
-        GE (ctx, glRenderbufferStorage (GL_RENDERBUFFER, GL_DEPTH_COMPONENT16,
-                                        width, height));
+      renderbuffer_storage (ctx, n_samples, GL_DEPTH_COMPONENT16,
+                            width, height);
       GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, 0));
       GE (ctx, glFramebufferRenderbuffer (GL_FRAMEBUFFER,
                                           GL_DEPTH_ATTACHMENT,
@@ -919,14 +1315,8 @@ try_creating_fbo (CoglOffscreen *offscreen,
     {
       GE (ctx, glGenRenderbuffers (1, &gl_stencil_handle));
       GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, gl_stencil_handle));
-      if (n_samples)
-        GE (ctx, glRenderbufferStorageMultisampleIMG (GL_RENDERBUFFER,
-                                                      n_samples,
-                                                      GL_STENCIL_INDEX8,
-                                                      width, height));
-      else
-        GE (ctx, glRenderbufferStorage (GL_RENDERBUFFER, GL_STENCIL_INDEX8,
-                                        width, height));
+      renderbuffer_storage (ctx, n_samples, GL_STENCIL_INDEX8,
+                            width, height);
       GE (ctx, glBindRenderbuffer (GL_RENDERBUFFER, 0));
       GE (ctx, glFramebufferRenderbuffer (GL_FRAMEBUFFER,
                                           GL_STENCIL_ATTACHMENT,
@@ -944,6 +1334,8 @@ try_creating_fbo (CoglOffscreen *offscreen,
       GSList *l;
 
       GE (ctx, glDeleteFramebuffers (1, &fbo_gl_handle));
+      if (resolve_fbo_gl_handle)
+        GE (ctx, glDeleteFramebuffers (1, &resolve_fbo_gl_handle));
 
       for (l = offscreen->renderbuffers; l; l = l->next)
         {
@@ -959,11 +1351,15 @@ try_creating_fbo (CoglOffscreen *offscreen,
 
   /* Update the real number of samples_per_pixel now that we have a
    * complete framebuffer */
-  if (n_samples)
+  if (explicit_resolve)
+    {
+      fb->samples_per_pixel = texture_samples;
+      offscreen->resolve_fbo_handle = resolve_fbo_gl_handle;
+    }
+  else if (n_samples)
     {
       GLenum attachment = GL_COLOR_ATTACHMENT0;
       GLenum pname = GL_TEXTURE_SAMPLES_IMG;
-      int texture_samples;
 
       GE( ctx, glGetFramebufferAttachmentParameteriv (GL_FRAMEBUFFER,
                                                       attachment,
@@ -1348,6 +1744,13 @@ _cogl_framebuffer_compare_clip_state (CoglFramebuffer *a,
       ||
       a->clip_state.stacks->data != b->clip_state.stacks->data)
     return COGL_FRAMEBUFFER_STATE_CLIP;
+  else if (a->repaint_clip_enabled != b->repaint_clip_enabled ||
+           (a->repaint_clip_enabled &&
+            (a->repaint_clip_x0 != b->repaint_clip_x0 ||
+             a->repaint_clip_y0 != b->repaint_clip_y0 ||
+             a->repaint_clip_x1 != b->repaint_clip_x1 ||
+             a->repaint_clip_y1 != b->repaint_clip_y1)))
+    return COGL_FRAMEBUFFER_STATE_CLIP;
   else
     return 0;
 }
@@ -1770,6 +2173,48 @@ cogl_framebuffer_set_dither_enabled (CoglFramebuffer *framebuffer,
       COGL_FRAMEBUFFER_STATE_DITHER;
 }
 
+gboolean
+cogl_framebuffer_get_occlusion_culling_enabled (CoglFramebuffer *framebuffer)
+{
+  return framebuffer->occlusion_culling_enabled;
+}
+
+void
+cogl_framebuffer_set_occlusion_culling_enabled (CoglFramebuffer *framebuffer,
+                                                gboolean enabled)
+{
+  /* This is only looked at when the journal is flushed so it takes
+   * effect for anything already logged */
+  framebuffer->occlusion_culling_enabled = enabled;
+}
+
+int
+_cogl_framebuffer_get_depth_bits (CoglFramebuffer *framebuffer)
+{
+  _cogl_framebuffer_init_bits (framebuffer);
+
+  return framebuffer->depth_bits;
+}
+
+gboolean
+cogl_framebuffer_get_depth_sorting_enabled (CoglFramebuffer *framebuffer)
+{
+  return framebuffer->depth_sorting_enabled;
+}
+
+void
+cogl_framebuffer_set_depth_sorting_enabled (CoglFramebuffer *framebuffer,
+                                            gboolean enabled)
+{
+  if (framebuffer->depth_sorting_enabled == enabled)
+    return;
+
+  /* Entries already in the journal weren't given a depth */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  framebuffer->depth_sorting_enabled = enabled;
+}
+
 CoglPixelFormat
 cogl_framebuffer_get_color_format (CoglFramebuffer *framebuffer)
 {
@@ -1801,32 +2246,6 @@ cogl_framebuffer_resolve_samples (CoglFramebuffer *framebuffer)
                                            0, 0,
                                            framebuffer->width,
                                            framebuffer->height);
-
-  /* TODO: Make this happen implicitly when the resolve texture next gets used
-   * as a source, either via cogl_texture_get_data(), via cogl_read_pixels() or
-   * if used as a source for rendering. We would also implicitly resolve if
-   * necessary before freeing a CoglFramebuffer.
-   *
-   * This API should still be kept but it is optional, only necessary
-   * if the user wants to explicitly control when the resolve happens e.g.
-   * to ensure it's done in advance of it being used as a source.
-   *
-   * Every texture should have a CoglFramebuffer *needs_resolve member
-   * internally. When the texture gets validated before being used as a source
-   * we should first check the needs_resolve pointer and if set we'll
-   * automatically call cogl_framebuffer_resolve_samples ().
-   *
-   * Calling cogl_framebuffer_resolve_samples() or
-   * cogl_framebuffer_resolve_samples_region() should reset the textures
-   * needs_resolve pointer to NULL.
-   *
-   * Rendering anything to a framebuffer will cause the corresponding
-   * texture's ->needs_resolve pointer to be set.
-   *
-   * XXX: Note: we only need to address this TODO item when adding support for
-   * EXT_framebuffer_multisample because currently we only support hardware
-   * that resolves implicitly anyway.
-   */
 }
 
 void
@@ -1836,8 +2255,85 @@ cogl_framebuffer_resolve_samples_region (CoglFramebuffer *framebuffer,
                                          int width,
                                          int height)
 {
-  /* NOP for now since we don't support EXT_framebuffer_multisample yet which
-   * requires an explicit resolve. */
+  CoglContext *ctx = framebuffer->context;
+  CoglOffscreen *offscreen;
+  int x0, y0, x1, y1;
+
+  /* Nothing to do if the GPU resolves the samples implicitly */
+  if (framebuffer->type != COGL_FRAMEBUFFER_TYPE_OFFSCREEN ||
+      !COGL_OFFSCREEN (framebuffer)->resolve_fbo_handle)
+    return;
+
+  offscreen = COGL_OFFSCREEN (framebuffer);
+
+  /* The damage is only recorded when the primitives actually reach
+   * GL so the journal must be flushed first */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  /* Only the part of the region that has changed needs to be
+   * resolved */
+  x0 = MAX (x, offscreen->damage_x0);
+  y0 = MAX (y, offscreen->damage_y0);
+  x1 = MIN (x + width, offscreen->damage_x1);
+  y1 = MIN (y + height, offscreen->damage_y1);
+
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  COGL_NOTE (OFFSCREEN, "Resolving samples in %ix%i region at %i,%i",
+             x1 - x0, y1 - y0, x0, y0);
+
+  GE (ctx, glBindFramebuffer (GL_READ_FRAMEBUFFER, offscreen->fbo_handle));
+  GE (ctx, glBindFramebuffer (GL_DRAW_FRAMEBUFFER,
+                              offscreen->resolve_fbo_handle));
+
+  /* The blit is affected by the scissor so it is disabled and the
+   * clip state will be flushed again before the next primitive */
+  GE (ctx, glDisable (GL_SCISSOR_TEST));
+  if (ctx->current_clip_stack_valid)
+    {
+      _cogl_clip_stack_unref (ctx->current_clip_stack);
+      ctx->current_clip_stack_valid = FALSE;
+    }
+
+  ctx->glBlitFramebuffer (x0, y0, x1, y1,
+                          x0, y0, x1, y1,
+                          GL_COLOR_BUFFER_BIT,
+                          GL_NEAREST);
+
+  ctx->current_draw_buffer_changes |= COGL_FRAMEBUFFER_STATE_BIND;
+
+  /* If the whole damaged area was resolved then the texture is now up
+   * to date. Otherwise the damage is kept as it is because the
+   * remaining area might not be a rectangle */
+  if (x0 == offscreen->damage_x0 && y0 == offscreen->damage_y0 &&
+      x1 == offscreen->damage_x1 && y1 == offscreen->damage_y1)
+    offscreen->damage_x0 = offscreen->damage_x1 = 0;
+}
+
+void
+_cogl_framebuffer_resolve_damage (CoglFramebuffer *framebuffer)
+{
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  cogl_framebuffer_resolve_samples (framebuffer);
+}
+
+void
+_cogl_framebuffer_bind_resolved_read_buffer (CoglFramebuffer *framebuffer)
+{
+  CoglContext *ctx = framebuffer->context;
+
+  if (framebuffer->type != COGL_FRAMEBUFFER_TYPE_OFFSCREEN ||
+      !COGL_OFFSCREEN (framebuffer)->resolve_fbo_handle)
+    return;
+
+  cogl_framebuffer_resolve_samples (framebuffer);
+
+  GE (ctx, glBindFramebuffer (GL_READ_FRAMEBUFFER,
+                              COGL_OFFSCREEN (framebuffer)->
+                              resolve_fbo_handle));
+  ctx->current_draw_buffer_changes |= COGL_FRAMEBUFFER_STATE_BIND;
 }
 
 CoglContext *
@@ -1868,6 +2364,15 @@ _cogl_framebuffer_try_fast_read_pixel (CoglFramebuffer *framebuffer,
       format != COGL_PIXEL_FORMAT_RGBA_8888)
     return FALSE;
 
+  /* The journal doesn't know about the repaint clip so it can't tell
+   * what is outside of it */
+  if (framebuffer->repaint_clip_enabled &&
+      (x < framebuffer->repaint_clip_x0 ||
+       x >= framebuffer->repaint_clip_x1 ||
+       y < framebuffer->repaint_clip_y0 ||
+       y >= framebuffer->repaint_clip_y1))
+    return FALSE;
+
   if (!_cogl_journal_try_read_pixel (framebuffer->journal,
                                      x, y, format, pixel,
                                      &found_intersection))
@@ -2009,6 +2514,18 @@ cogl_framebuffer_discard_buffers (CoglFramebuffer *framebuffer,
 {
   _COGL_RETURN_IF_FAIL (buffers & COGL_BUFFER_BIT_COLOR);
 
+  /* The multisampled buffers of an offscreen framebuffer are only
+   * scratch storage for the texture so the samples can be resolved
+   * and then discarded. This saves writing them back to memory on
+   * tiled GPUs */
+  if (framebuffer->type == COGL_FRAMEBUFFER_TYPE_OFFSCREEN &&
+      COGL_OFFSCREEN (framebuffer)->resolve_fbo_handle)
+    {
+      _cogl_framebuffer_resolve_damage (framebuffer);
+      _cogl_framebuffer_flush_state (framebuffer, framebuffer,
+                                     COGL_FRAMEBUFFER_STATE_BIND);
+    }
+
   _cogl_framebuffer_discard_buffers_real (framebuffer, buffers);
 }
 
@@ -2290,6 +2807,24 @@ cogl_framebuffer_push_scissor_clip (CoglFramebuffer *framebuffer,
       COGL_FRAMEBUFFER_STATE_CLIP;
 }
 
+void
+cogl_framebuffer_push_region_clip (CoglFramebuffer *framebuffer,
+                                   const int *rectangles,
+                                   int n_rectangles)
+{
+  CoglClipState *clip_state = _cogl_framebuffer_get_clip_state (framebuffer);
+
+  _COGL_RETURN_IF_FAIL (n_rectangles >= 0);
+
+  clip_state->stacks->data =
+    _cogl_clip_stack_push_region (clip_state->stacks->data,
+                                  rectangles, n_rectangles);
+
+  if (framebuffer->context->current_draw_buffer == framebuffer)
+    framebuffer->context->current_draw_buffer_changes |=
+      COGL_FRAMEBUFFER_STATE_CLIP;
+}
+
 void
 cogl_framebuffer_push_rectangle_clip (CoglFramebuffer *framebuffer,
                                       float x_1,
@@ -2688,11 +3223,21 @@ _cogl_framebuffer_draw_attributes (CoglFramebuffer *framebuffer,
   else
 #endif
     {
+      CoglContext *ctx = framebuffer->context;
+      int n_passes, pass;
+
       _cogl_flush_attributes_state (framebuffer, pipeline, flags,
                                     attributes, n_attributes);
 
-      GE (framebuffer->context,
-          glDrawArrays ((GLenum)mode, first_vertex, n_vertices));
+      /* A region clip is applied by repeating the draw for each of
+       * its rectangles */
+      n_passes = _cogl_clip_stack_get_n_region_passes (ctx);
+      for (pass = 0; pass < n_passes; pass++)
+        {
+          _cogl_clip_stack_begin_region_pass (ctx, pass);
+          GE (ctx, glDrawArrays ((GLenum)mode, first_vertex, n_vertices));
+        }
+      _cogl_clip_stack_end_region_passes (ctx);
     }
 }
 
@@ -2786,6 +3331,7 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
       size_t buffer_offset;
       size_t index_size;
       GLenum indices_gl_type = 0;
+      int n_passes, pass;
 
       _cogl_flush_attributes_state (framebuffer, pipeline, flags,
                                     attributes, n_attributes);
@@ -2808,11 +3354,18 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
           break;
         }
 
-      GE (framebuffer->context,
-          glDrawElements ((GLenum)mode,
-                          n_vertices,
-                          indices_gl_type,
-                          base + buffer_offset + index_size * first_vertex));
+      n_passes = _cogl_clip_stack_get_n_region_passes (framebuffer->context);
+      for (pass = 0; pass < n_passes; pass++)
+        {
+          _cogl_clip_stack_begin_region_pass (framebuffer->context, pass);
+          GE (framebuffer->context,
+              glDrawElements ((GLenum)mode,
+                              n_vertices,
+                              indices_gl_type,
+                              base + buffer_offset +
+                              index_size * first_vertex));
+        }
+      _cogl_clip_stack_end_region_passes (framebuffer->context);
 
       _cogl_buffer_unbind (buffer);
     }
@@ -2880,6 +3433,38 @@ _cogl_framebuffer_draw_primitive (CoglFramebuffer *framebuffer,
                                   CoglPrimitive *primitive,
                                   CoglDrawFlags flags)
 {
+  COGL_STATIC_COUNTER (primitive_culled_counter,
+                       "Primitive frustum culled counter",
+                       "Increments for each primitive that is skipped "
+                       "because its bounds are outside of the viewport "
+                       "or clip",
+                       0 /* no application private data */);
+
+  /* If the framebuffer state isn't going to be flushed then the
+     caller may have set up its own matrices */
+  if (primitive->has_bounds &&
+      !(flags & COGL_DRAW_SKIP_FRAMEBUFFER_FLUSH) &&
+      G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_FRUSTUM_CULLING)))
+    {
+      const float *min = primitive->bounds;
+      const float *max = primitive->bounds + 3;
+      float corners[8 * 3];
+      int i;
+
+      for (i = 0; i < 8; i++)
+        {
+          corners[i * 3] = (i & 1) ? max[0] : min[0];
+          corners[i * 3 + 1] = (i & 2) ? max[1] : min[1];
+          corners[i * 3 + 2] = (i & 4) ? max[2] : min[2];
+        }
+
+      if (_cogl_framebuffer_points_are_culled (framebuffer, corners, 8))
+        {
+          COGL_COUNTER_INC (_cogl_uprof_context, primitive_culled_counter);
+          return;
+        }
+    }
+
   if (primitive->indices)
     _cogl_framebuffer_draw_indexed_attributes (framebuffer,
                                                pipeline,
@@ -524,6 +524,37 @@ cogl_framebuffer_push_scissor_clip (CoglFramebuffer *framebuffer,
                                     int width,
                                     int height);
 
+/**
+ * cogl_framebuffer_push_region_clip:
+ * @framebuffer: A #CoglFramebuffer pointer
+ * @rectangles: (array length=n_rectangles): An array of rectangles
+ *   with 4 ints each for the x, y, width and height in window
+ *   coordinates
+ * @n_rectangles: The number of rectangles in @rectangles
+ *
+ * Specifies a clipping area for all subsequent drawing operations
+ * made from the union of a list of window space rectangles. The
+ * rectangles may overlap. Like cogl_framebuffer_push_scissor_clip()
+ * the rectangles are not transformed by the current model-view
+ * matrix.
+ *
+ * The region is implemented using only the scissor so unlike pushing
+ * a path it never needs the stencil buffer. If the clipped area
+ * contains more than one rectangle then each primitive will be
+ * drawn once per rectangle so this is best suited to a small number
+ * of rectangles such as the damaged areas of a window.
+ *
+ * The region is intersected with the current clip region. To undo
+ * the effect of this function, call cogl_framebuffer_pop_clip().
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_push_region_clip (CoglFramebuffer *framebuffer,
+                                   const int *rectangles,
+                                   int n_rectangles);
+
 /**
  * cogl_framebuffer_push_rectangle_clip:
  * @framebuffer: A #CoglFramebuffer pointer
@@ -720,6 +751,96 @@ void
 cogl_framebuffer_set_dither_enabled (CoglFramebuffer *framebuffer,
                                      gboolean dither_enabled);
 
+/**
+ * cogl_framebuffer_get_occlusion_culling_enabled:
+ * @framebuffer: a pointer to a #CoglFramebuffer
+ *
+ * Returns whether journaled rectangles of @framebuffer that are
+ * hidden by opaque rectangles drawn later may be skipped. See
+ * cogl_framebuffer_set_occlusion_culling_enabled() for details.
+ *
+ * Return value: %TRUE if occlusion culling has been enabled or %FALSE
+ *   if not.
+ * Since: 1.10
+ * Stability: unstable
+ */
+gboolean
+cogl_framebuffer_get_occlusion_culling_enabled (CoglFramebuffer *framebuffer);
+
+/**
+ * cogl_framebuffer_set_occlusion_culling_enabled:
+ * @framebuffer: a pointer to a #CoglFramebuffer
+ * @enabled: %TRUE to enable occlusion culling or %FALSE to disable
+ *
+ * Allows Cogl to skip rectangles that would be completely covered by
+ * an opaque, screen aligned rectangle drawn after them before they
+ * reach the GPU. This saves the cost of filling pixels that are never
+ * seen, for example when a full window background is painted over
+ * the previous contents, but it costs some extra work on the CPU each
+ * time the rectangles are flushed to find the hidden ones.
+ *
+ * A rectangle is only considered to be an occluder if its pipeline
+ * is opaque. A clipped rectangle only hides rectangles that are
+ * clipped in exactly the same way, and rectangles that use depth
+ * testing are never skipped.
+ *
+ * Occlusion culling is disabled by default.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_set_occlusion_culling_enabled (CoglFramebuffer *framebuffer,
+                                                gboolean enabled);
+
+/**
+ * cogl_framebuffer_get_depth_sorting_enabled:
+ * @framebuffer: a pointer to a #CoglFramebuffer
+ *
+ * Returns whether the journaled rectangles of @framebuffer may be
+ * reordered using the depth buffer. See
+ * cogl_framebuffer_set_depth_sorting_enabled() for details.
+ *
+ * Return value: %TRUE if depth sorting has been enabled or %FALSE if not.
+ * Since: 1.10
+ * Stability: unstable
+ */
+gboolean
+cogl_framebuffer_get_depth_sorting_enabled (CoglFramebuffer *framebuffer);
+
+/**
+ * cogl_framebuffer_set_depth_sorting_enabled:
+ * @framebuffer: a pointer to a #CoglFramebuffer
+ * @enabled: %TRUE to enable depth sorting or %FALSE to disable
+ *
+ * Allows Cogl to use the depth buffer of @framebuffer to reduce
+ * overdraw. Rectangles are normally drawn in the order they were
+ * submitted so that opaque content painted on top of other content
+ * still costs as much as if it were visible. When depth sorting is
+ * enabled each rectangle is given a depth that is nearer than
+ * everything submitted before it. Opaque rectangles are then drawn
+ * front to back with depth writes so that hidden pixels are rejected
+ * by the depth test before they are shaded. Translucent rectangles
+ * are drawn afterwards, in their original order, testing against
+ * the depth buffer but without writing to it. The end result is the
+ * same as drawing in submission order.
+ *
+ * @framebuffer must have a depth buffer, otherwise this has no
+ * effect, and the whole depth buffer must be cleared with
+ * cogl_framebuffer_clear() at the start of each frame. If any of the rectangles waiting to be drawn use a pipeline
+ * that enables depth testing then they are all drawn in order. The
+ * same happens once too many rectangles have been drawn since the
+ * depth buffer was last cleared.
+ *
+ * Depth sorting is disabled by default.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_framebuffer_set_depth_sorting_enabled (CoglFramebuffer *framebuffer,
+                                            gboolean enabled);
+
 /**
  * cogl_framebuffer_get_color_mask:
  * @framebuffer: a pointer to a #CoglFramebuffer
@@ -890,11 +1011,11 @@ cogl_framebuffer_resolve_samples (CoglFramebuffer *framebuffer);
  * architectures it is desirable to defer the resolve step until the
  * end of the frame.
  *
- * Use of this API is recommended if incremental, small updates to
- * a framebuffer are being made because by default Cogl will
- * implicitly resolve all the point samples of the framebuffer which
- * can result in redundant work if only a small number of samples have
- * changed.
+ * Cogl keeps track of the region of the framebuffer that has been
+ * drawn to since the samples were last resolved and only that region
+ * is resolved implicitly when the target color buffer is next used as
+ * a source. This API can be used to resolve a smaller region if it is
+ * known that only part of the framebuffer is going to be read.
  *
  * Because some GPUs implicitly resolve point samples this function
  * only guarantees that at-least the region specified will be resolved
@@ -1208,6 +1329,11 @@ cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
  * framebuffer, and it's not meaningful to try and discard the color buffer of
  * a #CoglOffscreen framebuffer since they are single-buffered.
  *
+ * If @framebuffer is a multisampled #CoglOffscreen whose samples have
+ * to be resolved explicitly then any pending samples are first
+ * resolved into the texture and then the multisampled buffers are
+ * discarded. This is useful at the end of rendering to an offscreen
+ * framebuffer that is going to be completely redrawn next time.
  *
  * Since: 1.8
  * Stability: unstable
@@ -43,7 +43,8 @@ G_BEGIN_DECLS
  * cogl_poll_get_info() and cogl_poll_dispatch() in applications that
  * are already using the GLib main loop. After this is called the
  * #GSource should be attached to the main loop using
- * g_source_attach().
+ * g_source_attach(). The source also wakes the main loop up in time to
+ * draw any frames requested with cogl_onscreen_schedule_frame().
  *
  * Return value: a new #GSource
  *
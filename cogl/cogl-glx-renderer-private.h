@@ -84,6 +84,9 @@ typedef struct _CoglGLXRenderer
   void
   (* glXSelectEvent) (Display *dpy, GLXDrawable drawable,
                       unsigned long mask);
+  void
+  (* glXQueryDrawable) (Display *dpy, GLXDrawable drawable,
+                        int attribute, unsigned int *value);
   GLXFBConfig *
   (* glXGetFBConfigs) (Display *dpy, int screen, int *nelements);
   GLXFBConfig *
@@ -110,7 +110,10 @@ typedef enum
   COGL_PRIVATE_FEATURE_OFFSCREEN_BLIT = 1L<<3,
   COGL_PRIVATE_FEATURE_FOUR_CLIP_PLANES = 1L<<4,
   COGL_PRIVATE_FEATURE_PBOS = 1L<<5,
-  COGL_PRIVATE_FEATURE_VBOS = 1L<<6
+  COGL_PRIVATE_FEATURE_VBOS = 1L<<6,
+  COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS = 1L<<7,
+  COGL_PRIVATE_FEATURE_COPY_IMAGE = 1L<<8,
+  COGL_PRIVATE_FEATURE_OFFSCREEN_MULTISAMPLE_RESOLVE = 1L<<9
 } CoglPrivateFeatureFlags;
 
 /* Sometimes when evaluating pipelines, either during comparisons or
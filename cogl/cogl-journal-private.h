@@ -27,6 +27,7 @@
 #include "cogl.h"
 #include "cogl-handle.h"
 #include "cogl-clip-stack.h"
+#include "cogl-fence-private.h"
 
 #define COGL_JOURNAL_VBO_POOL_SIZE 8
 
@@ -58,6 +59,11 @@ typedef struct _CoglJournal
 
   int fast_read_pixel_count;
 
+  /* Fences that were added while the journal had entries. They are
+     only inserted into the command stream once the journal is
+     flushed */
+  CoglFenceList pending_fences;
+
 } CoglJournal;
 
 /* To improve batching of geometry when submitting vertices to OpenGL we
@@ -71,6 +77,13 @@ typedef struct _CoglJournalEntry
   CoglClipStack           *clip_stack;
   /* Offset into ctx->logged_vertices */
   size_t                   array_offset;
+  /* Determines the depth of the entry when depth sorting or -1 */
+  int                      depth_serial;
+  /* Index of the modelview in ctx->journal_palette when the entries
+   * are transformed on the GPU */
+  int                      palette_index;
+  /* Whether the entry's vertices are uploaded as GLshorts */
+  gboolean                 compact;
   /* XXX: These entries are pretty big now considering the padding in
    * CoglPipelineFlushOptions and CoglMatrix, so we might need to optimize this
    * later. */
@@ -32,6 +32,7 @@
 #include "cogl-journal-private.h"
 #include "cogl-texture-private.h"
 #include "cogl-pipeline-private.h"
+#include "cogl-pipeline-state-private.h"
 #include "cogl-pipeline-opengl-private.h"
 #include "cogl-vertex-buffer-private.h"
 #include "cogl-framebuffer-private.h"
@@ -72,13 +73,24 @@
  * There will be four vertices per quad in the vertex array
  *
  * When we are transforming quads in software we need to also track the z
- * coordinate of transformed vertices.
+ * coordinate of transformed vertices. When depth sorting the vertices
+ * are also projected in software so we need the w coordinate as well.
+ * When the quads are instead transformed on the GPU the third
+ * component holds the index of the quad's modelview in the matrix
+ * palette.
+ *
+ * If all of the positions and texture coordinates of a quad are
+ * integers that fit in a GLshort after transformation (which is
+ * common for pixel aligned 2D content) then the quad is uploaded in a
+ * compact format instead where the position and each texture
+ * coordinate are a pair of GLshorts taking up a single 32bit word.
  *
  * So for a given number of layers this gets the stride in 32bit words:
  */
 #define SW_TRANSFORM      (!(COGL_DEBUG_ENABLED \
                              (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
-#define POS_STRIDE        (SW_TRANSFORM ? 3 : 2) /* number of 32bit words */
+#define POS_STRIDE        (ctx->journal_depth_sorting ? 4 : \
+                           SW_TRANSFORM ? 3 : 2) /* number of 32bit words */
 #define N_POS_COMPONENTS  POS_STRIDE
 #define COLOR_STRIDE      1 /* number of 32bit words */
 #define TEX_STRIDE        2 /* number of 32bit words */
@@ -86,12 +98,33 @@
 #define GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS(N_LAYERS) \
   (POS_STRIDE + COLOR_STRIDE + \
    TEX_STRIDE * (N_LAYERS < MIN_LAYER_PADING ? MIN_LAYER_PADING : N_LAYERS))
+#define COMPACT_POS_STRIDE 1 /* number of 32bit words */
+#define COMPACT_TEX_STRIDE 1 /* number of 32bit words */
+#define GET_JOURNAL_COMPACT_VB_STRIDE_FOR_N_LAYERS(N_LAYERS) \
+  (COMPACT_POS_STRIDE + COLOR_STRIDE + \
+   COMPACT_TEX_STRIDE * (N_LAYERS < MIN_LAYER_PADING ? \
+                         MIN_LAYER_PADING : N_LAYERS))
+#define GET_JOURNAL_VB_STRIDE_FOR_ENTRY(ENTRY) \
+  ((ENTRY)->compact ? \
+   GET_JOURNAL_COMPACT_VB_STRIDE_FOR_N_LAYERS ((ENTRY)->n_layers) : \
+   GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS ((ENTRY)->n_layers))
 
 /* If a batch is longer than this threshold then we'll assume it's not
    worth doing software clipping and it's cheaper to program the GPU
    to do the clip */
 #define COGL_JOURNAL_HARDWARE_CLIP_THRESHOLD 8
 
+/* The number of modelview matrices that can be given to the vertex
+   shader at once when transforming the quads on the GPU */
+#define COGL_JOURNAL_PALETTE_SIZE 16
+/* The journal must have at least this many entries before we consider
+   transforming them on the GPU and each palette must be shared by
+   this many entries on average. Otherwise the cost of using a GLSL
+   vertex program and splitting the batches is likely to be greater
+   than transforming the vertices in software */
+#define COGL_JOURNAL_GPU_TRANSFORM_THRESHOLD 128
+#define COGL_JOURNAL_GPU_TRANSFORM_MIN_ENTRIES_PER_PALETTE 32
+
 typedef struct _CoglJournalFlushState
 {
   CoglJournal         *journal;
@@ -113,6 +146,14 @@ typedef struct _CoglJournalFlushState
   CoglMatrixStack     *projection_stack;
 
   CoglPipeline        *pipeline;
+
+  /* Whether the current vbo offset batch uses compact vertices */
+  gboolean             compact;
+
+  /* Pipelines with a vertex snippet to use the matrix palette, indexed
+     by the original pipeline */
+  GHashTable          *gpu_transform_pipelines;
+  CoglSnippet         *gpu_transform_snippet;
 } CoglJournalFlushState;
 
 typedef void (*CoglJournalBatchCallback) (CoglJournalEntry *start,
@@ -150,6 +191,8 @@ _cogl_journal_new (void)
   journal->entries = g_array_new (FALSE, FALSE, sizeof (CoglJournalEntry));
   journal->vertices = g_array_new (FALSE, FALSE, sizeof (float));
 
+  COGL_TAILQ_INIT (&journal->pending_fences);
+
   return _cogl_journal_object_new (journal);
 }
 
@@ -185,11 +228,13 @@ _cogl_journal_dump_logged_quad (guint8 *data, int n_layers)
 static void
 _cogl_journal_dump_quad_vertices (guint8 *data, int n_layers)
 {
-  gsize stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (n_layers);
+  gsize stride;
   int i;
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
+  stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (n_layers);
+
   g_print ("n_layers = %d; stride = %d; pos stride = %d; color stride = %d; "
            "tex stride = %d; stride in bytes = %d\n",
            n_layers, (int)stride, POS_STRIDE, COLOR_STRIDE,
@@ -220,9 +265,13 @@ _cogl_journal_dump_quad_vertices (guint8 *data, int n_layers)
 static void
 _cogl_journal_dump_quad_batch (guint8 *data, int n_layers, int n_quads)
 {
-  gsize byte_stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (n_layers) * 4;
+  gsize byte_stride;
   int i;
 
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  byte_stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (n_layers) * 4;
+
   g_print ("_cogl_journal_dump_quad_batch: n_layers = %d, n_quads = %d\n",
            n_layers, n_quads);
   for (i = 0; i < n_quads; i++)
@@ -423,6 +472,91 @@ compare_entry_modelviews (CoglJournalEntry *entry0,
     return FALSE;
 }
 
+static gboolean
+compare_entry_palettes (CoglJournalEntry *entry0,
+                        CoglJournalEntry *entry1)
+{
+  return (entry0->palette_index / COGL_JOURNAL_PALETTE_SIZE ==
+          entry1->palette_index / COGL_JOURNAL_PALETTE_SIZE);
+}
+
+static CoglPipeline *
+get_gpu_transform_pipeline (CoglJournalFlushState *state,
+                            CoglPipeline *pipeline)
+{
+  CoglPipeline *derived =
+    g_hash_table_lookup (state->gpu_transform_pipelines, pipeline);
+
+  if (derived == NULL)
+    {
+      if (state->gpu_transform_snippet == NULL)
+        {
+          char *declarations =
+            g_strdup_printf ("uniform mat4 cogl_journal_palette[%i];\n",
+                             COGL_JOURNAL_PALETTE_SIZE);
+
+          state->gpu_transform_snippet =
+            cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX_TRANSFORM,
+                              declarations,
+                              NULL);
+          cogl_snippet_set_replace (state->gpu_transform_snippet,
+                                    "cogl_position_out = "
+                                    "cogl_modelview_projection_matrix * "
+                                    "cogl_journal_palette"
+                                    "[int (cogl_position_in.z)] * "
+                                    "vec4 (cogl_position_in.xy, 0.0, 1.0);\n");
+
+          g_free (declarations);
+        }
+
+      derived = cogl_pipeline_copy (pipeline);
+      cogl_pipeline_add_snippet (derived, state->gpu_transform_snippet);
+
+      g_hash_table_insert (state->gpu_transform_pipelines, pipeline, derived);
+    }
+
+  return derived;
+}
+
+/* At this point we have a run of quads whose modelview matrices are
+ * all in the same matrix palette */
+static void
+_cogl_journal_flush_palette_and_entries (CoglJournalEntry *batch_start,
+                                         int               batch_len,
+                                         void             *data)
+{
+  CoglJournalFlushState *state = data;
+  CoglPipeline *pipeline;
+  int first_matrix;
+  int n_matrices;
+  int location;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+    g_print ("BATCHING:     palette batch len = %d\n", batch_len);
+
+  first_matrix = (batch_start->palette_index / COGL_JOURNAL_PALETTE_SIZE *
+                  COGL_JOURNAL_PALETTE_SIZE);
+  n_matrices = MIN (ctx->journal_palette->len - first_matrix,
+                    COGL_JOURNAL_PALETTE_SIZE);
+
+  pipeline = get_gpu_transform_pipeline (state, batch_start->pipeline);
+  location = cogl_pipeline_get_uniform_location (pipeline,
+                                                 "cogl_journal_palette");
+  cogl_pipeline_set_uniform_matrix (pipeline,
+                                    location,
+                                    4, /* dimensions */
+                                    n_matrices,
+                                    FALSE, /* don't transpose */
+                                    (float *) ctx->journal_palette->data +
+                                    first_matrix * 16);
+
+  state->pipeline = pipeline;
+
+  _cogl_journal_flush_modelview_and_entries (batch_start, batch_len, data);
+}
+
 /* At this point we have a run of quads that we know have compatible
  * pipelines, but they may not all have the same modelview matrix */
 static void
@@ -456,6 +590,16 @@ _cogl_journal_flush_pipeline_and_entries (CoglJournalEntry *batch_start,
                       _cogl_journal_flush_modelview_and_entries,
                       data);
     }
+  /* ...or if the quads are transformed on the GPU then we need to
+   * break up batches according to the matrix palette they use */
+  else if (ctx->journal_gpu_transform)
+    {
+      batch_and_call (batch_start,
+                      batch_len,
+                      compare_entry_palettes,
+                      _cogl_journal_flush_palette_and_entries,
+                      data);
+    }
   else
     _cogl_journal_flush_modelview_and_entries (batch_start, batch_len, data);
 
@@ -537,15 +681,26 @@ _cogl_journal_flush_texcoord_vbo_offsets_and_entries (
 
       /* XXX: it may be worth having some form of static initializer for
        * attributes... */
-      *attribute_entry =
-        cogl_attribute_new (state->attribute_buffer,
-                            name,
-                            state->stride,
-                            state->array_offset +
-                            (POS_STRIDE + COLOR_STRIDE) * 4 +
-                            TEX_STRIDE * 4 * i,
-                            2,
-                            COGL_ATTRIBUTE_TYPE_FLOAT);
+      if (state->compact)
+        *attribute_entry =
+          cogl_attribute_new (state->attribute_buffer,
+                              name,
+                              state->stride,
+                              state->array_offset +
+                              (COMPACT_POS_STRIDE + COLOR_STRIDE) * 4 +
+                              COMPACT_TEX_STRIDE * 4 * i,
+                              2,
+                              COGL_ATTRIBUTE_TYPE_SHORT);
+      else
+        *attribute_entry =
+          cogl_attribute_new (state->attribute_buffer,
+                              name,
+                              state->stride,
+                              state->array_offset +
+                              (POS_STRIDE + COLOR_STRIDE) * 4 +
+                              TEX_STRIDE * 4 * i,
+                              2,
+                              COGL_ATTRIBUTE_TYPE_FLOAT);
 
       if (i >= 8)
         g_free (name);
@@ -602,9 +757,10 @@ _cogl_journal_flush_vbo_offsets_and_entries (CoglJournalEntry *batch_start,
    * (though n_layers may be padded; see definition of
    *  GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS for details)
    */
-  stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (batch_start->n_layers);
+  stride = GET_JOURNAL_VB_STRIDE_FOR_ENTRY (batch_start);
   stride *= sizeof (float);
   state->stride = stride;
+  state->compact = batch_start->compact;
 
   for (i = 0; i < state->attributes->len; i++)
     cogl_object_unref (g_array_index (state->attributes, CoglAttribute *, i));
@@ -612,19 +768,29 @@ _cogl_journal_flush_vbo_offsets_and_entries (CoglJournalEntry *batch_start,
   g_array_set_size (state->attributes, 2);
 
   attribute_entry = &g_array_index (state->attributes, CoglAttribute *, 0);
-  *attribute_entry = cogl_attribute_new (state->attribute_buffer,
-                                         "cogl_position_in",
-                                         stride,
-                                         state->array_offset,
-                                         N_POS_COMPONENTS,
-                                         COGL_ATTRIBUTE_TYPE_FLOAT);
+  if (batch_start->compact)
+    *attribute_entry = cogl_attribute_new (state->attribute_buffer,
+                                           "cogl_position_in",
+                                           stride,
+                                           state->array_offset,
+                                           2,
+                                           COGL_ATTRIBUTE_TYPE_SHORT);
+  else
+    *attribute_entry = cogl_attribute_new (state->attribute_buffer,
+                                           "cogl_position_in",
+                                           stride,
+                                           state->array_offset,
+                                           N_POS_COMPONENTS,
+                                           COGL_ATTRIBUTE_TYPE_FLOAT);
 
   attribute_entry = &g_array_index (state->attributes, CoglAttribute *, 1);
   *attribute_entry =
     cogl_attribute_new (state->attribute_buffer,
                         "cogl_color_in",
                         stride,
-                        state->array_offset + (POS_STRIDE * 4),
+                        state->array_offset +
+                        (batch_start->compact ?
+                         COMPACT_POS_STRIDE : POS_STRIDE) * 4,
                         4,
                         COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE);
 
@@ -639,7 +805,9 @@ _cogl_journal_flush_vbo_offsets_and_entries (CoglJournalEntry *batch_start,
    */
   state->current_vertex = 0;
 
-  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_JOURNAL)))
+  /* The dump code only understands float vertices */
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_JOURNAL)) &&
+      !batch_start->compact)
     {
       guint8 *verts;
 
@@ -675,11 +843,14 @@ _cogl_journal_flush_vbo_offsets_and_entries (CoglJournalEntry *batch_start,
 static gboolean
 compare_entry_strides (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
 {
-  /* Currently the only thing that affects the stride for our vertex arrays
-   * is the number of pipeline layers. We need to update our VBO offsets
-   * whenever the stride changes. */
+  /* The stride for our vertex arrays depends on the number of pipeline
+   * layers and whether the vertices are compact. We need to update our
+   * VBO offsets whenever the stride changes. */
   /* TODO: We should be padding the n_layers == 1 case as if it were
    * n_layers == 2 so we can reduce the need to split batches. */
+  if (entry0->compact != entry1->compact)
+    return FALSE;
+
   if (entry0->n_layers == entry1->n_layers ||
       (entry0->n_layers <= MIN_LAYER_PADING &&
        entry1->n_layers <= MIN_LAYER_PADING))
@@ -731,6 +902,13 @@ _cogl_journal_flush_clip_stacks_and_entries (CoglJournalEntry *batch_start,
       _cogl_context_set_current_modelview (ctx, state->modelview_stack);
     }
 
+  /* Depth sorted quads have also been projected in software */
+  if (ctx->journal_depth_sorting)
+    {
+      _cogl_matrix_stack_push (state->projection_stack);
+      _cogl_matrix_stack_load_identity (state->projection_stack);
+    }
+
   /* Setting up the clip state can sometimes also flush the projection
      matrix so we should flush it again. This will be a no-op if the
      clip code didn't modify the projection */
@@ -742,6 +920,9 @@ _cogl_journal_flush_clip_stacks_and_entries (CoglJournalEntry *batch_start,
                   _cogl_journal_flush_vbo_offsets_and_entries, /* callback */
                   data);
 
+  if (ctx->journal_depth_sorting)
+    _cogl_matrix_stack_pop (state->projection_stack);
+
   _cogl_matrix_stack_pop (state->modelview_stack);
 
   COGL_TIMER_STOP (_cogl_uprof_context,
@@ -1155,20 +1336,223 @@ create_attribute_buffer (CoglJournal *journal,
   return cogl_object_ref (vbo);
 }
 
+/* The number of distinct depths handed out to journal entries between
+ * clears of the depth buffer when depth sorting. This leaves a gap
+ * between each depth even with a 16-bit depth buffer */
+#define COGL_JOURNAL_N_DEPTH_SERIALS 32768
+
+static float
+get_depth_for_serial (int serial)
+{
+  /* Later entries get a smaller depth in normalized device
+   * coordinates so they are nearer to the viewer. The cleared depth
+   * of 1.0 is always further away than any entry */
+  return 1.0f - 2.0f * (serial + 1) / (COGL_JOURNAL_N_DEPTH_SERIALS + 1);
+}
+
+static gboolean
+fits_in_short (float value)
+{
+  return (value >= G_MININT16 && value <= G_MAXINT16 &&
+          value == (int) value);
+}
+
+/* Gets the positions of the four corners of the quad in the order
+ * they are uploaded. These are transformed by the modelview if we are
+ * doing software transforms. This assumes the modelview keeps the
+ * quad in the z=0 plane */
+static void
+get_entry_corners (const CoglJournalEntry *entry,
+                   const float *vin,
+                   float *corners)
+{
+  size_t array_stride =
+    GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+  float x0 = vin[0], y0 = vin[1];
+  float x1 = vin[array_stride], y1 = vin[array_stride + 1];
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  corners[0] = x0;
+  corners[1] = y0;
+  corners[2] = x0;
+  corners[3] = y1;
+  corners[4] = x1;
+  corners[5] = y1;
+  corners[6] = x1;
+  corners[7] = y0;
+
+  if (SW_TRANSFORM)
+    {
+      const CoglMatrix *m = &entry->model_view;
+      int i;
+
+      for (i = 0; i < 4; i++)
+        {
+          float x = corners[i * 2], y = corners[i * 2 + 1];
+
+          corners[i * 2] = m->xx * x + m->xy * y + m->xw;
+          corners[i * 2 + 1] = m->yx * x + m->yy * y + m->yw;
+        }
+    }
+}
+
+/* Checks whether all of the entry's vertices can be stored as GLshorts
+ * without losing any precision */
+static gboolean
+can_use_compact_vertices (const CoglJournalEntry *entry,
+                          const float *vin)
+{
+  size_t array_stride =
+    GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+  float corners[8];
+  int i;
+
+  _COGL_GET_CONTEXT (ctx, FALSE);
+
+  /* The compact position doesn't have a z component */
+  if (SW_TRANSFORM &&
+      (entry->model_view.zx != 0.0f ||
+       entry->model_view.zy != 0.0f ||
+       entry->model_view.zw != 0.0f))
+    return FALSE;
+
+  get_entry_corners (entry, vin, corners);
+
+  for (i = 0; i < 8; i++)
+    if (!fits_in_short (corners[i]))
+      return FALSE;
+
+  for (i = 0; i < entry->n_layers * 2; i++)
+    if (!fits_in_short (vin[2 + i]) ||
+        !fits_in_short (vin[array_stride + 2 + i]))
+      return FALSE;
+
+  return TRUE;
+}
+
+typedef struct
+{
+  CoglJournal *journal;
+  int n_compact;
+} CoglJournalCompactState;
+
+/* At this point we have a batch of entries that will share the same
+ * vbo offsets. They can only be made compact if they all fit */
+static void
+_cogl_journal_choose_compact_vertices (CoglJournalEntry *batch_start,
+                                       int               batch_len,
+                                       void             *data)
+{
+  CoglJournalCompactState *state = data;
+  CoglJournal *journal = state->journal;
+  int i;
+  COGL_STATIC_COUNTER (compact_vertices_counter,
+                       "Journal compact vertices counter",
+                       "Increments for each journal entry that is uploaded "
+                       "with compact vertices",
+                       0 /* no application private data */);
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  for (i = 0; i < batch_len; i++)
+    {
+      const float *vin = &g_array_index (journal->vertices, float,
+                                         batch_start[i].array_offset);
+
+      /* Skip the color */
+      if (!can_use_compact_vertices (batch_start + i, vin + 1))
+        return;
+    }
+
+  for (i = 0; i < batch_len; i++)
+    {
+      CoglJournalEntry *entry = batch_start + i;
+
+      entry->compact = TRUE;
+      state->n_compact++;
+      journal->needed_vbo_len -=
+        (GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (entry->n_layers) -
+         GET_JOURNAL_COMPACT_VB_STRIDE_FOR_N_LAYERS (entry->n_layers)) * 4;
+
+      COGL_COUNTER_INC (_cogl_uprof_context, compact_vertices_counter);
+    }
+}
+
+static void
+_cogl_journal_choose_compact_clip_batch (CoglJournalEntry *batch_start,
+                                         int               batch_len,
+                                         void             *data)
+{
+  batch_and_call (batch_start,
+                  batch_len,
+                  compare_entry_strides,
+                  _cogl_journal_choose_compact_vertices,
+                  data);
+}
+
+static void
+upload_compact_vertices (const CoglJournalEntry *entry,
+                         const float *vin,
+                         float *vout)
+{
+  size_t vb_stride =
+    GET_JOURNAL_COMPACT_VB_STRIDE_FOR_N_LAYERS (entry->n_layers);
+  size_t array_stride =
+    GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+  float corners[8];
+  int i, j;
+
+  get_entry_corners (entry, vin, corners);
+
+  for (i = 0; i < 4; i++)
+    {
+      gint16 *pos = (gint16 *) (vout + vb_stride * i);
+
+      pos[0] = corners[i * 2];
+      pos[1] = corners[i * 2 + 1];
+    }
+
+  for (j = 0; j < entry->n_layers; j++)
+    {
+      const float *tin = vin + 2 + j * 2;
+      float *tout = vout + COMPACT_POS_STRIDE + COLOR_STRIDE + j;
+      gint16 *t;
+
+      t = (gint16 *) (tout + vb_stride * 0);
+      t[0] = tin[0];
+      t[1] = tin[1];
+      t = (gint16 *) (tout + vb_stride * 1);
+      t[0] = tin[0];
+      t[1] = tin[array_stride + 1];
+      t = (gint16 *) (tout + vb_stride * 2);
+      t[0] = tin[array_stride];
+      t[1] = tin[array_stride + 1];
+      t = (gint16 *) (tout + vb_stride * 3);
+      t[0] = tin[array_stride];
+      t[1] = tin[1];
+    }
+}
+
 static CoglAttributeBuffer *
 upload_vertices (CoglJournal            *journal,
                  const CoglJournalEntry *entries,
                  int                     n_entries,
                  size_t                  needed_vbo_len,
-                 GArray                 *vertices)
+                 GArray                 *vertices,
+                 const CoglMatrix       *projection)
 {
   CoglAttributeBuffer *attribute_buffer;
   CoglBuffer *buffer;
   const float *vin;
   float *vout;
+  const CoglMatrix *last_model_view = NULL;
+  CoglMatrix modelview_projection;
   int entry_num;
   int i;
 
+  _COGL_GET_CONTEXT (ctx, NULL);
+
   g_assert (needed_vbo_len);
 
   attribute_buffer = create_attribute_buffer (journal, needed_vbo_len * 4);
@@ -1176,21 +1560,32 @@ upload_vertices (CoglJournal            *journal,
   cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_STATIC);
 
   vout = _cogl_buffer_map_for_fill_or_fallback (buffer);
-  vin = &g_array_index (vertices, float, 0);
 
   /* Expand the number of vertices from 2 to 4 while uploading */
   for (entry_num = 0; entry_num < n_entries; entry_num++)
     {
       const CoglJournalEntry *entry = entries + entry_num;
-      size_t vb_stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      size_t vb_stride = GET_JOURNAL_VB_STRIDE_FOR_ENTRY (entry);
       size_t array_stride =
         GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      size_t pos_stride = entry->compact ? COMPACT_POS_STRIDE : POS_STRIDE;
+
+      /* Entries may have been culled so the logged vertices aren't
+         necessarily contiguous */
+      vin = &g_array_index (vertices, float, entry->array_offset);
 
       /* Copy the color to all four of the vertices */
       for (i = 0; i < 4; i++)
-        memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
+        memcpy (vout + vb_stride * i + pos_stride, vin, 4);
       vin++;
 
+      if (entry->compact)
+        {
+          upload_compact_vertices (entry, vin, vout);
+          vout += vb_stride * 4;
+          continue;
+        }
+
       if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
         {
           vout[vb_stride * 0] = vin[0];
@@ -1215,14 +1610,56 @@ upload_vertices (CoglJournal            *journal,
           v[6] = vin[array_stride];
           v[7] = vin[1];
 
-          cogl_matrix_transform_points (&entry->model_view,
-                                        2, /* n_components */
-                                        sizeof (float) * 2, /* stride_in */
-                                        v, /* points_in */
-                                        /* strideout */
-                                        vb_stride * sizeof (float),
-                                        vout, /* points_out */
-                                        4 /* n_points */);
+          if (ctx->journal_gpu_transform)
+            {
+              float slot = entry->palette_index % COGL_JOURNAL_PALETTE_SIZE;
+
+              for (i = 0; i < 4; i++)
+                {
+                  vout[vb_stride * i] = v[i * 2];
+                  vout[vb_stride * i + 1] = v[i * 2 + 1];
+                  vout[vb_stride * i + 2] = slot;
+                }
+            }
+          else if (projection)
+            {
+              float depth = get_depth_for_serial (entry->depth_serial);
+
+              if (last_model_view == NULL ||
+                  memcmp (last_model_view, &entry->model_view,
+                          sizeof (float) * 16))
+                {
+                  cogl_matrix_multiply (&modelview_projection,
+                                        projection,
+                                        &entry->model_view);
+                  last_model_view = &entry->model_view;
+                }
+
+              cogl_matrix_project_points (&modelview_projection,
+                                          2, /* n_components */
+                                          sizeof (float) * 2, /* stride_in */
+                                          v, /* points_in */
+                                          /* strideout */
+                                          vb_stride * sizeof (float),
+                                          vout, /* points_out */
+                                          4 /* n_points */);
+
+              /* Replace the z coordinate so that the quad is flat at
+                 the depth of its serial. The w coordinate is left
+                 alone so the texture coordinates are still
+                 interpolated with the right perspective */
+              for (i = 0; i < 4; i++)
+                vout[vb_stride * i + 2] = depth * vout[vb_stride * i + 3];
+            }
+          else
+            cogl_matrix_transform_points (&entry->model_view,
+                                          2, /* n_components */
+                                          sizeof (float) * 2, /* stride_in */
+                                          v, /* points_in */
+                                          /* strideout */
+                                          vb_stride * sizeof (float),
+                                          vout, /* points_out */
+                                          4 /* n_points */);
         }
 
       for (i = 0; i < entry->n_layers; i++)
@@ -1240,7 +1677,6 @@ upload_vertices (CoglJournal            *journal,
           tout[vb_stride * 3 + 1 + i * 2] = tin[i * 2 + 1];
         }
 
-      vin += array_stride * 2;
       vout += vb_stride * 4;
     }
 
@@ -1267,6 +1703,16 @@ _cogl_journal_discard (CoglJournal *journal)
   journal->needed_vbo_len = 0;
   journal->fast_read_pixel_count = 0;
 
+  /* Any fences waiting for the journal can now follow the commands
+     that were just flushed */
+  while (!COGL_TAILQ_EMPTY (&journal->pending_fences))
+    {
+      CoglFence *fence = COGL_TAILQ_FIRST (&journal->pending_fences);
+
+      COGL_TAILQ_REMOVE (&journal->pending_fences, fence, list);
+      _cogl_fence_submit (fence);
+    }
+
   /* The journal only holds a reference to the framebuffer while the
      journal is not empty */
   if (journal->framebuffer)
@@ -1344,72 +1790,787 @@ _cogl_journal_all_entries_within_bounds (CoglJournal *journal,
   return TRUE;
 }
 
-/* XXX NB: When _cogl_journal_flush() returns all state relating
- * to pipelines, all glEnable flags and current matrix state
- * is undefined.
- */
-void
-_cogl_journal_flush (CoglJournal *journal,
-                     CoglFramebuffer *framebuffer)
+/* Transforms the corners of an entry into window coordinates. This
+ * returns FALSE if any of the corners are behind the viewer in which
+ * case the resulting polygon is meaningless */
+static gboolean
+transform_entry_to_screen_polygon (const CoglJournalEntry *entry,
+                                   const float *vertices,
+                                   const CoglMatrix *projection,
+                                   const float *viewport,
+                                   float *poly)
 {
-  CoglJournalFlushState state;
-  int                   i;
-  CoglMatrixStack      *modelview_stack;
-  COGL_STATIC_TIMER (flush_timer,
-                     "Mainloop", /* parent */
-                     "Journal Flush",
-                     "The time spent flushing the Cogl journal",
-                     0 /* no application private data */);
+  size_t array_stride =
+    GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+  gboolean in_front = TRUE;
+  int i;
 
-  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+  poly[0] = vertices[0];
+  poly[1] = vertices[1];
+  poly[2] = 0;
+  poly[3] = 1;
 
-  if (journal->entries->len == 0)
-    return;
+  poly[4] = vertices[0];
+  poly[5] = vertices[array_stride + 1];
+  poly[6] = 0;
+  poly[7] = 1;
 
-  /* Something has gone wrong if we're using a different framebuffer
-     to flush than the one that was current when the entries were
-     added */
-  _COGL_RETURN_IF_FAIL (framebuffer == journal->framebuffer);
+  poly[8] = vertices[array_stride];
+  poly[9] = vertices[array_stride + 1];
+  poly[10] = 0;
+  poly[11] = 1;
 
-  /* The entries in this journal may depend on images in other
-   * framebuffers which may require that we flush the journals
-   * associated with those framebuffers before we can flush
-   * this journal... */
-  _cogl_framebuffer_flush_dependency_journals (framebuffer);
+  poly[12] = vertices[array_stride];
+  poly[13] = vertices[1];
+  poly[14] = 0;
+  poly[15] = 1;
 
-  /* Note: we start the timer after flushing dependency journals so
-   * that the timer isn't started recursively. */
-  COGL_TIMER_START (_cogl_uprof_context, flush_timer);
+  /* TODO: perhaps split the following out into a more generalized
+   * _cogl_transform_points utility...
+   */
 
-  state.framebuffer = framebuffer;
-  cogl_push_framebuffer (framebuffer);
+  cogl_matrix_transform_points (&entry->model_view,
+                                2, /* n_components */
+                                sizeof (float) * 4, /* stride_in */
+                                poly, /* points_in */
+                                /* strideout */
+                                sizeof (float) * 4,
+                                poly, /* points_out */
+                                4 /* n_points */);
 
-  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
-    g_print ("BATCHING: journal len = %d\n", journal->entries->len);
+  cogl_matrix_project_points (projection,
+                              3, /* n_components */
+                              sizeof (float) * 4, /* stride_in */
+                              poly, /* points_in */
+                              /* strideout */
+                              sizeof (float) * 4,
+                              poly, /* points_out */
+                              4 /* n_points */);
 
-  /* NB: the journal deals with flushing the modelview stack and clip
-     state manually */
-  _cogl_framebuffer_flush_state (framebuffer,
-                                 framebuffer,
-                                 COGL_FRAMEBUFFER_STATE_ALL &
-                                 ~(COGL_FRAMEBUFFER_STATE_MODELVIEW |
-                                   COGL_FRAMEBUFFER_STATE_CLIP));
+/* Scale from OpenGL normalized device coordinates (ranging from -1 to 1)
+ * to Cogl window/framebuffer coordinates (ranging from 0 to buffer-size) with
+ * (0,0) being top left. */
+#define VIEWPORT_TRANSFORM_X(x, vp_origin_x, vp_width) \
+    (  ( ((x) + 1.0) * ((vp_width) / 2.0) ) + (vp_origin_x)  )
+/* Note: for Y we first flip all coordinates around the X axis while in
+ * normalized device coodinates */
+#define VIEWPORT_TRANSFORM_Y(y, vp_origin_y, vp_height) \
+    (  ( ((-(y)) + 1.0) * ((vp_height) / 2.0) ) + (vp_origin_y)  )
 
-  state.journal = journal;
+  /* Scale from normalized device coordinates (in range [-1,1]) to
+   * window coordinates ranging [0,window-size] ... */
+  for (i = 0; i < 4; i++)
+    {
+      float w = poly[4 * i + 3];
 
-  state.attributes = ctx->journal_flush_attributes_array;
+      if (w <= 0)
+        in_front = FALSE;
 
-  modelview_stack = _cogl_framebuffer_get_modelview_stack (framebuffer);
-  state.modelview_stack = modelview_stack;
-  state.projection_stack = _cogl_framebuffer_get_projection_stack (framebuffer);
+      /* Perform perspective division */
+      poly[4 * i] /= w;
+      poly[4 * i + 1] /= w;
 
-  if (G_UNLIKELY ((COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_CLIP)) == 0))
-    {
-      /* We do an initial walk of the journal to analyse the clip stack
-         batches to see if we can do software clipping. We do this as a
-         separate walk of the journal because we can modify entries and
-         this may end up joining together clip stack batches in the next
-         iteration. */
+      /* Apply viewport transform */
+      poly[4 * i] = VIEWPORT_TRANSFORM_X (poly[4 * i],
+                                          viewport[0], viewport[2]);
+      poly[4 * i + 1] = VIEWPORT_TRANSFORM_Y (poly[4 * i + 1],
+                                              viewport[1], viewport[3]);
+    }
+
+#undef VIEWPORT_TRANSFORM_X
+#undef VIEWPORT_TRANSFORM_Y
+
+  return in_front;
+}
+
+static void
+entry_to_screen_polygon (CoglFramebuffer *framebuffer,
+                         const CoglJournalEntry *entry,
+                         float *vertices,
+                         float *poly)
+{
+  CoglMatrixStack *projection_stack;
+  CoglMatrix projection;
+  float viewport[4];
+
+  projection_stack =
+    _cogl_framebuffer_get_projection_stack (framebuffer);
+  _cogl_matrix_stack_get (projection_stack, &projection);
+
+  cogl_framebuffer_get_viewport4fv (framebuffer, viewport);
+
+  transform_entry_to_screen_polygon (entry, vertices,
+                                     &projection, viewport,
+                                     poly);
+}
+
+/* The number of opaque rectangles we remember while looking for
+ * entries that they hide. Typically there are only a few large
+ * occluders such as backgrounds and panels so there's no point in
+ * tracking lots of them */
+#define COGL_JOURNAL_MAX_OCCLUDERS 8
+
+/* Fudge factor to account for the difference between our transform
+ * and the GPU's when deciding which pixels a rectangle touches */
+#define COGL_JOURNAL_OCCLUSION_EPSILON 0.01f
+
+typedef struct
+{
+  /* Inclusive range of pixels */
+  int x0, y0, x1, y1;
+  CoglClipStack *clip_stack;
+} CoglJournalOccluder;
+
+/* Works out the inclusive range of pixels that a rectangle in window
+ * coordinates might touch or, if @inner is TRUE, the range of pixels
+ * that it is guaranteed to cover. Without multisampling a pixel is
+ * rasterized if its center lies within the rectangle but with
+ * multisampling any part of the pixel may be sampled */
+static void
+get_rectangle_pixel_range (const float *bounds,
+                           gboolean multisample,
+                           gboolean inner,
+                           int *range)
+{
+  float offset = multisample ? 0.0f : 0.5f;
+  float epsilon = (inner ?
+                   COGL_JOURNAL_OCCLUSION_EPSILON :
+                   -COGL_JOURNAL_OCCLUSION_EPSILON);
+
+  if (multisample && inner)
+    {
+      range[0] = ceilf (bounds[0] + epsilon);
+      range[1] = ceilf (bounds[1] + epsilon);
+      range[2] = floorf (bounds[2] - epsilon) - 1;
+      range[3] = floorf (bounds[3] - epsilon) - 1;
+    }
+  else if (multisample)
+    {
+      range[0] = floorf (bounds[0] + epsilon);
+      range[1] = floorf (bounds[1] + epsilon);
+      range[2] = ceilf (bounds[2] - epsilon) - 1;
+      range[3] = ceilf (bounds[3] - epsilon) - 1;
+    }
+  else
+    {
+      range[0] = ceilf (bounds[0] - offset + epsilon);
+      range[1] = ceilf (bounds[1] - offset + epsilon);
+      range[2] = floorf (bounds[2] - offset - epsilon);
+      range[3] = floorf (bounds[3] - offset - epsilon);
+    }
+}
+
+static gboolean
+entry_is_occluded (const int *range,
+                   CoglClipStack *clip_stack,
+                   const CoglJournalOccluder *occluders,
+                   int n_occluders)
+{
+  int i;
+
+  for (i = 0; i < n_occluders; i++)
+    {
+      const CoglJournalOccluder *occluder = occluders + i;
+
+      /* A clipped occluder only hides entries that are clipped in
+       * exactly the same way */
+      if (occluder->clip_stack && occluder->clip_stack != clip_stack)
+        continue;
+
+      if (range[0] >= occluder->x0 && range[2] <= occluder->x1 &&
+          range[1] >= occluder->y0 && range[3] <= occluder->y1)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+add_occluder (CoglJournalOccluder *occluders,
+              int *n_occluders,
+              const int *range,
+              CoglClipStack *clip_stack)
+{
+  CoglJournalOccluder *occluder;
+  int area = (range[2] - range[0] + 1) * (range[3] - range[1] + 1);
+
+  if (*n_occluders < COGL_JOURNAL_MAX_OCCLUDERS)
+    occluder = occluders + (*n_occluders)++;
+  else
+    {
+      int smallest_area = G_MAXINT;
+      int i;
+
+      /* Replace the smallest occluder if the new one is bigger */
+      occluder = NULL;
+      for (i = 0; i < COGL_JOURNAL_MAX_OCCLUDERS; i++)
+        {
+          int occluder_area = ((occluders[i].x1 - occluders[i].x0 + 1) *
+                               (occluders[i].y1 - occluders[i].y0 + 1));
+          if (occluder_area < smallest_area)
+            {
+              smallest_area = occluder_area;
+              occluder = occluders + i;
+            }
+        }
+
+      if (smallest_area >= area)
+        return;
+    }
+
+  occluder->x0 = range[0];
+  occluder->y0 = range[1];
+  occluder->x1 = range[2];
+  occluder->y1 = range[3];
+  occluder->clip_stack = clip_stack;
+}
+
+static gboolean
+pipeline_has_depth_test (CoglPipeline *pipeline)
+{
+  CoglDepthState depth_state;
+
+  cogl_pipeline_get_depth_state (pipeline, &depth_state);
+
+  return cogl_depth_state_get_test_enabled (&depth_state);
+}
+
+/* Walks the journal from front to back and drops every entry that is
+ * completely hidden by an opaque, screen aligned rectangle drawn
+ * after it. This only removes entries; their logged vertices are left
+ * in place and are skipped when uploading */
+static void
+_cogl_journal_cull_occluded_entries (CoglJournal *journal,
+                                     CoglFramebuffer *framebuffer)
+{
+  CoglJournalOccluder occluders[COGL_JOURNAL_MAX_OCCLUDERS];
+  int n_occluders = 0;
+  CoglMatrixStack *projection_stack;
+  CoglMatrix projection;
+  float viewport[4];
+  gboolean multisample = framebuffer->samples_per_pixel > 0;
+  CoglPipeline *last_pipeline = NULL;
+  gboolean last_pipeline_is_occluder = FALSE;
+  gboolean last_pipeline_has_depth_test = FALSE;
+  guint8 *culled = NULL;
+  int n_culled = 0;
+  int n_entries = journal->entries->len;
+  int i, j;
+  COGL_STATIC_TIMER (time_cull_occluded,
+                     "Journal Flush", /* parent */
+                     "flush: cull occluded",
+                     "Time spent culling hidden journal entries",
+                     0 /* no application private data */);
+  COGL_STATIC_COUNTER (occlusion_culled_counter,
+                       "Journal occlusion culled counter",
+                       "Increments for each journal entry that is "
+                       "hidden by a later opaque rectangle",
+                       0 /* no application private data */);
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  COGL_TIMER_START (_cogl_uprof_context, time_cull_occluded);
+
+  projection_stack = _cogl_framebuffer_get_projection_stack (framebuffer);
+  _cogl_matrix_stack_get (projection_stack, &projection);
+  cogl_framebuffer_get_viewport4fv (framebuffer, viewport);
+
+  for (i = n_entries - 1; i >= 0; i--)
+    {
+      CoglJournalEntry *entry =
+        &g_array_index (journal->entries, CoglJournalEntry, i);
+      float *vertices = &g_array_index (journal->vertices, float,
+                                        entry->array_offset + 1);
+      float poly[16];
+      float bounds[4];
+      int range[4];
+      gboolean is_rectangle;
+
+      if (entry->pipeline != last_pipeline)
+        {
+          last_pipeline = entry->pipeline;
+          last_pipeline_is_occluder =
+            _cogl_pipeline_is_opaque_occluder (last_pipeline);
+          last_pipeline_has_depth_test =
+            pipeline_has_depth_test (last_pipeline);
+        }
+
+      /* Entries that test against the depth buffer also write to it
+       * so they can affect later drawing even when they are hidden */
+      if (last_pipeline_has_depth_test)
+        continue;
+
+      if (!transform_entry_to_screen_polygon (entry, vertices,
+                                              &projection, viewport,
+                                              poly))
+        continue;
+
+      bounds[0] = MIN (MIN (poly[0], poly[4]), MIN (poly[8], poly[12]));
+      bounds[1] = MIN (MIN (poly[1], poly[5]), MIN (poly[9], poly[13]));
+      bounds[2] = MAX (MAX (poly[0], poly[4]), MAX (poly[8], poly[12]));
+      bounds[3] = MAX (MAX (poly[1], poly[5]), MAX (poly[9], poly[13]));
+
+      get_rectangle_pixel_range (bounds, multisample, FALSE, range);
+
+      if (entry_is_occluded (range, entry->clip_stack,
+                             occluders, n_occluders))
+        {
+          if (culled == NULL)
+            culled = g_malloc0 (n_entries);
+          culled[i] = TRUE;
+          n_culled++;
+          COGL_COUNTER_INC (_cogl_uprof_context, occlusion_culled_counter);
+          continue;
+        }
+
+      if (!last_pipeline_is_occluder)
+        continue;
+
+      /* The polygon only fills its bounding box if it is still a
+       * screen aligned rectangle */
+      is_rectangle = ((poly[0] == poly[4] && poly[8] == poly[12] &&
+                       poly[1] == poly[13] && poly[5] == poly[9]) ||
+                      (poly[1] == poly[5] && poly[9] == poly[13] &&
+                       poly[0] == poly[12] && poly[4] == poly[8]));
+      if (!is_rectangle)
+        continue;
+
+      get_rectangle_pixel_range (bounds, multisample, TRUE, range);
+      if (range[0] > range[2] || range[1] > range[3])
+        continue;
+
+      add_occluder (occluders, &n_occluders, range, entry->clip_stack);
+    }
+
+  if (culled)
+    {
+      for (i = 0, j = 0; i < n_entries; i++)
+        {
+          CoglJournalEntry *entry =
+            &g_array_index (journal->entries, CoglJournalEntry, i);
+
+          if (culled[i])
+            {
+              journal->needed_vbo_len -=
+                GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (entry->n_layers) * 4;
+              _cogl_pipeline_journal_unref (entry->pipeline);
+              _cogl_clip_stack_unref (entry->clip_stack);
+            }
+          else
+            {
+              if (i != j)
+                g_array_index (journal->entries, CoglJournalEntry, j) = *entry;
+              j++;
+            }
+        }
+
+      g_array_set_size (journal->entries, j);
+
+      g_free (culled);
+    }
+
+  COGL_NOTE (CULLING, "Occlusion culled %i of %i journal entries",
+             n_culled, n_entries);
+
+  COGL_TIMER_STOP (_cogl_uprof_context, time_cull_occluded);
+}
+
+/* Checks whether all of the entries in the journal can be reordered
+ * using the depth buffer. The vertices of depth sorted entries are
+ * projected in software and their z coordinate is replaced so the
+ * entries must not rely on being clipped to the near or far planes */
+static gboolean
+_cogl_journal_can_depth_sort (CoglJournal *journal,
+                              const CoglMatrix *projection)
+{
+  const CoglMatrix *last_model_view = NULL;
+  CoglMatrix modelview_projection;
+  CoglPipeline *last_pipeline = NULL;
+  int i, j;
+
+  for (i = 0; i < journal->entries->len; i++)
+    {
+      CoglJournalEntry *entry =
+        &g_array_index (journal->entries, CoglJournalEntry, i);
+      size_t array_stride =
+        GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      float *vertices = &g_array_index (journal->vertices, float,
+                                        entry->array_offset + 1);
+      float points[16];
+
+      if (entry->depth_serial < 0 ||
+          entry->depth_serial >= COGL_JOURNAL_N_DEPTH_SERIALS)
+        return FALSE;
+
+      if (entry->pipeline != last_pipeline)
+        {
+          last_pipeline = entry->pipeline;
+          if (pipeline_has_depth_test (last_pipeline))
+            return FALSE;
+        }
+
+      if (last_model_view == NULL ||
+          memcmp (last_model_view, &entry->model_view, sizeof (float) * 16))
+        {
+          cogl_matrix_multiply (&modelview_projection,
+                                projection,
+                                &entry->model_view);
+          last_model_view = &entry->model_view;
+        }
+
+      points[0] = vertices[0];
+      points[1] = vertices[1];
+      points[2] = vertices[0];
+      points[3] = vertices[array_stride + 1];
+      points[4] = vertices[array_stride];
+      points[5] = vertices[array_stride + 1];
+      points[6] = vertices[array_stride];
+      points[7] = vertices[1];
+
+      cogl_matrix_project_points (&modelview_projection,
+                                  2, /* n_components */
+                                  sizeof (float) * 2, /* stride_in */
+                                  points, /* points_in */
+                                  sizeof (float) * 4, /* stride_out */
+                                  points, /* points_out */
+                                  4 /* n_points */);
+
+      for (j = 0; j < 4; j++)
+        {
+          float z = points[j * 4 + 2];
+          float w = points[j * 4 + 3];
+
+          if (w <= 0 || z < -w || z > w)
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+/* The pipelines used to draw depth sorted entries are cached as weak
+ * copies on the pipeline they were derived from. They are indexed by
+ * whether the entries are opaque. The struct is refcounted because
+ * the weak copies can outlive the source pipeline's user data */
+typedef struct
+{
+  int ref_count;
+  CoglPipeline *weak_pipelines[2];
+} CoglJournalDepthSortedPipelines;
+
+static CoglUserDataKey depth_sorted_pipelines_key;
+static CoglUserDataKey depth_sorted_pipeline_copy_key;
+
+static void
+unref_depth_sorted_pipelines (CoglJournalDepthSortedPipelines *cache)
+{
+  if (--cache->ref_count < 1)
+    g_slice_free (CoglJournalDepthSortedPipelines, cache);
+}
+
+static void
+weak_depth_sorted_pipeline_destroyed_cb (CoglPipeline *pipeline,
+                                         void *user_data)
+{
+  CoglJournalDepthSortedPipelines *cache = user_data;
+  int i;
+
+  /* The source pipeline has been modified or destroyed so the copy
+   * is no longer valid */
+  for (i = 0; i < G_N_ELEMENTS (cache->weak_pipelines); i++)
+    if (cache->weak_pipelines[i] == pipeline)
+      {
+        cache->weak_pipelines[i] = NULL;
+        cogl_object_unref (pipeline);
+      }
+}
+
+static void
+destroy_depth_sorted_pipelines_cb (void *user_data)
+{
+  /* The references on the weak copies are dropped by
+   * weak_depth_sorted_pipeline_destroyed_cb which is always called
+   * when the source pipeline is destroyed */
+  unref_depth_sorted_pipelines (user_data);
+}
+
+static CoglPipeline *
+get_depth_sorted_pipeline (CoglPipeline *pipeline,
+                           gboolean opaque)
+{
+  CoglJournalDepthSortedPipelines *cache;
+  CoglPipeline *derived;
+  CoglDepthState depth_state;
+
+  cache = cogl_object_get_user_data (COGL_OBJECT (pipeline),
+                                     &depth_sorted_pipelines_key);
+
+  if (cache == NULL)
+    {
+      cache = g_slice_new0 (CoglJournalDepthSortedPipelines);
+      cache->ref_count = 1;
+      cogl_object_set_user_data (COGL_OBJECT (pipeline),
+                                 &depth_sorted_pipelines_key,
+                                 cache,
+                                 destroy_depth_sorted_pipelines_cb);
+    }
+  else if (cache->weak_pipelines[opaque])
+    return cache->weak_pipelines[opaque];
+
+  cogl_depth_state_init (&depth_state);
+  cogl_depth_state_set_test_enabled (&depth_state, TRUE);
+  cogl_depth_state_set_test_function (&depth_state,
+                                      COGL_DEPTH_TEST_FUNCTION_LESS);
+  /* Translucent entries mustn't hide anything drawn after them */
+  cogl_depth_state_set_write_enabled (&depth_state, opaque);
+
+  derived =
+    _cogl_pipeline_weak_copy (pipeline,
+                              weak_depth_sorted_pipeline_destroyed_cb,
+                              cache);
+  cogl_pipeline_set_depth_state (derived, &depth_state, NULL);
+
+  /* The copy keeps the struct alive until it is freed because its
+   * destroy callback may still be called after the source pipeline
+   * has dropped its reference */
+  cache->ref_count++;
+  cogl_object_set_user_data (COGL_OBJECT (derived),
+                             &depth_sorted_pipeline_copy_key,
+                             cache,
+                             (CoglUserDataDestroyCallback)
+                             unref_depth_sorted_pipelines);
+
+  cache->weak_pipelines[opaque] = derived;
+
+  return derived;
+}
+
+/* Moves the opaque entries to the start of the journal in reverse
+ * order so that they are drawn front to back. The translucent entries
+ * are drawn afterwards in their original order. Each entry is given a
+ * pipeline that tests against the depth buffer so that the result is
+ * the same as drawing in the original order.
+ *
+ * The depth sorted pipelines are weak copies so the entries' original
+ * pipelines must stay alive until the journal has been drawn. They
+ * are returned in an array and the caller drops their journal
+ * references after the flush */
+static GPtrArray *
+_cogl_journal_depth_sort_entries (CoglJournal *journal)
+{
+  int n_entries = journal->entries->len;
+  CoglJournalEntry *entries = (CoglJournalEntry *) journal->entries->data;
+  CoglJournalEntry *sorted;
+  GPtrArray *sources;
+  CoglPipeline *last_pipeline = NULL;
+  gboolean last_pipeline_is_opaque = FALSE;
+  guint8 *opaque;
+  int n_opaque = 0;
+  int next_opaque, next_translucent;
+  int i;
+  COGL_STATIC_COUNTER (depth_sorted_counter,
+                       "Journal depth sorted counter",
+                       "Increments for each opaque journal entry that is "
+                       "drawn front to back",
+                       0 /* no application private data */);
+
+  opaque = g_malloc (n_entries);
+
+  for (i = 0; i < n_entries; i++)
+    {
+      if (entries[i].pipeline != last_pipeline)
+        {
+          last_pipeline = entries[i].pipeline;
+          last_pipeline_is_opaque =
+            _cogl_pipeline_is_opaque_occluder (last_pipeline);
+        }
+
+      opaque[i] = last_pipeline_is_opaque;
+      if (last_pipeline_is_opaque)
+        n_opaque++;
+    }
+
+  sources = g_ptr_array_sized_new (n_entries);
+
+  sorted = g_new (CoglJournalEntry, n_entries);
+  next_opaque = 0;
+  next_translucent = n_entries - 1;
+
+  /* Walking backwards puts the opaque entries front to back and the
+     translucent entries back to front starting from the end */
+  for (i = n_entries - 1; i >= 0; i--)
+    {
+      CoglJournalEntry *entry = sorted + (opaque[i] ?
+                                          next_opaque++ :
+                                          next_translucent--);
+      CoglPipeline *pipeline;
+
+      *entry = entries[i];
+
+      pipeline = get_depth_sorted_pipeline (entry->pipeline, opaque[i]);
+      _cogl_pipeline_journal_ref (pipeline);
+      /* The entry's reference on its original pipeline is handed to
+       * the caller */
+      g_ptr_array_add (sources, entry->pipeline);
+      entry->pipeline = pipeline;
+
+      if (opaque[i])
+        COGL_COUNTER_INC (_cogl_uprof_context, depth_sorted_counter);
+    }
+
+  memcpy (entries, sorted, sizeof (CoglJournalEntry) * n_entries);
+
+  g_free (sorted);
+  g_free (opaque);
+
+  COGL_NOTE (CULLING, "Depth sorted %i opaque and %i translucent journal "
+             "entries", n_opaque, n_entries - n_opaque);
+
+  return sources;
+}
+
+/* Gives each entry an index into a palette of modelview matrices so
+ * that the entries can be transformed in the vertex shader. Returns
+ * FALSE if it isn't worth doing so */
+static gboolean
+_cogl_journal_build_palette (CoglJournal *journal)
+{
+  int n_entries = journal->entries->len;
+  CoglJournalEntry *entries = (CoglJournalEntry *) journal->entries->data;
+  CoglPipeline *last_pipeline = NULL;
+  GArray *palette;
+  int first_matrix = 0;
+  int n_palettes;
+  int i;
+
+  _COGL_GET_CONTEXT (ctx, FALSE);
+
+  if (n_entries < COGL_JOURNAL_GPU_TRANSFORM_THRESHOLD ||
+      !cogl_has_feature (ctx, COGL_FEATURE_ID_GLSL))
+    return FALSE;
+
+  if (ctx->journal_palette == NULL)
+    ctx->journal_palette = g_array_new (FALSE, FALSE, sizeof (float) * 16);
+  palette = ctx->journal_palette;
+  g_array_set_size (palette, 0);
+
+  for (i = 0; i < n_entries; i++)
+    {
+      CoglJournalEntry *entry = entries + i;
+      const float *matrix = cogl_matrix_get_array (&entry->model_view);
+      int matrix_num;
+
+      /* The transform replaces the vertex transform hook so we can't
+         use it if the pipeline wants to do its own */
+      if (entry->pipeline != last_pipeline)
+        {
+          last_pipeline = entry->pipeline;
+
+          if (_cogl_pipeline_has_vertex_snippets (last_pipeline) ||
+              cogl_pipeline_get_user_program (last_pipeline) !=
+              COGL_INVALID_HANDLE)
+            return FALSE;
+        }
+
+      /* Neighbouring entries are likely to have the same modelview so
+         we search the current palette backwards */
+      for (matrix_num = (int) palette->len - 1;
+           matrix_num >= first_matrix;
+           matrix_num--)
+        if (!memcmp ((float *) palette->data + matrix_num * 16,
+                     matrix,
+                     sizeof (float) * 16))
+          break;
+
+      if (matrix_num < first_matrix)
+        {
+          if (palette->len - first_matrix >= COGL_JOURNAL_PALETTE_SIZE)
+            first_matrix = palette->len;
+
+          matrix_num = palette->len;
+          g_array_append_vals (palette, matrix, 1);
+        }
+
+      entry->palette_index = matrix_num;
+    }
+
+  n_palettes = ((palette->len + COGL_JOURNAL_PALETTE_SIZE - 1) /
+                COGL_JOURNAL_PALETTE_SIZE);
+
+  return (n_entries / n_palettes >=
+          COGL_JOURNAL_GPU_TRANSFORM_MIN_ENTRIES_PER_PALETTE);
+}
+
+/* XXX NB: When _cogl_journal_flush() returns all state relating
+ * to pipelines, all glEnable flags and current matrix state
+ * is undefined.
+ */
+void
+_cogl_journal_flush (CoglJournal *journal,
+                     CoglFramebuffer *framebuffer)
+{
+  CoglJournalFlushState state;
+  int                   i;
+  CoglMatrixStack      *modelview_stack;
+  CoglMatrix            projection;
+  const CoglMatrix     *depth_sort_projection = NULL;
+  GPtrArray            *depth_sorted_sources = NULL;
+  CoglJournalCompactState compact_state;
+  COGL_STATIC_TIMER (flush_timer,
+                     "Mainloop", /* parent */
+                     "Journal Flush",
+                     "The time spent flushing the Cogl journal",
+                     0 /* no application private data */);
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (journal->entries->len == 0)
+    return;
+
+  /* Something has gone wrong if we're using a different framebuffer
+     to flush than the one that was current when the entries were
+     added */
+  _COGL_RETURN_IF_FAIL (framebuffer == journal->framebuffer);
+
+  /* The entries in this journal may depend on images in other
+   * framebuffers which may require that we flush the journals
+   * associated with those framebuffers before we can flush
+   * this journal... */
+  _cogl_framebuffer_flush_dependency_journals (framebuffer);
+
+  /* Note: we start the timer after flushing dependency journals so
+   * that the timer isn't started recursively. */
+  COGL_TIMER_START (_cogl_uprof_context, flush_timer);
+
+  state.framebuffer = framebuffer;
+  cogl_push_framebuffer (framebuffer);
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+    g_print ("BATCHING: journal len = %d\n", journal->entries->len);
+
+  /* NB: the journal deals with flushing the modelview stack and clip
+     state manually */
+  _cogl_framebuffer_flush_state (framebuffer,
+                                 framebuffer,
+                                 COGL_FRAMEBUFFER_STATE_ALL &
+                                 ~(COGL_FRAMEBUFFER_STATE_MODELVIEW |
+                                   COGL_FRAMEBUFFER_STATE_CLIP));
+
+  state.journal = journal;
+
+  state.attributes = ctx->journal_flush_attributes_array;
+
+  modelview_stack = _cogl_framebuffer_get_modelview_stack (framebuffer);
+  state.modelview_stack = modelview_stack;
+  state.projection_stack = _cogl_framebuffer_get_projection_stack (framebuffer);
+
+  if (G_UNLIKELY ((COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_CLIP)) == 0))
+    {
+      /* We do an initial walk of the journal to analyse the clip stack
+         batches to see if we can do software clipping. We do this as a
+         separate walk of the journal because we can modify entries and
+         this may end up joining together clip stack batches in the next
+         iteration. */
       batch_and_call ((CoglJournalEntry *)journal->entries->data, /* first entry */
                       journal->entries->len, /* max number of entries to consider */
                       compare_entry_clip_stacks,
@@ -1417,6 +2578,72 @@ _cogl_journal_flush (CoglJournal *journal,
                       &state); /* data */
     }
 
+  /* Culling is done after software clipping because that may have
+     removed the clip stacks of some entries, making them usable as
+     occluders */
+  if (framebuffer->occlusion_culling_enabled &&
+      journal->entries->len > 1 &&
+      G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_OCCLUSION_CULLING)))
+    _cogl_journal_cull_occluded_entries (journal, framebuffer);
+
+  /* Without a depth buffer the entries would simply be drawn in the
+     wrong order */
+  if (framebuffer->depth_sorting_enabled && SW_TRANSFORM &&
+      _cogl_framebuffer_get_depth_bits (framebuffer) > 0)
+    {
+      _cogl_matrix_stack_get (state.projection_stack, &projection);
+
+      if (_cogl_journal_can_depth_sort (journal, &projection))
+        {
+          depth_sorted_sources = _cogl_journal_depth_sort_entries (journal);
+
+          /* The positions now have a w component */
+          journal->needed_vbo_len += journal->entries->len * 4;
+          ctx->journal_depth_sorting = TRUE;
+          depth_sort_projection = &projection;
+        }
+    }
+
+  compact_state.journal = journal;
+  compact_state.n_compact = 0;
+
+  /* Compact vertices are preferred over transforming on the GPU
+     because they are most likely to be used for pixel aligned 2D
+     content which is cheap to transform anyway */
+  if (!ctx->journal_depth_sorting &&
+      G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_COMPACT_VERTICES)))
+    batch_and_call ((CoglJournalEntry *)journal->entries->data,
+                    journal->entries->len,
+                    compare_entry_clip_stacks,
+                    _cogl_journal_choose_compact_clip_batch,
+                    &compact_state);
+
+  if (!ctx->journal_depth_sorting && compact_state.n_compact == 0 &&
+      SW_TRANSFORM &&
+      G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_GPU_TRANSFORM)) &&
+      _cogl_journal_build_palette (journal))
+    {
+      COGL_STATIC_COUNTER (gpu_transform_counter,
+                           "Journal GPU transform counter",
+                           "Increments for each journal flush that "
+                           "transforms its entries in the vertex shader",
+                           0 /* no application private data */);
+
+      COGL_COUNTER_INC (_cogl_uprof_context, gpu_transform_counter);
+
+      ctx->journal_gpu_transform = TRUE;
+      state.gpu_transform_pipelines =
+        g_hash_table_new_full (g_direct_hash,
+                               g_direct_equal,
+                               NULL,
+                               cogl_object_unref);
+      state.gpu_transform_snippet = NULL;
+
+      COGL_NOTE (BATCHING, "Transforming %i journal entries using %i "
+                 "matrices on the GPU",
+                 journal->entries->len, ctx->journal_palette->len);
+    }
+
   /* We upload the vertices after the clip stack pass in case it
      modifies the entries */
   state.attribute_buffer =
@@ -1424,7 +2651,8 @@ _cogl_journal_flush (CoglJournal *journal,
                      &g_array_index (journal->entries, CoglJournalEntry, 0),
                      journal->entries->len,
                      journal->needed_vbo_len,
-                     journal->vertices);
+                     journal->vertices,
+                     depth_sort_projection);
   state.array_offset = 0;
 
   /* batch_and_call() batches a list of journal entries according to some
@@ -1436,8 +2664,8 @@ _cogl_journal_flush (CoglJournal *journal,
    * 2) We split the entries according to the stride of the vertices:
    *      Each time the stride of our vertex data changes we need to call
    *      gl{Vertex,Color}Pointer to inform GL of new VBO offsets.
-   *      Currently the only thing that affects the stride of our vertex data
-   *      is the number of pipeline layers.
+   *      The stride of our vertex data depends on the number of pipeline
+   *      layers and whether the batch was uploaded with compact vertices.
    * 3) We split the entries explicitly by the number of pipeline layers:
    *      We pad our vertex data when the number of layers is < 2 so that we
    *      can minimize changes in stride. Each time the number of layers
@@ -1456,6 +2684,16 @@ _cogl_journal_flush (CoglJournal *journal,
                   _cogl_journal_flush_clip_stacks_and_entries, /* callback */
                   &state); /* data */
 
+  ctx->journal_depth_sorting = FALSE;
+
+  if (ctx->journal_gpu_transform)
+    {
+      g_hash_table_destroy (state.gpu_transform_pipelines);
+      if (state.gpu_transform_snippet)
+        cogl_object_unref (state.gpu_transform_snippet);
+      ctx->journal_gpu_transform = FALSE;
+    }
+
   for (i = 0; i < state.attributes->len; i++)
     cogl_object_unref (g_array_index (state.attributes, CoglAttribute *, i));
   g_array_set_size (state.attributes, 0);
@@ -1464,6 +2702,14 @@ _cogl_journal_flush (CoglJournal *journal,
 
   _cogl_journal_discard (journal);
 
+  if (depth_sorted_sources)
+    {
+      for (i = 0; i < depth_sorted_sources->len; i++)
+        _cogl_pipeline_journal_unref (g_ptr_array_index (depth_sorted_sources,
+                                                         i));
+      g_ptr_array_free (depth_sorted_sources, TRUE);
+    }
+
   cogl_pop_framebuffer ();
 
   COGL_TIMER_STOP (_cogl_uprof_context, flush_timer);
@@ -1485,6 +2731,36 @@ add_framebuffer_deps_cb (CoglPipelineLayer *layer, void *user_data)
   return TRUE;
 }
 
+/* Checks whether a quad would be entirely outside of the viewport or
+ * clip of the framebuffer so it doesn't need to be logged at all */
+static gboolean
+quad_is_culled (CoglFramebuffer *framebuffer,
+                CoglPipeline *pipeline,
+                const float *position)
+{
+  float corners[4 * 3];
+
+  /* Vertex shaders and snippets may move the vertices anywhere */
+  if (_cogl_pipeline_get_user_program (pipeline) ||
+      _cogl_pipeline_has_non_layer_vertex_snippets (pipeline))
+    return FALSE;
+
+  corners[0] = position[0];
+  corners[1] = position[1];
+  corners[2] = 0;
+  corners[3] = position[0];
+  corners[4] = position[3];
+  corners[5] = 0;
+  corners[6] = position[2];
+  corners[7] = position[3];
+  corners[8] = 0;
+  corners[9] = position[2];
+  corners[10] = position[1];
+  corners[11] = 0;
+
+  return _cogl_framebuffer_points_are_culled (framebuffer, corners, 4);
+}
+
 void
 _cogl_journal_log_quad (CoglJournal  *journal,
                         const float  *position,
@@ -1509,11 +2785,26 @@ _cogl_journal_log_quad (CoglJournal  *journal,
                      "Journal Log",
                      "The time spent logging in the Cogl journal",
                      0 /* no application private data */);
+  COGL_STATIC_COUNTER (frustum_culled_counter,
+                       "Journal frustum culled counter",
+                       "Increments for each rectangle that isn't logged "
+                       "because it is outside of the viewport or clip",
+                       0 /* no application private data */);
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
   COGL_TIMER_START (_cogl_uprof_context, log_timer);
 
+  /* Skipping quads that can't be seen here saves transforming and
+     uploading them when the journal is flushed */
+  if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_FRUSTUM_CULLING)) &&
+      quad_is_culled (cogl_get_draw_framebuffer (), pipeline, position))
+    {
+      COGL_COUNTER_INC (_cogl_uprof_context, frustum_culled_counter);
+      COGL_TIMER_STOP (_cogl_uprof_context, log_timer);
+      return;
+    }
+
   /* If the framebuffer was previously empty then we'll take a
      reference to the current framebuffer. This reference will be
      removed when the journal is flushed. FIXME: This should probably
@@ -1574,6 +2865,18 @@ _cogl_journal_log_quad (CoglJournal  *journal,
 
   entry->n_layers = n_layers;
   entry->array_offset = next_vert;
+  entry->compact = FALSE;
+
+  if (journal->framebuffer->depth_sorting_enabled)
+    {
+      entry->depth_serial = journal->framebuffer->depth_sort_serial;
+      /* Once we run out of depths the entries are drawn in order
+         until the depth buffer is cleared again */
+      if (entry->depth_serial < COGL_JOURNAL_N_DEPTH_SERIALS)
+        journal->framebuffer->depth_sort_serial++;
+    }
+  else
+    entry->depth_serial = -1;
 
   final_pipeline = pipeline;
 
@@ -1622,98 +2925,6 @@ _cogl_journal_log_quad (CoglJournal  *journal,
   COGL_TIMER_STOP (_cogl_uprof_context, log_timer);
 }
 
-static void
-entry_to_screen_polygon (CoglFramebuffer *framebuffer,
-                         const CoglJournalEntry *entry,
-                         float *vertices,
-                         float *poly)
-{
-  size_t array_stride =
-    GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
-  CoglMatrixStack *projection_stack;
-  CoglMatrix projection;
-  int i;
-  float viewport[4];
-
-  poly[0] = vertices[0];
-  poly[1] = vertices[1];
-  poly[2] = 0;
-  poly[3] = 1;
-
-  poly[4] = vertices[0];
-  poly[5] = vertices[array_stride + 1];
-  poly[6] = 0;
-  poly[7] = 1;
-
-  poly[8] = vertices[array_stride];
-  poly[9] = vertices[array_stride + 1];
-  poly[10] = 0;
-  poly[11] = 1;
-
-  poly[12] = vertices[array_stride];
-  poly[13] = vertices[1];
-  poly[14] = 0;
-  poly[15] = 1;
-
-  /* TODO: perhaps split the following out into a more generalized
-   * _cogl_transform_points utility...
-   */
-
-  cogl_matrix_transform_points (&entry->model_view,
-                                2, /* n_components */
-                                sizeof (float) * 4, /* stride_in */
-                                poly, /* points_in */
-                                /* strideout */
-                                sizeof (float) * 4,
-                                poly, /* points_out */
-                                4 /* n_points */);
-
-  projection_stack =
-    _cogl_framebuffer_get_projection_stack (framebuffer);
-  _cogl_matrix_stack_get (projection_stack, &projection);
-
-  cogl_matrix_project_points (&projection,
-                              3, /* n_components */
-                              sizeof (float) * 4, /* stride_in */
-                              poly, /* points_in */
-                              /* strideout */
-                              sizeof (float) * 4,
-                              poly, /* points_out */
-                              4 /* n_points */);
-
-  cogl_framebuffer_get_viewport4fv (framebuffer, viewport);
-
-/* Scale from OpenGL normalized device coordinates (ranging from -1 to 1)
- * to Cogl window/framebuffer coordinates (ranging from 0 to buffer-size) with
- * (0,0) being top left. */
-#define VIEWPORT_TRANSFORM_X(x, vp_origin_x, vp_width) \
-    (  ( ((x) + 1.0) * ((vp_width) / 2.0) ) + (vp_origin_x)  )
-/* Note: for Y we first flip all coordinates around the X axis while in
- * normalized device coodinates */
-#define VIEWPORT_TRANSFORM_Y(y, vp_origin_y, vp_height) \
-    (  ( ((-(y)) + 1.0) * ((vp_height) / 2.0) ) + (vp_origin_y)  )
-
-  /* Scale from normalized device coordinates (in range [-1,1]) to
-   * window coordinates ranging [0,window-size] ... */
-  for (i = 0; i < 4; i++)
-    {
-      float w = poly[4 * i + 3];
-
-      /* Perform perspective division */
-      poly[4 * i] /= w;
-      poly[4 * i + 1] /= w;
-
-      /* Apply viewport transform */
-      poly[4 * i] = VIEWPORT_TRANSFORM_X (poly[4 * i],
-                                          viewport[0], viewport[2]);
-      poly[4 * i + 1] = VIEWPORT_TRANSFORM_Y (poly[4 * i + 1],
-                                              viewport[1], viewport[3]);
-    }
-
-#undef VIEWPORT_TRANSFORM_X
-#undef VIEWPORT_TRANSFORM_Y
-}
-
 static gboolean
 try_checking_point_hits_entry_after_clipping (CoglFramebuffer *framebuffer,
                                               CoglJournalEntry *entry,
@@ -1734,6 +2945,8 @@ try_checking_point_hits_entry_after_clipping (CoglFramebuffer *framebuffer,
        clip_entry;
        clip_entry = clip_entry->parent)
     {
+      _cogl_clip_stack_ensure_bounds (clip_entry);
+
       if (x < clip_entry->bounds_x0 ||
           x >= clip_entry->bounds_x1 ||
           y < clip_entry->bounds_y0 ||
@@ -33,6 +33,7 @@
 #include "cogl-spans.h"
 #include "cogl-meta-texture.h"
 #include "cogl-texture-rectangle-private.h"
+#include "cogl-sparse-texture-private.h"
 
 #include <string.h>
 #include <math.h>
@@ -549,6 +550,18 @@ cogl_meta_texture_foreach_in_region (CoglMetaTexture *meta_texture,
       ty_2 *= height;
     }
 
+  /* The generic code below iterates every slice of the texture to
+   * build the repeating grid. That would load the whole image for a
+   * sparse texture so it handles the region directly instead */
+  if (cogl_is_sparse_texture (texture))
+    {
+      _cogl_sparse_texture_foreach_in_region (COGL_SPARSE_TEXTURE (texture),
+                                              tx_1, ty_1, tx_2, ty_2,
+                                              callback,
+                                              user_data);
+      return;
+    }
+
   /* XXX: at some point this wont be routed through the CoglTexture
    * vtable, instead there will be a separate CoglMetaTexture
    * interface vtable. */
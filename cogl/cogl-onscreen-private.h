@@ -25,6 +25,7 @@
 #define __COGL_ONSCREEN_PRIVATE_H
 
 #include "cogl-framebuffer-private.h"
+#include "cogl-frame-clock-private.h"
 
 #include <glib.h>
 
@@ -32,6 +33,10 @@
 #include <windows.h>
 #endif
 
+/* The number of previous frames we remember the damage for. A back
+ * buffer older than this has to be repainted in full */
+#define COGL_ONSCREEN_MAX_DAMAGE_HISTORY 4
+
 typedef struct _CoglSwapBuffersNotifyEntry CoglSwapBuffersNotifyEntry;
 
 COGL_TAILQ_HEAD (CoglSwapBuffersNotifyList, CoglSwapBuffersNotifyEntry);
@@ -45,6 +50,19 @@ struct _CoglSwapBuffersNotifyEntry
   unsigned int id;
 };
 
+typedef struct _CoglFrameCallbackEntry CoglFrameCallbackEntry;
+
+COGL_TAILQ_HEAD (CoglFrameCallbackList, CoglFrameCallbackEntry);
+
+struct _CoglFrameCallbackEntry
+{
+  COGL_TAILQ_ENTRY (CoglFrameCallbackEntry) list_node;
+
+  CoglFrameCallback callback;
+  void *user_data;
+  unsigned int id;
+};
+
 struct _CoglOnscreen
 {
   CoglFramebuffer  _parent;
@@ -63,6 +81,34 @@ struct _CoglOnscreen
 
   CoglSwapBuffersNotifyList swap_callbacks;
 
+  CoglFrameCallbackList frame_callbacks;
+  CoglFrameClock frame_clock;
+
+  /* The age of the current back buffer as reported by the winsys or
+   * -1 if it hasn't been queried since the last swap */
+  int buffer_age;
+
+  /* Set once the application has used any of the buffer age API.
+   * Until then nothing can rely on the contents of the back buffer
+   * so they are still discarded after each swap */
+  gboolean preserve_back_buffer;
+
+  /* Whether the contents of the current back buffer were discarded
+   * after the last swap. The winsys doesn't know about the discard so
+   * its buffer age can't be trusted in that case */
+  gboolean back_buffer_discarded;
+
+  /* The bounding box (x0, y0, x1, y1) of the damage reported with
+   * cogl_onscreen_add_damage() for the current frame */
+  gboolean has_damage;
+  int damage[4];
+
+  /* The damage bounding boxes of previously swapped frames, most
+   * recent first, so that we can work out what has changed since a
+   * back buffer of a given age was last presented */
+  int damage_history[COGL_ONSCREEN_MAX_DAMAGE_HISTORY][4];
+  int n_damage_history;
+
   void *winsys;
 };
 
@@ -76,4 +122,16 @@ _cogl_framebuffer_winsys_update_size (CoglFramebuffer *framebuffer,
 void
 _cogl_onscreen_notify_swap_buffers (CoglOnscreen *onscreen);
 
+/*
+ * Returns the time at which the frame callbacks of @onscreen should
+ * next be dispatched or -1 if no frame has been scheduled.
+ */
+gint64
+_cogl_onscreen_get_frame_deadline (CoglOnscreen *onscreen,
+                                   gint64 now);
+
+void
+_cogl_onscreen_dispatch_frame (CoglOnscreen *onscreen,
+                               gint64 now);
+
 #endif /* __COGL_ONSCREEN_PRIVATE_H */
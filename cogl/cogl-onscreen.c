@@ -30,8 +30,11 @@
 #include "cogl-framebuffer-private.h"
 #include "cogl-onscreen-template-private.h"
 #include "cogl-context-private.h"
+#include "cogl-texture-2d-private.h"
 #include "cogl-object-private.h"
 
+#include <string.h>
+
 static void _cogl_onscreen_free (CoglOnscreen *onscreen);
 
 COGL_OBJECT_INTERNAL_DEFINE_WITH_CODE (Onscreen, onscreen,
@@ -45,6 +48,11 @@ _cogl_onscreen_init_from_template (CoglOnscreen *onscreen,
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
 
   COGL_TAILQ_INIT (&onscreen->swap_callbacks);
+  COGL_TAILQ_INIT (&onscreen->frame_callbacks);
+
+  _cogl_frame_clock_init (&onscreen->frame_clock);
+
+  onscreen->buffer_age = -1;
 
   framebuffer->config = onscreen_template->config;
   cogl_object_ref (framebuffer->config.swap_chain);
@@ -112,6 +120,13 @@ _cogl_onscreen_free (CoglOnscreen *onscreen)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
   const CoglWinsysVtable *winsys = _cogl_framebuffer_get_winsys (framebuffer);
+  CoglFrameCallbackEntry *entry;
+
+  while ((entry = COGL_TAILQ_FIRST (&onscreen->frame_callbacks)))
+    {
+      COGL_TAILQ_REMOVE (&onscreen->frame_callbacks, entry, list_node);
+      g_slice_free (CoglFrameCallbackEntry, entry);
+    }
 
   if (framebuffer->context->window_buffer == onscreen)
     framebuffer->context->window_buffer = NULL;
@@ -125,6 +140,49 @@ _cogl_onscreen_free (CoglOnscreen *onscreen)
   g_free (onscreen);
 }
 
+static void
+_cogl_onscreen_end_frame (CoglOnscreen *onscreen,
+                          gboolean keep_history)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+
+  if (keep_history)
+    {
+      int *damage;
+
+      memmove (onscreen->damage_history + 1,
+               onscreen->damage_history,
+               sizeof (onscreen->damage_history[0]) *
+               (COGL_ONSCREEN_MAX_DAMAGE_HISTORY - 1));
+      onscreen->n_damage_history =
+        MIN (onscreen->n_damage_history + 1,
+             COGL_ONSCREEN_MAX_DAMAGE_HISTORY);
+
+      /* If the application didn't tell us what it changed then we
+       * have to assume it redrew everything */
+      damage = onscreen->damage_history[0];
+      if (onscreen->has_damage)
+        memcpy (damage, onscreen->damage, sizeof (onscreen->damage));
+      else
+        {
+          damage[0] = 0;
+          damage[1] = 0;
+          damage[2] = framebuffer->width;
+          damage[3] = framebuffer->height;
+        }
+    }
+  else
+    onscreen->n_damage_history = 0;
+
+  onscreen->has_damage = FALSE;
+  onscreen->buffer_age = -1;
+
+  _cogl_framebuffer_disable_repaint_clip (framebuffer);
+
+  _cogl_transient_offscreen_pool_end_frame (framebuffer->context);
+  _cogl_texture_2d_end_frame (framebuffer->context);
+}
+
 void
 cogl_framebuffer_swap_buffers (CoglFramebuffer *framebuffer)
 {
@@ -136,10 +194,32 @@ cogl_framebuffer_swap_buffers (CoglFramebuffer *framebuffer)
   cogl_flush ();
   winsys = _cogl_framebuffer_get_winsys (framebuffer);
   winsys->onscreen_swap_buffers (COGL_ONSCREEN (framebuffer));
-  cogl_framebuffer_discard_buffers (framebuffer,
-                                    COGL_BUFFER_BIT_COLOR |
-                                    COGL_BUFFER_BIT_DEPTH |
-                                    COGL_BUFFER_BIT_STENCIL);
+
+  /* If the winsys will tell us when the swap completes then the frame
+   * clock waits for that before starting another frame */
+  _cogl_frame_clock_notify_swap (&COGL_ONSCREEN (framebuffer)->frame_clock,
+                                 g_get_monotonic_time (),
+                                 cogl_has_feature
+                                 (framebuffer->context,
+                                  COGL_FEATURE_ID_SWAP_BUFFERS_EVENT));
+
+  _cogl_onscreen_end_frame (COGL_ONSCREEN (framebuffer), TRUE);
+
+  /* An application that uses the buffer age to only repaint what
+   * changed relies on the contents of the back buffer so we mustn't
+   * let the driver throw them away. Everything else keeps the discard
+   * so that tiled GPUs don't have to load the old contents */
+  if (cogl_has_feature (framebuffer->context, COGL_FEATURE_ID_BUFFER_AGE) &&
+      COGL_ONSCREEN (framebuffer)->preserve_back_buffer)
+    COGL_ONSCREEN (framebuffer)->back_buffer_discarded = FALSE;
+  else
+    {
+      cogl_framebuffer_discard_buffers (framebuffer,
+                                        COGL_BUFFER_BIT_COLOR |
+                                        COGL_BUFFER_BIT_DEPTH |
+                                        COGL_BUFFER_BIT_STENCIL);
+      COGL_ONSCREEN (framebuffer)->back_buffer_discarded = TRUE;
+    }
 }
 
 void
@@ -164,10 +244,164 @@ cogl_framebuffer_swap_region (CoglFramebuffer *framebuffer,
                                 rectangles,
                                 n_rectangles);
 
+  /* Region swaps don't generate swap complete notifications */
+  _cogl_frame_clock_notify_swap (&COGL_ONSCREEN (framebuffer)->frame_clock,
+                                 g_get_monotonic_time (),
+                                 FALSE);
+
+  /* Copying a region to the front buffer doesn't fit into the
+   * sequence of buffer ages so we can't trust the history anymore */
+  _cogl_onscreen_end_frame (COGL_ONSCREEN (framebuffer), FALSE);
+
   cogl_framebuffer_discard_buffers (framebuffer,
                                     COGL_BUFFER_BIT_COLOR |
                                     COGL_BUFFER_BIT_DEPTH |
                                     COGL_BUFFER_BIT_STENCIL);
+  COGL_ONSCREEN (framebuffer)->back_buffer_discarded = TRUE;
+}
+
+int
+cogl_onscreen_get_buffer_age (CoglOnscreen *onscreen)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  const CoglWinsysVtable *winsys;
+
+  /* The contents are only kept from now on. The current back buffer
+   * may already have been discarded in which case it is undefined */
+  onscreen->preserve_back_buffer = TRUE;
+
+  if (onscreen->back_buffer_discarded)
+    return 0;
+
+  if (onscreen->buffer_age >= 0)
+    return onscreen->buffer_age;
+
+  if (!framebuffer->allocated ||
+      !cogl_has_feature (framebuffer->context, COGL_FEATURE_ID_BUFFER_AGE))
+    return 0;
+
+  winsys = _cogl_framebuffer_get_winsys (framebuffer);
+
+  /* The age can't change until the next swap so we only need to ask
+   * the window system once per frame */
+  onscreen->buffer_age = winsys->onscreen_get_buffer_age (onscreen);
+
+  return onscreen->buffer_age;
+}
+
+static void
+_cogl_onscreen_get_repaint_bounds (CoglOnscreen *onscreen,
+                                   int *x0,
+                                   int *y0,
+                                   int *x1,
+                                   int *y1)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  int age;
+  int i;
+
+  *x0 = 0;
+  *y0 = 0;
+  *x1 = framebuffer->width;
+  *y1 = framebuffer->height;
+
+  if (!onscreen->has_damage)
+    return;
+
+  /* An age of 0 means the contents of the back buffer are undefined
+   * and if the buffer is older than the history we remember then we
+   * don't know what has changed since it was presented. In both cases
+   * everything needs to be repainted */
+  age = cogl_onscreen_get_buffer_age (onscreen);
+  if (age == 0 || age - 1 > onscreen->n_damage_history)
+    return;
+
+  /* The back buffer is missing this frame's damage and the damage of
+   * every frame that has been presented since it was last used */
+  *x0 = onscreen->damage[0];
+  *y0 = onscreen->damage[1];
+  *x1 = onscreen->damage[2];
+  *y1 = onscreen->damage[3];
+
+  for (i = 0; i < age - 1; i++)
+    {
+      const int *damage = onscreen->damage_history[i];
+
+      *x0 = MIN (*x0, damage[0]);
+      *y0 = MIN (*y0, damage[1]);
+      *x1 = MAX (*x1, damage[2]);
+      *y1 = MAX (*y1, damage[3]);
+    }
+}
+
+void
+cogl_onscreen_add_damage (CoglOnscreen *onscreen,
+                          const int *rectangles,
+                          int n_rectangles)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  int x0, y0, x1, y1;
+  int i;
+
+  _COGL_RETURN_IF_FAIL (n_rectangles >= 0);
+
+  onscreen->preserve_back_buffer = TRUE;
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      const int *rect = rectangles + i * 4;
+      int rect_x0 = CLAMP (rect[0], 0, framebuffer->width);
+      int rect_y0 = CLAMP (rect[1], 0, framebuffer->height);
+      int rect_x1 = CLAMP (rect[0] + rect[2], 0, framebuffer->width);
+      int rect_y1 = CLAMP (rect[1] + rect[3], 0, framebuffer->height);
+
+      if (rect_x0 >= rect_x1 || rect_y0 >= rect_y1)
+        continue;
+
+      if (onscreen->has_damage)
+        {
+          onscreen->damage[0] = MIN (onscreen->damage[0], rect_x0);
+          onscreen->damage[1] = MIN (onscreen->damage[1], rect_y0);
+          onscreen->damage[2] = MAX (onscreen->damage[2], rect_x1);
+          onscreen->damage[3] = MAX (onscreen->damage[3], rect_y1);
+        }
+      else
+        {
+          onscreen->damage[0] = rect_x0;
+          onscreen->damage[1] = rect_y0;
+          onscreen->damage[2] = rect_x1;
+          onscreen->damage[3] = rect_y1;
+          onscreen->has_damage = TRUE;
+        }
+    }
+
+  if (!onscreen->has_damage)
+    return;
+
+  _cogl_onscreen_get_repaint_bounds (onscreen, &x0, &y0, &x1, &y1);
+
+  /* There's no point in scissoring if we have to repaint everything */
+  if (x0 == 0 && y0 == 0 &&
+      x1 == framebuffer->width && y1 == framebuffer->height)
+    _cogl_framebuffer_disable_repaint_clip (framebuffer);
+  else
+    _cogl_framebuffer_set_repaint_clip (framebuffer, x0, y0, x1, y1);
+}
+
+void
+cogl_onscreen_get_repaint_region (CoglOnscreen *onscreen,
+                                  int *rectangle)
+{
+  int x0, y0, x1, y1;
+
+  onscreen->preserve_back_buffer = TRUE;
+
+  _cogl_onscreen_get_repaint_bounds (onscreen, &x0, &y0, &x1, &y1);
+
+  rectangle[0] = x0;
+  rectangle[1] = y0;
+  rectangle[2] = x1 - x0;
+  rectangle[3] = y1 - y0;
 }
 
 #ifdef COGL_HAS_X11_SUPPORT
@@ -288,6 +522,75 @@ cogl_framebuffer_remove_swap_buffers_callback (CoglFramebuffer *framebuffer,
     }
 }
 
+unsigned int
+cogl_onscreen_add_frame_callback (CoglOnscreen *onscreen,
+                                  CoglFrameCallback callback,
+                                  void *user_data)
+{
+  CoglFrameCallbackEntry *entry = g_slice_new0 (CoglFrameCallbackEntry);
+  static int next_frame_callback_id = 0;
+
+  entry->callback = callback;
+  entry->user_data = user_data;
+  entry->id = next_frame_callback_id++;
+
+  COGL_TAILQ_INSERT_TAIL (&onscreen->frame_callbacks, entry, list_node);
+
+  return entry->id;
+}
+
+void
+cogl_onscreen_remove_frame_callback (CoglOnscreen *onscreen,
+                                     unsigned int id)
+{
+  CoglFrameCallbackEntry *entry;
+
+  COGL_TAILQ_FOREACH (entry, &onscreen->frame_callbacks, list_node)
+    {
+      if (entry->id == id)
+        {
+          COGL_TAILQ_REMOVE (&onscreen->frame_callbacks, entry, list_node);
+          g_slice_free (CoglFrameCallbackEntry, entry);
+          break;
+        }
+    }
+}
+
+void
+cogl_onscreen_schedule_frame (CoglOnscreen *onscreen)
+{
+  _COGL_RETURN_IF_FAIL (_cogl_is_onscreen (onscreen));
+
+  onscreen->frame_clock.frame_scheduled = TRUE;
+}
+
+gint64
+_cogl_onscreen_get_frame_deadline (CoglOnscreen *onscreen,
+                                   gint64 now)
+{
+  /* There's no point in waking up if nothing will draw the frame */
+  if (COGL_TAILQ_EMPTY (&onscreen->frame_callbacks))
+    return -1;
+
+  return _cogl_frame_clock_get_deadline (&onscreen->frame_clock, now);
+}
+
+void
+_cogl_onscreen_dispatch_frame (CoglOnscreen *onscreen,
+                               gint64 now)
+{
+  CoglFrameCallbackEntry *entry, *tmp;
+  gint64 target_time;
+
+  target_time = _cogl_frame_clock_begin_frame (&onscreen->frame_clock, now);
+
+  COGL_TAILQ_FOREACH_SAFE (entry,
+                           &onscreen->frame_callbacks,
+                           list_node,
+                           tmp)
+    entry->callback (onscreen, target_time, entry->user_data);
+}
+
 void
 cogl_onscreen_set_swap_throttled (CoglOnscreen *onscreen,
                                   gboolean throttled)
@@ -338,6 +641,9 @@ _cogl_onscreen_notify_swap_buffers (CoglOnscreen *onscreen)
 {
   CoglSwapBuffersNotifyEntry *entry, *tmp;
 
+  _cogl_frame_clock_notify_presented (&onscreen->frame_clock,
+                                      g_get_monotonic_time ());
+
   COGL_TAILQ_FOREACH_SAFE (entry,
                            &onscreen->swap_callbacks,
                            list_node,
@@ -355,6 +661,11 @@ _cogl_framebuffer_winsys_update_size (CoglFramebuffer *framebuffer,
   framebuffer->width = width;
   framebuffer->height = height;
 
+  /* The damage we remember was relative to the old size so the next
+   * frame will have to be repainted in full */
+  if (framebuffer->type == COGL_FRAMEBUFFER_TYPE_ONSCREEN)
+    COGL_ONSCREEN (framebuffer)->n_damage_history = 0;
+
   /* The framebuffer geometry can affect the GL viewport so if the
    * framebuffer being updated is the current framebuffer we mark the
    * viewport state as changed so it will be updated the next time
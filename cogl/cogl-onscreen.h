@@ -300,7 +300,11 @@ cogl_onscreen_hide (CoglOnscreen *onscreen);
  * stencil buffers as if cogl_framebuffer_discard_buffers() were used. The
  * significance of the discard is that you should not expect to be able to
  * start a new frame that incrementally builds on the contents of the previous
- * frame.
+ * frame. The exception is when the %COGL_FEATURE_ID_BUFFER_AGE feature
+ * is available and the application has used cogl_onscreen_get_buffer_age(),
+ * cogl_onscreen_add_damage() or cogl_onscreen_get_repaint_region() on
+ * the framebuffer. In that case the contents are preserved so that only
+ * damaged regions need to be redrawn.
  *
  * Since: 1.8
  * Stability: unstable
@@ -319,6 +323,9 @@ cogl_framebuffer_swap_buffers (CoglFramebuffer *framebuffer);
  * display.  @rectangles represents the region as array of @n_rectangles each
  * defined by 4 sequential (x, y, width, height) integers.
  *
+ * <note>Applications should check for the %COGL_FEATURE_ID_SWAP_REGION
+ * feature before using this API.</note>
+ *
  * This function also implicitly discards the contents of the color, depth and
  * stencil buffers as if cogl_framebuffer_discard_buffers() were used. The
  * significance of the discard is that you should not expect to be able to
@@ -333,6 +340,85 @@ cogl_framebuffer_swap_region (CoglFramebuffer *framebuffer,
                               const int *rectangles,
                               int n_rectangles);
 
+/**
+ * cogl_onscreen_get_buffer_age:
+ * @onscreen: A #CoglOnscreen framebuffer
+ *
+ * Gets the number of frames since the current back buffer of
+ * @onscreen was last presented. A value of 1 means the back buffer
+ * contains the previous frame, 2 means it contains the frame before
+ * that and so on. A value of 0 means the contents of the back buffer
+ * are undefined and the whole frame needs to be redrawn.
+ *
+ * Calling this tells Cogl that the application may rely on the
+ * contents of the back buffer so they will no longer be discarded by
+ * cogl_framebuffer_swap_buffers(). The back buffer of the frame in
+ * which this is first called may already have been discarded so that
+ * frame will always see an age of 0.
+ *
+ * <note>This will always return 0 unless the
+ * %COGL_FEATURE_ID_BUFFER_AGE feature is available.</note>
+ *
+ * Return value: The age of the current back buffer
+ * Since: 2.0
+ * Stability: unstable
+ */
+int
+cogl_onscreen_get_buffer_age (CoglOnscreen *onscreen);
+
+/**
+ * cogl_onscreen_add_damage:
+ * @onscreen: A #CoglOnscreen framebuffer
+ * @rectangles: An array of integer 4-tuples representing rectangles as
+ *              (x, y, width, height) tuples.
+ * @n_rectangles: The number of 4-tuples to be read from @rectangles
+ *
+ * Tells Cogl which regions of @onscreen will change in the current
+ * frame. The rectangles are in window coordinates relative to the top
+ * left of the framebuffer and can be added incrementally before
+ * drawing starts.
+ *
+ * Cogl remembers the damage of the last few frames so that combined
+ * with the age of the back buffer it can work out which region
+ * actually needs to be repainted. Until the next call to
+ * cogl_framebuffer_swap_buffers() all clears and drawing to @onscreen
+ * are implicitly scissored to that region so an application can
+ * simply redraw its whole scene and only the pixels that changed will
+ * be touched. Use cogl_onscreen_get_repaint_region() to find out what
+ * the region is so that drawing outside of it can be skipped entirely.
+ *
+ * If this isn't called for a frame then the whole of that frame is
+ * assumed to have changed.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_onscreen_add_damage (CoglOnscreen *onscreen,
+                          const int *rectangles,
+                          int n_rectangles);
+
+/**
+ * cogl_onscreen_get_repaint_region:
+ * @onscreen: A #CoglOnscreen framebuffer
+ * @rectangle: (out) (array fixed-size=4): The location to store the
+ *             region as an (x, y, width, height) tuple.
+ *
+ * Gets the bounding box of the region of @onscreen that needs to be
+ * repainted in the current frame. This is the union of the damage
+ * added with cogl_onscreen_add_damage() for this frame and the damage
+ * of every frame presented since the current back buffer was last
+ * used. If no damage has been added, the back buffer age is unknown
+ * or the back buffer is older than the history Cogl keeps then this
+ * will be the whole framebuffer.
+ *
+ * Since: 2.0
+ * Stability: unstable
+ */
+void
+cogl_onscreen_get_repaint_region (CoglOnscreen *onscreen,
+                                  int *rectangle);
+
 
 typedef void (*CoglSwapBuffersNotify) (CoglFramebuffer *framebuffer,
                                        void *user_data);
@@ -381,6 +467,91 @@ void
 cogl_framebuffer_remove_swap_buffers_callback (CoglFramebuffer *framebuffer,
                                                unsigned int id);
 
+/**
+ * CoglFrameCallback:
+ * @onscreen: The #CoglOnscreen that the frame is for
+ * @target_time: The time, in the same units as g_get_monotonic_time(),
+ *               at which the frame is expected to be shown
+ * @user_data: The private pointer passed to
+ *             cogl_onscreen_add_frame_callback()
+ *
+ * The type of the callbacks that are called when Cogl decides it is
+ * time to draw a frame that was requested with
+ * cogl_onscreen_schedule_frame(). Animations should be advanced to
+ * @target_time rather than to the current time.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+typedef void (*CoglFrameCallback) (CoglOnscreen *onscreen,
+                                   gint64 target_time,
+                                   void *user_data);
+
+/**
+ * cogl_onscreen_add_frame_callback:
+ * @onscreen: A #CoglOnscreen framebuffer
+ * @callback: A callback function to call when a frame should be drawn
+ * @user_data: A private pointer to be passed to @callback
+ *
+ * Installs a @callback function that will be called from
+ * cogl_poll_dispatch() when a frame scheduled with
+ * cogl_onscreen_schedule_frame() should be drawn. The callback is
+ * expected to draw the frame and call cogl_framebuffer_swap_buffers()
+ * before returning so that Cogl can measure how long frames take.
+ *
+ * Return value: a unique identifier that can be used to remove the
+ *               callback later.
+ * Since: 1.10
+ * Stability: unstable
+ */
+unsigned int
+cogl_onscreen_add_frame_callback (CoglOnscreen *onscreen,
+                                  CoglFrameCallback callback,
+                                  void *user_data);
+
+/**
+ * cogl_onscreen_remove_frame_callback:
+ * @onscreen: A #CoglOnscreen framebuffer
+ * @id: An identifier returned from cogl_onscreen_add_frame_callback()
+ *
+ * Removes a callback that was previously registered using
+ * cogl_onscreen_add_frame_callback().
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_onscreen_remove_frame_callback (CoglOnscreen *onscreen,
+                                     unsigned int id);
+
+/**
+ * cogl_onscreen_schedule_frame:
+ * @onscreen: A #CoglOnscreen framebuffer
+ *
+ * Requests that the frame callbacks of @onscreen be called for a new
+ * frame. Instead of drawing as soon as possible Cogl waits until the
+ * latest moment that still leaves enough time to draw and present the
+ * frame before the next vblank. This minimizes the time between the
+ * application sampling its input and the result reaching the screen.
+ *
+ * The vblank times are predicted from the completion of previous
+ * swaps, so pacing works best when the
+ * %COGL_FEATURE_ID_SWAP_BUFFERS_EVENT feature is available, and the
+ * time needed for a frame is measured from previous frames.
+ *
+ * The wait is reflected in the timeout returned by
+ * cogl_poll_get_info() so the application's main loop, or a
+ * #GSource created with cogl_glib_source_new(), wakes up at the right
+ * time. The callbacks are then called from cogl_poll_dispatch().
+ * Calling this function again before the frame is drawn has no
+ * effect.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_onscreen_schedule_frame (CoglOnscreen *onscreen);
+
 G_END_DECLS
 
 #endif /* __COGL_ONSCREEN_H */
@@ -207,7 +207,9 @@ has_replace_hook (CoglPipelineLayer *layer,
 {
   CoglPipelineSnippet *snippet;
 
-  COGL_LIST_FOREACH (snippet, get_layer_fragment_snippets (layer), list_node)
+  COGL_LIST_FOREACH (snippet,
+                     &get_layer_fragment_snippets (layer)->entries,
+                     list_node)
     if (snippet->snippet->hook == hook && snippet->snippet->replace)
       return TRUE;
 
@@ -116,11 +116,13 @@ _cogl_pipeline_layer_has_alpha (CoglPipelineLayer *layer)
   /* All bets are off if the layer contains any snippets */
   snippets_authority = _cogl_pipeline_layer_get_authority
     (layer, COGL_PIPELINE_LAYER_STATE_VERTEX_SNIPPETS);
-  if (!COGL_LIST_EMPTY (&snippets_authority->big_state->vertex_snippets))
+  if (!COGL_LIST_EMPTY (&snippets_authority->big_state->
+                        vertex_snippets.entries))
     return TRUE;
   snippets_authority = _cogl_pipeline_layer_get_authority
     (layer, COGL_PIPELINE_LAYER_STATE_FRAGMENT_SNIPPETS);
-  if (!COGL_LIST_EMPTY (&snippets_authority->big_state->fragment_snippets))
+  if (!COGL_LIST_EMPTY (&snippets_authority->big_state->
+                        fragment_snippets.entries))
     return TRUE;
 
   return FALSE;
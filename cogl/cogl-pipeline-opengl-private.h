@@ -67,6 +67,14 @@ typedef struct _CoglTextureUnit
    * dirty_gl_texture == TRUE */
   GLenum             gl_target;
 
+  /* The GL sampler object bound to this unit when sampler objects
+   * are being used instead of per texture filters and wrap modes */
+  GLuint             gl_sampler;
+  /* The GL texture that was bound when gl_sampler was chosen. This
+   * is only used to count the texture parameter changes that the
+   * sampler saved */
+  GLuint             gl_sampler_texture;
+
   /* Foreign textures are those not created or deleted by Cogl. If we ever
    * call glBindTexture for a foreign texture then the next time we are
    * asked to glBindTexture we can't try and optimize a redundant state
@@ -37,6 +37,7 @@
 #include "cogl-context-private.h"
 #include "cogl-texture-private.h"
 #include "cogl-framebuffer-private.h"
+#include "cogl-profile.h"
 
 /* This is needed to set the color attribute on GLES2 */
 #ifdef HAVE_COGL_GLES2
@@ -57,6 +58,9 @@
 #ifndef GL_COORD_REPLACE
 #define GL_COORD_REPLACE 0x8862
 #endif
+#ifndef GL_TEXTURE_RECTANGLE_ARB
+#define GL_TEXTURE_RECTANGLE_ARB 0x84F5
+#endif
 #ifndef GL_CLAMP_TO_BORDER
 #define GL_CLAMP_TO_BORDER 0x812d
 #endif
@@ -69,6 +73,8 @@ texture_unit_init (CoglTextureUnit *unit, int index_)
   unit->enabled_gl_target = 0;
   unit->gl_texture = 0;
   unit->gl_target = 0;
+  unit->gl_sampler = 0;
+  unit->gl_sampler_texture = 0;
   unit->is_foreign = FALSE;
   unit->dirty_gl_texture = FALSE;
   unit->matrix_stack = _cogl_matrix_stack_new ();
@@ -891,6 +897,15 @@ _cogl_pipeline_flush_common_gl_state (CoglPipeline  *pipeline,
                                          &state);
 }
 
+static GLenum
+get_gl_wrap_mode (CoglPipelineWrapModeInternal wrap_mode)
+{
+  if (wrap_mode == COGL_PIPELINE_WRAP_MODE_INTERNAL_AUTOMATIC)
+    return GL_CLAMP_TO_EDGE;
+  else
+    return wrap_mode;
+}
+
 /* Re-assert the layer's wrap modes on the given CoglTexture.
  *
  * Note: we don't simply forward the wrap modes to layer->texture
@@ -901,7 +916,6 @@ _cogl_pipeline_layer_forward_wrap_modes (CoglPipelineLayer *layer,
                                          CoglTexture *texture)
 {
   CoglPipelineWrapModeInternal wrap_mode_s, wrap_mode_t, wrap_mode_p;
-  GLenum gl_wrap_mode_s, gl_wrap_mode_t, gl_wrap_mode_p;
 
   if (texture == NULL)
     return;
@@ -922,34 +936,92 @@ _cogl_pipeline_layer_forward_wrap_modes (CoglPipelineLayer *layer,
      will break if the application tries to use different modes in
      different layers using the same texture. */
 
-  if (wrap_mode_s == COGL_PIPELINE_WRAP_MODE_INTERNAL_AUTOMATIC)
-    gl_wrap_mode_s = GL_CLAMP_TO_EDGE;
-  else
-    gl_wrap_mode_s = wrap_mode_s;
+  _cogl_texture_set_wrap_mode_parameters (texture,
+                                          get_gl_wrap_mode (wrap_mode_s),
+                                          get_gl_wrap_mode (wrap_mode_t),
+                                          get_gl_wrap_mode (wrap_mode_p));
+}
 
-  if (wrap_mode_t == COGL_PIPELINE_WRAP_MODE_INTERNAL_AUTOMATIC)
-    gl_wrap_mode_t = GL_CLAMP_TO_EDGE;
-  else
-    gl_wrap_mode_t = wrap_mode_t;
+/* Binds a sampler object with the layer's filters and wrap modes to
+ * the texture unit. The sampler overrides the parameters of whichever
+ * texture is bound to the unit so the texture object's own state
+ * never needs to be touched. */
+static void
+_cogl_pipeline_layer_bind_sampler (CoglPipelineLayer *layer,
+                                   CoglTextureUnit *unit)
+{
+  const CoglSamplerCacheEntry *entry;
+  CoglPipelineFilter min, mag;
+  CoglPipelineWrapModeInternal wrap_mode_s, wrap_mode_t, wrap_mode_p;
 
-  if (wrap_mode_p == COGL_PIPELINE_WRAP_MODE_INTERNAL_AUTOMATIC)
-    gl_wrap_mode_p = GL_CLAMP_TO_EDGE;
-  else
-    gl_wrap_mode_p = wrap_mode_p;
+  COGL_STATIC_COUNTER (sampler_bind_counter,
+                       "Sampler object bind counter",
+                       "Increments each time a different sampler object "
+                       "is bound to a texture unit",
+                       0 /* no application private data */);
+  COGL_STATIC_COUNTER (skipped_tex_parameter_counter,
+                       "Skipped texture parameter updates counter",
+                       "Increments each time the same texture is used "
+                       "with different filters or wrap modes so that "
+                       "its parameters would otherwise have been set",
+                       0 /* no application private data */);
 
-  _cogl_texture_set_wrap_mode_parameters (texture,
-                                          gl_wrap_mode_s,
-                                          gl_wrap_mode_t,
-                                          gl_wrap_mode_p);
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  _cogl_pipeline_layer_get_filters (layer, &min, &mag);
+  _cogl_pipeline_layer_get_wrap_modes (layer,
+                                       &wrap_mode_s,
+                                       &wrap_mode_t,
+                                       &wrap_mode_p);
+
+  entry = _cogl_sampler_cache_get_entry (ctx->sampler_cache,
+                                         min, mag,
+                                         get_gl_wrap_mode (wrap_mode_s),
+                                         get_gl_wrap_mode (wrap_mode_t),
+                                         get_gl_wrap_mode (wrap_mode_p));
+
+  if (unit->gl_sampler != entry->sampler_object)
+    {
+      /* Without samplers the parameters of the texture object would
+       * only have been updated if the same texture is now used with
+       * different state */
+      if (unit->gl_sampler && unit->gl_sampler_texture == unit->gl_texture)
+        COGL_COUNTER_INC (_cogl_uprof_context, skipped_tex_parameter_counter);
+
+      GE( ctx, glBindSampler (unit->index, entry->sampler_object) );
+      unit->gl_sampler = entry->sampler_object;
+
+      COGL_COUNTER_INC (_cogl_uprof_context, sampler_bind_counter);
+    }
+
+  unit->gl_sampler_texture = unit->gl_texture;
+}
+
+/* Rectangle textures can't use mipmap filters or repeat wrap modes
+ * and the texture backend is what knows how to cope with that, so
+ * they always go through the texture object. Any sampler left bound
+ * to the unit would override that so it is unbound first. */
+static void
+_cogl_pipeline_layer_unbind_sampler (CoglTextureUnit *unit)
+{
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (unit->gl_sampler)
+    {
+      GE( ctx, glBindSampler (unit->index, 0) );
+      unit->gl_sampler = 0;
+    }
 }
 
 /* OpenGL associates the min/mag filters and repeat modes with the
- * texture object not the texture unit so we always have to re-assert
- * the filter and repeat modes whenever we use a texture since it may
- * be referenced by multiple pipelines with different modes.
+ * texture object not the texture unit so without sampler objects we
+ * always have to re-assert the filter and repeat modes whenever we
+ * use a texture since it may be referenced by multiple pipelines
+ * with different modes.
  *
- * XXX: GL_ARB_sampler_objects fixes this in OpenGL so we should
- * eventually look at using this extension when available.
+ * When GL_ARB_sampler_objects is available we instead bind a cached
+ * sampler object for each combination of filters and wrap modes to
+ * the unit so the texture parameters are left alone.
  */
 static void
 foreach_texture_unit_update_filter_and_wrap_modes (void)
@@ -967,11 +1039,20 @@ foreach_texture_unit_update_filter_and_wrap_modes (void)
         {
           CoglTexture *texture = _cogl_pipeline_layer_get_texture (unit->layer);
 
-          if (texture != NULL)
+          if (texture == NULL)
+            continue;
+
+          if (ctx->sampler_cache &&
+              unit->gl_target != GL_TEXTURE_RECTANGLE_ARB)
+            _cogl_pipeline_layer_bind_sampler (unit->layer, unit);
+          else
             {
               CoglPipelineFilter min;
               CoglPipelineFilter mag;
 
+              if (ctx->sampler_cache)
+                _cogl_pipeline_layer_unbind_sampler (unit);
+
               _cogl_pipeline_layer_get_filters (unit->layer, &min, &mag);
               _cogl_texture_set_filters (texture, min, mag);
 
@@ -1159,6 +1240,16 @@ _cogl_pipeline_flush_gl_state (CoglPipeline *pipeline,
                      "Material Flush",
                      "The time spent flushing material state",
                      0 /* no application private data */);
+  COGL_STATIC_COUNTER (pipeline_fast_flush_counter,
+                       "pipeline fast flush counter",
+                       "Increments each time a pipeline flush is skipped "
+                       "because the pipeline is already current",
+                       0 /* no application private data */);
+  COGL_STATIC_COUNTER (pipeline_full_flush_counter,
+                       "pipeline full flush counter",
+                       "Increments each time a pipeline flush has to "
+                       "compare and flush the pipeline state",
+                       0 /* no application private data */);
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
@@ -1170,7 +1261,10 @@ _cogl_pipeline_flush_gl_state (CoglPipeline *pipeline,
        * pipeline and we can see the pipeline hasn't changed */
       if (ctx->current_pipeline_age == pipeline->age &&
           ctx->current_pipeline_skip_gl_color == skip_gl_color)
-        goto done;
+        {
+          COGL_COUNTER_INC (_cogl_uprof_context, pipeline_fast_flush_counter);
+          goto done;
+        }
 
       pipelines_difference = ctx->current_pipeline_changes_since_flush;
     }
@@ -1184,6 +1278,8 @@ _cogl_pipeline_flush_gl_state (CoglPipeline *pipeline,
   else
     pipelines_difference = COGL_PIPELINE_STATE_ALL_SPARSE;
 
+  COGL_COUNTER_INC (_cogl_uprof_context, pipeline_full_flush_counter);
+
   /* Get a layer_differences mask for each layer to be flushed */
   n_layers = cogl_pipeline_get_n_layers (pipeline);
   if (n_layers)
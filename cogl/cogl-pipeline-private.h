@@ -690,6 +690,20 @@ _cogl_pipeline_prune_empty_layer_difference (CoglPipeline *layers_authority,
 gboolean
 _cogl_pipeline_get_real_blend_enabled (CoglPipeline *pipeline);
 
+/*
+ * _cogl_pipeline_is_opaque_occluder:
+ * @pipeline: A #CoglPipeline
+ *
+ * Checks whether drawing with @pipeline unconditionally overwrites
+ * the color of every fragment covered by the geometry so that
+ * anything drawn underneath it earlier would be completely hidden.
+ *
+ * Return value: %TRUE if geometry drawn with @pipeline hides
+ *   everything beneath it.
+ */
+gboolean
+_cogl_pipeline_is_opaque_occluder (CoglPipeline *pipeline);
+
 /*
  * Calls the pre_paint method on the layer texture if there is
  * one. This will determine whether mipmaps are needed based on the
@@ -33,7 +33,17 @@
 
 typedef struct _CoglPipelineSnippet CoglPipelineSnippet;
 
-COGL_LIST_HEAD (CoglPipelineSnippetList, CoglPipelineSnippet);
+COGL_LIST_HEAD (CoglPipelineSnippetEntries, CoglPipelineSnippet);
+
+typedef struct
+{
+  CoglPipelineSnippetEntries entries;
+
+  /* A hash of the interned ids of all the snippets in the list. This
+     is updated as snippets are added so that hashing a pipeline
+     doesn't need to walk the list */
+  unsigned int hash;
+} CoglPipelineSnippetList;
 
 struct _CoglPipelineSnippet
 {
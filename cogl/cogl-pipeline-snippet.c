@@ -44,11 +44,11 @@ _cogl_pipeline_snippet_generate_code (const CoglPipelineSnippetData *data)
   int snippet_num = 0;
   int n_snippets = 0;
 
-  first_snippet = COGL_LIST_FIRST (data->snippets);
+  first_snippet = COGL_LIST_FIRST (&data->snippets->entries);
 
   /* First count the number of snippets so we can easily tell when
      we're at the last one */
-  COGL_LIST_FOREACH (snippet, data->snippets, list_node)
+  COGL_LIST_FOREACH (snippet, &data->snippets->entries, list_node)
     if (snippet->snippet->hook == data->hook)
       {
         /* Don't bother processing any previous snippets if we reach
@@ -194,7 +194,7 @@ _cogl_pipeline_snippet_list_free (CoglPipelineSnippetList *list)
 {
   CoglPipelineSnippet *pipeline_snippet, *tmp;
 
-  COGL_LIST_FOREACH_SAFE (pipeline_snippet, list, list_node, tmp)
+  COGL_LIST_FOREACH_SAFE (pipeline_snippet, &list->entries, list_node, tmp)
     _cogl_pipeline_snippet_free (pipeline_snippet);
 }
 
@@ -208,18 +208,27 @@ _cogl_pipeline_snippet_list_add (CoglPipelineSnippetList *list,
 
   _cogl_snippet_make_immutable (pipeline_snippet->snippet);
 
-  if (COGL_LIST_EMPTY (list))
-    COGL_LIST_INSERT_HEAD (list, pipeline_snippet, list_node);
+  if (COGL_LIST_EMPTY (&list->entries))
+    {
+      COGL_LIST_INSERT_HEAD (&list->entries, pipeline_snippet, list_node);
+      list->hash = 0;
+    }
   else
     {
       CoglPipelineSnippet *tail;
 
-      for (tail = COGL_LIST_FIRST (list);
+      for (tail = COGL_LIST_FIRST (&list->entries);
            COGL_LIST_NEXT (tail, list_node);
            tail = COGL_LIST_NEXT (tail, list_node));
 
       COGL_LIST_INSERT_AFTER (tail, pipeline_snippet, list_node);
     }
+
+  /* Snippets are only ever appended so the hash can be accumulated
+     without looking at the rest of the list */
+  list->hash = _cogl_util_one_at_a_time_hash (list->hash,
+                                              &snippet->id,
+                                              sizeof (snippet->id));
 }
 
 void
@@ -229,9 +238,10 @@ _cogl_pipeline_snippet_list_copy (CoglPipelineSnippetList *dst,
   CoglPipelineSnippet *tail = NULL;
   const CoglPipelineSnippet *l;
 
-  COGL_LIST_INIT (dst);
+  COGL_LIST_INIT (&dst->entries);
+  dst->hash = src->hash;
 
-  COGL_LIST_FOREACH (l, src, list_node)
+  COGL_LIST_FOREACH (l, &src->entries, list_node)
     {
       CoglPipelineSnippet *copy = g_slice_dup (CoglPipelineSnippet, l);
 
@@ -240,7 +250,7 @@ _cogl_pipeline_snippet_list_copy (CoglPipelineSnippetList *dst,
       if (tail)
         COGL_LIST_INSERT_AFTER (tail, copy, list_node);
       else
-        COGL_LIST_INSERT_HEAD (dst, copy, list_node);
+        COGL_LIST_INSERT_HEAD (&dst->entries, copy, list_node);
 
       tail = copy;
     }
@@ -250,14 +260,9 @@ void
 _cogl_pipeline_snippet_list_hash (CoglPipelineSnippetList *list,
                                   unsigned int *hash)
 {
-  CoglPipelineSnippet *l;
-
-  COGL_LIST_FOREACH (l, list, list_node)
-    {
-      *hash = _cogl_util_one_at_a_time_hash (*hash,
-                                             &l->snippet,
-                                             sizeof (CoglSnippet *));
-    }
+  *hash = _cogl_util_one_at_a_time_hash (*hash,
+                                         &list->hash,
+                                         sizeof (unsigned int));
 }
 
 gboolean
@@ -266,10 +271,16 @@ _cogl_pipeline_snippet_list_equal (CoglPipelineSnippetList *list0,
 {
   CoglPipelineSnippet *l0, *l1;
 
-  for (l0 = COGL_LIST_FIRST (list0), l1 = COGL_LIST_FIRST (list1);
+  if (list0->hash != list1->hash)
+    return FALSE;
+
+  /* Snippets with the same source share an id so pipelines using
+     separately created but identical snippets can share programs */
+  for (l0 = COGL_LIST_FIRST (&list0->entries),
+         l1 = COGL_LIST_FIRST (&list1->entries);
        l0 && l1;
        l0 = COGL_LIST_NEXT (l0, list_node), l1 = COGL_LIST_NEXT (l1, list_node))
-    if (l0->snippet != l1->snippet)
+    if (l0->snippet->id != l1->snippet->id)
       return FALSE;
 
   return l0 == NULL && l1 == NULL;
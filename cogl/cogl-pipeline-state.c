@@ -1624,7 +1624,7 @@ _cogl_pipeline_has_non_layer_vertex_snippets (CoglPipeline *pipeline)
     _cogl_pipeline_get_authority (pipeline,
                                   COGL_PIPELINE_STATE_VERTEX_SNIPPETS);
 
-  return !COGL_LIST_EMPTY (&authority->big_state->vertex_snippets);
+  return !COGL_LIST_EMPTY (&authority->big_state->vertex_snippets.entries);
 }
 
 static gboolean
@@ -1636,7 +1636,7 @@ check_layer_has_vertex_snippet (CoglPipelineLayer *layer,
     _cogl_pipeline_layer_get_authority (layer, state);
   gboolean *found_vertex_snippet = user_data;
 
-  if (!COGL_LIST_EMPTY (&authority->big_state->vertex_snippets))
+  if (!COGL_LIST_EMPTY (&authority->big_state->vertex_snippets.entries))
     {
       *found_vertex_snippet = TRUE;
       return FALSE;
@@ -1667,7 +1667,7 @@ _cogl_pipeline_has_non_layer_fragment_snippets (CoglPipeline *pipeline)
     _cogl_pipeline_get_authority (pipeline,
                                   COGL_PIPELINE_STATE_FRAGMENT_SNIPPETS);
 
-  return !COGL_LIST_EMPTY (&authority->big_state->fragment_snippets);
+  return !COGL_LIST_EMPTY (&authority->big_state->fragment_snippets.entries);
 }
 
 static gboolean
@@ -1679,7 +1679,7 @@ check_layer_has_fragment_snippet (CoglPipelineLayer *layer,
     _cogl_pipeline_layer_get_authority (layer, state);
   gboolean *found_fragment_snippet = user_data;
 
-  if (!COGL_LIST_EMPTY (&authority->big_state->fragment_snippets))
+  if (!COGL_LIST_EMPTY (&authority->big_state->fragment_snippets.entries))
     {
       *found_fragment_snippet = TRUE;
       return FALSE;
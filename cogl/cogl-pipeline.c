@@ -445,8 +445,12 @@ destroy_weak_children_cb (CoglNode *node,
                                          destroy_weak_children_cb,
                                          NULL);
 
+      /* The callback usually drops the last reference on the weak
+       * pipeline so we need to keep it alive until it is unparented */
+      cogl_object_ref (pipeline);
       pipeline->destroy_callback (pipeline, pipeline->destroy_data);
       _cogl_pipeline_unparent (COGL_NODE (pipeline));
+      cogl_object_unref (pipeline);
     }
 
   return TRUE;
@@ -517,6 +521,72 @@ _cogl_pipeline_get_real_blend_enabled (CoglPipeline *pipeline)
   return pipeline->real_blend_enable;
 }
 
+static gboolean
+check_layer_has_no_fragment_snippets_cb (CoglPipelineLayer *layer,
+                                         void *user_data)
+{
+  CoglPipelineLayer *authority =
+    _cogl_pipeline_layer_get_authority (layer,
+                                        COGL_PIPELINE_LAYER_STATE_FRAGMENT_SNIPPETS);
+  gboolean *has_no_snippets = user_data;
+
+  if (!COGL_LIST_EMPTY (&authority->big_state->fragment_snippets.entries))
+    {
+      *has_no_snippets = FALSE;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+gboolean
+_cogl_pipeline_is_opaque_occluder (CoglPipeline *pipeline)
+{
+  CoglPipeline *authority;
+  gboolean has_no_snippets = TRUE;
+
+  /* The pipeline must replace the framebuffer color outright... */
+  if (pipeline->real_blend_enable)
+    return FALSE;
+
+  authority =
+    _cogl_pipeline_get_authority (pipeline, COGL_PIPELINE_STATE_LOGIC_OPS);
+  if (authority->big_state->logic_ops_state.color_mask != COGL_COLOR_MASK_ALL)
+    return FALSE;
+
+  /* ...for every fragment it touches. Anything that could reject
+   * fragments means the geometry might not actually cover what is
+   * underneath */
+  authority =
+    _cogl_pipeline_get_authority (pipeline, COGL_PIPELINE_STATE_ALPHA_FUNC);
+  if (authority->big_state->alpha_state.alpha_func !=
+      COGL_PIPELINE_ALPHA_FUNC_ALWAYS)
+    return FALSE;
+
+  authority =
+    _cogl_pipeline_get_authority (pipeline, COGL_PIPELINE_STATE_DEPTH);
+  if (authority->big_state->depth_state.test_enabled)
+    return FALSE;
+
+  /* User programs and snippets can discard fragments */
+  authority =
+    _cogl_pipeline_get_authority (pipeline, COGL_PIPELINE_STATE_USER_SHADER);
+  if (authority->big_state->user_program)
+    return FALSE;
+
+  authority =
+    _cogl_pipeline_get_authority (pipeline,
+                                  COGL_PIPELINE_STATE_FRAGMENT_SNIPPETS);
+  if (!COGL_LIST_EMPTY (&authority->big_state->fragment_snippets.entries))
+    return FALSE;
+
+  _cogl_pipeline_foreach_layer_internal (pipeline,
+                                         check_layer_has_no_fragment_snippets_cb,
+                                         &has_no_snippets);
+
+  return has_no_snippets;
+}
+
 static void
 _cogl_pipeline_update_layers_cache (CoglPipeline *pipeline)
 {
@@ -525,6 +595,12 @@ _cogl_pipeline_update_layers_cache (CoglPipeline *pipeline)
   CoglPipeline *current;
   int layers_found;
 
+  COGL_STATIC_COUNTER (layers_cache_rebuild_counter,
+                       "pipeline layers cache rebuild counter",
+                       "Increments each time the flattened array of "
+                       "layers for a pipeline has to be rebuilt",
+                       0 /* no application private data */);
+
   if (G_LIKELY (!pipeline->layers_cache_dirty) ||
       pipeline->n_layers == 0)
     return;
@@ -532,7 +608,7 @@ _cogl_pipeline_update_layers_cache (CoglPipeline *pipeline)
   pipeline->layers_cache_dirty = FALSE;
 
   n_layers = pipeline->n_layers;
-  if (G_LIKELY (n_layers < G_N_ELEMENTS (pipeline->short_layers_cache)))
+  if (G_LIKELY (n_layers <= G_N_ELEMENTS (pipeline->short_layers_cache)))
     {
       pipeline->layers_cache = pipeline->short_layers_cache;
       memset (pipeline->layers_cache, 0,
@@ -566,8 +642,17 @@ _cogl_pipeline_update_layers_cache (CoglPipeline *pipeline)
    * values in the range [0,n_layers-1]. As soon as a pointer is found
    * we ignore layers of further ancestors with the same ->unit_index
    * values.
+   *
+   * Walking all the way up to the root pipeline for every pipeline
+   * gets expensive with many layers and deep hierarchies, so as soon
+   * as we reach an ancestor that is itself a _LAYERS authority we
+   * make sure its cache is valid and take the remaining layers
+   * straight from its flattened array. That way sibling pipelines
+   * share the work of flattening their common ancestry.
    */
 
+  COGL_COUNTER_INC (_cogl_uprof_context, layers_cache_rebuild_counter);
+
   layers_found = 0;
   for (current = pipeline;
        _cogl_pipeline_get_parent (current);
@@ -578,6 +663,28 @@ _cogl_pipeline_update_layers_cache (CoglPipeline *pipeline)
       if (!(current->differences & COGL_PIPELINE_STATE_LAYERS))
         continue;
 
+      if (current != pipeline && current->n_layers > 0)
+        {
+          int n_shared = MIN (n_layers, current->n_layers);
+          int i;
+
+          _cogl_pipeline_update_layers_cache (current);
+
+          for (i = 0; i < n_shared; i++)
+            if (!pipeline->layers_cache[i])
+              {
+                pipeline->layers_cache[i] = current->layers_cache[i];
+                layers_found++;
+              }
+
+          if (layers_found == n_layers)
+            return;
+
+          /* Any layers with a higher unit index than the ancestor has
+           * must come from further up the hierarchy */
+          continue;
+        }
+
       for (l = current->layer_differences; l; l = l->next)
         {
           CoglPipelineLayer *layer = l->data;
@@ -1538,6 +1645,10 @@ _cogl_pipeline_prune_to_n_layers (CoglPipeline *pipeline, int n)
                                          update_prune_layers_info_cb,
                                          &state);
 
+  /* Iterating the layers may have rebuilt the cache for the old
+   * number of layers which would leave it the wrong size */
+  recursively_free_layer_caches (pipeline);
+
   pipeline->differences |= COGL_PIPELINE_STATE_LAYERS;
   pipeline->n_layers = n;
 
@@ -30,6 +30,37 @@
 #include "cogl-poll.h"
 #include "cogl-winsys-private.h"
 #include "cogl-context-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-onscreen-private.h"
+
+/* Reduces the timeout so that we wake up in time to start any
+ * frames scheduled with cogl_onscreen_schedule_frame() */
+static void
+update_timeout_for_frames (CoglContext *context,
+                           gint64 *timeout)
+{
+  gint64 now = g_get_monotonic_time ();
+  GList *l;
+
+  for (l = context->framebuffers; l; l = l->next)
+    {
+      CoglFramebuffer *framebuffer = l->data;
+      gint64 deadline, frame_timeout;
+
+      if (framebuffer->type != COGL_FRAMEBUFFER_TYPE_ONSCREEN)
+        continue;
+
+      deadline = _cogl_onscreen_get_frame_deadline (COGL_ONSCREEN (framebuffer),
+                                                    now);
+      if (deadline < 0)
+        continue;
+
+      frame_timeout = MAX (deadline - now, 0);
+
+      if (*timeout == -1 || frame_timeout < *timeout)
+        *timeout = frame_timeout;
+    }
+}
 
 void
 cogl_poll_get_info (CoglContext *context,
@@ -47,18 +78,21 @@ cogl_poll_get_info (CoglContext *context,
   winsys = _cogl_context_get_winsys (context);
 
   if (winsys->poll_get_info)
+    winsys->poll_get_info (context,
+                           poll_fds,
+                           n_poll_fds,
+                           timeout);
+  else
     {
-      winsys->poll_get_info (context,
-                             poll_fds,
-                             n_poll_fds,
-                             timeout);
-      return;
+      /* By default we'll assume Cogl doesn't need to block on anything */
+      *poll_fds = NULL;
+      *n_poll_fds = 0;
+      *timeout = -1; /* no timeout */
     }
 
-  /* By default we'll assume Cogl doesn't need to block on anything */
-  *poll_fds = NULL;
-  *n_poll_fds = 0;
-  *timeout = -1; /* no timeout */
+  update_timeout_for_frames (context, timeout);
+
+  _cogl_fence_poll_prepare (context, poll_fds, n_poll_fds, timeout);
 }
 
 void
@@ -67,6 +101,9 @@ cogl_poll_dispatch (CoglContext *context,
                     int n_poll_fds)
 {
   const CoglWinsysVtable *winsys;
+  GSList *due_onscreens = NULL, *l;
+  gint64 now;
+  GList *fl;
 
   _COGL_RETURN_IF_FAIL (cogl_is_context (context));
 
@@ -74,4 +111,33 @@ cogl_poll_dispatch (CoglContext *context,
 
   if (winsys->poll_dispatch)
     winsys->poll_dispatch (context, poll_fds, n_poll_fds);
+
+  _cogl_fence_poll_dispatch (context);
+
+  /* The frame callbacks can create or destroy framebuffers so we
+   * gather the onscreens that are due before calling any of them */
+  now = g_get_monotonic_time ();
+
+  for (fl = context->framebuffers; fl; fl = fl->next)
+    {
+      CoglFramebuffer *framebuffer = fl->data;
+      gint64 deadline;
+
+      if (framebuffer->type != COGL_FRAMEBUFFER_TYPE_ONSCREEN)
+        continue;
+
+      deadline = _cogl_onscreen_get_frame_deadline (COGL_ONSCREEN (framebuffer),
+                                                    now);
+      if (deadline >= 0 && deadline <= now)
+        due_onscreens = g_slist_prepend (due_onscreens,
+                                         cogl_object_ref (framebuffer));
+    }
+
+  for (l = due_onscreens; l; l = l->next)
+    {
+      _cogl_onscreen_dispatch_frame (l->data, now);
+      cogl_object_unref (l->data);
+    }
+
+  g_slist_free (due_onscreens);
 }
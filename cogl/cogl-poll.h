@@ -129,7 +129,9 @@ typedef struct {
  * @timeout will contain a maximum amount of time to wait in
  * microseconds before the application should wake up or -1 if the
  * application should wait indefinitely. This can also be 0 zero if
- * Cogl needs to be woken up immediately.
+ * Cogl needs to be woken up immediately. If a frame has been
+ * requested with cogl_onscreen_schedule_frame() then the timeout will
+ * expire when it is time to start drawing that frame.
  *
  * Stability: unstable
  * Since: 1.10
@@ -46,6 +46,11 @@ struct _CoglPrimitive
   CoglAttribute **attributes;
   int n_attributes;
 
+  /* Optional bounding box of the vertices given by the application
+     as the minimum x, y and z followed by the maximum */
+  gboolean has_bounds;
+  float bounds[6];
+
   int n_embedded_attributes;
   CoglAttribute *embedded_attribute;
 };
@@ -58,6 +58,7 @@ cogl_primitive_new_with_attributes (CoglVerticesMode mode,
   primitive->n_vertices = n_vertices;
   primitive->indices = NULL;
   primitive->immutable_ref = 0;
+  primitive->has_bounds = FALSE;
 
   primitive->n_attributes = n_attributes;
   primitive->n_embedded_attributes = n_attributes;
@@ -448,6 +449,9 @@ cogl_primitive_set_attributes (CoglPrimitive *primitive,
           sizeof (CoglAttribute *) * n_attributes);
 
   primitive->n_attributes = n_attributes;
+
+  /* The bounds were for the old vertices */
+  primitive->has_bounds = FALSE;
 }
 
 int
@@ -540,6 +544,34 @@ cogl_primitive_get_indices (CoglPrimitive *primitive)
   return primitive->indices;
 }
 
+void
+cogl_primitive_set_bounds (CoglPrimitive *primitive,
+                           float min_x,
+                           float min_y,
+                           float min_z,
+                           float max_x,
+                           float max_y,
+                           float max_z)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_primitive (primitive));
+
+  primitive->has_bounds = TRUE;
+  primitive->bounds[0] = min_x;
+  primitive->bounds[1] = min_y;
+  primitive->bounds[2] = min_z;
+  primitive->bounds[3] = max_x;
+  primitive->bounds[4] = max_y;
+  primitive->bounds[5] = max_z;
+}
+
+void
+cogl_primitive_clear_bounds (CoglPrimitive *primitive)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_primitive (primitive));
+
+  primitive->has_bounds = FALSE;
+}
+
 CoglPrimitive *
 cogl_primitive_copy (CoglPrimitive *primitive)
 {
@@ -553,6 +585,9 @@ cogl_primitive_copy (CoglPrimitive *primitive)
   cogl_primitive_set_indices (copy, primitive->indices, primitive->n_vertices);
   cogl_primitive_set_first_vertex (copy, primitive->first_vertex);
 
+  copy->has_bounds = primitive->has_bounds;
+  memcpy (copy->bounds, primitive->bounds, sizeof (primitive->bounds));
+
   return copy;
 }
 
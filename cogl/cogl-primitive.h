@@ -803,6 +803,54 @@ cogl_primitive_set_indices (CoglPrimitive *primitive,
 CoglIndices *
 cogl_primitive_get_indices (CoglPrimitive *primitive);
 
+/**
+ * cogl_primitive_set_bounds:
+ * @primitive: A #CoglPrimitive
+ * @min_x: The minimum x coordinate of any vertex
+ * @min_y: The minimum y coordinate of any vertex
+ * @min_z: The minimum z coordinate of any vertex
+ * @max_x: The maximum x coordinate of any vertex
+ * @max_y: The maximum y coordinate of any vertex
+ * @max_z: The maximum z coordinate of any vertex
+ *
+ * Tells Cogl the axis aligned box that contains all of the vertices
+ * of @primitive in model coordinates. When the primitive is drawn
+ * Cogl will transform the box with the current modelview and
+ * projection matrices and skip drawing altogether if it lies outside
+ * of the viewport or the current clip. This avoids the cost of
+ * flushing the state for primitives that wouldn't be visible, such as
+ * items that have been scrolled out of view.
+ *
+ * Cogl can't verify the bounds so they must cover everything that
+ * would be drawn, including any displacement done by a vertex shader
+ * or snippet. The bounds are cleared if the attributes of @primitive
+ * are replaced with cogl_primitive_set_attributes().
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_primitive_set_bounds (CoglPrimitive *primitive,
+                           float min_x,
+                           float min_y,
+                           float min_z,
+                           float max_x,
+                           float max_y,
+                           float max_z);
+
+/**
+ * cogl_primitive_clear_bounds:
+ * @primitive: A #CoglPrimitive
+ *
+ * Removes any bounds that were set with cogl_primitive_set_bounds()
+ * so that @primitive is always drawn.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_primitive_clear_bounds (CoglPrimitive *primitive);
+
 /**
  * cogl_primitive_copy:
  * @primitive: A primitive copy
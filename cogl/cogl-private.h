@@ -42,6 +42,25 @@ _cogl_check_extension (const char *name, const char *ext);
 void
 _cogl_clear (const CoglColor *color, unsigned long buffers);
 
+/*
+ * _cogl_read_pixels_from_gl:
+ * @source_format: The format of the buffer bound for reading. Only
+ *   the premultiplied state is used
+ *
+ * Reads a region from the currently bound GL read buffer and converts
+ * it to @format. Unlike _cogl_read_pixels_with_rowstride() this
+ * doesn't flush any state, bind anything or flip the image.
+ */
+void
+_cogl_read_pixels_from_gl (int x,
+                           int y,
+                           int width,
+                           int height,
+                           CoglPixelFormat source_format,
+                           CoglPixelFormat format,
+                           guint8 *pixels,
+                           int rowstride);
+
 void
 _cogl_read_pixels_with_rowstride (int x,
                                   int y,
@@ -0,0 +1,64 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef __COGL_SAMPLER_CACHE_PRIVATE_H
+#define __COGL_SAMPLER_CACHE_PRIVATE_H
+
+#include "cogl.h"
+
+#include <glib.h>
+
+typedef struct _CoglSamplerCache CoglSamplerCache;
+
+typedef struct _CoglSamplerCacheEntry
+{
+  GLenum min_filter;
+  GLenum mag_filter;
+
+  GLenum wrap_mode_s;
+  GLenum wrap_mode_t;
+  GLenum wrap_mode_p;
+
+  GLuint sampler_object;
+} CoglSamplerCacheEntry;
+
+CoglSamplerCache *
+_cogl_sampler_cache_new (CoglContext *context);
+
+/*
+ * Gets the sampler object that has the given GL filters and wrap
+ * modes, creating it the first time the combination is used. The
+ * returned entry stays valid until the cache is freed.
+ */
+const CoglSamplerCacheEntry *
+_cogl_sampler_cache_get_entry (CoglSamplerCache *cache,
+                               GLenum min_filter,
+                               GLenum mag_filter,
+                               GLenum wrap_mode_s,
+                               GLenum wrap_mode_t,
+                               GLenum wrap_mode_p);
+
+void
+_cogl_sampler_cache_free (CoglSamplerCache *cache);
+
+#endif /* __COGL_SAMPLER_CACHE_PRIVATE_H */
@@ -0,0 +1,162 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cogl-sampler-cache-private.h"
+#include "cogl-context-private.h"
+#include "cogl-util.h"
+
+#ifndef GL_TEXTURE_WRAP_R
+#define GL_TEXTURE_WRAP_R 0x8072
+#endif
+
+struct _CoglSamplerCache
+{
+  CoglContext *context;
+
+  /* Maps from a CoglSamplerCacheEntry (using only the filter and wrap
+   * mode members as the key) to the same entry */
+  GHashTable *hash_table;
+};
+
+static unsigned int
+hash_sampler_cache_entry (const void *data)
+{
+  CoglSamplerCacheEntry *entry = (CoglSamplerCacheEntry *) data;
+  unsigned int hash = 0;
+
+  hash = _cogl_util_one_at_a_time_hash (hash, &entry->min_filter,
+                                        sizeof (entry->min_filter));
+  hash = _cogl_util_one_at_a_time_hash (hash, &entry->mag_filter,
+                                        sizeof (entry->mag_filter));
+  hash = _cogl_util_one_at_a_time_hash (hash, &entry->wrap_mode_s,
+                                        sizeof (entry->wrap_mode_s));
+  hash = _cogl_util_one_at_a_time_hash (hash, &entry->wrap_mode_t,
+                                        sizeof (entry->wrap_mode_t));
+  hash = _cogl_util_one_at_a_time_hash (hash, &entry->wrap_mode_p,
+                                        sizeof (entry->wrap_mode_p));
+
+  return _cogl_util_one_at_a_time_mix (hash);
+}
+
+static gboolean
+sampler_cache_entry_equal (const void *value0,
+                           const void *value1)
+{
+  const CoglSamplerCacheEntry *entry0 = value0;
+  const CoglSamplerCacheEntry *entry1 = value1;
+
+  return (entry0->min_filter == entry1->min_filter &&
+          entry0->mag_filter == entry1->mag_filter &&
+          entry0->wrap_mode_s == entry1->wrap_mode_s &&
+          entry0->wrap_mode_t == entry1->wrap_mode_t &&
+          entry0->wrap_mode_p == entry1->wrap_mode_p);
+}
+
+CoglSamplerCache *
+_cogl_sampler_cache_new (CoglContext *context)
+{
+  CoglSamplerCache *cache = g_new (CoglSamplerCache, 1);
+
+  cache->context = context;
+  cache->hash_table = g_hash_table_new (hash_sampler_cache_entry,
+                                        sampler_cache_entry_equal);
+
+  return cache;
+}
+
+const CoglSamplerCacheEntry *
+_cogl_sampler_cache_get_entry (CoglSamplerCache *cache,
+                               GLenum min_filter,
+                               GLenum mag_filter,
+                               GLenum wrap_mode_s,
+                               GLenum wrap_mode_t,
+                               GLenum wrap_mode_p)
+{
+  CoglContext *context = cache->context;
+  CoglSamplerCacheEntry key, *entry;
+
+  key.min_filter = min_filter;
+  key.mag_filter = mag_filter;
+  key.wrap_mode_s = wrap_mode_s;
+  key.wrap_mode_t = wrap_mode_t;
+  key.wrap_mode_p = wrap_mode_p;
+
+  entry = g_hash_table_lookup (cache->hash_table, &key);
+
+  if (entry == NULL)
+    {
+      entry = g_slice_dup (CoglSamplerCacheEntry, &key);
+
+      GE( context, glGenSamplers (1, &entry->sampler_object) );
+
+      GE( context, glSamplerParameteri (entry->sampler_object,
+                                        GL_TEXTURE_MIN_FILTER,
+                                        min_filter) );
+      GE( context, glSamplerParameteri (entry->sampler_object,
+                                        GL_TEXTURE_MAG_FILTER,
+                                        mag_filter) );
+      GE( context, glSamplerParameteri (entry->sampler_object,
+                                        GL_TEXTURE_WRAP_S,
+                                        wrap_mode_s) );
+      GE( context, glSamplerParameteri (entry->sampler_object,
+                                        GL_TEXTURE_WRAP_T,
+                                        wrap_mode_t) );
+      GE( context, glSamplerParameteri (entry->sampler_object,
+                                        GL_TEXTURE_WRAP_R,
+                                        wrap_mode_p) );
+
+      g_hash_table_insert (cache->hash_table, entry, entry);
+    }
+
+  return entry;
+}
+
+static void
+hash_table_free_entry_cb (void *key,
+                          void *value,
+                          void *user_data)
+{
+  CoglContext *context = user_data;
+  CoglSamplerCacheEntry *entry = value;
+
+  GE( context, glDeleteSamplers (1, &entry->sampler_object) );
+
+  g_slice_free (CoglSamplerCacheEntry, entry);
+}
+
+void
+_cogl_sampler_cache_free (CoglSamplerCache *cache)
+{
+  g_hash_table_foreach (cache->hash_table,
+                        hash_table_free_entry_cb,
+                        cache->context);
+
+  g_hash_table_destroy (cache->hash_table);
+
+  g_free (cache);
+}
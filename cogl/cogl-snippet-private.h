@@ -32,6 +32,7 @@
 
 #include "cogl-snippet.h"
 #include "cogl-object-private.h"
+#include "cogl-context.h"
 
 /* These values are also used in the enum for CoglSnippetHook. They
    are copied here because we don't really want these names to be part
@@ -58,6 +59,17 @@ struct _CoglSnippet
      ignored. */
   gboolean immutable;
 
+  /* Once the snippet is immutable it is interned so that snippets
+     with identical source code share the same id. The id can then be
+     compared instead of the source when checking whether two
+     pipelines would generate the same program. */
+  unsigned int hash;
+  unsigned int id;
+  /* The context whose table uses this snippet as the key for its
+     source or NULL if another snippet with the same source was
+     interned first */
+  CoglContext *interned_context;
+
   char *declarations;
   char *pre;
   char *replace;
@@ -67,5 +79,23 @@ struct _CoglSnippet
 void
 _cogl_snippet_make_immutable (CoglSnippet *snippet);
 
+/*
+ * _cogl_snippet_destroy_table:
+ * @context: A #CoglContext
+ *
+ * Destroys the table of interned snippets of @context. Snippets that
+ * are still alive are detached from the context so they won't try to
+ * remove themselves from the table when they are freed.
+ */
+void
+_cogl_snippet_destroy_table (CoglContext *context);
+
+unsigned int
+_cogl_snippet_hash (const void *snippet);
+
+gboolean
+_cogl_snippet_equal (const void *snippet0,
+                     const void *snippet1);
+
 #endif /* __COGL_SNIPPET_PRIVATE_H */
 
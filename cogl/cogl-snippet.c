@@ -29,7 +29,10 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include "cogl-snippet-private.h"
+#include "cogl-context-private.h"
 #include "cogl-util.h"
 
 static void
@@ -161,15 +164,105 @@ cogl_snippet_get_post (CoglSnippet *snippet)
   return snippet->post;
 }
 
+static unsigned int
+hash_string (unsigned int hash,
+             const char *string)
+{
+  /* The terminator is included so that a NULL string and an empty
+     string hash differently from the string that follows */
+  if (string)
+    return _cogl_util_one_at_a_time_hash (hash,
+                                          (void *) string,
+                                          strlen (string) + 1);
+  else
+    return _cogl_util_one_at_a_time_hash (hash, &string, sizeof (string));
+}
+
+unsigned int
+_cogl_snippet_hash (const void *key)
+{
+  const CoglSnippet *snippet = key;
+
+  return snippet->hash;
+}
+
+gboolean
+_cogl_snippet_equal (const void *key0,
+                     const void *key1)
+{
+  const CoglSnippet *snippet0 = key0;
+  const CoglSnippet *snippet1 = key1;
+
+  return (snippet0->hook == snippet1->hook &&
+          g_strcmp0 (snippet0->declarations, snippet1->declarations) == 0 &&
+          g_strcmp0 (snippet0->pre, snippet1->pre) == 0 &&
+          g_strcmp0 (snippet0->replace, snippet1->replace) == 0 &&
+          g_strcmp0 (snippet0->post, snippet1->post) == 0);
+}
+
 void
 _cogl_snippet_make_immutable (CoglSnippet *snippet)
 {
+  CoglSnippet *interned;
+  unsigned int hash = 0;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (snippet->immutable)
+    return;
+
   snippet->immutable = TRUE;
+
+  hash = _cogl_util_one_at_a_time_hash (hash,
+                                        &snippet->hook,
+                                        sizeof (snippet->hook));
+  hash = hash_string (hash, snippet->declarations);
+  hash = hash_string (hash, snippet->pre);
+  hash = hash_string (hash, snippet->replace);
+  hash = hash_string (hash, snippet->post);
+  snippet->hash = _cogl_util_one_at_a_time_mix (hash);
+
+  /* The table doesn't hold a reference on the snippets. The first
+     snippet with a given source is used as the key until it is
+     destroyed */
+  interned = g_hash_table_lookup (ctx->snippet_table, snippet);
+
+  if (interned)
+    snippet->id = interned->id;
+  else
+    {
+      snippet->id = ctx->next_snippet_id++;
+      snippet->interned_context = ctx;
+      g_hash_table_insert (ctx->snippet_table, snippet, snippet);
+    }
+}
+
+static void
+detach_snippet_cb (void *key,
+                   void *value,
+                   void *user_data)
+{
+  CoglSnippet *snippet = value;
+
+  snippet->interned_context = NULL;
+}
+
+void
+_cogl_snippet_destroy_table (CoglContext *context)
+{
+  g_hash_table_foreach (context->snippet_table, detach_snippet_cb, NULL);
+  g_hash_table_destroy (context->snippet_table);
 }
 
 static void
 _cogl_snippet_free (CoglSnippet *snippet)
 {
+  /* If the snippet is the key for its source then the next snippet
+     with the same source will get a new id. Snippets that outlive
+     their context have already been detached from it */
+  if (snippet->interned_context)
+    g_hash_table_remove (snippet->interned_context->snippet_table, snippet);
+
   g_free (snippet->declarations);
   g_free (snippet->pre);
   g_free (snippet->replace);
@@ -175,4 +175,134 @@ _cogl_span_iter_end (CoglSpanIter *iter)
   return iter->pos >= iter->cover_end;
 }
 
+/* When planning power-of-two slices, each extra slice along an axis
+   is considered to cost as much as this many wasted pixels along
+   that axis. Slices aren't free because each one splits the geometry
+   and the batching */
+#define COGL_TEXTURE_SLICE_COST 32
 
+int
+_cogl_rect_slices_for_size (int     size_to_fill,
+                            int     max_span_size,
+                            int     max_waste,
+                            GArray *out_spans)
+{
+  int       n_spans = 0;
+  CoglSpan  span;
+
+  /* Init first slice span */
+  span.start = 0;
+  span.size = max_span_size;
+  span.waste = 0;
+
+  /* Repeat until whole area covered */
+  while (size_to_fill >= span.size)
+    {
+      /* Add another slice span of same size */
+      if (out_spans)
+        g_array_append_val (out_spans, span);
+      span.start   += span.size;
+      size_to_fill -= span.size;
+      n_spans++;
+    }
+
+  /* Add one last smaller slice span */
+  if (size_to_fill > 0)
+    {
+      span.size = size_to_fill;
+      if (out_spans)
+        g_array_append_val (out_spans, span);
+      n_spans++;
+    }
+
+  return n_spans;
+}
+
+int
+_cogl_pot_slices_for_size (int    size_to_fill,
+                           int    max_span_size,
+                           int    max_waste,
+                           GArray *out_spans)
+{
+  int      n_spans = 0;
+  CoglSpan span;
+  int      best_unit = 1;
+  int      best_cost = G_MAXINT;
+  int      high, low, unit;
+
+  /* Init first slice span */
+  span.start = 0;
+  span.size = max_span_size;
+  span.waste = 0;
+
+  /* Fix invalid max_waste */
+  if (max_waste < 0)
+    max_waste = 0;
+
+  /* Cover as much as possible with spans of the largest size */
+  while (size_to_fill > max_span_size)
+    {
+      if (out_spans)
+        g_array_append_val (out_spans, span);
+
+      span.start   += span.size;
+      size_to_fill -= span.size;
+      n_spans++;
+    }
+
+  /* The remainder can be covered exactly by one span for each bit
+     that is set in its size but that may need a lot of slices. For
+     each power of two 'unit' we instead consider using exact spans
+     for the bits above the unit and rounding the rest up to a single
+     span of the unit size. The plan with the lowest combined cost of
+     waste and slices is chosen. A unit of 1 always has no waste so
+     there is always a valid plan */
+  for (unit = 1; unit <= max_span_size; unit *= 2)
+    {
+      int waste, cost;
+
+      low = size_to_fill & (unit - 1);
+      high = size_to_fill - low;
+      waste = low ? unit - low : 0;
+
+      if (waste > max_waste)
+        continue;
+
+      cost = (waste +
+              (_cogl_util_popcountl (high) + (low ? 1 : 0)) *
+              COGL_TEXTURE_SLICE_COST);
+
+      if (cost < best_cost)
+        {
+          best_cost = cost;
+          best_unit = unit;
+        }
+    }
+
+  low = size_to_fill & (best_unit - 1);
+  high = size_to_fill - low;
+
+  /* Add the exact spans from largest to smallest */
+  for (unit = max_span_size; unit > 0; unit /= 2)
+    if ((high & unit))
+      {
+        span.size = unit;
+        if (out_spans)
+          g_array_append_val (out_spans, span);
+        span.start += span.size;
+        n_spans++;
+      }
+
+  /* Round the rest up to a span of the unit size. Only the last span
+     can have waste */
+  if (low)
+    {
+      span.size = best_unit;
+      span.waste = best_unit - low;
+      if (out_spans)
+        g_array_append_val (out_spans, span);
+      n_spans++;
+    }
+
+  return n_spans;
+}
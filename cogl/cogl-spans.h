@@ -71,4 +71,22 @@ _cogl_span_iter_next (CoglSpanIter *iter);
 gboolean
 _cogl_span_iter_end (CoglSpanIter *iter);
 
+/* These fill @out_spans with spans covering @size_to_fill texels that
+ * are no bigger than @max_span_size and return the number of spans.
+ * @out_spans can be NULL to just count them. The rect variant is for
+ * when NPOT textures are available so it never wastes anything. The
+ * pot variant only creates power-of-two spans and puts up to
+ * @max_waste texels of waste in the last one */
+int
+_cogl_rect_slices_for_size (int     size_to_fill,
+                            int     max_span_size,
+                            int     max_waste,
+                            GArray *out_spans);
+
+int
+_cogl_pot_slices_for_size (int    size_to_fill,
+                           int    max_span_size,
+                           int    max_waste,
+                           GArray *out_spans);
+
 #endif /* __COGL_SPANS_PRIVATE_H */
@@ -0,0 +1,115 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef __COGL_SPARSE_TEXTURE_PRIVATE_H
+#define __COGL_SPARSE_TEXTURE_PRIVATE_H
+
+#include "cogl-texture-private.h"
+#include "cogl-texture-2d.h"
+#include "cogl-sparse-texture.h"
+#include "cogl-meta-texture.h"
+
+/* Each tile is stored in the cache texture with a border of this
+ * many pixels copied from the neighbouring tiles so that linear
+ * filtering doesn't sample from an unrelated tile */
+#define COGL_SPARSE_TEXTURE_TILE_BORDER 1
+
+typedef struct
+{
+  /* The index of the tile stored in this slot or -1 if it is free */
+  int tile;
+  /* The value of the use counter of the texture when the slot was
+   * last handed out */
+  unsigned int last_used;
+} CoglSparseTextureSlot;
+
+struct _CoglSparseTexture
+{
+  CoglTexture _parent;
+
+  CoglContext *context;
+
+  int width;
+  int height;
+  CoglPixelFormat format;
+  int tile_size;
+  int n_tiles_x;
+  int n_tiles_y;
+
+  /* All of the resident tiles are stored in this texture in a grid of
+   * slots */
+  CoglTexture2D *cache_texture;
+  int n_slots;
+  int n_slots_x;
+  CoglSparseTextureSlot *slots;
+
+  /* Maps each tile index to the slot that it is stored in or -1 */
+  int *tile_slots;
+
+  /* Scratch space to assemble a tile and its border before
+   * uploading */
+  guint8 *tile_buffer;
+
+  CoglSparseTextureTileCallback callback;
+  void *user_data;
+  CoglUserDataDestroyCallback destroy;
+
+  unsigned int use_counter;
+  /* The value of use_counter when the journals were last flushed. A
+   * slot that was used after this may still be referenced by batched
+   * drawing */
+  unsigned int flush_counter;
+
+  unsigned int n_hits;
+  unsigned int n_misses;
+};
+
+/*
+ * _cogl_sparse_texture_foreach_in_region:
+ * @texture: A #CoglSparseTexture
+ * @tx_1: The left edge of the region in texels
+ * @ty_1: The top edge of the region in texels
+ * @tx_2: The right edge of the region in texels
+ * @ty_2: The bottom edge of the region in texels
+ * @callback: The callback to call for each part of a tile
+ * @user_data: Private data to pass to @callback
+ *
+ * Iterates the tiles covering the given region, loading any that
+ * aren't resident, and repeating the texture if the region extends
+ * outside of it. The meta coordinates passed to @callback are in
+ * texels and the sub-texture coordinates are normalized coordinates
+ * within the cache texture. This is used by
+ * cogl_meta_texture_foreach_in_region() instead of the generic
+ * repeating code so that only the visible tiles are loaded.
+ */
+void
+_cogl_sparse_texture_foreach_in_region (CoglSparseTexture *texture,
+                                        float tx_1,
+                                        float ty_1,
+                                        float tx_2,
+                                        float ty_2,
+                                        CoglMetaTextureCallback callback,
+                                        void *user_data);
+
+#endif /* __COGL_SPARSE_TEXTURE_PRIVATE_H */
@@ -0,0 +1,746 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cogl.h"
+#include "cogl-internal.h"
+#include "cogl-util.h"
+#include "cogl-texture-private.h"
+#include "cogl-sparse-texture-private.h"
+#include "cogl-context-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-handle.h"
+#include "cogl-profile.h"
+
+#include <string.h>
+#include <math.h>
+
+static void _cogl_sparse_texture_free (CoglSparseTexture *sparse_tex);
+
+COGL_TEXTURE_DEFINE (SparseTexture, sparse_texture);
+
+static const CoglTextureVtable cogl_sparse_texture_vtable;
+
+typedef struct
+{
+  const guint8 *data;
+  int rowstride;
+  int bpp;
+} CoglSparseTextureDataSource;
+
+/* A part of a tile along one axis */
+typedef struct
+{
+  int tile;
+  /* The position of the part in the coordinates of the region */
+  float start;
+  float end;
+  /* The position of the part relative to the start of the tile */
+  float tile_start;
+  float tile_end;
+} CoglSparseTextureSegment;
+
+static void
+_cogl_sparse_texture_free (CoglSparseTexture *sparse_tex)
+{
+  cogl_object_unref (sparse_tex->cache_texture);
+
+  g_free (sparse_tex->slots);
+  g_free (sparse_tex->tile_slots);
+  g_free (sparse_tex->tile_buffer);
+
+  if (sparse_tex->destroy)
+    sparse_tex->destroy (sparse_tex->user_data);
+
+  /* Chain up */
+  _cogl_texture_free (COGL_TEXTURE (sparse_tex));
+}
+
+/* Finds the slot to load a new tile into. Either a free slot is used
+ * or the one that was used the longest time ago is replaced */
+static int
+_cogl_sparse_texture_find_slot (CoglSparseTexture *sparse_tex)
+{
+  CoglSparseTextureSlot *slots = sparse_tex->slots;
+  int best = 0;
+  int i;
+
+  for (i = 0; i < sparse_tex->n_slots; i++)
+    {
+      if (slots[i].tile == -1)
+        return i;
+
+      if (slots[i].last_used < slots[best].last_used)
+        best = i;
+    }
+
+  /* If the slot has been drawn with since the journals were last
+   * flushed then batched drawing may still be sampling from it so it
+   * must be finished before the contents are replaced */
+  if (slots[best].last_used > sparse_tex->flush_counter)
+    {
+      GList *l;
+
+      for (l = sparse_tex->context->framebuffers; l; l = l->next)
+        _cogl_framebuffer_flush_journal (l->data);
+
+      sparse_tex->flush_counter = sparse_tex->use_counter;
+    }
+
+  sparse_tex->tile_slots[slots[best].tile] = -1;
+  slots[best].tile = -1;
+
+  return best;
+}
+
+static void
+_cogl_sparse_texture_load_tile (CoglSparseTexture *sparse_tex,
+                                int tile,
+                                int slot)
+{
+  int border = COGL_SPARSE_TEXTURE_TILE_BORDER;
+  int tile_x = (tile % sparse_tex->n_tiles_x) * sparse_tex->tile_size;
+  int tile_y = (tile / sparse_tex->n_tiles_x) * sparse_tex->tile_size;
+  int tile_width = MIN (sparse_tex->tile_size, sparse_tex->width - tile_x);
+  int tile_height = MIN (sparse_tex->tile_size, sparse_tex->height - tile_y);
+  int buffer_width = tile_width + border * 2;
+  int buffer_height = tile_height + border * 2;
+  int slot_size = sparse_tex->tile_size + border * 2;
+  int bpp = _cogl_get_format_bpp (sparse_tex->format);
+  int rowstride = slot_size * bpp;
+  guint8 *buffer = sparse_tex->tile_buffer;
+  int src_x1, src_y1, src_x2, src_y2;
+  int offset_x, offset_y;
+  int x, y;
+
+  /* The border is fetched from the neighbouring tiles except at the
+   * edges of the image where the edge pixels are repeated instead */
+  src_x1 = MAX (0, tile_x - border);
+  src_y1 = MAX (0, tile_y - border);
+  src_x2 = MIN (sparse_tex->width, tile_x + tile_width + border);
+  src_y2 = MIN (sparse_tex->height, tile_y + tile_height + border);
+  offset_x = src_x1 - (tile_x - border);
+  offset_y = src_y1 - (tile_y - border);
+
+  sparse_tex->callback (sparse_tex,
+                        src_x1, src_y1,
+                        src_x2 - src_x1, src_y2 - src_y1,
+                        buffer + offset_y * rowstride + offset_x * bpp,
+                        rowstride,
+                        sparse_tex->user_data);
+
+  for (y = offset_y; y < offset_y + src_y2 - src_y1; y++)
+    {
+      guint8 *row = buffer + y * rowstride;
+
+      for (x = 0; x < offset_x; x++)
+        memcpy (row + x * bpp, row + offset_x * bpp, bpp);
+      for (x = offset_x + src_x2 - src_x1; x < buffer_width; x++)
+        memcpy (row + x * bpp, row + (x - 1) * bpp, bpp);
+    }
+
+  for (y = 0; y < offset_y; y++)
+    memcpy (buffer + y * rowstride,
+            buffer + offset_y * rowstride,
+            buffer_width * bpp);
+  for (y = offset_y + src_y2 - src_y1; y < buffer_height; y++)
+    memcpy (buffer + y * rowstride,
+            buffer + (y - 1) * rowstride,
+            buffer_width * bpp);
+
+  cogl_texture_set_region (COGL_TEXTURE (sparse_tex->cache_texture),
+                           0, 0, /* src_x/y */
+                           (slot % sparse_tex->n_slots_x) * slot_size,
+                           (slot / sparse_tex->n_slots_x) * slot_size,
+                           buffer_width, buffer_height,
+                           buffer_width, buffer_height,
+                           sparse_tex->format,
+                           rowstride,
+                           buffer);
+
+  sparse_tex->slots[slot].tile = tile;
+  sparse_tex->tile_slots[tile] = slot;
+}
+
+/* Returns the slot containing the given tile, loading it first if
+ * it isn't resident */
+static int
+_cogl_sparse_texture_get_slot (CoglSparseTexture *sparse_tex,
+                               int tile)
+{
+  int slot = sparse_tex->tile_slots[tile];
+
+  COGL_STATIC_COUNTER (sparse_texture_hit_counter,
+                       "Sparse texture tile hit counter",
+                       "Increments each time a tile of a sparse texture "
+                       "is drawn from the cache",
+                       0 /* no application private data */);
+  COGL_STATIC_COUNTER (sparse_texture_miss_counter,
+                       "Sparse texture tile miss counter",
+                       "Increments each time a tile of a sparse texture "
+                       "has to be loaded into the cache",
+                       0 /* no application private data */);
+
+  if (slot == -1)
+    {
+      COGL_COUNTER_INC (_cogl_uprof_context, sparse_texture_miss_counter);
+      sparse_tex->n_misses++;
+
+      slot = _cogl_sparse_texture_find_slot (sparse_tex);
+      _cogl_sparse_texture_load_tile (sparse_tex, tile, slot);
+    }
+  else
+    {
+      COGL_COUNTER_INC (_cogl_uprof_context, sparse_texture_hit_counter);
+      sparse_tex->n_hits++;
+    }
+
+  sparse_tex->slots[slot].last_used = ++sparse_tex->use_counter;
+
+  return slot;
+}
+
+/* Finds the part of the tile that contains @pos along one axis,
+ * repeating the texture if @pos is outside of it */
+static void
+_cogl_sparse_texture_get_segment (float pos,
+                                  float end,
+                                  int size,
+                                  int tile_size,
+                                  CoglSparseTextureSegment *segment)
+{
+  float period_start = floorf (pos / size) * size;
+  int tile = MIN ((pos - period_start) / tile_size, (size - 1) / tile_size);
+  float tile_start = period_start + tile * tile_size;
+  float tile_end = period_start + MIN ((tile + 1) * tile_size, size);
+
+  /* Handle rounding errors at the end of the texture */
+  if (tile_end <= pos && pos < end)
+    {
+      period_start += size;
+      tile = 0;
+      tile_start = period_start;
+      tile_end = period_start + MIN (tile_size, size);
+    }
+
+  segment->tile = tile;
+  segment->start = pos;
+  segment->end = MIN (tile_end, end);
+  segment->tile_start = pos - tile_start;
+  segment->tile_end = segment->end - tile_start;
+}
+
+void
+_cogl_sparse_texture_foreach_in_region (CoglSparseTexture *sparse_tex,
+                                        float tx_1,
+                                        float ty_1,
+                                        float tx_2,
+                                        float ty_2,
+                                        CoglMetaTextureCallback callback,
+                                        void *user_data)
+{
+  int border = COGL_SPARSE_TEXTURE_TILE_BORDER;
+  int slot_size = sparse_tex->tile_size + border * 2;
+  float cache_width =
+    cogl_texture_get_width (COGL_TEXTURE (sparse_tex->cache_texture));
+  float cache_height =
+    cogl_texture_get_height (COGL_TEXTURE (sparse_tex->cache_texture));
+  gboolean flipped_x = tx_1 > tx_2;
+  gboolean flipped_y = ty_1 > ty_2;
+  CoglSparseTextureSegment x_segment, y_segment;
+  float x, y;
+
+  if (flipped_x)
+    {
+      float tmp = tx_1;
+      tx_1 = tx_2;
+      tx_2 = tmp;
+    }
+  if (flipped_y)
+    {
+      float tmp = ty_1;
+      ty_1 = ty_2;
+      ty_2 = tmp;
+    }
+
+  /* Each loop runs at least once so that a degenerate region, such
+   * as the ones used to clamp to the edge, still gets a callback */
+  y = ty_1;
+  do
+    {
+      _cogl_sparse_texture_get_segment (y, ty_2,
+                                        sparse_tex->height,
+                                        sparse_tex->tile_size,
+                                        &y_segment);
+
+      x = tx_1;
+      do
+        {
+          float meta_coords[4];
+          float slice_coords[4];
+          float slot_x, slot_y;
+          int tile, slot;
+
+          _cogl_sparse_texture_get_segment (x, tx_2,
+                                            sparse_tex->width,
+                                            sparse_tex->tile_size,
+                                            &x_segment);
+
+          tile = y_segment.tile * sparse_tex->n_tiles_x + x_segment.tile;
+          slot = _cogl_sparse_texture_get_slot (sparse_tex, tile);
+
+          slot_x = (slot % sparse_tex->n_slots_x) * slot_size + border;
+          slot_y = (slot / sparse_tex->n_slots_x) * slot_size + border;
+
+          slice_coords[0] = (slot_x + x_segment.tile_start) / cache_width;
+          slice_coords[1] = (slot_y + y_segment.tile_start) / cache_height;
+          slice_coords[2] = (slot_x + x_segment.tile_end) / cache_width;
+          slice_coords[3] = (slot_y + y_segment.tile_end) / cache_height;
+
+          meta_coords[0] = x_segment.start;
+          meta_coords[1] = y_segment.start;
+          meta_coords[2] = x_segment.end;
+          meta_coords[3] = y_segment.end;
+
+          if (flipped_x)
+            {
+              float tmp = slice_coords[0];
+              slice_coords[0] = slice_coords[2];
+              slice_coords[2] = tmp;
+              tmp = meta_coords[0];
+              meta_coords[0] = meta_coords[2];
+              meta_coords[2] = tmp;
+            }
+          if (flipped_y)
+            {
+              float tmp = slice_coords[1];
+              slice_coords[1] = slice_coords[3];
+              slice_coords[3] = tmp;
+              tmp = meta_coords[1];
+              meta_coords[1] = meta_coords[3];
+              meta_coords[3] = tmp;
+            }
+
+          callback (COGL_TEXTURE (sparse_tex->cache_texture),
+                    slice_coords, meta_coords,
+                    user_data);
+
+          x = x_segment.end;
+        }
+      while (x < tx_2);
+
+      y = y_segment.end;
+    }
+  while (y < ty_2);
+}
+
+static void
+_cogl_sparse_texture_copy_from_data_cb (CoglSparseTexture *sparse_tex,
+                                        int x,
+                                        int y,
+                                        int width,
+                                        int height,
+                                        guint8 *data,
+                                        int rowstride,
+                                        void *user_data)
+{
+  CoglSparseTextureDataSource *source = user_data;
+  const guint8 *src = source->data + y * source->rowstride + x * source->bpp;
+  int i;
+
+  for (i = 0; i < height; i++)
+    memcpy (data + i * rowstride,
+            src + i * source->rowstride,
+            width * source->bpp);
+}
+
+static void
+_cogl_sparse_texture_free_data_source (void *user_data)
+{
+  g_slice_free (CoglSparseTextureDataSource, user_data);
+}
+
+CoglSparseTexture *
+cogl_sparse_texture_new (CoglContext *context,
+                         int width,
+                         int height,
+                         CoglPixelFormat format,
+                         int tile_size,
+                         int n_cache_tiles,
+                         CoglSparseTextureTileCallback callback,
+                         void *user_data,
+                         CoglUserDataDestroyCallback destroy,
+                         GError **error)
+{
+  CoglSparseTexture *sparse_tex;
+  CoglTexture2D *cache_texture;
+  int slot_size = tile_size + COGL_SPARSE_TEXTURE_TILE_BORDER * 2;
+  int n_tiles_x, n_tiles_y;
+  int n_slots_x, n_slots_y;
+  int i;
+
+  _COGL_RETURN_VAL_IF_FAIL (width > 0 && height > 0, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (tile_size > 0, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (n_cache_tiles > 0, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (format != COGL_PIXEL_FORMAT_ANY, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (callback != NULL, NULL);
+
+  n_tiles_x = (width + tile_size - 1) / tile_size;
+  n_tiles_y = (height + tile_size - 1) / tile_size;
+
+  /* There's no point in having more slots than tiles */
+  n_cache_tiles = MIN (n_cache_tiles, n_tiles_x * n_tiles_y);
+
+  /* Lay the slots out in a roughly square grid */
+  n_slots_x = ceilf (sqrtf (n_cache_tiles));
+  n_slots_y = (n_cache_tiles + n_slots_x - 1) / n_slots_x;
+
+  cache_texture = cogl_texture_2d_new_with_size (context,
+                                                 n_slots_x * slot_size,
+                                                 n_slots_y * slot_size,
+                                                 format,
+                                                 error);
+  if (cache_texture == NULL)
+    return NULL;
+
+  sparse_tex = g_new (CoglSparseTexture, 1);
+
+  _cogl_texture_init (COGL_TEXTURE (sparse_tex), &cogl_sparse_texture_vtable);
+
+  sparse_tex->context = context;
+  sparse_tex->width = width;
+  sparse_tex->height = height;
+  sparse_tex->format = format;
+  sparse_tex->tile_size = tile_size;
+  sparse_tex->n_tiles_x = n_tiles_x;
+  sparse_tex->n_tiles_y = n_tiles_y;
+
+  sparse_tex->cache_texture = cache_texture;
+  sparse_tex->n_slots = n_cache_tiles;
+  sparse_tex->n_slots_x = n_slots_x;
+  sparse_tex->slots = g_new (CoglSparseTextureSlot, n_cache_tiles);
+  for (i = 0; i < n_cache_tiles; i++)
+    {
+      sparse_tex->slots[i].tile = -1;
+      sparse_tex->slots[i].last_used = 0;
+    }
+
+  sparse_tex->tile_slots = g_new (int, n_tiles_x * n_tiles_y);
+  for (i = 0; i < n_tiles_x * n_tiles_y; i++)
+    sparse_tex->tile_slots[i] = -1;
+
+  sparse_tex->tile_buffer =
+    g_malloc (slot_size * slot_size * _cogl_get_format_bpp (format));
+
+  sparse_tex->callback = callback;
+  sparse_tex->user_data = user_data;
+  sparse_tex->destroy = destroy;
+
+  sparse_tex->use_counter = 0;
+  sparse_tex->flush_counter = 0;
+  sparse_tex->n_hits = 0;
+  sparse_tex->n_misses = 0;
+
+  return _cogl_sparse_texture_handle_new (sparse_tex);
+}
+
+CoglSparseTexture *
+cogl_sparse_texture_new_from_data (CoglContext *context,
+                                   int width,
+                                   int height,
+                                   CoglPixelFormat format,
+                                   int rowstride,
+                                   const guint8 *data,
+                                   int tile_size,
+                                   int n_cache_tiles,
+                                   GError **error)
+{
+  CoglSparseTextureDataSource *source;
+  CoglSparseTexture *sparse_tex;
+
+  _COGL_RETURN_VAL_IF_FAIL (data != NULL, NULL);
+  _COGL_RETURN_VAL_IF_FAIL (format != COGL_PIXEL_FORMAT_ANY, NULL);
+
+  source = g_slice_new (CoglSparseTextureDataSource);
+  source->data = data;
+  source->bpp = _cogl_get_format_bpp (format);
+  /* Rowstride from width if not given */
+  source->rowstride = rowstride ? rowstride : width * source->bpp;
+
+  sparse_tex =
+    cogl_sparse_texture_new (context,
+                             width, height,
+                             format,
+                             tile_size,
+                             n_cache_tiles,
+                             _cogl_sparse_texture_copy_from_data_cb,
+                             source,
+                             _cogl_sparse_texture_free_data_source,
+                             error);
+
+  if (sparse_tex == NULL)
+    _cogl_sparse_texture_free_data_source (source);
+
+  return sparse_tex;
+}
+
+void
+cogl_sparse_texture_get_tile_stats (CoglSparseTexture *sparse_tex,
+                                    unsigned int *n_hits,
+                                    unsigned int *n_misses)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_sparse_texture (sparse_tex));
+
+  if (n_hits)
+    *n_hits = sparse_tex->n_hits;
+  if (n_misses)
+    *n_misses = sparse_tex->n_misses;
+}
+
+void
+cogl_sparse_texture_reset_tile_stats (CoglSparseTexture *sparse_tex)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_sparse_texture (sparse_tex));
+
+  sparse_tex->n_hits = 0;
+  sparse_tex->n_misses = 0;
+}
+
+typedef struct
+{
+  CoglMetaTextureCallback callback;
+  void *user_data;
+  float x_normalize_factor;
+  float y_normalize_factor;
+} CoglSparseTextureNormalizeData;
+
+static void
+normalize_meta_coords_cb (CoglTexture *sub_texture,
+                          const float *sub_texture_coords,
+                          const float *meta_coords,
+                          void *user_data)
+{
+  CoglSparseTextureNormalizeData *data = user_data;
+  float normalized_coords[4] =
+    {
+      meta_coords[0] * data->x_normalize_factor,
+      meta_coords[1] * data->y_normalize_factor,
+      meta_coords[2] * data->x_normalize_factor,
+      meta_coords[3] * data->y_normalize_factor
+    };
+
+  data->callback (sub_texture, sub_texture_coords, normalized_coords,
+                  data->user_data);
+}
+
+static void
+_cogl_sparse_texture_foreach_sub_texture_in_region (
+                                       CoglTexture *tex,
+                                       float virtual_tx_1,
+                                       float virtual_ty_1,
+                                       float virtual_tx_2,
+                                       float virtual_ty_2,
+                                       CoglMetaTextureCallback callback,
+                                       void *user_data)
+{
+  CoglSparseTexture *sparse_tex = COGL_SPARSE_TEXTURE (tex);
+  CoglSparseTextureNormalizeData data;
+
+  data.callback = callback;
+  data.user_data = user_data;
+  data.x_normalize_factor = 1.0f / sparse_tex->width;
+  data.y_normalize_factor = 1.0f / sparse_tex->height;
+
+  _cogl_sparse_texture_foreach_in_region (sparse_tex,
+                                          virtual_tx_1 * sparse_tex->width,
+                                          virtual_ty_1 * sparse_tex->height,
+                                          virtual_tx_2 * sparse_tex->width,
+                                          virtual_ty_2 * sparse_tex->height,
+                                          normalize_meta_coords_cb,
+                                          &data);
+}
+
+static int
+_cogl_sparse_texture_get_max_waste (CoglTexture *tex)
+{
+  return -1;
+}
+
+static gboolean
+_cogl_sparse_texture_is_sliced (CoglTexture *tex)
+{
+  /* The tiles always have to be resolved with the meta texture
+   * interface */
+  return TRUE;
+}
+
+static gboolean
+_cogl_sparse_texture_can_hardware_repeat (CoglTexture *tex)
+{
+  return FALSE;
+}
+
+static void
+_cogl_sparse_texture_transform_coords_to_gl (CoglTexture *tex,
+                                             float *s,
+                                             float *t)
+{
+  /* This should never be called because the texture is always
+   * sliced */
+  g_assert_not_reached ();
+}
+
+static CoglTransformResult
+_cogl_sparse_texture_transform_quad_coords_to_gl (CoglTexture *tex,
+                                                  float *coords)
+{
+  return COGL_TRANSFORM_SOFTWARE_REPEAT;
+}
+
+static gboolean
+_cogl_sparse_texture_get_gl_texture (CoglTexture *tex,
+                                     GLuint *out_gl_handle,
+                                     GLenum *out_gl_target)
+{
+  CoglSparseTexture *sparse_tex = COGL_SPARSE_TEXTURE (tex);
+
+  return cogl_texture_get_gl_texture (COGL_TEXTURE (sparse_tex->cache_texture),
+                                      out_gl_handle, out_gl_target);
+}
+
+static void
+_cogl_sparse_texture_set_filters (CoglTexture *tex,
+                                  GLenum min_filter,
+                                  GLenum mag_filter)
+{
+  CoglSparseTexture *sparse_tex = COGL_SPARSE_TEXTURE (tex);
+
+  _cogl_texture_set_filters (COGL_TEXTURE (sparse_tex->cache_texture),
+                             min_filter, mag_filter);
+}
+
+static void
+_cogl_sparse_texture_pre_paint (CoglTexture *tex,
+                                CoglTexturePrePaintFlags flags)
+{
+  CoglSparseTexture *sparse_tex = COGL_SPARSE_TEXTURE (tex);
+
+  /* Mipmaps of the cache texture would mix unrelated tiles together
+   * so they are never generated */
+  _cogl_texture_pre_paint (COGL_TEXTURE (sparse_tex->cache_texture),
+                           flags & ~COGL_TEXTURE_NEEDS_MIPMAP);
+}
+
+static void
+_cogl_sparse_texture_ensure_non_quad_rendering (CoglTexture *tex)
+{
+  /* Nothing can be done to make the tiles usable for arbitrary
+   * geometry */
+}
+
+static void
+_cogl_sparse_texture_set_wrap_mode_parameters (CoglTexture *tex,
+                                               GLenum wrap_mode_s,
+                                               GLenum wrap_mode_t,
+                                               GLenum wrap_mode_p)
+{
+  CoglSparseTexture *sparse_tex = COGL_SPARSE_TEXTURE (tex);
+
+  _cogl_texture_set_wrap_mode_parameters
+    (COGL_TEXTURE (sparse_tex->cache_texture),
+     wrap_mode_s, wrap_mode_t, wrap_mode_p);
+}
+
+static gboolean
+_cogl_sparse_texture_set_region (CoglTexture *tex,
+                                 int src_x,
+                                 int src_y,
+                                 int dst_x,
+                                 int dst_y,
+                                 unsigned int dst_width,
+                                 unsigned int dst_height,
+                                 CoglBitmap *bmp)
+{
+  /* The image is owned by the tile source so it can't be modified
+   * through the texture */
+  return FALSE;
+}
+
+static CoglPixelFormat
+_cogl_sparse_texture_get_format (CoglTexture *tex)
+{
+  return COGL_SPARSE_TEXTURE (tex)->format;
+}
+
+static GLenum
+_cogl_sparse_texture_get_gl_format (CoglTexture *tex)
+{
+  CoglSparseTexture *sparse_tex = COGL_SPARSE_TEXTURE (tex);
+
+  return _cogl_texture_get_gl_format (COGL_TEXTURE (sparse_tex->cache_texture));
+}
+
+static int
+_cogl_sparse_texture_get_width (CoglTexture *tex)
+{
+  return COGL_SPARSE_TEXTURE (tex)->width;
+}
+
+static int
+_cogl_sparse_texture_get_height (CoglTexture *tex)
+{
+  return COGL_SPARSE_TEXTURE (tex)->height;
+}
+
+static gboolean
+_cogl_sparse_texture_is_foreign (CoglTexture *tex)
+{
+  return FALSE;
+}
+
+static const CoglTextureVtable
+cogl_sparse_texture_vtable =
+  {
+    _cogl_sparse_texture_set_region,
+    NULL, /* get_data */
+    _cogl_sparse_texture_foreach_sub_texture_in_region,
+    _cogl_sparse_texture_get_max_waste,
+    _cogl_sparse_texture_is_sliced,
+    _cogl_sparse_texture_can_hardware_repeat,
+    _cogl_sparse_texture_transform_coords_to_gl,
+    _cogl_sparse_texture_transform_quad_coords_to_gl,
+    _cogl_sparse_texture_get_gl_texture,
+    _cogl_sparse_texture_set_filters,
+    _cogl_sparse_texture_pre_paint,
+    _cogl_sparse_texture_ensure_non_quad_rendering,
+    _cogl_sparse_texture_set_wrap_mode_parameters,
+    _cogl_sparse_texture_get_format,
+    _cogl_sparse_texture_get_gl_format,
+    _cogl_sparse_texture_get_width,
+    _cogl_sparse_texture_get_height,
+    _cogl_sparse_texture_is_foreign
+  };
@@ -0,0 +1,221 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_SPARSE_TEXTURE_H__
+#define __COGL_SPARSE_TEXTURE_H__
+
+#include <glib.h>
+#include <cogl/cogl-context.h>
+#include <cogl/cogl-types.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-sparse-texture
+ * @short_description: A meta texture for images that are too large
+ *                     to keep in video memory
+ *
+ * A #CoglSparseTexture represents a very large image, such as a map
+ * or a scanned document, without keeping all of it in video memory.
+ * The image is divided into square tiles and only the tiles that
+ * have recently been drawn are kept in a cache texture of a fixed
+ * size. When a tile that isn't in the cache is needed it is
+ * requested from a tile source supplied by the application and the
+ * least recently used tile is replaced.
+ *
+ * A #CoglSparseTexture implements the #CoglMetaTexture interface so
+ * it can be drawn with cogl_rectangle() or resolved manually with
+ * cogl_meta_texture_foreach_in_region(). Only the tiles that
+ * intersect the region being drawn are loaded.
+ *
+ * Sparse textures can't be used with the low-level drawing APIs,
+ * with multi-texturing or with mipmap filters.
+ */
+
+typedef struct _CoglSparseTexture CoglSparseTexture;
+#define COGL_SPARSE_TEXTURE(X) ((CoglSparseTexture *)X)
+
+/**
+ * CoglSparseTextureTileCallback:
+ * @texture: The #CoglSparseTexture that needs the data
+ * @x: The x position of the region in the image
+ * @y: The y position of the region in the image
+ * @width: The width of the region
+ * @height: The height of the region
+ * @data: The memory to write the image data to
+ * @rowstride: The number of bytes between the start of each row in
+ *   @data
+ * @user_data: The private data passed when the texture was created
+ *
+ * A callback used to fetch a region of the image represented by a
+ * #CoglSparseTexture when it is needed. The data must be written in
+ * the format that the texture was created with. The region is
+ * slightly bigger than a tile because the neighbouring pixels are
+ * needed to filter across the edges of the tiles.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+typedef void (*CoglSparseTextureTileCallback) (CoglSparseTexture *texture,
+                                               int x,
+                                               int y,
+                                               int width,
+                                               int height,
+                                               guint8 *data,
+                                               int rowstride,
+                                               void *user_data);
+
+/**
+ * cogl_sparse_texture_new:
+ * @context: A #CoglContext
+ * @width: The width of the image
+ * @height: The height of the image
+ * @format: The format of the image data
+ * @tile_size: The width and height of each tile
+ * @n_cache_tiles: The maximum number of tiles to keep in video memory
+ * @callback: A #CoglSparseTextureTileCallback that provides the image
+ *   data
+ * @user_data: Private data to pass to @callback
+ * @destroy: (allow-none): A #CoglUserDataDestroyCallback to call when
+ *   @user_data is no longer needed
+ * @error: A #GError for exceptions
+ *
+ * Creates a sparse texture whose image data is fetched on demand by
+ * calling @callback. The video memory used is about @n_cache_tiles
+ * tiles of @tile_size × @tile_size pixels regardless of the size of
+ * the image. @n_cache_tiles should be at least the number of tiles
+ * that are visible at once, otherwise tiles will be reloaded while
+ * drawing each frame.
+ *
+ * Return value: A new #CoglSparseTexture or %NULL if the cache
+ *   texture couldn't be created, in which case @error is set.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+CoglSparseTexture *
+cogl_sparse_texture_new (CoglContext *context,
+                         int width,
+                         int height,
+                         CoglPixelFormat format,
+                         int tile_size,
+                         int n_cache_tiles,
+                         CoglSparseTextureTileCallback callback,
+                         void *user_data,
+                         CoglUserDataDestroyCallback destroy,
+                         GError **error);
+
+/**
+ * cogl_sparse_texture_new_from_data:
+ * @context: A #CoglContext
+ * @width: The width of the image
+ * @height: The height of the image
+ * @format: The format of @data
+ * @rowstride: The number of bytes between the start of each row in
+ *   @data or 0 to calculate it from @width
+ * @data: The image data
+ * @tile_size: The width and height of each tile
+ * @n_cache_tiles: The maximum number of tiles to keep in video memory
+ * @error: A #GError for exceptions
+ *
+ * Creates a sparse texture that copies its tiles from @data when
+ * they are needed. This is intended for images that are mapped from
+ * a file with mmap() so that only the parts of the file that are
+ * drawn need to be read. The data is not copied so it must remain
+ * valid until the texture is destroyed.
+ *
+ * Return value: A new #CoglSparseTexture or %NULL if the cache
+ *   texture couldn't be created, in which case @error is set.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+CoglSparseTexture *
+cogl_sparse_texture_new_from_data (CoglContext *context,
+                                   int width,
+                                   int height,
+                                   CoglPixelFormat format,
+                                   int rowstride,
+                                   const guint8 *data,
+                                   int tile_size,
+                                   int n_cache_tiles,
+                                   GError **error);
+
+/**
+ * cogl_sparse_texture_get_tile_stats:
+ * @texture: A #CoglSparseTexture
+ * @n_hits: (out) (allow-none): Return location for the number of
+ *   times a tile was already in the cache when it was needed
+ * @n_misses: (out) (allow-none): Return location for the number of
+ *   times a tile had to be loaded
+ *
+ * Retrieves statistics about how well the tile cache of @texture is
+ * working since it was created or since the last call to
+ * cogl_sparse_texture_reset_tile_stats(). If the number of misses
+ * keeps growing while the same region is drawn then the cache is too
+ * small.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_sparse_texture_get_tile_stats (CoglSparseTexture *texture,
+                                    unsigned int *n_hits,
+                                    unsigned int *n_misses);
+
+/**
+ * cogl_sparse_texture_reset_tile_stats:
+ * @texture: A #CoglSparseTexture
+ *
+ * Resets the counters returned by cogl_sparse_texture_get_tile_stats()
+ * to zero.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_sparse_texture_reset_tile_stats (CoglSparseTexture *texture);
+
+/**
+ * cogl_is_sparse_texture:
+ * @object: A #CoglObject pointer
+ *
+ * Gets whether the given object references a #CoglSparseTexture.
+ *
+ * Return value: %TRUE if the object references a #CoglSparseTexture
+ *   and %FALSE otherwise.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+gboolean
+cogl_is_sparse_texture (void *object);
+
+G_END_DECLS
+
+#endif /* __COGL_SPARSE_TEXTURE_H__ */
@@ -28,6 +28,19 @@
 #include "cogl-pipeline-private.h"
 #include "cogl-texture-private.h"
 
+/* The maximum number of separate regions that are kept waiting to be
+ * uploaded when uploads are batched. After this the new region is
+ * merged with the closest pending one */
+#define COGL_TEXTURE_2D_MAX_DIRTY_RECTS 8
+
+typedef struct
+{
+  /* The rectangle covers the texels from (x0, y0) up to but not
+   * including (x1, y1) */
+  int x0, y0;
+  int x1, y1;
+} CoglTexture2DDirtyRect;
+
 struct _CoglTexture2D
 {
   CoglTexture     _parent;
@@ -50,6 +63,34 @@ struct _CoglTexture2D
   gboolean        is_foreign;
 
   CoglTexturePixel first_pixel;
+
+  /* The estimated size of the storage that was added to the memory
+   * usage of the context or 0 if the storage isn't owned by Cogl */
+  size_t          memory_size;
+
+  CoglTexture2DRegenerateCallback regenerate_callback;
+  void           *regenerate_data;
+  CoglUserDataDestroyCallback regenerate_destroy;
+  /* Whether the GL texture has been deleted to keep within the
+   * texture memory budget */
+  gboolean        evicted;
+  /* The value of ctx->texture_use_age when the texture was last
+   * used */
+  unsigned int    last_used;
+
+  /* If uploads are batched, cogl_texture_set_region() only writes to
+   * this copy of the texture in system memory and the dirty
+   * rectangles are uploaded from it the next time the texture is
+   * used. It is allocated on the first batched write */
+  gboolean        batch_uploads;
+  CoglBitmap     *shadow_bmp;
+  /* Whether the texels of shadow_bmp outside of the dirty rectangles
+   * match the GL texture. Unless this is set, rectangles are only
+   * merged when no texels are added that weren't written because
+   * uploading them would overwrite the GL texture with garbage */
+  gboolean        shadow_valid;
+  CoglTexture2DDirtyRect dirty_rects[COGL_TEXTURE_2D_MAX_DIRTY_RECTS];
+  int             n_dirty_rects;
 };
 
 CoglHandle
@@ -76,8 +117,8 @@ _cogl_egl_texture_2d_new_from_image (CoglContext *ctx,
  * @handle: A handle to a 2D texture
  *
  * This should be called whenever the texture is modified other than
- * by using cogl_texture_set_region. It will cause the mipmaps to be
- * invalidated
+ * by using cogl_texture_set_region. It will cause the mipmaps and the
+ * copy of the texture used to batch uploads to be invalidated
  */
 void
 _cogl_texture_2d_externally_modified (CoglHandle handle);
@@ -104,4 +145,54 @@ _cogl_texture_2d_copy_from_framebuffer (CoglHandle handle,
                                         int width,
                                         int height);
 
+/*
+ * _cogl_texture_2d_copy_from_texture_2d:
+ * @dst_handle: A handle to the 2D texture to copy into
+ * @dst_x: X-position to store the image within the texture
+ * @dst_y: Y-position to store the image within the texture
+ * @src_handle: A handle to the 2D texture to copy from
+ * @src_x: X-position within the source texture to read from
+ * @src_y: Y-position within the source texture to read from
+ * @width: width of the rectangle to copy
+ * @height: height of the rectangle to copy
+ *
+ * This copies a portion of one texture directly into another using
+ * glCopyImageSubData without going through a framebuffer. This
+ * should only be called if the COGL_PRIVATE_FEATURE_COPY_IMAGE
+ * feature is advertised and the two textures have the same internal
+ * format.
+ */
+void
+_cogl_texture_2d_copy_from_texture_2d (CoglHandle dst_handle,
+                                       int dst_x,
+                                       int dst_y,
+                                       CoglHandle src_handle,
+                                       int src_x,
+                                       int src_y,
+                                       int width,
+                                       int height);
+
+/*
+ * _cogl_texture_2d_evict_to_budget:
+ * @ctx: A #CoglContext
+ *
+ * Frees the storage of the least recently used textures that have a
+ * regenerate callback until the texture memory of the context is
+ * within its budget. Textures that have been used since the last
+ * frame was finished are not evicted because batched drawing may
+ * still refer to them.
+ */
+void
+_cogl_texture_2d_evict_to_budget (CoglContext *ctx);
+
+/*
+ * _cogl_texture_2d_end_frame:
+ * @ctx: A #CoglContext
+ *
+ * Called when an onscreen framebuffer is swapped so that the
+ * textures used in the frame become evictable again.
+ */
+void
+_cogl_texture_2d_end_frame (CoglContext *ctx);
+
 #endif /* __COGL_TEXTURE_2D_H */
@@ -489,102 +489,6 @@ _cogl_texture_2d_sliced_upload_subregion_to_gl (CoglTexture2DSliced *tex_2ds,
   return TRUE;
 }
 
-static int
-_cogl_rect_slices_for_size (int     size_to_fill,
-                            int     max_span_size,
-                            int     max_waste,
-                            GArray *out_spans)
-{
-  int       n_spans = 0;
-  CoglSpan  span;
-
-  /* Init first slice span */
-  span.start = 0;
-  span.size = max_span_size;
-  span.waste = 0;
-
-  /* Repeat until whole area covered */
-  while (size_to_fill >= span.size)
-    {
-      /* Add another slice span of same size */
-      if (out_spans)
-        g_array_append_val (out_spans, span);
-      span.start   += span.size;
-      size_to_fill -= span.size;
-      n_spans++;
-    }
-
-  /* Add one last smaller slice span */
-  if (size_to_fill > 0)
-    {
-      span.size = size_to_fill;
-      if (out_spans)
-        g_array_append_val (out_spans, span);
-      n_spans++;
-    }
-
-  return n_spans;
-}
-
-static int
-_cogl_pot_slices_for_size (int    size_to_fill,
-                           int    max_span_size,
-                           int    max_waste,
-                           GArray *out_spans)
-{
-  int      n_spans = 0;
-  CoglSpan span;
-
-  /* Init first slice span */
-  span.start = 0;
-  span.size = max_span_size;
-  span.waste = 0;
-
-  /* Fix invalid max_waste */
-  if (max_waste < 0)
-    max_waste = 0;
-
-  while (TRUE)
-    {
-      /* Is the whole area covered? */
-      if (size_to_fill > span.size)
-        {
-          /* Not yet - add a span of this size */
-          if (out_spans)
-            g_array_append_val (out_spans, span);
-
-          span.start   += span.size;
-          size_to_fill -= span.size;
-          n_spans++;
-        }
-      else if (span.size - size_to_fill <= max_waste)
-        {
-          /* Yes and waste is small enough */
-          /* Pick the next power of two up from size_to_fill. This can
-             sometimes be less than the span.size that would be chosen
-             otherwise */
-          span.size = _cogl_util_next_p2 (size_to_fill);
-          span.waste = span.size - size_to_fill;
-          if (out_spans)
-            g_array_append_val (out_spans, span);
-
-          return ++n_spans;
-        }
-      else
-        {
-          /* Yes but waste is too large */
-          while (span.size - size_to_fill > max_waste)
-            {
-              span.size /= 2;
-              g_assert (span.size > 0);
-            }
-        }
-    }
-
-  /* Can't get here */
-  return 0;
-}
-
 static void
 _cogl_texture_2d_sliced_set_wrap_mode_parameters (CoglTexture *tex,
                                                   GLenum wrap_mode_s,
@@ -642,6 +546,9 @@ _cogl_texture_2d_sliced_slices_create (CoglContext *ctx,
       slices_for_size = _cogl_pot_slices_for_size;
     }
 
+  if (!_cogl_texture_format_is_supported (ctx, format))
+    return FALSE;
+
   ctx->texture_driver->pixel_format_to_gl (format,
                                            &gl_intformat,
                                            NULL,
@@ -731,6 +638,29 @@ _cogl_texture_2d_sliced_slices_create (CoglContext *ctx,
                        tex_2ds->slice_y_spans);
     }
 
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_SLICING)))
+    {
+      int total_width = 0, total_height = 0;
+      int total_texels;
+
+      for (x = 0; x < n_x_slices; x++)
+        total_width += g_array_index (tex_2ds->slice_x_spans,
+                                      CoglSpan, x).size;
+      for (y = 0; y < n_y_slices; y++)
+        total_height += g_array_index (tex_2ds->slice_y_spans,
+                                       CoglSpan, y).size;
+
+      total_texels = total_width * total_height;
+
+      COGL_NOTE (SLICING, "Texture %ix%i: %ix%i slices, "
+                 "%i texels allocated, %i wasted (%.1f%%)",
+                 width, height,
+                 n_x_slices, n_y_slices,
+                 total_texels,
+                 total_texels - width * height,
+                 (total_texels - width * height) * 100.0f / total_texels);
+    }
+
   /* Init and resize GL handle array */
   n_slices = n_x_slices * n_y_slices;
 
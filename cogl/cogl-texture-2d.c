@@ -39,6 +39,8 @@
 #include "cogl-journal-private.h"
 #include "cogl-pipeline-opengl-private.h"
 #include "cogl-framebuffer-private.h"
+#include "cogl-blit.h"
+#include "cogl-profile.h"
 #ifdef COGL_HAS_EGL_SUPPORT
 #include "cogl-winsys-egl-private.h"
 #endif
@@ -51,6 +53,8 @@
 #endif
 
 static void _cogl_texture_2d_free (CoglTexture2D *tex_2d);
+static void _cogl_texture_2d_ensure_resident (CoglTexture2D *tex_2d);
+static void _cogl_texture_2d_flush_uploads (CoglTexture2D *tex_2d);
 
 COGL_TEXTURE_DEFINE (Texture2D, texture_2d);
 
@@ -73,6 +77,8 @@ _cogl_texture_2d_set_wrap_mode_parameters (CoglTexture *tex,
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
+  _cogl_texture_2d_ensure_resident (tex_2d);
+
   /* Only set the wrap mode if it's different from the current value
      to avoid too many GL calls. Texture 2D doesn't make use of the r
      coordinate so we can ignore its wrap mode */
@@ -97,9 +103,25 @@ _cogl_texture_2d_set_wrap_mode_parameters (CoglTexture *tex,
 static void
 _cogl_texture_2d_free (CoglTexture2D *tex_2d)
 {
-  if (!tex_2d->is_foreign)
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (!tex_2d->is_foreign && !tex_2d->evicted)
     _cogl_delete_gl_texture (tex_2d->gl_texture);
 
+  if (!tex_2d->evicted)
+    _cogl_context_remove_memory_usage (ctx,
+                                       COGL_MEMORY_USAGE_TYPE_TEXTURE_2D,
+                                       tex_2d->memory_size);
+
+  if (tex_2d->regenerate_callback && tex_2d->memory_size > 0)
+    ctx->evictable_textures = g_list_remove (ctx->evictable_textures, tex_2d);
+
+  if (tex_2d->regenerate_destroy)
+    tex_2d->regenerate_destroy (tex_2d->regenerate_data);
+
+  if (tex_2d->shadow_bmp)
+    cogl_object_unref (tex_2d->shadow_bmp);
+
   /* Chain up */
   _cogl_texture_free (COGL_TEXTURE (tex_2d));
 }
@@ -121,6 +143,9 @@ _cogl_texture_2d_can_create (unsigned int width,
        !_cogl_util_is_pot (height)))
     return FALSE;
 
+  if (!_cogl_texture_format_is_supported (ctx, internal_format))
+    return FALSE;
+
   ctx->texture_driver->pixel_format_to_gl (internal_format,
                                            &gl_intformat,
                                            NULL,
@@ -165,9 +190,220 @@ _cogl_texture_2d_create_base (unsigned int     width,
 
   tex_2d->format = internal_format;
 
+  tex_2d->memory_size = 0;
+  tex_2d->regenerate_callback = NULL;
+  tex_2d->regenerate_data = NULL;
+  tex_2d->regenerate_destroy = NULL;
+  tex_2d->evicted = FALSE;
+  tex_2d->last_used = 0;
+
+  tex_2d->batch_uploads = FALSE;
+  tex_2d->shadow_bmp = NULL;
+  tex_2d->shadow_valid = FALSE;
+  tex_2d->n_dirty_rects = 0;
+
   return tex_2d;
 }
 
+static void
+_cogl_texture_2d_set_memory_size (CoglContext *ctx,
+                                  CoglTexture2D *tex_2d)
+{
+  tex_2d->memory_size = ((size_t) tex_2d->width * tex_2d->height *
+                         _cogl_get_format_bpp (tex_2d->format));
+
+  _cogl_context_add_memory_usage (ctx,
+                                  COGL_MEMORY_USAGE_TYPE_TEXTURE_2D,
+                                  tex_2d->memory_size);
+}
+
+static void
+_cogl_texture_2d_evict (CoglContext *ctx,
+                        CoglTexture2D *tex_2d)
+{
+  COGL_STATIC_COUNTER (texture_2d_evict_counter,
+                       "Texture 2D evict counter",
+                       "Increments each time the storage of a texture "
+                       "is freed to keep within the memory budget",
+                       0 /* no application private data */);
+
+  COGL_COUNTER_INC (_cogl_uprof_context, texture_2d_evict_counter);
+
+  _cogl_delete_gl_texture (tex_2d->gl_texture);
+  tex_2d->gl_texture = 0;
+  tex_2d->evicted = TRUE;
+
+  /* The regenerate callback will write the contents again so there's
+   * no point in keeping the pending uploads or the shadow copy */
+  tex_2d->n_dirty_rects = 0;
+  if (tex_2d->shadow_bmp)
+    {
+      cogl_object_unref (tex_2d->shadow_bmp);
+      tex_2d->shadow_bmp = NULL;
+    }
+
+  _cogl_pipeline_texture_storage_change_notify (COGL_TEXTURE (tex_2d));
+
+  _cogl_context_remove_memory_usage (ctx,
+                                     COGL_MEMORY_USAGE_TYPE_TEXTURE_2D,
+                                     tex_2d->memory_size);
+}
+
+void
+_cogl_texture_2d_evict_to_budget (CoglContext *ctx)
+{
+  if (ctx->texture_memory_budget == 0 ||
+      _cogl_context_get_texture_memory_usage (ctx) <=
+      ctx->texture_memory_budget)
+    return;
+
+  /* A texture with a framebuffer can't be evicted so the framebuffers
+   * cached for blitting shouldn't hold on to them */
+  _cogl_blit_clear_fbo_cache (ctx);
+
+  while (_cogl_context_get_texture_memory_usage (ctx) >
+         ctx->texture_memory_budget)
+    {
+      CoglTexture2D *oldest = NULL;
+      GList *l;
+
+      for (l = ctx->evictable_textures; l; l = l->next)
+        {
+          CoglTexture2D *tex_2d = l->data;
+
+          if (!tex_2d->evicted &&
+              tex_2d->last_used <= ctx->texture_frame_use_age &&
+              (oldest == NULL || tex_2d->last_used < oldest->last_used) &&
+              _cogl_texture_get_associated_framebuffers (COGL_TEXTURE (tex_2d))
+              == NULL)
+            oldest = tex_2d;
+        }
+
+      /* Everything else is either in use or can't be recreated */
+      if (oldest == NULL)
+        break;
+
+      _cogl_texture_2d_evict (ctx, oldest);
+    }
+}
+
+void
+_cogl_texture_2d_end_frame (CoglContext *ctx)
+{
+  ctx->texture_frame_use_age = ctx->texture_use_age;
+
+  _cogl_texture_2d_evict_to_budget (ctx);
+}
+
+/* Recreates the storage of a texture that was evicted. This must be
+ * called before anything touches the GL texture */
+static void
+_cogl_texture_2d_ensure_resident (CoglTexture2D *tex_2d)
+{
+  GLenum gl_intformat;
+  GLenum gl_format;
+  GLenum gl_type;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (G_LIKELY (!tex_2d->evicted))
+    return;
+
+  ctx->texture_driver->pixel_format_to_gl (tex_2d->format,
+                                           &gl_intformat,
+                                           &gl_format,
+                                           &gl_type);
+
+  ctx->texture_driver->gen (GL_TEXTURE_2D, 1, &tex_2d->gl_texture);
+  _cogl_bind_gl_texture_transient (GL_TEXTURE_2D,
+                                   tex_2d->gl_texture,
+                                   FALSE);
+  GE( ctx, glTexImage2D (GL_TEXTURE_2D, 0, gl_intformat,
+                         tex_2d->width, tex_2d->height, 0,
+                         gl_format, gl_type, NULL) );
+  GE( ctx, glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+                            tex_2d->mag_filter) );
+  GE( ctx, glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                            tex_2d->min_filter) );
+
+  /* The new texture object has the default wrap modes */
+  tex_2d->wrap_mode_s = GL_FALSE;
+  tex_2d->wrap_mode_t = GL_FALSE;
+  tex_2d->mipmaps_dirty = TRUE;
+  tex_2d->evicted = FALSE;
+
+  /* Mark the texture as used before adding the memory usage so that
+   * it won't be chosen to be evicted again straight away */
+  tex_2d->last_used = ++ctx->texture_use_age;
+
+  _cogl_pipeline_texture_storage_change_notify (COGL_TEXTURE (tex_2d));
+
+  _cogl_context_add_memory_usage (ctx,
+                                  COGL_MEMORY_USAGE_TYPE_TEXTURE_2D,
+                                  tex_2d->memory_size);
+
+  tex_2d->regenerate_callback (tex_2d, tex_2d->regenerate_data);
+}
+
+void
+cogl_texture_2d_set_regenerate_callback (CoglTexture2D *texture,
+                                         CoglTexture2DRegenerateCallback
+                                           callback,
+                                         void *user_data,
+                                         CoglUserDataDestroyCallback destroy)
+{
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  _COGL_RETURN_IF_FAIL (cogl_is_texture_2d (texture));
+
+  /* The old callback may still be needed to restore the contents */
+  _cogl_texture_2d_ensure_resident (texture);
+
+  if (texture->regenerate_destroy)
+    texture->regenerate_destroy (texture->regenerate_data);
+
+  /* Textures whose storage isn't owned by Cogl are never evictable */
+  if (texture->memory_size > 0)
+    {
+      if (texture->regenerate_callback == NULL && callback)
+        ctx->evictable_textures =
+          g_list_prepend (ctx->evictable_textures, texture);
+      else if (texture->regenerate_callback && callback == NULL)
+        ctx->evictable_textures =
+          g_list_remove (ctx->evictable_textures, texture);
+    }
+
+  texture->regenerate_callback = callback;
+  texture->regenerate_data = user_data;
+  texture->regenerate_destroy = destroy;
+
+  if (callback)
+    _cogl_texture_2d_evict_to_budget (ctx);
+}
+
+void
+cogl_texture_2d_set_batch_uploads (CoglTexture2D *texture,
+                                   gboolean batch_uploads)
+{
+  _COGL_RETURN_IF_FAIL (cogl_is_texture_2d (texture));
+
+  if (texture->batch_uploads == !!batch_uploads)
+    return;
+
+  if (!batch_uploads)
+    {
+      _cogl_texture_2d_flush_uploads (texture);
+
+      if (texture->shadow_bmp)
+        {
+          cogl_object_unref (texture->shadow_bmp);
+          texture->shadow_bmp = NULL;
+        }
+    }
+
+  texture->batch_uploads = !!batch_uploads;
+}
+
 CoglTexture2D *
 cogl_texture_2d_new_with_size (CoglContext *ctx,
                                int width,
@@ -208,6 +444,8 @@ cogl_texture_2d_new_with_size (CoglContext *ctx,
   GE( ctx, glTexImage2D (GL_TEXTURE_2D, 0, gl_intformat,
                          width, height, 0, gl_format, gl_type, NULL) );
 
+  _cogl_texture_2d_set_memory_size (ctx, tex_2d);
+
   return _cogl_texture_2d_handle_new (tex_2d);
 }
 
@@ -287,6 +525,8 @@ _cogl_texture_2d_new_from_bitmap (CoglBitmap      *bmp,
 
   tex_2d->gl_format = gl_intformat;
 
+  _cogl_texture_2d_set_memory_size (ctx, tex_2d);
+
   cogl_object_unref (dst_bmp);
 
   return _cogl_texture_2d_handle_new (tex_2d);
@@ -568,6 +808,7 @@ _cogl_texture_2d_externally_modified (CoglHandle handle)
     return;
 
   COGL_TEXTURE_2D (handle)->mipmaps_dirty = TRUE;
+  COGL_TEXTURE_2D (handle)->shadow_valid = FALSE;
 }
 
 void
@@ -587,6 +828,10 @@ _cogl_texture_2d_copy_from_framebuffer (CoglHandle handle,
 
   tex_2d = COGL_TEXTURE_2D (handle);
 
+  _cogl_texture_2d_ensure_resident (tex_2d);
+  /* Pending writes must land before the copy overwrites them */
+  _cogl_texture_2d_flush_uploads (tex_2d);
+
   /* Make sure the current framebuffers are bound, though we don't need to
    * flush the clip state here since we aren't going to draw to the
    * framebuffer. */
@@ -606,6 +851,45 @@ _cogl_texture_2d_copy_from_framebuffer (CoglHandle handle,
                             width, height);
 
   tex_2d->mipmaps_dirty = TRUE;
+  tex_2d->shadow_valid = FALSE;
+}
+
+void
+_cogl_texture_2d_copy_from_texture_2d (CoglHandle dst_handle,
+                                       int dst_x,
+                                       int dst_y,
+                                       CoglHandle src_handle,
+                                       int src_x,
+                                       int src_y,
+                                       int width,
+                                       int height)
+{
+  CoglTexture2D *dst_tex_2d;
+  CoglTexture2D *src_tex_2d;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  _COGL_RETURN_IF_FAIL (cogl_is_texture_2d (dst_handle));
+  _COGL_RETURN_IF_FAIL (cogl_is_texture_2d (src_handle));
+
+  dst_tex_2d = COGL_TEXTURE_2D (dst_handle);
+  src_tex_2d = COGL_TEXTURE_2D (src_handle);
+
+  _cogl_texture_2d_ensure_resident (dst_tex_2d);
+  _cogl_texture_2d_ensure_resident (src_tex_2d);
+  _cogl_texture_2d_flush_uploads (dst_tex_2d);
+  _cogl_texture_2d_flush_uploads (src_tex_2d);
+
+  GE( ctx, glCopyImageSubData (src_tex_2d->gl_texture, GL_TEXTURE_2D,
+                               0, /* level */
+                               src_x, src_y, 0,
+                               dst_tex_2d->gl_texture, GL_TEXTURE_2D,
+                               0, /* level */
+                               dst_x, dst_y, 0,
+                               width, height, 1) );
+
+  dst_tex_2d->mipmaps_dirty = TRUE;
+  dst_tex_2d->shadow_valid = FALSE;
 }
 
 static int
@@ -660,6 +944,11 @@ _cogl_texture_2d_get_gl_texture (CoglTexture *tex,
 {
   CoglTexture2D *tex_2d = COGL_TEXTURE_2D (tex);
 
+  _cogl_texture_2d_ensure_resident (tex_2d);
+  /* Anything that asks for the GL texture is about to read from it
+   * or render to it */
+  _cogl_texture_2d_flush_uploads (tex_2d);
+
   if (out_gl_handle)
     *out_gl_handle = tex_2d->gl_texture;
 
@@ -678,6 +967,8 @@ _cogl_texture_2d_set_filters (CoglTexture *tex,
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
+  _cogl_texture_2d_ensure_resident (tex_2d);
+
   if (min_filter == tex_2d->min_filter
       && mag_filter == tex_2d->mag_filter)
     return;
@@ -701,6 +992,11 @@ _cogl_texture_2d_pre_paint (CoglTexture *tex, CoglTexturePrePaintFlags flags)
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
+  _cogl_texture_2d_ensure_resident (tex_2d);
+  tex_2d->last_used = ++ctx->texture_use_age;
+
+  _cogl_texture_2d_flush_uploads (tex_2d);
+
   /* Only update if the mipmaps are dirty */
   if ((flags & COGL_TEXTURE_NEEDS_MIPMAP) &&
       tex_2d->auto_mipmap && tex_2d->mipmaps_dirty)
@@ -740,6 +1036,252 @@ _cogl_texture_2d_ensure_non_quad_rendering (CoglTexture *tex)
   /* Nothing needs to be done */
 }
 
+static void
+_cogl_texture_2d_flush_uploads (CoglTexture2D *tex_2d)
+{
+  GLenum gl_format;
+  GLenum gl_type;
+  gboolean first_pixel_dirty = FALSE;
+  int i;
+
+  COGL_STATIC_COUNTER (texture_2d_batched_upload_counter,
+                       "Texture 2D batched upload counter",
+                       "Increments for each upload of a region that was "
+                       "batched from calls to cogl_texture_set_region",
+                       0 /* no application private data */);
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  if (tex_2d->n_dirty_rects == 0)
+    return;
+
+  ctx->texture_driver->pixel_format_to_gl (tex_2d->format,
+                                           NULL, /* internal format */
+                                           &gl_format,
+                                           &gl_type);
+
+  for (i = 0; i < tex_2d->n_dirty_rects; i++)
+    {
+      const CoglTexture2DDirtyRect *rect = tex_2d->dirty_rects + i;
+
+      COGL_COUNTER_INC (_cogl_uprof_context,
+                        texture_2d_batched_upload_counter);
+
+      ctx->texture_driver->upload_subregion_to_gl (GL_TEXTURE_2D,
+                                                   tex_2d->gl_texture,
+                                                   FALSE,
+                                                   rect->x0, rect->y0,
+                                                   rect->x0, rect->y0,
+                                                   rect->x1 - rect->x0,
+                                                   rect->y1 - rect->y0,
+                                                   tex_2d->shadow_bmp,
+                                                   gl_format,
+                                                   gl_type);
+
+      if (rect->x0 == 0 && rect->y0 == 0)
+        first_pixel_dirty = TRUE;
+    }
+
+  /* Keep our copy of the first pixel up to date for the mipmap
+   * fallback */
+  if (first_pixel_dirty &&
+      !cogl_has_feature (ctx, COGL_FEATURE_ID_OFFSCREEN))
+    {
+      guint8 *data = _cogl_bitmap_map (tex_2d->shadow_bmp,
+                                       COGL_BUFFER_ACCESS_READ, 0);
+
+      if (data)
+        {
+          tex_2d->first_pixel.gl_format = gl_format;
+          tex_2d->first_pixel.gl_type = gl_type;
+          memcpy (tex_2d->first_pixel.data, data,
+                  _cogl_get_format_bpp (tex_2d->format));
+
+          _cogl_bitmap_unmap (tex_2d->shadow_bmp);
+        }
+    }
+
+  tex_2d->n_dirty_rects = 0;
+}
+
+static gboolean
+_cogl_texture_2d_can_merge_rects (CoglTexture2D *tex_2d,
+                                  const CoglTexture2DDirtyRect *a,
+                                  const CoglTexture2DDirtyRect *b)
+{
+  int union_area, area_a, area_b;
+
+  if (!tex_2d->shadow_valid)
+    {
+      /* Only merge if one rectangle contains the other or if they
+       * share a whole edge so that the union doesn't contain any
+       * texels that weren't written */
+      if (a->x0 == b->x0 && a->x1 == b->x1)
+        return a->y0 <= b->y1 && b->y0 <= a->y1;
+      if (a->y0 == b->y0 && a->y1 == b->y1)
+        return a->x0 <= b->x1 && b->x0 <= a->x1;
+
+      return ((a->x0 <= b->x0 && a->y0 <= b->y0 &&
+               a->x1 >= b->x1 && a->y1 >= b->y1) ||
+              (b->x0 <= a->x0 && b->y0 <= a->y0 &&
+               b->x1 >= a->x1 && b->y1 >= a->y1));
+    }
+
+  /* Otherwise uploading some texels that didn't change is cheaper
+   * than another call into the driver as long as the union isn't
+   * mostly empty */
+  union_area = ((MAX (a->x1, b->x1) - MIN (a->x0, b->x0)) *
+                (MAX (a->y1, b->y1) - MIN (a->y0, b->y0)));
+  area_a = (a->x1 - a->x0) * (a->y1 - a->y0);
+  area_b = (b->x1 - b->x0) * (b->y1 - b->y0);
+
+  return union_area <= (area_a + area_b) * 2;
+}
+
+static void
+_cogl_texture_2d_union_rects (CoglTexture2DDirtyRect *dst,
+                              const CoglTexture2DDirtyRect *src)
+{
+  dst->x0 = MIN (dst->x0, src->x0);
+  dst->y0 = MIN (dst->y0, src->y0);
+  dst->x1 = MAX (dst->x1, src->x1);
+  dst->y1 = MAX (dst->y1, src->y1);
+}
+
+static void
+_cogl_texture_2d_add_dirty_rect (CoglTexture2D *tex_2d,
+                                 CoglTexture2DDirtyRect *rect)
+{
+  int i = 0;
+
+  COGL_STATIC_COUNTER (texture_2d_coalesced_upload_counter,
+                       "Texture 2D coalesced upload counter",
+                       "Increments each time a region passed to "
+                       "cogl_texture_set_region is merged with one that "
+                       "is already waiting to be uploaded",
+                       0 /* no application private data */);
+
+  /* Merging can make the rectangle touch one that it didn't before
+   * so we start again after each merge */
+  while (i < tex_2d->n_dirty_rects)
+    {
+      CoglTexture2DDirtyRect *other = tex_2d->dirty_rects + i;
+
+      if (_cogl_texture_2d_can_merge_rects (tex_2d, rect, other))
+        {
+          COGL_COUNTER_INC (_cogl_uprof_context,
+                            texture_2d_coalesced_upload_counter);
+
+          _cogl_texture_2d_union_rects (rect, other);
+          *other = tex_2d->dirty_rects[--tex_2d->n_dirty_rects];
+          i = 0;
+        }
+      else
+        i++;
+    }
+
+  if (tex_2d->n_dirty_rects >= COGL_TEXTURE_2D_MAX_DIRTY_RECTS)
+    {
+      if (tex_2d->shadow_valid)
+        {
+          int best = 0, best_growth = G_MAXINT;
+
+          /* Merge with the rectangle that grows the least */
+          for (i = 0; i < tex_2d->n_dirty_rects; i++)
+            {
+              CoglTexture2DDirtyRect merged = tex_2d->dirty_rects[i];
+              const CoglTexture2DDirtyRect *other = &tex_2d->dirty_rects[i];
+              int growth;
+
+              _cogl_texture_2d_union_rects (&merged, rect);
+              growth = ((merged.x1 - merged.x0) * (merged.y1 - merged.y0) -
+                        (other->x1 - other->x0) * (other->y1 - other->y0));
+
+              if (growth < best_growth)
+                {
+                  best = i;
+                  best_growth = growth;
+                }
+            }
+
+          COGL_COUNTER_INC (_cogl_uprof_context,
+                            texture_2d_coalesced_upload_counter);
+
+          _cogl_texture_2d_union_rects (rect, tex_2d->dirty_rects + best);
+          tex_2d->dirty_rects[best] =
+            tex_2d->dirty_rects[--tex_2d->n_dirty_rects];
+        }
+      else
+        _cogl_texture_2d_flush_uploads (tex_2d);
+    }
+
+  tex_2d->dirty_rects[tex_2d->n_dirty_rects++] = *rect;
+}
+
+/* Copies a region into the shadow copy of the texture and queues it
+ * to be uploaded the next time the texture is used */
+static gboolean
+_cogl_texture_2d_batch_region (CoglTexture2D *tex_2d,
+                               int src_x,
+                               int src_y,
+                               int dst_x,
+                               int dst_y,
+                               int width,
+                               int height,
+                               CoglBitmap *bmp)
+{
+  CoglTexture2DDirtyRect rect;
+
+  if (_cogl_bitmap_get_format (bmp) == tex_2d->format)
+    bmp = cogl_object_ref (bmp);
+  else if ((bmp = _cogl_bitmap_convert_format_and_premult (bmp,
+                                                           tex_2d->format))
+           == NULL)
+    return FALSE;
+
+  if (tex_2d->shadow_bmp == NULL)
+    {
+      int rowstride = tex_2d->width * _cogl_get_format_bpp (tex_2d->format);
+
+      tex_2d->shadow_bmp =
+        _cogl_bitmap_new_from_data (g_malloc (rowstride * tex_2d->height),
+                                    tex_2d->format,
+                                    tex_2d->width,
+                                    tex_2d->height,
+                                    rowstride,
+                                    (CoglBitmapDestroyNotify) g_free,
+                                    NULL);
+      tex_2d->shadow_valid = FALSE;
+    }
+
+  _cogl_bitmap_copy_subregion (bmp, tex_2d->shadow_bmp,
+                               src_x, src_y,
+                               dst_x, dst_y,
+                               width, height);
+
+  cogl_object_unref (bmp);
+
+  rect.x0 = dst_x;
+  rect.y0 = dst_y;
+  rect.x1 = dst_x + width;
+  rect.y1 = dst_y + height;
+
+  /* Writing the whole texture makes the shadow match the contents
+   * again and replaces any pending writes */
+  if (rect.x0 == 0 && rect.y0 == 0 &&
+      rect.x1 == tex_2d->width && rect.y1 == tex_2d->height)
+    {
+      tex_2d->shadow_valid = TRUE;
+      tex_2d->n_dirty_rects = 0;
+    }
+
+  _cogl_texture_2d_add_dirty_rect (tex_2d, &rect);
+
+  tex_2d->mipmaps_dirty = TRUE;
+
+  return TRUE;
+}
+
 static gboolean
 _cogl_texture_2d_set_region (CoglTexture    *tex,
                              int             src_x,
@@ -757,6 +1299,21 @@ _cogl_texture_2d_set_region (CoglTexture    *tex,
 
   _COGL_GET_CONTEXT (ctx, FALSE);
 
+  _cogl_texture_2d_ensure_resident (tex_2d);
+
+  /* Textures that are rendered to can't be batched because the
+   * rendering would be overwritten by the pending uploads */
+  if (tex_2d->batch_uploads &&
+      _cogl_texture_get_associated_framebuffers (tex) == NULL)
+    return _cogl_texture_2d_batch_region (tex_2d,
+                                          src_x, src_y,
+                                          dst_x, dst_y,
+                                          dst_width, dst_height,
+                                          bmp);
+
+  _cogl_texture_2d_flush_uploads (tex_2d);
+  tex_2d->shadow_valid = FALSE;
+
   bmp = _cogl_texture_prepare_for_upload (bmp,
                                           cogl_texture_get_format (tex),
                                           NULL,
@@ -811,6 +1368,9 @@ _cogl_texture_2d_get_data (CoglTexture     *tex,
 
   _COGL_GET_CONTEXT (ctx, FALSE);
 
+  _cogl_texture_2d_ensure_resident (tex_2d);
+  _cogl_texture_2d_flush_uploads (tex_2d);
+
   bpp = _cogl_get_format_bpp (format);
 
   ctx->texture_driver->pixel_format_to_gl (format,
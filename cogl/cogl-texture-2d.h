@@ -216,6 +216,83 @@ cogl_wayland_texture_2d_new_from_buffer (CoglContext *ctx,
                                          GError **error);
 #endif /* COGL_HAS_WAYLAND_EGL_SERVER_SUPPORT */
 
+/**
+ * CoglTexture2DRegenerateCallback:
+ * @texture: The texture whose storage was recreated
+ * @user_data: The private data passed to
+ *   cogl_texture_2d_set_regenerate_callback()
+ *
+ * The callback used by a #CoglTexture2D to recreate its contents
+ * after its storage was evicted to keep within the texture memory
+ * budget of the context. The callback should upload the contents
+ * again, for example with cogl_texture_set_region(). It is called
+ * while Cogl is about to use the texture so it must not draw
+ * anything.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+typedef void (*CoglTexture2DRegenerateCallback) (CoglTexture2D *texture,
+                                                 void *user_data);
+
+#define cogl_texture_2d_set_regenerate_callback \
+  cogl_texture_2d_set_regenerate_callback_EXP
+/**
+ * cogl_texture_2d_set_regenerate_callback:
+ * @texture: A #CoglTexture2D
+ * @callback: (allow-none): A #CoglTexture2DRegenerateCallback or
+ *   %NULL to make the texture non-evictable again
+ * @user_data: Private data to pass to @callback
+ * @destroy: (allow-none): A #CoglUserDataDestroyCallback to call when
+ *   @user_data is no longer needed
+ *
+ * Declares that the contents of @texture can be recreated by calling
+ * @callback. This lets Cogl free the storage of the texture when the
+ * context goes over the budget set with
+ * cogl_context_set_texture_memory_budget(). The next time the texture
+ * is used the storage is allocated again and @callback is called to
+ * fill it.
+ *
+ * Textures that wrap a foreign GL texture or an EGLImage and textures
+ * that are used as the target of an offscreen framebuffer are never
+ * evicted.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_texture_2d_set_regenerate_callback (CoglTexture2D *texture,
+                                         CoglTexture2DRegenerateCallback
+                                           callback,
+                                         void *user_data,
+                                         CoglUserDataDestroyCallback destroy);
+
+#define cogl_texture_2d_set_batch_uploads \
+  cogl_texture_2d_set_batch_uploads_EXP
+/**
+ * cogl_texture_2d_set_batch_uploads:
+ * @texture: A #CoglTexture2D
+ * @batch_uploads: Whether to batch uploads to @texture
+ *
+ * Sets whether data written to @texture with cogl_texture_set_region()
+ * is uploaded straight away. When uploads are batched the data is
+ * instead copied into a shadow copy of the texture in system memory
+ * and the modified regions are uploaded the next time the texture is
+ * used. Neighbouring regions are merged while they are waiting so
+ * that many small writes, such as glyphs being added to an atlas,
+ * only need a few uploads. This costs an extra copy of the texture in
+ * system memory.
+ *
+ * Writes to a texture that is the target of an offscreen framebuffer
+ * are always uploaded straight away.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_texture_2d_set_batch_uploads (CoglTexture2D *texture,
+                                   gboolean batch_uploads);
+
 G_END_DECLS
 
 #endif /* __COGL_TEXURE_2D_H */
@@ -90,11 +90,24 @@ _cogl_texture_3d_set_wrap_mode_parameters (CoglTexture *tex,
     }
 }
 
+static size_t
+_cogl_texture_3d_get_memory_size (CoglTexture3D *tex_3d)
+{
+  return ((size_t) tex_3d->width * tex_3d->height * tex_3d->depth *
+          _cogl_get_format_bpp (tex_3d->format));
+}
+
 static void
 _cogl_texture_3d_free (CoglTexture3D *tex_3d)
 {
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
   _cogl_delete_gl_texture (tex_3d->gl_texture);
 
+  _cogl_context_remove_memory_usage (ctx,
+                                     COGL_MEMORY_USAGE_TYPE_TEXTURE_3D,
+                                     _cogl_texture_3d_get_memory_size (tex_3d));
+
   /* Chain up */
   _cogl_texture_free (COGL_TEXTURE (tex_3d));
 }
@@ -169,6 +182,16 @@ _cogl_texture_3d_can_create (unsigned int     width,
       return FALSE;
     }
 
+  if (!_cogl_texture_format_is_supported (ctx, internal_format))
+    {
+      g_set_error (error,
+                   COGL_ERROR,
+                   COGL_ERROR_UNSUPPORTED,
+                   "The requested texture format is not supported by the "
+                   "GPU");
+      return FALSE;
+    }
+
   ctx->texture_driver->pixel_format_to_gl (internal_format,
                                            &gl_intformat,
                                            NULL,
@@ -231,6 +254,10 @@ cogl_texture_3d_new_with_size (unsigned int     width,
   GE( ctx, glTexImage3D (GL_TEXTURE_3D, 0, gl_intformat,
                          width, height, depth, 0, gl_format, gl_type, NULL) );
 
+  _cogl_context_add_memory_usage (ctx,
+                                  COGL_MEMORY_USAGE_TYPE_TEXTURE_3D,
+                                  _cogl_texture_3d_get_memory_size (tex_3d));
+
   return _cogl_texture_3d_handle_new (tex_3d);
 }
 
@@ -309,6 +336,10 @@ _cogl_texture_3d_new_from_bitmap (CoglBitmap      *bmp,
 
   tex_3d->gl_format = gl_intformat;
 
+  _cogl_context_add_memory_usage (ctx,
+                                  COGL_MEMORY_USAGE_TYPE_TEXTURE_3D,
+                                  _cogl_texture_3d_get_memory_size (tex_3d));
+
   cogl_object_unref (dst_bmp);
 
   return _cogl_texture_3d_handle_new (tex_3d);
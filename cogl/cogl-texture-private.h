@@ -212,9 +212,16 @@ _cogl_texture_pre_paint (CoglTexture *texture, CoglTexturePrePaintFlags flags);
 void
 _cogl_texture_ensure_non_quad_rendering (CoglTexture *texture);
 
+/* Checks whether the driver can store textures in the given format.
+   This only fails for the floating point and red-green formats */
+gboolean
+_cogl_texture_format_is_supported (CoglContext *ctx,
+                                   CoglPixelFormat format);
+
 /* Utility function to determine which pixel format to use when
    dst_format is COGL_PIXEL_FORMAT_ANY. If dst_format is not ANY then
-   it will just be returned directly */
+   it will just be returned directly. A floating point format is
+   replaced with an 8-bit format if the driver can't store it */
 CoglPixelFormat
 _cogl_texture_determine_internal_format (CoglPixelFormat src_format,
                                          CoglPixelFormat dst_format);
@@ -99,11 +99,27 @@ _cogl_texture_rectangle_set_wrap_mode_parameters (CoglTexture *tex,
     }
 }
 
+static size_t
+_cogl_texture_rectangle_get_memory_size (CoglTextureRectangle *tex_rect)
+{
+  return ((size_t) tex_rect->width * tex_rect->height *
+          _cogl_get_format_bpp (tex_rect->format));
+}
+
 static void
 _cogl_texture_rectangle_free (CoglTextureRectangle *tex_rect)
 {
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
   if (!tex_rect->is_foreign)
-    _cogl_delete_gl_texture (tex_rect->gl_texture);
+    {
+      _cogl_delete_gl_texture (tex_rect->gl_texture);
+
+      _cogl_context_remove_memory_usage
+        (ctx,
+         COGL_MEMORY_USAGE_TYPE_TEXTURE_RECTANGLE,
+         _cogl_texture_rectangle_get_memory_size (tex_rect));
+    }
 
   /* Chain up */
   _cogl_texture_free (COGL_TEXTURE (tex_rect));
@@ -129,6 +145,15 @@ _cogl_texture_rectangle_can_create (unsigned int width,
       return FALSE;
     }
 
+  if (!_cogl_texture_format_is_supported (ctx, internal_format))
+    {
+      g_set_error (error,
+                   COGL_TEXTURE_ERROR,
+                   COGL_TEXTURE_ERROR_FORMAT,
+                   "The requested texture format is unsupported");
+      return FALSE;
+    }
+
   ctx->texture_driver->pixel_format_to_gl (internal_format,
                                            &gl_intformat,
                                            NULL,
@@ -172,6 +197,8 @@ _cogl_texture_rectangle_create_base (unsigned int     width,
   tex_rect->wrap_mode_s = GL_FALSE;
   tex_rect->wrap_mode_t = GL_FALSE;
 
+  tex_rect->is_foreign = FALSE;
+
   tex_rect->format = internal_format;
 
   return tex_rect;
@@ -212,6 +239,11 @@ cogl_texture_rectangle_new_with_size (CoglContext *ctx,
   GE( ctx, glTexImage2D (GL_TEXTURE_RECTANGLE_ARB, 0, gl_intformat,
                          width, height, 0, gl_format, gl_type, NULL) );
 
+  _cogl_context_add_memory_usage
+    (ctx,
+     COGL_MEMORY_USAGE_TYPE_TEXTURE_RECTANGLE,
+     _cogl_texture_rectangle_get_memory_size (tex_rect));
+
   return _cogl_texture_rectangle_object_new (tex_rect);
 }
 
@@ -265,6 +297,11 @@ _cogl_texture_rectangle_new_from_bitmap (CoglBitmap      *bmp,
 
   tex_rect->gl_format = gl_intformat;
 
+  _cogl_context_add_memory_usage
+    (ctx,
+     COGL_MEMORY_USAGE_TYPE_TEXTURE_RECTANGLE,
+     _cogl_texture_rectangle_get_memory_size (tex_rect));
+
   cogl_object_unref (dst_bmp);
 
   return _cogl_texture_rectangle_object_new (tex_rect);
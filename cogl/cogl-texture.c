@@ -149,16 +149,50 @@ _cogl_texture_needs_premult_conversion (CoglPixelFormat src_format,
           (dst_format & COGL_PREMULT_BIT));
 }
 
+gboolean
+_cogl_texture_format_is_supported (CoglContext *ctx,
+                                   CoglPixelFormat format)
+{
+  switch (format & COGL_UNPREMULT_MASK)
+    {
+    case COGL_PIXEL_FORMAT_R_16F:
+    case COGL_PIXEL_FORMAT_RG_16F:
+      return (cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_HALF_FLOAT) &&
+              cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_RG));
+
+    case COGL_PIXEL_FORMAT_RGBA_16F:
+      return cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_HALF_FLOAT);
+
+    case COGL_PIXEL_FORMAT_RGBA_32F:
+      return cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_FLOAT);
+
+    case COGL_PIXEL_FORMAT_R_8:
+    case COGL_PIXEL_FORMAT_RG_88:
+      return cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_RG);
+
+    default:
+      return TRUE;
+    }
+}
+
 CoglPixelFormat
 _cogl_texture_determine_internal_format (CoglPixelFormat src_format,
                                          CoglPixelFormat dst_format)
 {
+  _COGL_GET_CONTEXT (ctx, dst_format);
+
   /* If the application hasn't specified a specific format then we'll
    * pick the most appropriate. By default Cogl will use a
    * premultiplied internal format. Later we will add control over
    * this. */
   if (dst_format == COGL_PIXEL_FORMAT_ANY)
     {
+      /* Floating point and red-green data is converted if the driver
+       * can't store it directly */
+      if (!_cogl_texture_format_is_supported (ctx, src_format))
+        src_format = (COGL_PIXEL_FORMAT_RGBA_8888 |
+                      (src_format & COGL_PREMULT_BIT));
+
       if ((src_format & COGL_A_BIT) &&
           src_format != COGL_PIXEL_FORMAT_A_8)
         return src_format | COGL_PREMULT_BIT;
@@ -386,6 +420,34 @@ cogl_texture_new_from_bitmap (CoglBitmap *bitmap,
                                                            internal_format));
 }
 
+/* Regenerate callback for textures loaded from a file so that their
+ * storage can be evicted to keep within the texture memory budget */
+static void
+_cogl_texture_reload_file_cb (CoglTexture2D *texture,
+                              void *user_data)
+{
+  const char *filename = user_data;
+  int width = cogl_texture_get_width (COGL_TEXTURE (texture));
+  int height = cogl_texture_get_height (COGL_TEXTURE (texture));
+  CoglBitmap *bmp;
+
+  bmp = cogl_bitmap_new_from_file (filename, NULL);
+
+  if (bmp == NULL ||
+      _cogl_bitmap_get_width (bmp) < width ||
+      _cogl_bitmap_get_height (bmp) < height)
+    g_warning ("Failed to reload the evicted texture \"%s\"", filename);
+  else
+    cogl_texture_set_region_from_bitmap (COGL_TEXTURE (texture),
+                                         0, 0, /* src_x/y */
+                                         0, 0, /* dst_x/y */
+                                         width, height,
+                                         bmp);
+
+  if (bmp)
+    cogl_object_unref (bmp);
+}
+
 CoglTexture *
 cogl_texture_new_from_file (const char        *filename,
                             CoglTextureFlags   flags,
@@ -416,6 +478,14 @@ cogl_texture_new_from_file (const char        *filename,
 
   cogl_object_unref (bmp);
 
+  /* The file can be loaded again if the storage of the texture is
+     evicted. Only plain 2D textures can be evicted */
+  if (texture && cogl_is_texture_2d (texture))
+    cogl_texture_2d_set_regenerate_callback (COGL_TEXTURE_2D (texture),
+                                             _cogl_texture_reload_file_cb,
+                                             g_strdup (filename),
+                                             g_free);
+
   return texture;
 }
 
@@ -1011,38 +1081,60 @@ get_texture_bits_via_offscreen (CoglTexture    *texture,
                                 unsigned int    dst_rowstride,
                                 CoglPixelFormat dst_format)
 {
-  CoglFramebuffer *framebuffer;
+  GLuint gl_handle;
+  GLenum gl_target;
+  gboolean ret;
 
   _COGL_GET_CONTEXT (ctx, FALSE);
 
   if (!cogl_has_feature (ctx, COGL_FEATURE_ID_OFFSCREEN))
     return FALSE;
 
-  framebuffer = _cogl_offscreen_new_to_texture_full
-                                      (texture,
-                                       COGL_OFFSCREEN_DISABLE_DEPTH_AND_STENCIL,
-                                       0);
+  if (!cogl_texture_get_gl_texture (texture, &gl_handle, &gl_target))
+    return FALSE;
 
-  if (framebuffer == NULL)
+  if (gl_target != GL_TEXTURE_2D
+#ifdef HAVE_COGL_GL
+      && gl_target != GL_TEXTURE_RECTANGLE_ARB
+#endif
+      )
     return FALSE;
 
-  if (!cogl_framebuffer_allocate (framebuffer, NULL))
-    {
-      cogl_object_unref (framebuffer);
-      return FALSE;
-    }
+  /* Creating a CoglOffscreen for every read is expensive so instead
+   * the texture is temporarily attached to an fbo that is kept for
+   * the lifetime of the context. No journal needs to be flushed
+   * because nothing is drawn to it */
+  if (ctx->texture_download_fbo == 0)
+    ctx->glGenFramebuffers (1, &ctx->texture_download_fbo);
 
-  cogl_push_framebuffer (framebuffer);
+  /* Some drivers consider the fbo incomplete if the texture has a
+   * mipmap filter but no mipmaps. The filters will be reset when the
+   * texture is next used for rendering */
+  _cogl_texture_set_filters (texture, GL_NEAREST, GL_NEAREST);
 
-  _cogl_read_pixels_with_rowstride (x, y, width, height,
-                                    COGL_READ_PIXELS_COLOR_BUFFER,
-                                    dst_format, dst_bits, dst_rowstride);
+  /* Make sure the current framebuffer is bound again before anything
+   * is drawn */
+  ctx->current_draw_buffer_changes |= COGL_FRAMEBUFFER_STATE_BIND;
 
-  cogl_pop_framebuffer ();
+  GE (ctx, glBindFramebuffer (GL_FRAMEBUFFER, ctx->texture_download_fbo));
+  GE (ctx, glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   gl_target, gl_handle, 0));
 
-  cogl_object_unref (framebuffer);
+  ret = (ctx->glCheckFramebufferStatus (GL_FRAMEBUFFER) ==
+         GL_FRAMEBUFFER_COMPLETE);
 
-  return TRUE;
+  /* The rows of a texture attached to an fbo are in the same order
+   * as the texture data so there's no need to flip */
+  if (ret)
+    _cogl_read_pixels_from_gl (x, y, width, height,
+                               cogl_texture_get_format (texture),
+                               dst_format, dst_bits, dst_rowstride);
+
+  /* Detach the texture so that the fbo doesn't keep it alive */
+  GE (ctx, glFramebufferTexture2D (GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   gl_target, 0, 0));
+
+  return ret;
 }
 
 static gboolean
@@ -1345,6 +1437,9 @@ _cogl_texture_associate_framebuffer (CoglTexture *texture,
                               &framebuffer_destroy_notify_key,
                               texture,
                               _cogl_texture_framebuffer_destroy_cb);
+
+  /* Rendering will make the shadow copy used to batch uploads stale */
+  _cogl_texture_2d_externally_modified (texture);
 }
 
 const GList *
@@ -1360,9 +1455,11 @@ _cogl_texture_flush_journal_rendering (CoglTexture *texture)
 
   /* It could be that a referenced texture is part of a framebuffer
    * which has an associated journal that must be flushed before it
-   * can be sampled from by the current primitive... */
+   * can be sampled from by the current primitive. If the framebuffer
+   * is multisampled then the samples may also need to be resolved
+   * into the texture... */
   for (l = texture->framebuffers; l; l = l->next)
-    _cogl_framebuffer_flush_journal (l->data);
+    _cogl_framebuffer_resolve_damage (l->data);
 }
 
 /* This function lets you define a meta texture as a grid of textures
@@ -0,0 +1,64 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifndef __COGL_TRANSIENT_OFFSCREEN_PRIVATE_H
+#define __COGL_TRANSIENT_OFFSCREEN_PRIVATE_H
+
+#include "cogl-transient-offscreen.h"
+
+/* Unused framebuffers are destroyed once they haven't been borrowed
+ * for this many frames */
+#define COGL_TRANSIENT_OFFSCREEN_MAX_AGE 3
+
+/* The default for the maximum size of the unused framebuffers */
+#define COGL_TRANSIENT_OFFSCREEN_DEFAULT_BUDGET (32 * 1024 * 1024)
+
+typedef struct
+{
+  CoglFramebuffer *framebuffer;
+
+  int width;
+  int height;
+  CoglPixelFormat format;
+  CoglTransientOffscreenFlags flags;
+
+  /* An estimate of the memory used by the texture and any depth and
+   * stencil buffer */
+  size_t size;
+
+  gboolean in_use;
+  /* The value of ctx->transient_offscreen_frame when the framebuffer
+   * was last released */
+  unsigned int release_frame;
+} CoglTransientOffscreen;
+
+void
+_cogl_transient_offscreen_pool_free (CoglContext *context);
+
+/* Called once per frame when an onscreen framebuffer is swapped to
+ * age the unused framebuffers */
+void
+_cogl_transient_offscreen_pool_end_frame (CoglContext *context);
+
+#endif /* __COGL_TRANSIENT_OFFSCREEN_PRIVATE_H */
@@ -0,0 +1,289 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "cogl-transient-offscreen-private.h"
+#include "cogl-context-private.h"
+#include "cogl-framebuffer-private.h"
+#include "cogl-texture-2d.h"
+#include "cogl-internal.h"
+#include "cogl-profile.h"
+
+static void
+_cogl_transient_offscreen_free (CoglContext *context,
+                                CoglTransientOffscreen *target)
+{
+  if (!target->in_use)
+    context->transient_offscreen_unused_size -= target->size;
+
+  cogl_object_unref (target->framebuffer);
+  g_slice_free (CoglTransientOffscreen, target);
+}
+
+/* Destroys the unused framebuffers that were released the longest
+ * time ago until the unused framebuffers fit in the budget */
+static void
+_cogl_transient_offscreen_pool_trim (CoglContext *context)
+{
+  while (context->transient_offscreen_unused_size >
+         context->transient_offscreen_budget)
+    {
+      GList *oldest = NULL, *l;
+
+      for (l = context->transient_offscreens; l; l = l->next)
+        {
+          CoglTransientOffscreen *target = l->data;
+
+          if (!target->in_use &&
+              (oldest == NULL ||
+               target->release_frame <
+               ((CoglTransientOffscreen *) oldest->data)->release_frame))
+            oldest = l;
+        }
+
+      _cogl_transient_offscreen_free (context, oldest->data);
+      context->transient_offscreens =
+        g_list_delete_link (context->transient_offscreens, oldest);
+    }
+}
+
+static CoglTransientOffscreen *
+_cogl_transient_offscreen_new (CoglContext *context,
+                               int width,
+                               int height,
+                               CoglPixelFormat format,
+                               CoglTransientOffscreenFlags flags)
+{
+  CoglTransientOffscreen *target;
+  CoglTexture2D *texture;
+  CoglHandle offscreen;
+  CoglOffscreenFlags create_flags;
+
+  texture = cogl_texture_2d_new_with_size (context,
+                                           width, height,
+                                           format,
+                                           NULL);
+  if (texture == NULL)
+    return NULL;
+
+  if ((flags & COGL_TRANSIENT_OFFSCREEN_FLAG_DEPTH_STENCIL))
+    create_flags = 0;
+  else
+    create_flags = COGL_OFFSCREEN_DISABLE_DEPTH_AND_STENCIL;
+
+  offscreen = _cogl_offscreen_new_to_texture_full (COGL_TEXTURE (texture),
+                                                   create_flags,
+                                                   0 /* level */);
+  /* The offscreen keeps its own reference on the texture */
+  cogl_object_unref (texture);
+
+  if (offscreen == COGL_INVALID_HANDLE)
+    return NULL;
+
+  if (!cogl_framebuffer_allocate (offscreen, NULL))
+    {
+      cogl_object_unref (offscreen);
+      return NULL;
+    }
+
+  /* The pool is owned by the context so its framebuffers mustn't
+   * keep the context alive. They are all destroyed by
+   * _cogl_transient_offscreen_pool_free when the context is freed */
+  _cogl_framebuffer_release_context_ref (offscreen);
+
+  target = g_slice_new (CoglTransientOffscreen);
+  target->framebuffer = offscreen;
+  target->width = width;
+  target->height = height;
+  target->format = format;
+  target->flags = flags;
+  target->size = (size_t) width * height * _cogl_get_format_bpp (format);
+  /* Assume a packed 24-bit depth and 8-bit stencil buffer */
+  if ((flags & COGL_TRANSIENT_OFFSCREEN_FLAG_DEPTH_STENCIL))
+    target->size += (size_t) width * height * 4;
+  target->in_use = FALSE;
+  target->release_frame = 0;
+
+  return target;
+}
+
+CoglFramebuffer *
+cogl_context_acquire_transient_offscreen (CoglContext *context,
+                                          int width,
+                                          int height,
+                                          CoglPixelFormat format,
+                                          CoglTransientOffscreenFlags flags,
+                                          CoglTexture **texture)
+{
+  CoglTransientOffscreen *target = NULL;
+  CoglFramebuffer *framebuffer;
+  CoglMatrix identity;
+  GList *l;
+
+  COGL_STATIC_COUNTER (transient_offscreen_created_counter,
+                       "Transient offscreen created counter",
+                       "Increments each time a transient offscreen "
+                       "framebuffer can't be recycled from the pool",
+                       0 /* no application private data */);
+
+  _COGL_RETURN_VAL_IF_FAIL (width > 0 && height > 0, NULL);
+
+  for (l = context->transient_offscreens; l; l = l->next)
+    {
+      CoglTransientOffscreen *candidate = l->data;
+
+      if (!candidate->in_use &&
+          candidate->width == width &&
+          candidate->height == height &&
+          candidate->format == format &&
+          candidate->flags == flags)
+        {
+          target = candidate;
+          break;
+        }
+    }
+
+  if (target)
+    {
+      /* Batched drawing from earlier in the frame may still be
+       * sampling from the texture so it has to be flushed before the
+       * new contents are drawn. Swapping buffers flushes everything
+       * so this isn't needed for framebuffers released in an earlier
+       * frame */
+      if (target->release_frame == context->transient_offscreen_frame)
+        for (l = context->framebuffers; l; l = l->next)
+          _cogl_framebuffer_flush_journal (l->data);
+
+      context->transient_offscreen_unused_size -= target->size;
+
+      framebuffer = target->framebuffer;
+
+      cogl_framebuffer_set_viewport (framebuffer, 0, 0, width, height);
+      cogl_framebuffer_identity_matrix (framebuffer);
+      cogl_matrix_init_identity (&identity);
+      cogl_framebuffer_set_projection_matrix (framebuffer, &identity);
+    }
+  else
+    {
+      COGL_COUNTER_INC (_cogl_uprof_context,
+                        transient_offscreen_created_counter);
+
+      target = _cogl_transient_offscreen_new (context,
+                                              width, height,
+                                              format, flags);
+      if (target == NULL)
+        return NULL;
+
+      context->transient_offscreens =
+        g_list_prepend (context->transient_offscreens, target);
+
+      framebuffer = target->framebuffer;
+    }
+
+  target->in_use = TRUE;
+
+  if (texture)
+    *texture = COGL_OFFSCREEN (framebuffer)->texture;
+
+  return framebuffer;
+}
+
+void
+cogl_context_release_transient_offscreen (CoglContext *context,
+                                          CoglFramebuffer *offscreen)
+{
+  GList *l;
+
+  for (l = context->transient_offscreens; l; l = l->next)
+    {
+      CoglTransientOffscreen *target = l->data;
+
+      if (target->framebuffer == offscreen)
+        {
+          _COGL_RETURN_IF_FAIL (target->in_use);
+
+          target->in_use = FALSE;
+          target->release_frame = context->transient_offscreen_frame;
+          context->transient_offscreen_unused_size += target->size;
+
+          _cogl_transient_offscreen_pool_trim (context);
+
+          return;
+        }
+    }
+
+  g_warning ("cogl_context_release_transient_offscreen: The framebuffer "
+             "was not acquired from the transient offscreen pool");
+}
+
+void
+cogl_context_set_transient_offscreen_budget (CoglContext *context,
+                                             size_t max_bytes)
+{
+  context->transient_offscreen_budget = max_bytes;
+
+  _cogl_transient_offscreen_pool_trim (context);
+}
+
+void
+_cogl_transient_offscreen_pool_end_frame (CoglContext *context)
+{
+  GList *l, *next;
+
+  context->transient_offscreen_frame++;
+
+  for (l = context->transient_offscreens; l; l = next)
+    {
+      CoglTransientOffscreen *target = l->data;
+
+      next = l->next;
+
+      if (!target->in_use &&
+          (context->transient_offscreen_frame - target->release_frame >
+           COGL_TRANSIENT_OFFSCREEN_MAX_AGE))
+        {
+          _cogl_transient_offscreen_free (context, target);
+          context->transient_offscreens =
+            g_list_delete_link (context->transient_offscreens, l);
+        }
+    }
+}
+
+void
+_cogl_transient_offscreen_pool_free (CoglContext *context)
+{
+  GList *l;
+
+  /* Framebuffers that are still borrowed are destroyed too. The
+   * application shouldn't be using them after destroying the
+   * context */
+  for (l = context->transient_offscreens; l; l = l->next)
+    _cogl_transient_offscreen_free (context, l->data);
+
+  g_list_free (context->transient_offscreens);
+  context->transient_offscreens = NULL;
+}
@@ -0,0 +1,150 @@
+/*
+ * Cogl
+ *
+ * An object oriented GL/GLES Abstraction/Utility Layer
+ *
+ * Copyright (C) 2012 Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+#if !defined(__COGL_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <cogl/cogl.h> can be included directly."
+#endif
+
+#ifndef __COGL_TRANSIENT_OFFSCREEN_H__
+#define __COGL_TRANSIENT_OFFSCREEN_H__
+
+#include <glib.h>
+#include <cogl/cogl-context.h>
+#include <cogl/cogl-framebuffer.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION:cogl-transient-offscreen
+ * @short_description: Functions for borrowing short lived offscreen
+ *                     framebuffers
+ *
+ * Effects such as blurs and shadows typically render into an
+ * intermediate texture that is only needed for part of a frame.
+ * Creating a new texture and offscreen framebuffer for this every
+ * frame is expensive because the driver has to allocate the storage
+ * and check that the framebuffer is complete each time.
+ *
+ * Instead an application can borrow a transient offscreen
+ * framebuffer from a pool kept by the #CoglContext and give it back
+ * when it is finished with it. Framebuffers that haven't been used
+ * for a few frames are destroyed and the total size of the unused
+ * framebuffers kept in the pool is limited.
+ */
+
+/**
+ * CoglTransientOffscreenFlags:
+ * @COGL_TRANSIENT_OFFSCREEN_FLAG_NONE: No flags
+ * @COGL_TRANSIENT_OFFSCREEN_FLAG_DEPTH_STENCIL: The framebuffer needs
+ *   a depth and stencil buffer
+ *
+ * Flags to pass to cogl_context_acquire_transient_offscreen() to
+ * describe the framebuffer that is needed.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+typedef enum
+{
+  COGL_TRANSIENT_OFFSCREEN_FLAG_NONE = 0,
+  COGL_TRANSIENT_OFFSCREEN_FLAG_DEPTH_STENCIL = 1 << 0
+} CoglTransientOffscreenFlags;
+
+/**
+ * cogl_context_acquire_transient_offscreen:
+ * @context: A #CoglContext
+ * @width: The width of the framebuffer
+ * @height: The height of the framebuffer
+ * @format: The internal format of the texture to render to
+ * @flags: A #CoglTransientOffscreenFlags
+ * @texture: (out) (allow-none): Return location for the texture that
+ *   the framebuffer renders to or %NULL
+ *
+ * Borrows an offscreen framebuffer from the context's pool, creating
+ * a new one if there isn't an unused framebuffer with the same size,
+ * format and flags. The framebuffer and the texture are owned by the
+ * pool so they must not be unreferenced. Instead the framebuffer must
+ * be given back with cogl_context_release_transient_offscreen() once
+ * the results have been used.
+ *
+ * The contents of a recycled framebuffer are undefined so the
+ * application should clear it or draw over all of it. The viewport,
+ * the projection matrix and the modelview matrix are reset to their
+ * defaults.
+ *
+ * Return value: (transfer none): An allocated offscreen
+ *               #CoglFramebuffer or %NULL if one couldn't be created
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+CoglFramebuffer *
+cogl_context_acquire_transient_offscreen (CoglContext *context,
+                                          int width,
+                                          int height,
+                                          CoglPixelFormat format,
+                                          CoglTransientOffscreenFlags flags,
+                                          CoglTexture **texture);
+
+/**
+ * cogl_context_release_transient_offscreen:
+ * @context: A #CoglContext
+ * @offscreen: A framebuffer returned by
+ *   cogl_context_acquire_transient_offscreen()
+ *
+ * Gives a framebuffer borrowed with
+ * cogl_context_acquire_transient_offscreen() back to the pool so that
+ * it can be reused. Any drawing that samples from its texture can
+ * still be batched up because Cogl makes sure that it is finished
+ * before the framebuffer is drawn to again. However the texture must
+ * not be used for new drawing after calling this.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_context_release_transient_offscreen (CoglContext *context,
+                                          CoglFramebuffer *offscreen);
+
+/**
+ * cogl_context_set_transient_offscreen_budget:
+ * @context: A #CoglContext
+ * @max_bytes: The maximum size of the unused framebuffers to keep
+ *
+ * Sets an estimate of the maximum amount of memory that the unused
+ * framebuffers in the transient offscreen pool can use. When this is
+ * exceeded the framebuffers that were released the longest time ago
+ * are destroyed. Framebuffers that are currently borrowed don't count
+ * towards the budget.
+ *
+ * Since: 1.10
+ * Stability: unstable
+ */
+void
+cogl_context_set_transient_offscreen_budget (CoglContext *context,
+                                             size_t max_bytes);
+
+G_END_DECLS
+
+#endif /* __COGL_TRANSIENT_OFFSCREEN_H__ */
@@ -193,6 +193,17 @@ typedef struct _CoglTextureVertex       CoglTextureVertex;
  * @COGL_PIXEL_FORMAT_ABGR_8888_PRE: Premultiplied ABGR, 32 bits
  * @COGL_PIXEL_FORMAT_RGBA_4444_PRE: Premultiplied RGBA, 16 bits
  * @COGL_PIXEL_FORMAT_RGBA_5551_PRE: Premultiplied RGBA, 16 bits
+ * @COGL_PIXEL_FORMAT_R_16F: Single red component, 16-bit half float
+ * @COGL_PIXEL_FORMAT_RG_16F: Red and green components, 16-bit half
+ *   float per component
+ * @COGL_PIXEL_FORMAT_RGBA_16F: RGBA, 16-bit half float per component
+ * @COGL_PIXEL_FORMAT_RGBA_32F: RGBA, 32-bit float per component
+ * @COGL_PIXEL_FORMAT_RGBA_16F_PRE: Premultiplied RGBA, 16-bit half
+ *   float per component
+ * @COGL_PIXEL_FORMAT_RGBA_32F_PRE: Premultiplied RGBA, 32-bit float
+ *   per component
+ * @COGL_PIXEL_FORMAT_R_8: Single red component, 8 bits
+ * @COGL_PIXEL_FORMAT_RG_88: Red and green components, 8 bits each
  *
  * Pixel formats used by COGL. For the formats with a byte per
  * component, the order of the components specify the order in
@@ -208,6 +219,23 @@ typedef struct _CoglTextureVertex       CoglTextureVertex;
  * the blue component would be in 1-5. Therefore the order in memory
  * depends on the endianness of the system.
  *
+ * The floating point formats store each component as a native endian
+ * float or as an IEEE 754 half float in a 16-bit number, in the order
+ * given by the name of the format. Textures can only use them if the
+ * %COGL_FEATURE_ID_TEXTURE_HALF_FLOAT or
+ * %COGL_FEATURE_ID_TEXTURE_FLOAT feature is available. The formats
+ * with only red or red and green components additionally need
+ * %COGL_FEATURE_ID_TEXTURE_RG. Unlike the 8-bit formats, values
+ * outside of the range 0 to 1 can be stored so they are suitable for
+ * high dynamic range rendering and accumulation buffers.
+ *
+ * %COGL_PIXEL_FORMAT_R_8 and %COGL_PIXEL_FORMAT_RG_88 also need
+ * %COGL_FEATURE_ID_TEXTURE_RG. When they are sampled the missing
+ * components read as 0 and the alpha as 1, so unlike
+ * %COGL_PIXEL_FORMAT_A_8 the value has to be taken from the red
+ * component. They are stored natively by GPUs that don't support
+ * alpha-only textures efficiently.
+ *
  * When uploading a texture %COGL_PIXEL_FORMAT_ANY can be used as the
  * internal format. Cogl will try to pick the best format to use
  * internally and convert the texture data if necessary.
@@ -224,6 +252,13 @@ typedef enum { /*< prefix=COGL_PIXEL_FORMAT >*/
   COGL_PIXEL_FORMAT_YUV           = 7,
   COGL_PIXEL_FORMAT_G_8           = 8,
 
+  COGL_PIXEL_FORMAT_R_16F         = 9,
+  COGL_PIXEL_FORMAT_RG_16F        = 10,
+  COGL_PIXEL_FORMAT_RGBA_16F      = 11 | COGL_A_BIT,
+  COGL_PIXEL_FORMAT_RGBA_32F      = 12 | COGL_A_BIT,
+  COGL_PIXEL_FORMAT_R_8           = 13,
+  COGL_PIXEL_FORMAT_RG_88         = 14,
+
   COGL_PIXEL_FORMAT_RGB_888       =  COGL_PIXEL_FORMAT_24,
   COGL_PIXEL_FORMAT_BGR_888       = (COGL_PIXEL_FORMAT_24 | COGL_BGR_BIT),
 
@@ -237,7 +272,9 @@ typedef enum { /*< prefix=COGL_PIXEL_FORMAT >*/
   COGL_PIXEL_FORMAT_ARGB_8888_PRE = (COGL_PIXEL_FORMAT_32 | COGL_A_BIT | COGL_PREMULT_BIT | COGL_AFIRST_BIT),
   COGL_PIXEL_FORMAT_ABGR_8888_PRE = (COGL_PIXEL_FORMAT_32 | COGL_A_BIT | COGL_PREMULT_BIT | COGL_BGR_BIT | COGL_AFIRST_BIT),
   COGL_PIXEL_FORMAT_RGBA_4444_PRE = (COGL_PIXEL_FORMAT_RGBA_4444 | COGL_A_BIT | COGL_PREMULT_BIT),
-  COGL_PIXEL_FORMAT_RGBA_5551_PRE = (COGL_PIXEL_FORMAT_RGBA_5551 | COGL_A_BIT | COGL_PREMULT_BIT)
+  COGL_PIXEL_FORMAT_RGBA_5551_PRE = (COGL_PIXEL_FORMAT_RGBA_5551 | COGL_A_BIT | COGL_PREMULT_BIT),
+  COGL_PIXEL_FORMAT_RGBA_16F_PRE  = (COGL_PIXEL_FORMAT_RGBA_16F | COGL_PREMULT_BIT),
+  COGL_PIXEL_FORMAT_RGBA_32F_PRE  = (COGL_PIXEL_FORMAT_RGBA_32F | COGL_PREMULT_BIT)
 } CoglPixelFormat;
 
 /**
@@ -673,6 +710,11 @@ typedef enum _CoglWinsysFeature
    * only needs to be throttled to the framerate */
   COGL_WINSYS_FEATURE_SWAP_REGION_SYNCHRONIZED,
 
+  /* Available if the age of the back buffer can be queried so that
+   * only the regions damaged since it was last presented need to be
+   * redrawn */
+  COGL_WINSYS_FEATURE_BUFFER_AGE,
+
   COGL_WINSYS_FEATURE_N_FEATURES
 } CoglWinsysFeature;
 
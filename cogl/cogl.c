@@ -369,71 +369,24 @@ cogl_flush (void)
 }
 
 void
-_cogl_read_pixels_with_rowstride (int x,
-                                  int y,
-                                  int width,
-                                  int height,
-                                  CoglReadPixelsFlags source,
-                                  CoglPixelFormat format,
-                                  guint8 *pixels,
-                                  int rowstride)
+_cogl_read_pixels_from_gl (int x,
+                           int y,
+                           int width,
+                           int height,
+                           CoglPixelFormat source_format,
+                           CoglPixelFormat format,
+                           guint8 *pixels,
+                           int rowstride)
 {
-  CoglFramebuffer *framebuffer = _cogl_get_read_framebuffer ();
-  int              framebuffer_height;
   int              bpp;
   CoglBitmap      *bmp;
   GLenum           gl_intformat;
   GLenum           gl_format;
   GLenum           gl_type;
   CoglPixelFormat  bmp_format;
-  gboolean         pack_invert_set;
 
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
-  _COGL_RETURN_IF_FAIL (source == COGL_READ_PIXELS_COLOR_BUFFER);
-
-  if (width == 1 && height == 1 && !framebuffer->clear_clip_dirty)
-    {
-      /* If everything drawn so far for this frame is still in the
-       * Journal then if all of the rectangles only have a flat
-       * opaque color we have a fast-path for reading a single pixel
-       * that avoids the relatively high cost of flushing primitives
-       * to be drawn on the GPU (considering how simple the geometry
-       * is in this case) and then blocking on the long GPU pipelines
-       * for the result.
-       */
-      if (_cogl_framebuffer_try_fast_read_pixel (framebuffer,
-                                                 x, y, source, format,
-                                                 pixels))
-        return;
-    }
-
-  /* make sure any batched primitives get emitted to the GL driver
-   * before issuing our read pixels...
-   *
-   * XXX: Note we currently use cogl_flush to ensure *all* journals
-   * are flushed here and not _cogl_journal_flush because we don't
-   * track the dependencies between framebuffers so we don't know if
-   * the current framebuffer depends on the contents of other
-   * framebuffers which could also have associated journal entries.
-   */
-  cogl_flush ();
-
-  _cogl_framebuffer_flush_state (cogl_get_draw_framebuffer (),
-                                 framebuffer,
-                                 COGL_FRAMEBUFFER_STATE_BIND);
-
-  framebuffer_height = cogl_framebuffer_get_height (framebuffer);
-
-  /* The y co-ordinate should be given in OpenGL's coordinate system
-   * so 0 is the bottom row
-   *
-   * NB: all offscreen rendering is done upside down so no conversion
-   * is necissary in this case.
-   */
-  if (!cogl_is_offscreen (framebuffer))
-    y = framebuffer_height - y - height;
-
   /* Initialise the CoglBitmap */
   bpp = _cogl_get_format_bpp (format);
   bmp_format = format;
@@ -444,7 +397,7 @@ _cogl_read_pixels_with_rowstride (int x,
        * premultiplied state of the framebuffer so that it will get
        * converted to the right format below */
 
-      if ((framebuffer->format & COGL_PREMULT_BIT))
+      if ((source_format & COGL_PREMULT_BIT))
         bmp_format |= COGL_PREMULT_BIT;
       else
         bmp_format &= ~COGL_PREMULT_BIT;
@@ -459,17 +412,6 @@ _cogl_read_pixels_with_rowstride (int x,
                                            &gl_format,
                                            &gl_type);
 
-  /* NB: All offscreen rendering is done upside down so there is no need
-   * to flip in this case... */
-  if ((ctx->private_feature_flags & COGL_PRIVATE_FEATURE_MESA_PACK_INVERT) &&
-      !cogl_is_offscreen (framebuffer))
-    {
-      GE (ctx, glPixelStorei (GL_PACK_INVERT_MESA, TRUE));
-      pack_invert_set = TRUE;
-    }
-  else
-    pack_invert_set = FALSE;
-
   /* Under GLES only GL_RGBA with GL_UNSIGNED_BYTE as well as an
      implementation specific format under
      GL_IMPLEMENTATION_COLOR_READ_FORMAT_OES and
@@ -533,6 +475,89 @@ _cogl_read_pixels_with_rowstride (int x,
       _cogl_bitmap_convert_premult_status (bmp, format);
     }
 
+  cogl_object_unref (bmp);
+}
+
+void
+_cogl_read_pixels_with_rowstride (int x,
+                                  int y,
+                                  int width,
+                                  int height,
+                                  CoglReadPixelsFlags source,
+                                  CoglPixelFormat format,
+                                  guint8 *pixels,
+                                  int rowstride)
+{
+  CoglFramebuffer *framebuffer = _cogl_get_read_framebuffer ();
+  int              framebuffer_height;
+  gboolean         pack_invert_set;
+
+  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+
+  _COGL_RETURN_IF_FAIL (source == COGL_READ_PIXELS_COLOR_BUFFER);
+
+  if (width == 1 && height == 1 && !framebuffer->clear_clip_dirty)
+    {
+      /* If everything drawn so far for this frame is still in the
+       * Journal then if all of the rectangles only have a flat
+       * opaque color we have a fast-path for reading a single pixel
+       * that avoids the relatively high cost of flushing primitives
+       * to be drawn on the GPU (considering how simple the geometry
+       * is in this case) and then blocking on the long GPU pipelines
+       * for the result.
+       */
+      if (_cogl_framebuffer_try_fast_read_pixel (framebuffer,
+                                                 x, y, source, format,
+                                                 pixels))
+        return;
+    }
+
+  /* make sure any batched primitives get emitted to the GL driver
+   * before issuing our read pixels...
+   *
+   * XXX: Note we currently use cogl_flush to ensure *all* journals
+   * are flushed here and not _cogl_journal_flush because we don't
+   * track the dependencies between framebuffers so we don't know if
+   * the current framebuffer depends on the contents of other
+   * framebuffers which could also have associated journal entries.
+   */
+  cogl_flush ();
+
+  _cogl_framebuffer_flush_state (cogl_get_draw_framebuffer (),
+                                 framebuffer,
+                                 COGL_FRAMEBUFFER_STATE_BIND);
+
+  /* Multisampled renderbuffers can't be read directly so if the
+   * samples need an explicit resolve they are read from the texture
+   * instead */
+  _cogl_framebuffer_bind_resolved_read_buffer (framebuffer);
+
+  framebuffer_height = cogl_framebuffer_get_height (framebuffer);
+
+  /* The y co-ordinate should be given in OpenGL's coordinate system
+   * so 0 is the bottom row
+   *
+   * NB: all offscreen rendering is done upside down so no conversion
+   * is necissary in this case.
+   */
+  if (!cogl_is_offscreen (framebuffer))
+    y = framebuffer_height - y - height;
+
+  /* NB: All offscreen rendering is done upside down so there is no need
+   * to flip in this case... */
+  if ((ctx->private_feature_flags & COGL_PRIVATE_FEATURE_MESA_PACK_INVERT) &&
+      !cogl_is_offscreen (framebuffer))
+    {
+      GE (ctx, glPixelStorei (GL_PACK_INVERT_MESA, TRUE));
+      pack_invert_set = TRUE;
+    }
+  else
+    pack_invert_set = FALSE;
+
+  _cogl_read_pixels_from_gl (x, y, width, height,
+                             framebuffer->format,
+                             format, pixels, rowstride);
+
   /* Currently this function owns the pack_invert state and we don't want this
    * to interfere with other Cogl components so all other code can assume that
    * we leave the pack_invert state off. */
@@ -561,7 +586,6 @@ _cogl_read_pixels_with_rowstride (int x,
         }
     }
 
-  cogl_object_unref (bmp);
 }
 
 void
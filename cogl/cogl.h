@@ -98,6 +98,9 @@ typedef struct _CoglFramebuffer CoglFramebuffer;
 #include <cogl/cogl-framebuffer.h>
 #include <cogl/cogl-onscreen.h>
 #include <cogl/cogl-poll.h>
+#include <cogl/cogl-fence.h>
+#include <cogl/cogl-transient-offscreen.h>
+#include <cogl/cogl-sparse-texture.h>
 #if defined (COGL_HAS_EGL_PLATFORM_KMS_SUPPORT)
 #include <cogl/cogl-kms-renderer.h>
 #endif
@@ -210,6 +213,22 @@ cogl_features_available (CoglFeatureFlags features);
  * @COGL_FEATURE_ID_SWAP_BUFFERS_EVENT:
  *     Available if the window system supports reporting an event
  *     for swap buffer completions.
+ * @COGL_FEATURE_ID_SWAP_REGION: Whether cogl_framebuffer_swap_region()
+ *     is supported for onscreen framebuffers.
+ * @COGL_FEATURE_ID_BUFFER_AGE: Whether cogl_onscreen_get_buffer_age()
+ *     can report the age of the back buffer so that only damaged
+ *     regions need to be repainted.
+ * @COGL_FEATURE_ID_FENCE: Whether cogl_framebuffer_add_fence_callback()
+ *     can notify when GPU commands have completed.
+ * @COGL_FEATURE_ID_TEXTURE_HALF_FLOAT: Whether textures can be created
+ *     with %COGL_PIXEL_FORMAT_RGBA_16F. Rendering to them with an
+ *     offscreen framebuffer may additionally fail on some GLES
+ *     drivers.
+ * @COGL_FEATURE_ID_TEXTURE_FLOAT: Whether textures can be created
+ *     with %COGL_PIXEL_FORMAT_RGBA_32F.
+ * @COGL_FEATURE_ID_TEXTURE_RG: Whether textures can be created with
+ *     only red or only red and green components, such as
+ *     %COGL_PIXEL_FORMAT_R_8.
  *
  * All the capabilities that can vary between different GPUs supported
  * by Cogl. Applications that depend on any of these features should explicitly
@@ -237,6 +256,12 @@ typedef enum _CoglFeatureID
   COGL_FEATURE_ID_MAP_BUFFER_FOR_WRITE,
   COGL_FEATURE_ID_MIRRORED_REPEAT,
   COGL_FEATURE_ID_SWAP_BUFFERS_EVENT,
+  COGL_FEATURE_ID_SWAP_REGION,
+  COGL_FEATURE_ID_BUFFER_AGE,
+  COGL_FEATURE_ID_FENCE,
+  COGL_FEATURE_ID_TEXTURE_HALF_FLOAT,
+  COGL_FEATURE_ID_TEXTURE_FLOAT,
+  COGL_FEATURE_ID_TEXTURE_RG,
 
   /*< private > */
   _COGL_N_FEATURE_IDS
@@ -217,6 +217,16 @@ _cogl_gl_update_features (CoglContext *context,
       COGL_FLAGS_SET (ctx->features,
                       COGL_FEATURE_ID_OFFSCREEN_MULTISAMPLE, TRUE);
     }
+  else if (context->glRenderbufferStorageMultisample &&
+           context->glBlitFramebuffer)
+    {
+      /* The samples have to be resolved explicitly by blitting them
+       * to the texture */
+      private_flags |= COGL_PRIVATE_FEATURE_OFFSCREEN_MULTISAMPLE_RESOLVE;
+      flags |= COGL_FEATURE_OFFSCREEN_MULTISAMPLE;
+      COGL_FLAGS_SET (ctx->features,
+                      COGL_FEATURE_ID_OFFSCREEN_MULTISAMPLE, TRUE);
+    }
 
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 2, 1) ||
       _cogl_check_extension ("GL_EXT_pixel_buffer_object", gl_extensions))
@@ -252,6 +262,15 @@ _cogl_gl_update_features (CoglContext *context,
                       COGL_FEATURE_ID_MAP_BUFFER_FOR_WRITE, TRUE);
     }
 
+  if (context->glGenSamplers)
+    private_flags |= COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS;
+
+  if (context->glCopyImageSubData)
+    private_flags |= COGL_PRIVATE_FEATURE_COPY_IMAGE;
+
+  if (context->glFenceSync)
+    COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_FENCE, TRUE);
+
   if (_cogl_check_extension ("GL_ARB_texture_rectangle", gl_extensions))
     {
       flags |= COGL_FEATURE_TEXTURE_RECTANGLE;
@@ -265,6 +284,21 @@ _cogl_gl_update_features (CoglContext *context,
       COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TEXTURE_3D, TRUE);
     }
 
+  if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) ||
+      _cogl_check_extension ("GL_ARB_texture_float", gl_extensions))
+    {
+      COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TEXTURE_FLOAT, TRUE);
+
+      if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) ||
+          _cogl_check_extension ("GL_ARB_half_float_pixel", gl_extensions))
+        COGL_FLAGS_SET (ctx->features,
+                        COGL_FEATURE_ID_TEXTURE_HALF_FLOAT, TRUE);
+    }
+
+  if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) ||
+      _cogl_check_extension ("GL_ARB_texture_rg", gl_extensions))
+    COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TEXTURE_RG, TRUE);
+
   if (context->glEGLImageTargetTexture2D)
     private_flags |= COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE;
 
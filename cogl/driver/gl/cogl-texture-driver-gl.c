@@ -46,6 +46,31 @@
 #include <stdlib.h>
 #include <math.h>
 
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_RG
+#define GL_RG 0x8227
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+#ifndef GL_RG8
+#define GL_RG8 0x822B
+#endif
+#ifndef GL_R16F
+#define GL_R16F 0x822D
+#endif
+#ifndef GL_RG16F
+#define GL_RG16F 0x822F
+#endif
+#ifndef GL_RGBA32F
+#define GL_RGBA32F 0x8814
+#endif
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+
 static void
 _cogl_texture_driver_gen (GLenum   gl_target,
                           GLsizei  n,
@@ -292,10 +317,12 @@ _cogl_texture_driver_size_supported_3d (GLenum gl_target,
     /* Unknown target, assume it's not supported */
     return FALSE;
 
-  /* Proxy texture allows for a quick check for supported size */
-  GE( ctx, glTexImage3D (proxy_target, 0, GL_RGBA,
+  /* Proxy texture allows for a quick check for supported size. See
+     the comment in _cogl_texture_driver_size_supported for the
+     format */
+  GE( ctx, glTexImage3D (proxy_target, 0, gl_format,
                          width, height, depth, 0 /* border */,
-                         gl_format, gl_type, NULL) );
+                         GL_RGBA, GL_UNSIGNED_BYTE, NULL) );
 
   GE( ctx, glGetTexLevelParameteriv (proxy_target, 0,
                                      GL_TEXTURE_WIDTH, &new_width) );
@@ -325,10 +352,13 @@ _cogl_texture_driver_size_supported (GLenum gl_target,
     /* Unknown target, assume it's not supported */
     return FALSE;
 
-  /* Proxy texture allows for a quick check for supported size */
-  GE( ctx, glTexImage2D (proxy_target, 0, GL_RGBA,
+  /* Proxy texture allows for a quick check for supported size. The
+     format passed in is the internal format so it can't be used as
+     the format of the data, but no data is uploaded so any valid
+     combination will do */
+  GE( ctx, glTexImage2D (proxy_target, 0, gl_format,
                          width, height, 0 /* border */,
-                         gl_format, gl_type, NULL) );
+                         GL_RGBA, GL_UNSIGNED_BYTE, NULL) );
 
   GE( ctx, glGetTexLevelParameteriv (proxy_target, 0,
                                      GL_TEXTURE_WIDTH, &new_width) );
@@ -385,6 +415,36 @@ _cogl_texture_driver_pixel_format_from_gl_internal (GLenum gl_int_format,
 
       *out_format = COGL_PIXEL_FORMAT_RGBA_8888;
       return TRUE;
+
+    case GL_R8:
+
+      *out_format = COGL_PIXEL_FORMAT_R_8;
+      return TRUE;
+
+    case GL_RG8:
+
+      *out_format = COGL_PIXEL_FORMAT_RG_88;
+      return TRUE;
+
+    case GL_R16F:
+
+      *out_format = COGL_PIXEL_FORMAT_R_16F;
+      return TRUE;
+
+    case GL_RG16F:
+
+      *out_format = COGL_PIXEL_FORMAT_RG_16F;
+      return TRUE;
+
+    case GL_RGBA16F:
+
+      *out_format = COGL_PIXEL_FORMAT_RGBA_16F;
+      return TRUE;
+
+    case GL_RGBA32F:
+
+      *out_format = COGL_PIXEL_FORMAT_RGBA_32F;
+      return TRUE;
     }
 
   return FALSE;
@@ -418,6 +478,16 @@ _cogl_texture_driver_pixel_format_to_gl (CoglPixelFormat  format,
       glformat = GL_LUMINANCE;
       gltype = GL_UNSIGNED_BYTE;
       break;
+    case COGL_PIXEL_FORMAT_R_8:
+      glintformat = GL_R8;
+      glformat = GL_RED;
+      gltype = GL_UNSIGNED_BYTE;
+      break;
+    case COGL_PIXEL_FORMAT_RG_88:
+      glintformat = GL_RG8;
+      glformat = GL_RG;
+      gltype = GL_UNSIGNED_BYTE;
+      break;
 
     case COGL_PIXEL_FORMAT_RGB_888:
       glintformat = GL_RGB;
@@ -482,6 +552,31 @@ _cogl_texture_driver_pixel_format_to_gl (CoglPixelFormat  format,
       gltype = GL_UNSIGNED_SHORT_5_5_5_1;
       break;
 
+      /* The floating point formats need GL 3.0 or the
+       * ARB_texture_float, ARB_half_float_pixel and ARB_texture_rg
+       * extensions. _cogl_texture_format_is_supported checks for
+       * these before a texture is created */
+    case COGL_PIXEL_FORMAT_R_16F:
+      glintformat = GL_R16F;
+      glformat = GL_RED;
+      gltype = GL_HALF_FLOAT;
+      break;
+    case COGL_PIXEL_FORMAT_RG_16F:
+      glintformat = GL_RG16F;
+      glformat = GL_RG;
+      gltype = GL_HALF_FLOAT;
+      break;
+    case COGL_PIXEL_FORMAT_RGBA_16F:
+      glintformat = GL_RGBA16F;
+      glformat = GL_RGBA;
+      gltype = GL_HALF_FLOAT;
+      break;
+    case COGL_PIXEL_FORMAT_RGBA_32F:
+      glintformat = GL_RGBA32F;
+      glformat = GL_RGBA;
+      gltype = GL_FLOAT;
+      break;
+
       /* FIXME: check extensions for YUV support */
     default:
       break;
@@ -113,6 +113,9 @@ _cogl_gles_update_features (CoglContext *context,
   if (context->glBlitFramebuffer)
     private_flags |= COGL_PRIVATE_FEATURE_OFFSCREEN_BLIT;
 
+  if (context->glCopyImageSubData)
+    private_flags |= COGL_PRIVATE_FEATURE_COPY_IMAGE;
+
   if (_cogl_check_extension ("GL_OES_element_index_uint", gl_extensions))
     {
       flags |= COGL_FEATURE_UNSIGNED_INT_INDICES;
@@ -160,6 +163,16 @@ _cogl_gles_update_features (CoglContext *context,
                       COGL_FEATURE_ID_MAP_BUFFER_FOR_WRITE, TRUE);
     }
 
+  if (_cogl_check_extension ("GL_OES_texture_half_float", gl_extensions))
+    COGL_FLAGS_SET (context->features,
+                    COGL_FEATURE_ID_TEXTURE_HALF_FLOAT, TRUE);
+
+  if (_cogl_check_extension ("GL_OES_texture_float", gl_extensions))
+    COGL_FLAGS_SET (context->features, COGL_FEATURE_ID_TEXTURE_FLOAT, TRUE);
+
+  if (_cogl_check_extension ("GL_EXT_texture_rg", gl_extensions))
+    COGL_FLAGS_SET (context->features, COGL_FEATURE_ID_TEXTURE_RG, TRUE);
+
   if (context->glEGLImageTargetTexture2D)
     private_flags |= COGL_PRIVATE_FEATURE_TEXTURE_2D_FROM_EGL_IMAGE;
 
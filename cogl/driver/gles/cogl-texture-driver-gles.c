@@ -52,6 +52,15 @@
 #ifndef GL_MAX_3D_TEXTURE_SIZE_OES
 #define GL_MAX_3D_TEXTURE_SIZE_OES 0x8073
 #endif
+#ifndef GL_HALF_FLOAT_OES
+#define GL_HALF_FLOAT_OES 0x8D61
+#endif
+#ifndef GL_RED_EXT
+#define GL_RED_EXT 0x1903
+#endif
+#ifndef GL_RG_EXT
+#define GL_RG_EXT 0x8227
+#endif
 
 static void
 _cogl_texture_driver_gen (GLenum   gl_target,
@@ -431,6 +440,16 @@ _cogl_texture_driver_pixel_format_to_gl (CoglPixelFormat  format,
       glformat = GL_LUMINANCE;
       gltype = GL_UNSIGNED_BYTE;
       break;
+    case COGL_PIXEL_FORMAT_R_8:
+      glintformat = GL_RED_EXT;
+      glformat = GL_RED_EXT;
+      gltype = GL_UNSIGNED_BYTE;
+      break;
+    case COGL_PIXEL_FORMAT_RG_88:
+      glintformat = GL_RG_EXT;
+      glformat = GL_RG_EXT;
+      gltype = GL_UNSIGNED_BYTE;
+      break;
 
       /* Just one 24-bit ordering supported */
     case COGL_PIXEL_FORMAT_RGB_888:
@@ -472,6 +491,31 @@ _cogl_texture_driver_pixel_format_to_gl (CoglPixelFormat  format,
       gltype = GL_UNSIGNED_SHORT_5_5_5_1;
       break;
 
+      /* The floating point formats need the OES_texture_half_float,
+       * OES_texture_float and EXT_texture_rg extensions. Like the
+       * other formats the internal format has to be the same as the
+       * format of the data */
+    case COGL_PIXEL_FORMAT_R_16F:
+      glintformat = GL_RED_EXT;
+      glformat = GL_RED_EXT;
+      gltype = GL_HALF_FLOAT_OES;
+      break;
+    case COGL_PIXEL_FORMAT_RG_16F:
+      glintformat = GL_RG_EXT;
+      glformat = GL_RG_EXT;
+      gltype = GL_HALF_FLOAT_OES;
+      break;
+    case COGL_PIXEL_FORMAT_RGBA_16F:
+      glintformat = GL_RGBA;
+      glformat = GL_RGBA;
+      gltype = GL_HALF_FLOAT_OES;
+      break;
+    case COGL_PIXEL_FORMAT_RGBA_32F:
+      glintformat = GL_RGBA;
+      glformat = GL_RGBA;
+      gltype = GL_FLOAT;
+      break;
+
       /* FIXME: check extensions for YUV support */
     default:
       break;
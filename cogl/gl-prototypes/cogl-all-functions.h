@@ -145,6 +145,18 @@ COGL_EXT_FUNCTION (void, glBlitFramebuffer,
                     GLenum                filter))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (offscreen_multisample, 3, 0,
+                0, /* not in either GLES */
+                "EXT\0",
+                "framebuffer_multisample\0")
+COGL_EXT_FUNCTION (void, glRenderbufferStorageMultisample,
+                   (GLenum                target,
+                    GLsizei               samples,
+                    GLenum                internalformat,
+                    GLsizei               width,
+                    GLsizei               height))
+COGL_EXT_END ()
+
 /* ARB_fragment_program */
 COGL_EXT_BEGIN (arbfp, 255, 255,
                 0, /* not in either GLES */
@@ -182,6 +194,39 @@ COGL_EXT_FUNCTION (void, glEGLImageTargetRenderbufferStorage,
                     GLeglImageOES    image))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (sampler_objects, 3, 3,
+                0, /* not in either GLES */
+                "ARB:\0",
+                "sampler_objects\0")
+COGL_EXT_FUNCTION (void, glGenSamplers,
+                   (GLsizei count,
+                    GLuint *samplers))
+COGL_EXT_FUNCTION (void, glDeleteSamplers,
+                   (GLsizei count,
+                    const GLuint *samplers))
+COGL_EXT_FUNCTION (void, glBindSampler,
+                   (GLuint unit,
+                    GLuint sampler))
+COGL_EXT_FUNCTION (void, glSamplerParameteri,
+                   (GLuint sampler,
+                    GLenum pname,
+                    GLint param))
+COGL_EXT_END ()
+
+/* GLsync is a pointer and GLuint64 a 64-bit integer but older GL
+ * headers don't define them so we use equivalent types instead */
+COGL_EXT_BEGIN (sync, 3, 2,
+                0, /* not in either GLES */
+                "ARB:\0",
+                "sync\0")
+COGL_EXT_FUNCTION (void *, glFenceSync,
+                   (GLenum condition, GLbitfield flags))
+COGL_EXT_FUNCTION (GLenum, glClientWaitSync,
+                   (void *sync, GLbitfield flags, guint64 timeout))
+COGL_EXT_FUNCTION (void, glDeleteSync,
+                   (void *sync))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (framebuffer_discard, 255, 255,
                 0, /* not in either GLES */
                 "EXT\0",
@@ -192,6 +237,28 @@ COGL_EXT_FUNCTION (void, glDiscardFramebuffer,
                     const GLenum    *attachments))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (copy_image, 4, 3,
+                0, /* not in either GLES */
+                "ARB:\0EXT\0OES\0",
+                "copy_image\0")
+COGL_EXT_FUNCTION (void, glCopyImageSubData,
+                   (GLuint           srcName,
+                    GLenum           srcTarget,
+                    GLint            srcLevel,
+                    GLint            srcX,
+                    GLint            srcY,
+                    GLint            srcZ,
+                    GLuint           dstName,
+                    GLenum           dstTarget,
+                    GLint            dstLevel,
+                    GLint            dstX,
+                    GLint            dstY,
+                    GLint            dstZ,
+                    GLsizei          srcWidth,
+                    GLsizei          srcHeight,
+                    GLsizei          srcDepth))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (IMG_multisampled_render_to_texture, 255, 255,
                 0, /* not in either GLES */
                 "\0",
@@ -76,7 +76,10 @@ typedef enum _CoglEGLWinsysFeature
   COGL_EGL_WINSYS_FEATURE_EGL_IMAGE_FROM_WAYLAND_BUFFER =1L<<2,
   COGL_EGL_WINSYS_FEATURE_SURFACELESS_OPENGL            =1L<<3,
   COGL_EGL_WINSYS_FEATURE_SURFACELESS_GLES1             =1L<<4,
-  COGL_EGL_WINSYS_FEATURE_SURFACELESS_GLES2             =1L<<5
+  COGL_EGL_WINSYS_FEATURE_SURFACELESS_GLES2             =1L<<5,
+  COGL_EGL_WINSYS_FEATURE_BUFFER_AGE                    =1L<<6,
+  COGL_EGL_WINSYS_FEATURE_FENCE_SYNC                    =1L<<7,
+  COGL_EGL_WINSYS_FEATURE_NATIVE_FENCE_SYNC             =1L<<8
 } CoglEGLWinsysFeature;
 
 typedef struct _CoglRendererEGL
@@ -48,11 +48,16 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <glib/gi18n-lib.h>
 
 #define MAX_EGL_CONFIG_ATTRIBS 30
 
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
 /* Define a set of arrays containing the functions required from GL
    for each winsys feature */
 #define COGL_WINSYS_FEATURE_BEGIN(name, namespaces, extension_names,    \
@@ -421,8 +426,21 @@ _cogl_winsys_context_init (CoglContext *context, GError **error)
                       COGL_WINSYS_FEATURE_SWAP_REGION, TRUE);
       COGL_FLAGS_SET (context->winsys_features,
                       COGL_WINSYS_FEATURE_SWAP_REGION_THROTTLE, TRUE);
+      COGL_FLAGS_SET (context->features,
+                      COGL_FEATURE_ID_SWAP_REGION, TRUE);
     }
 
+  if (egl_renderer->private_features & COGL_EGL_WINSYS_FEATURE_BUFFER_AGE)
+    {
+      COGL_FLAGS_SET (context->winsys_features,
+                      COGL_WINSYS_FEATURE_BUFFER_AGE, TRUE);
+      COGL_FLAGS_SET (context->features,
+                      COGL_FEATURE_ID_BUFFER_AGE, TRUE);
+    }
+
+  if (egl_renderer->private_features & COGL_EGL_WINSYS_FEATURE_FENCE_SYNC)
+    COGL_FLAGS_SET (context->features, COGL_FEATURE_ID_FENCE, TRUE);
+
   if (egl_renderer->platform_vtable->context_init &&
       !egl_renderer->platform_vtable->context_init (context, error))
     return FALSE;
@@ -616,6 +634,33 @@ _cogl_winsys_onscreen_swap_buffers (CoglOnscreen *onscreen)
   eglSwapBuffers (egl_renderer->edpy, egl_onscreen->egl_surface);
 }
 
+static int
+_cogl_winsys_onscreen_get_buffer_age (CoglOnscreen *onscreen)
+{
+  CoglContext *context = COGL_FRAMEBUFFER (onscreen)->context;
+  CoglRenderer *renderer = context->display->renderer;
+  CoglRendererEGL *egl_renderer = renderer->winsys;
+  CoglOnscreenEGL *egl_onscreen = onscreen->winsys;
+  EGLint age;
+
+  if (!(egl_renderer->private_features & COGL_EGL_WINSYS_FEATURE_BUFFER_AGE))
+    return 0;
+
+  /* The surface needs to be current for the age to refer to the
+   * buffer that will be drawn to next */
+  _cogl_framebuffer_flush_state (COGL_FRAMEBUFFER (onscreen),
+                                 COGL_FRAMEBUFFER (onscreen),
+                                 COGL_FRAMEBUFFER_STATE_BIND);
+
+  if (eglQuerySurface (egl_renderer->edpy,
+                       egl_onscreen->egl_surface,
+                       EGL_BUFFER_AGE_EXT,
+                       &age) == EGL_FALSE)
+    return 0;
+
+  return age;
+}
+
 static void
 _cogl_winsys_onscreen_update_swap_throttled (CoglOnscreen *onscreen)
 {
@@ -639,6 +684,94 @@ _cogl_winsys_context_egl_get_egl_display (CoglContext *context)
   return egl_renderer->edpy;
 }
 
+#ifdef EGL_KHR_fence_sync
+
+typedef struct _CoglFenceEGL
+{
+  EGLSyncKHR sync;
+  int fd;
+} CoglFenceEGL;
+
+static void *
+_cogl_winsys_fence_add (CoglContext *context,
+                        int *fd)
+{
+  CoglRendererEGL *egl_renderer = context->display->renderer->winsys;
+  CoglFenceEGL *fence;
+  EGLSyncKHR sync = EGL_NO_SYNC_KHR;
+
+  *fd = -1;
+
+  if (!(egl_renderer->private_features & COGL_EGL_WINSYS_FEATURE_FENCE_SYNC))
+    return NULL;
+
+#ifdef EGL_ANDROID_native_fence_sync
+  if ((egl_renderer->private_features &
+       COGL_EGL_WINSYS_FEATURE_NATIVE_FENCE_SYNC))
+    {
+      sync = egl_renderer->pf_eglCreateSync (egl_renderer->edpy,
+                                             EGL_SYNC_NATIVE_FENCE_ANDROID,
+                                             NULL);
+
+      /* The file descriptor only exists once the fence has been
+       * flushed to the GPU */
+      if (sync != EGL_NO_SYNC_KHR)
+        {
+          context->glFlush ();
+          *fd = egl_renderer->pf_eglDupNativeFenceFD (egl_renderer->edpy,
+                                                      sync);
+        }
+    }
+#endif
+
+  if (sync == EGL_NO_SYNC_KHR)
+    sync = egl_renderer->pf_eglCreateSync (egl_renderer->edpy,
+                                           EGL_SYNC_FENCE_KHR,
+                                           NULL);
+
+  if (sync == EGL_NO_SYNC_KHR)
+    return NULL;
+
+  fence = g_slice_new (CoglFenceEGL);
+  fence->sync = sync;
+  fence->fd = *fd;
+
+  return fence;
+}
+
+static gboolean
+_cogl_winsys_fence_is_complete (CoglContext *context,
+                                void *fence)
+{
+  CoglRendererEGL *egl_renderer = context->display->renderer->winsys;
+  CoglFenceEGL *egl_fence = fence;
+  EGLint ret;
+
+  ret = egl_renderer->pf_eglClientWaitSync (egl_renderer->edpy,
+                                            egl_fence->sync,
+                                            EGL_SYNC_FLUSH_COMMANDS_BIT_KHR,
+                                            0);
+
+  return ret == EGL_CONDITION_SATISFIED_KHR;
+}
+
+static void
+_cogl_winsys_fence_destroy (CoglContext *context,
+                            void *fence)
+{
+  CoglRendererEGL *egl_renderer = context->display->renderer->winsys;
+  CoglFenceEGL *egl_fence = fence;
+
+  if (egl_fence->fd >= 0)
+    close (egl_fence->fd);
+
+  egl_renderer->pf_eglDestroySync (egl_renderer->edpy, egl_fence->sync);
+
+  g_slice_free (CoglFenceEGL, egl_fence);
+}
+
+#endif /* EGL_KHR_fence_sync */
+
 static CoglWinsysVtable _cogl_winsys_vtable =
   {
     .constraints = COGL_RENDERER_CONSTRAINT_USES_EGL,
@@ -660,8 +793,14 @@ static CoglWinsysVtable _cogl_winsys_vtable =
     .onscreen_bind = _cogl_winsys_onscreen_bind,
     .onscreen_swap_buffers = _cogl_winsys_onscreen_swap_buffers,
     .onscreen_swap_region = _cogl_winsys_onscreen_swap_region,
+    .onscreen_get_buffer_age = _cogl_winsys_onscreen_get_buffer_age,
     .onscreen_update_swap_throttled =
       _cogl_winsys_onscreen_update_swap_throttled,
+#ifdef EGL_KHR_fence_sync
+    .fence_add = _cogl_winsys_fence_add,
+    .fence_is_complete = _cogl_winsys_fence_is_complete,
+    .fence_destroy = _cogl_winsys_fence_destroy,
+#endif
   };
 
 /* XXX: we use a function because no doubt someone will complain
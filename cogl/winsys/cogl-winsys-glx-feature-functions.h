@@ -103,3 +103,13 @@ COGL_WINSYS_FEATURE_BEGIN (swap_event,
                            0,
                            COGL_WINSYS_FEATURE_SWAP_BUFFERS_EVENT)
 COGL_WINSYS_FEATURE_END ()
+
+/* The buffer age is queried with the core glXQueryDrawable function
+ * so there are no extra functions to resolve */
+COGL_WINSYS_FEATURE_BEGIN (buffer_age,
+                           "EXT\0",
+                           "buffer_age\0",
+                           0,
+                           0,
+                           COGL_WINSYS_FEATURE_BUFFER_AGE)
+COGL_WINSYS_FEATURE_END ()
@@ -62,6 +62,9 @@
 #include <X11/Xlib.h>
 
 #define COGL_ONSCREEN_X11_EVENT_MASK StructureNotifyMask
+#ifndef GLX_BACK_BUFFER_AGE_EXT
+#define GLX_BACK_BUFFER_AGE_EXT 0x20F4
+#endif
 #define MAX_GLX_CONFIG_ATTRIBS 30
 
 typedef struct _CoglContextGLX
@@ -270,6 +273,8 @@ resolve_core_glx_functions (CoglRenderer *renderer,
                         (void **) &glx_renderer->glXGetVisualFromFBConfig) ||
       !g_module_symbol (glx_renderer->libgl_module, "glXSelectEvent",
                         (void **) &glx_renderer->glXSelectEvent) ||
+      !g_module_symbol (glx_renderer->libgl_module, "glXQueryDrawable",
+                        (void **) &glx_renderer->glXQueryDrawable) ||
       !g_module_symbol (glx_renderer->libgl_module, "glXCreateWindow",
                         (void **) &glx_renderer->glXCreateWindow) ||
       !g_module_symbol (glx_renderer->libgl_module, "glXGetFBConfigs",
@@ -422,8 +427,12 @@ update_winsys_features (CoglContext *context, GError **error)
                     TRUE);
 
   if (glx_renderer->pf_glXCopySubBuffer || context->glBlitFramebuffer)
-    COGL_FLAGS_SET (context->winsys_features,
-                    COGL_WINSYS_FEATURE_SWAP_REGION, TRUE);
+    {
+      COGL_FLAGS_SET (context->winsys_features,
+                      COGL_WINSYS_FEATURE_SWAP_REGION, TRUE);
+      COGL_FLAGS_SET (context->features,
+                      COGL_FEATURE_ID_SWAP_REGION, TRUE);
+    }
 
   /* Note: glXCopySubBuffer and glBlitFramebuffer won't be throttled
    * by the SwapInterval so we have to throttle swap_region requests
@@ -438,6 +447,11 @@ update_winsys_features (CoglContext *context, GError **error)
                     COGL_FEATURE_ID_SWAP_BUFFERS_EVENT,
                     TRUE);
 
+  if (_cogl_winsys_has_feature (COGL_WINSYS_FEATURE_BUFFER_AGE))
+    COGL_FLAGS_SET (context->features,
+                    COGL_FEATURE_ID_BUFFER_AGE,
+                    TRUE);
+
   return TRUE;
 }
 
@@ -1348,6 +1362,38 @@ _cogl_winsys_onscreen_swap_buffers (CoglOnscreen *onscreen)
     glx_onscreen->last_swap_vsync_counter = _cogl_winsys_get_vsync_counter ();
 }
 
+static int
+_cogl_winsys_onscreen_get_buffer_age (CoglOnscreen *onscreen)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  CoglContext *context = framebuffer->context;
+  CoglXlibRenderer *xlib_renderer =
+    _cogl_xlib_renderer_get_data (context->display->renderer);
+  CoglGLXRenderer *glx_renderer = context->display->renderer->winsys;
+  CoglOnscreenXlib *xlib_onscreen = onscreen->winsys;
+  CoglOnscreenGLX *glx_onscreen = onscreen->winsys;
+  GLXDrawable drawable;
+  unsigned int age = 0;
+
+  if (!_cogl_winsys_has_feature (COGL_WINSYS_FEATURE_BUFFER_AGE))
+    return 0;
+
+  /* The GLX_EXT_buffer_age spec says the drawable must be current to
+   * the calling thread for the query to succeed */
+  _cogl_framebuffer_flush_state (framebuffer,
+                                 framebuffer,
+                                 COGL_FRAMEBUFFER_STATE_BIND);
+
+  drawable = glx_onscreen->glxwin ? glx_onscreen->glxwin : xlib_onscreen->xwin;
+
+  glx_renderer->glXQueryDrawable (xlib_renderer->xdpy,
+                                  drawable,
+                                  GLX_BACK_BUFFER_AGE_EXT,
+                                  &age);
+
+  return age;
+}
+
 static guint32
 _cogl_winsys_onscreen_x11_get_window_xid (CoglOnscreen *onscreen)
 {
@@ -2043,6 +2089,7 @@ static CoglWinsysVtable _cogl_winsys_vtable =
     .onscreen_bind = _cogl_winsys_onscreen_bind,
     .onscreen_swap_buffers = _cogl_winsys_onscreen_swap_buffers,
     .onscreen_swap_region = _cogl_winsys_onscreen_swap_region,
+    .onscreen_get_buffer_age = _cogl_winsys_onscreen_get_buffer_age,
     .onscreen_update_swap_throttled =
       _cogl_winsys_onscreen_update_swap_throttled,
     .onscreen_x11_get_window_xid =
@@ -111,6 +111,9 @@ typedef struct _CoglWinsysVtable
                            const int *rectangles,
                            int n_rectangles);
 
+  int
+  (*onscreen_get_buffer_age) (CoglOnscreen *onscreen);
+
 #ifdef COGL_HAS_EGL_SUPPORT
   EGLDisplay
   (*context_egl_get_egl_display) (CoglContext *context);
@@ -139,6 +142,19 @@ typedef struct _CoglWinsysVtable
                     const CoglPollFD *poll_fds,
                     int n_poll_fds);
 
+  /* Returns NULL if a fence couldn't be created. Otherwise *fd is set
+   * to a file descriptor that becomes readable when the fence signals
+   * or -1 if there isn't one */
+  void *
+  (*fence_add) (CoglContext *context,
+                int *fd);
+  gboolean
+  (*fence_is_complete) (CoglContext *context,
+                        void *fence);
+  void
+  (*fence_destroy) (CoglContext *context,
+                    void *fence);
+
 #ifdef COGL_HAS_XLIB_SUPPORT
   gboolean
   (*texture_pixmap_x11_create) (CoglTexturePixmapX11 *tex_pixmap);
@@ -103,6 +103,16 @@ struct {
     COGL_FEATURE_ID_MIRRORED_REPEAT,
     "Mirrored repeat wrap modes",
     "Mirrored repeat wrap modes"
+  },
+  {
+    COGL_FEATURE_ID_SWAP_REGION,
+    "Swapping sub-regions of onscreen framebuffers",
+    "cogl_framebuffer_swap_region() is supported"
+  },
+  {
+    COGL_FEATURE_ID_BUFFER_AGE,
+    "Back buffer age queries",
+    "The age of onscreen back buffers can be queried for partial redraws"
   }
 };
 
@@ -0,0 +1,332 @@
+/*
+ * A headless load generator for cogland
+ *
+ * This connects a number of clients to a running compositor, each
+ * with a single shm surface. Every frame each client changes a small
+ * square inside its buffer and only reports that square as damaged,
+ * which mimics a typical blinking cursor or spinner. The time between
+ * committing a frame and the compositor's frame callback is recorded
+ * so the compositor frame time can be compared for different numbers
+ * of clients.
+ *
+ * Usage: cogland-load [-n CLIENTS] [-f FRAMES] [-s SIZE] [-d DAMAGE]
+ */
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#include <wayland-client.h>
+
+typedef struct
+{
+  int id;
+
+  struct wl_display *display;
+  struct wl_compositor *compositor;
+  struct wl_shm *shm;
+  struct wl_shell *shell;
+
+  struct wl_surface *surface;
+  struct wl_shell_surface *shell_surface;
+  struct wl_buffer *buffer;
+  guint32 *data;
+
+  int fd;
+  guint32 mask;
+
+  int n_frames;
+  gint64 frame_start;
+  gboolean frame_pending;
+} LoadClient;
+
+static int n_clients = 8;
+static int max_frames = 600;
+static int surface_size = 256;
+static int damage_size = 16;
+
+static gint64 total_frame_time;
+static gint64 min_frame_time = G_MAXINT64;
+static gint64 max_frame_time;
+static int n_frames_completed;
+
+static GOptionEntry options[] =
+{
+  { "clients", 'n', 0, G_OPTION_ARG_INT, &n_clients,
+    "Number of clients to connect", "N" },
+  { "frames", 'f', 0, G_OPTION_ARG_INT, &max_frames,
+    "Number of frames to draw per client", "N" },
+  { "size", 's', 0, G_OPTION_ARG_INT, &surface_size,
+    "Width and height of each surface", "PIXELS" },
+  { "damage", 'd', 0, G_OPTION_ARG_INT, &damage_size,
+    "Width and height of the area damaged each frame", "PIXELS" },
+  { NULL }
+};
+
+static gint64
+get_time_us (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (gint64) tv.tv_sec * G_USEC_PER_SEC + tv.tv_usec;
+}
+
+static int
+update_mask_cb (guint32 mask, void *user_data)
+{
+  LoadClient *client = user_data;
+
+  client->mask = mask;
+
+  return 0;
+}
+
+static void
+global_cb (struct wl_display *display,
+           guint32 id,
+           const char *interface,
+           guint32 version,
+           void *user_data)
+{
+  LoadClient *client = user_data;
+
+  if (strcmp (interface, "wl_compositor") == 0)
+    client->compositor = wl_display_bind (display, id,
+                                          &wl_compositor_interface);
+  else if (strcmp (interface, "wl_shm") == 0)
+    client->shm = wl_display_bind (display, id, &wl_shm_interface);
+  else if (strcmp (interface, "wl_shell") == 0)
+    client->shell = wl_display_bind (display, id, &wl_shell_interface);
+}
+
+static struct wl_buffer *
+create_shm_buffer (LoadClient *client)
+{
+  char filename[] = "/tmp/cogland-load-XXXXXX";
+  int stride = surface_size * 4;
+  int size = stride * surface_size;
+  struct wl_buffer *buffer;
+  int i;
+
+  client->fd = mkstemp (filename);
+  if (client->fd < 0)
+    g_error ("Failed to create a temporary file for the shm buffer");
+  unlink (filename);
+
+  if (ftruncate (client->fd, size) < 0)
+    g_error ("Failed to resize the shm buffer");
+
+  client->data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       client->fd, 0);
+  if (client->data == MAP_FAILED)
+    g_error ("Failed to map the shm buffer");
+
+  for (i = 0; i < surface_size * surface_size; i++)
+    client->data[i] = 0xff202020;
+
+  buffer = wl_shm_create_buffer (client->shm, client->fd,
+                                 surface_size, surface_size, stride,
+                                 WL_SHM_FORMAT_XRGB8888);
+
+  return buffer;
+}
+
+static void draw_frame (LoadClient *client);
+
+static void
+frame_done_cb (void *user_data,
+               struct wl_callback *callback,
+               guint32 time)
+{
+  LoadClient *client = user_data;
+  gint64 frame_time = get_time_us () - client->frame_start;
+
+  wl_callback_destroy (callback);
+
+  total_frame_time += frame_time;
+  min_frame_time = MIN (min_frame_time, frame_time);
+  max_frame_time = MAX (max_frame_time, frame_time);
+  n_frames_completed++;
+
+  client->frame_pending = FALSE;
+
+  if (++client->n_frames < max_frames)
+    draw_frame (client);
+}
+
+static const struct wl_callback_listener frame_listener =
+{
+  frame_done_cb
+};
+
+static void
+draw_frame (LoadClient *client)
+{
+  int squares_per_row = surface_size / damage_size;
+  int square = client->n_frames % (squares_per_row * squares_per_row);
+  int x = (square % squares_per_row) * damage_size;
+  int y = (square / squares_per_row) * damage_size;
+  guint32 color = 0xff000000 | g_random_int ();
+  struct wl_callback *callback;
+  int i, j;
+
+  for (j = y; j < y + damage_size; j++)
+    for (i = x; i < x + damage_size; i++)
+      client->data[j * surface_size + i] = color;
+
+  wl_buffer_damage (client->buffer, x, y, damage_size, damage_size);
+  wl_surface_damage (client->surface, x, y, damage_size, damage_size);
+
+  callback = wl_surface_frame (client->surface);
+  wl_callback_add_listener (callback, &frame_listener, client);
+
+  client->frame_start = get_time_us ();
+  client->frame_pending = TRUE;
+}
+
+static LoadClient *
+load_client_new (int id)
+{
+  LoadClient *client = g_slice_new0 (LoadClient);
+
+  client->id = id;
+
+  client->display = wl_display_connect (NULL);
+  if (client->display == NULL)
+    g_error ("Failed to connect to the compositor");
+
+  wl_display_add_global_listener (client->display, global_cb, client);
+  wl_display_get_fd (client->display, update_mask_cb, client);
+  wl_display_roundtrip (client->display);
+
+  if (!client->compositor || !client->shm)
+    g_error ("The compositor is missing the wl_compositor or wl_shm "
+             "interfaces");
+
+  client->surface = wl_compositor_create_surface (client->compositor);
+
+  if (client->shell)
+    {
+      client->shell_surface =
+        wl_shell_get_shell_surface (client->shell, client->surface);
+      wl_shell_surface_set_toplevel (client->shell_surface);
+    }
+
+  client->buffer = create_shm_buffer (client);
+  wl_surface_attach (client->surface, client->buffer, 0, 0);
+  wl_surface_damage (client->surface, 0, 0, surface_size, surface_size);
+
+  draw_frame (client);
+
+  return client;
+}
+
+static void
+load_client_free (LoadClient *client)
+{
+  if (client->shell_surface)
+    wl_shell_surface_destroy (client->shell_surface);
+  wl_buffer_destroy (client->buffer);
+  wl_surface_destroy (client->surface);
+  wl_display_flush (client->display);
+  wl_display_disconnect (client->display);
+
+  munmap (client->data, surface_size * surface_size * 4);
+  close (client->fd);
+
+  g_slice_free (LoadClient, client);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  LoadClient **clients;
+  struct pollfd *fds;
+  gint64 start_time, elapsed;
+  int n_running;
+  int i;
+
+  context = g_option_context_new ("- generate load for cogland");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      fprintf (stderr, "%s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (n_clients < 1 || max_frames < 1 ||
+      damage_size < 1 || damage_size > surface_size)
+    {
+      fprintf (stderr, "Invalid options\n");
+      return 1;
+    }
+
+  clients = g_new (LoadClient *, n_clients);
+  fds = g_new (struct pollfd, n_clients);
+
+  for (i = 0; i < n_clients; i++)
+    clients[i] = load_client_new (i);
+
+  start_time = get_time_us ();
+
+  do
+    {
+      n_running = 0;
+
+      for (i = 0; i < n_clients; i++)
+        {
+          LoadClient *client = clients[i];
+
+          if (client->mask & WL_DISPLAY_WRITABLE)
+            wl_display_iterate (client->display, WL_DISPLAY_WRITABLE);
+
+          fds[i].fd = wl_display_get_fd (client->display,
+                                         update_mask_cb, client);
+          fds[i].events = POLLIN;
+          fds[i].revents = 0;
+
+          if (client->frame_pending)
+            n_running++;
+        }
+
+      if (n_running == 0)
+        break;
+
+      if (poll (fds, n_clients, -1) < 0)
+        g_error ("poll failed");
+
+      for (i = 0; i < n_clients; i++)
+        if (fds[i].revents & POLLIN)
+          wl_display_iterate (clients[i]->display, WL_DISPLAY_READABLE);
+    }
+  while (TRUE);
+
+  elapsed = get_time_us () - start_time;
+
+  printf ("clients: %d, surface: %dx%d, damage per frame: %dx%d\n",
+          n_clients, surface_size, surface_size, damage_size, damage_size);
+  printf ("frames: %d in %.2fs\n",
+          n_frames_completed, elapsed / (double) G_USEC_PER_SEC);
+  if (n_frames_completed)
+    printf ("frame time (commit to frame callback): "
+            "avg %.2fms, min %.2fms, max %.2fms\n",
+            total_frame_time / (double) n_frames_completed / 1000.0,
+            min_frame_time / 1000.0,
+            max_frame_time / 1000.0);
+
+  for (i = 0; i < n_clients; i++)
+    load_client_free (clients[i]);
+
+  g_free (clients);
+  g_free (fds);
+
+  return 0;
+}
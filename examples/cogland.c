@@ -8,6 +8,16 @@
 
 typedef struct _CoglandCompositor CoglandCompositor;
 
+/* Once more than this many damage boxes have accumulated for a frame
+ * they get collapsed into their bounding box */
+#define COGLAND_MAX_DAMAGE_BOXES 16
+
+typedef struct
+{
+  int x1, y1;
+  int x2, y2;
+} CoglandBox;
+
 typedef struct
 {
   struct wl_buffer *wayland_buffer;
@@ -53,6 +63,10 @@ typedef struct
 
   CoglOnscreen *onscreen;
 
+  /* Set when the whole output needs to be redrawn and swapped with
+   * cogl_framebuffer_swap_buffers(), such as for the first frame */
+  gboolean needs_full_repaint;
+
   GList *modes;
 
 } CoglandOutput;
@@ -79,6 +93,11 @@ struct _CoglandCompositor
 
   GQueue frame_callbacks;
 
+  /* Areas of the virtual screen that have changed since the last
+   * paint, as an array of CoglandBoxes */
+  GArray *damage;
+  gboolean swap_region_supported;
+
   CoglPrimitive *triangle;
   CoglPipeline *triangle_pipeline;
 
@@ -95,6 +114,115 @@ get_time (void)
   return tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
+static gboolean
+cogland_box_intersect (const CoglandBox *a,
+                       const CoglandBox *b,
+                       CoglandBox *result)
+{
+  result->x1 = MAX (a->x1, b->x1);
+  result->y1 = MAX (a->y1, b->y1);
+  result->x2 = MIN (a->x2, b->x2);
+  result->y2 = MIN (a->y2, b->y2);
+
+  return result->x1 < result->x2 && result->y1 < result->y2;
+}
+
+static void
+cogland_box_union (CoglandBox *box, const CoglandBox *other)
+{
+  box->x1 = MIN (box->x1, other->x1);
+  box->y1 = MIN (box->y1, other->y1);
+  box->x2 = MAX (box->x2, other->x2);
+  box->y2 = MAX (box->y2, other->y2);
+}
+
+static void
+cogland_compositor_damage (CoglandCompositor *compositor,
+                           int x,
+                           int y,
+                           int width,
+                           int height)
+{
+  CoglandBox screen = { 0, 0,
+                        compositor->virtual_width,
+                        compositor->virtual_height };
+  CoglandBox area = { x, y, x + width, y + height };
+  CoglandBox box;
+  int i;
+
+  if (!cogland_box_intersect (&area, &screen, &box))
+    return;
+
+  /* Clients commonly report the same area via both the buffer and
+   * the surface so skip boxes that are already covered */
+  for (i = 0; i < compositor->damage->len; i++)
+    {
+      CoglandBox *old = &g_array_index (compositor->damage, CoglandBox, i);
+
+      if (box.x1 >= old->x1 && box.y1 >= old->y1 &&
+          box.x2 <= old->x2 && box.y2 <= old->y2)
+        return;
+    }
+
+  if (compositor->damage->len >= COGLAND_MAX_DAMAGE_BOXES)
+    {
+      CoglandBox *extents =
+        &g_array_index (compositor->damage, CoglandBox, 0);
+
+      for (i = 1; i < compositor->damage->len; i++)
+        cogland_box_union (extents,
+                           &g_array_index (compositor->damage,
+                                           CoglandBox, i));
+      cogland_box_union (extents, &box);
+
+      g_array_set_size (compositor->damage, 1);
+    }
+  else
+    g_array_append_val (compositor->damage, box);
+}
+
+static void
+cogland_surface_damage_area (CoglandSurface *surface,
+                             int x,
+                             int y,
+                             int width,
+                             int height)
+{
+  struct wl_buffer *wayland_buffer;
+  CoglandBox bounds, area, box;
+
+  if (surface->buffer == NULL)
+    return;
+
+  wayland_buffer = surface->buffer->wayland_buffer;
+
+  bounds.x1 = 0;
+  bounds.y1 = 0;
+  bounds.x2 = wayland_buffer->width;
+  bounds.y2 = wayland_buffer->height;
+
+  area.x1 = x;
+  area.y1 = y;
+  area.x2 = x + width;
+  area.y2 = y + height;
+
+  if (cogland_box_intersect (&area, &bounds, &box))
+    cogland_compositor_damage (surface->compositor,
+                               surface->x + box.x1,
+                               surface->y + box.y1,
+                               box.x2 - box.x1,
+                               box.y2 - box.y1);
+}
+
+static void
+cogland_surface_damage_all (CoglandSurface *surface)
+{
+  if (surface->buffer)
+    cogland_surface_damage_area (surface, 0, 0,
+                                 surface->buffer->wayland_buffer->width,
+                                 surface->buffer->wayland_buffer->height);
+}
+
 static gboolean
 wayland_event_source_prepare (GSource *base, int *timeout)
 {
@@ -189,6 +317,18 @@ shm_buffer_damaged (struct wl_buffer *wayland_buffer,
                     gint32 height)
 {
   CoglandBuffer *buffer = wayland_buffer->user_data;
+  CoglandBox bounds = { 0, 0, wayland_buffer->width, wayland_buffer->height };
+  CoglandBox area = { x, y, x + width, y + height };
+  CoglandBox box;
+  GList *l;
+
+  /* The buffer may have been released when the last surface it was
+   * attached to went away */
+  if (buffer == NULL)
+    return;
+
+  if (!cogland_box_intersect (&area, &bounds, &box))
+    return;
 
   if (buffer->texture)
     {
@@ -216,15 +356,26 @@ shm_buffer_damaged (struct wl_buffer *wayland_buffer,
             format = COGL_PIXEL_FORMAT_ARGB_8888;
         }
 
+      /* Only the damaged sub-rectangle is uploaded. The source size
+       * given to Cogl is that of the whole shm buffer so that the
+       * rowstride and source offsets address the right pixels */
       cogl_texture_set_region (COGL_TEXTURE (buffer->texture),
-                               x, y,
-                               x, y,
-                               width, height,
-                               width, height,
+                               box.x1, box.y1,
+                               box.x1, box.y1,
+                               box.x2 - box.x1,
+                               box.y2 - box.y1,
+                               wayland_buffer->width,
+                               wayland_buffer->height,
                                format,
                                wl_shm_buffer_get_stride (wayland_buffer),
                                wl_shm_buffer_get_data (wayland_buffer));
     }
+
+  for (l = buffer->surfaces_attached_to; l; l = l->next)
+    cogland_surface_damage_area (l->data,
+                                 box.x1, box.y1,
+                                 box.x2 - box.x1,
+                                 box.y2 - box.y1);
 }
 
 static void
@@ -280,6 +431,9 @@ cogland_surface_attach_buffer (struct wl_client *wayland_client,
   if (buffer && surface->buffer == buffer)
     return;
 
+  /* Whatever was previously covered by the surface needs repainting */
+  cogland_surface_damage_all (surface);
+
   cogland_surface_detach_buffer (surface);
 
   /* XXX: it seems like for shm buffers we will have been notified of
@@ -310,6 +464,10 @@ cogland_surface_attach_buffer (struct wl_client *wayland_client,
     }
 
   surface->buffer = buffer;
+  surface->x += dx;
+  surface->y += dy;
+
+  cogland_surface_damage_all (surface);
 }
 
 static void
@@ -320,6 +478,9 @@ cogland_surface_damage (struct wl_client *client,
                         gint32 width,
                         gint32 height)
 {
+  CoglandSurface *surface = resource->data;
+
+  cogland_surface_damage_area (surface, x, y, width, height);
 }
 
 typedef struct _CoglandFrameCallback
@@ -377,6 +538,7 @@ cogland_surface_free (CoglandSurface *surface)
 {
   CoglandCompositor *compositor = surface->compositor;
   compositor->surfaces = g_list_remove (compositor->surfaces, surface);
+  cogland_surface_damage_all (surface);
   cogland_surface_detach_buffer (surface);
   g_slice_free (CoglandSurface, surface);
 }
@@ -397,6 +559,10 @@ cogland_compositor_create_surface (struct wl_client *wayland_client,
 
   surface->compositor = compositor;
 
+  /* Cascade new surfaces so that they don't all overlap */
+  surface->x = 32 * (g_list_length (compositor->surfaces) % 8);
+  surface->y = surface->x;
+
   surface->wayland_surface.resource.destroy =
     cogland_surface_resource_destroy_cb;
   surface->wayland_surface.resource.object.id = id;
@@ -486,6 +652,16 @@ cogland_compositor_create_output (CoglandCompositor *compositor,
   cogl_pop_framebuffer ();
 #endif
 
+  /* Map the virtual screen 1:1 to pixels so that surface damage can
+   * be translated directly into output damage */
+  cogl_framebuffer_orthographic (fb,
+                                 0, 0,
+                                 compositor->virtual_width,
+                                 compositor->virtual_height,
+                                 -1, 100);
+
+  output->needs_full_repaint = TRUE;
+
   mode = g_slice_new0 (CoglandMode);
   mode->flags = 0;
   mode->width = width_mm;
@@ -497,41 +673,131 @@ cogland_compositor_create_output (CoglandCompositor *compositor,
   compositor->outputs = g_list_prepend (compositor->outputs, output);
 }
 
-static gboolean
-paint_cb (void *user_data)
+static void
+cogland_output_paint (CoglandCompositor *compositor,
+                      CoglandOutput *output)
 {
-  CoglandCompositor *compositor = user_data;
+  CoglFramebuffer *fb = COGL_FRAMEBUFFER (output->onscreen);
+  CoglandBox output_box;
+  CoglandBox extents;
+  int *rectangles;
+  int n_rectangles = 0;
+  gboolean full_repaint;
   GList *l;
+  int i;
 
-  for (l = compositor->outputs; l; l = l->next)
+  output_box.x1 = output->x;
+  output_box.y1 = output->y;
+  output_box.x2 = output->x + cogl_framebuffer_get_width (fb);
+  output_box.y2 = output->y + cogl_framebuffer_get_height (fb);
+
+  /* Clip the accumulated damage to this output and convert it into
+   * window coordinates for cogl_framebuffer_swap_region() */
+  rectangles = g_alloca (sizeof (int) * 4 * (compositor->damage->len + 1));
+  for (i = 0; i < compositor->damage->len; i++)
     {
-      CoglandOutput *output = l->data;
-      CoglFramebuffer *fb = COGL_FRAMEBUFFER (output->onscreen);
-      GList *l2;
+      CoglandBox *damage = &g_array_index (compositor->damage, CoglandBox, i);
+      CoglandBox box;
+      int *rect;
+
+      if (!cogland_box_intersect (damage, &output_box, &box))
+        continue;
+
+      if (n_rectangles == 0)
+        extents = box;
+      else
+        cogland_box_union (&extents, &box);
+
+      rect = rectangles + n_rectangles++ * 4;
+      rect[0] = box.x1 - output->x;
+      rect[1] = box.y1 - output->y;
+      rect[2] = box.x2 - box.x1;
+      rect[3] = box.y2 - box.y1;
+    }
 
-      cogl_push_framebuffer (fb);
+  full_repaint = (output->needs_full_repaint ||
+                  (n_rectangles > 0 && !compositor->swap_region_supported));
 
-      cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  if (!full_repaint && n_rectangles == 0)
+    return;
 
-      cogl_framebuffer_draw_primitive (fb, compositor->triangle_pipeline,
-                                       compositor->triangle);
+  if (full_repaint)
+    extents = output_box;
 
-      for (l2 = compositor->surfaces; l2; l2 = l2->next)
-        {
-          CoglandSurface *surface = l2->data;
-
-          if (surface->buffer)
-            {
-              CoglTexture2D *texture = surface->buffer->texture;
-              cogl_set_source_texture (COGL_TEXTURE (texture));
-              cogl_rectangle (-1, 1, 1, -1);
-            }
-        }
-      cogl_framebuffer_swap_buffers (fb);
+  cogl_push_framebuffer (fb);
 
-      cogl_pop_framebuffer ();
+  if (!full_repaint)
+    cogl_framebuffer_push_scissor_clip (fb,
+                                        extents.x1 - output->x,
+                                        extents.y1 - output->y,
+                                        extents.x2 - extents.x1,
+                                        extents.y2 - extents.y1);
+
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  cogl_framebuffer_push_matrix (fb);
+  cogl_framebuffer_translate (fb,
+                              compositor->virtual_width / 2.0f,
+                              compositor->virtual_height / 2.0f,
+                              0);
+  cogl_framebuffer_scale (fb,
+                          compositor->virtual_width / 2.0f,
+                          -compositor->virtual_height / 2.0f,
+                          1);
+  cogl_framebuffer_draw_primitive (fb, compositor->triangle_pipeline,
+                                   compositor->triangle);
+  cogl_framebuffer_pop_matrix (fb);
+
+  /* Surfaces are prepended as they are created so walk the list
+   * backwards to paint the oldest surface at the bottom */
+  for (l = g_list_last (compositor->surfaces); l; l = l->prev)
+    {
+      CoglandSurface *surface = l->data;
+      struct wl_buffer *wayland_buffer;
+      CoglandBox surface_box, box;
+
+      if (!surface->buffer)
+        continue;
+
+      wayland_buffer = surface->buffer->wayland_buffer;
+      surface_box.x1 = surface->x;
+      surface_box.y1 = surface->y;
+      surface_box.x2 = surface->x + wayland_buffer->width;
+      surface_box.y2 = surface->y + wayland_buffer->height;
+
+      /* Skip surfaces that don't touch the area being repainted */
+      if (!cogland_box_intersect (&surface_box, &extents, &box))
+        continue;
+
+      cogl_set_source_texture (COGL_TEXTURE (surface->buffer->texture));
+      cogl_rectangle (surface_box.x1, surface_box.y1,
+                      surface_box.x2, surface_box.y2);
     }
 
+  if (full_repaint)
+    cogl_framebuffer_swap_buffers (fb);
+  else
+    {
+      cogl_framebuffer_pop_clip (fb);
+      cogl_framebuffer_swap_region (fb, rectangles, n_rectangles);
+    }
+
+  cogl_pop_framebuffer ();
+
+  output->needs_full_repaint = FALSE;
+}
+
+static gboolean
+paint_cb (void *user_data)
+{
+  CoglandCompositor *compositor = user_data;
+  GList *l;
+
+  for (l = compositor->outputs; l; l = l->next)
+    cogland_output_paint (compositor, l->data);
+
+  g_array_set_size (compositor->damage, 0);
+
   while (!g_queue_is_empty (&compositor->frame_callbacks))
     {
       CoglandFrameCallback *callback =
@@ -708,6 +974,7 @@ main (int argc, char **argv)
     g_error ("failed to create wayland display");
 
   g_queue_init (&compositor.frame_callbacks);
+  compositor.damage = g_array_new (FALSE, FALSE, sizeof (CoglandBox));
 
   if (!wl_display_add_global (compositor.wayland_display,
                               &wl_compositor_interface,
@@ -735,6 +1002,9 @@ main (int argc, char **argv)
   if (!compositor.cogl_context)
     g_error ("Failed to create a Cogl context: %s\n", error->message);
 
+  compositor.swap_region_supported =
+    cogl_has_feature (compositor.cogl_context, COGL_FEATURE_ID_SWAP_REGION);
+
   compositor.virtual_width = 640;
   compositor.virtual_height = 480;
 
@@ -0,0 +1,115 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+typedef struct
+{
+  gint16 x, y;
+  guint8 r, g, b, a;
+} Vert;
+
+static void
+draw_quad (CoglFramebuffer *fb,
+           CoglPipeline *pipeline,
+           CoglAttributeBuffer *buffer,
+           int x)
+{
+  CoglAttribute *attributes[2];
+
+  attributes[0] = cogl_attribute_new (buffer,
+                                      "cogl_position_in",
+                                      sizeof (Vert),
+                                      G_STRUCT_OFFSET (Vert, x),
+                                      2, /* n_components */
+                                      COGL_ATTRIBUTE_TYPE_SHORT);
+  /* A colour array on an opaque pipeline makes Cogl derive a
+   * pipeline with blending enabled */
+  attributes[1] = cogl_attribute_new (buffer,
+                                      "cogl_color_in",
+                                      sizeof (Vert),
+                                      G_STRUCT_OFFSET (Vert, r),
+                                      4, /* n_components */
+                                      COGL_ATTRIBUTE_TYPE_UNSIGNED_BYTE);
+
+  cogl_framebuffer_push_matrix (fb);
+  cogl_framebuffer_translate (fb, x, 0, 0);
+
+  cogl_framebuffer_draw_attributes (fb,
+                                    pipeline,
+                                    COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                    0, /* first_vertex */
+                                    4, /* n_vertices */
+                                    attributes,
+                                    2 /* n_attributes */);
+
+  cogl_framebuffer_pop_matrix (fb);
+
+  cogl_object_unref (attributes[1]);
+  cogl_object_unref (attributes[0]);
+}
+
+void
+test_cogl_attribute_overrides (TestUtilsGTestFixture *fixture,
+                               void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglFramebuffer *fb = shared_state->fb;
+  CoglAttributeBuffer *buffer;
+  CoglPipeline *pipeline, *other;
+
+  static const Vert verts[] =
+    {
+      { 0, 0, /**/ 0x00, 0x00, 0xff, 0xff },
+      { 0, 10, /**/ 0x00, 0x00, 0xff, 0xff },
+      { 10, 0, /**/ 0x00, 0x00, 0xff, 0xff },
+      { 10, 10, /**/ 0x00, 0x00, 0xff, 0xff }
+    };
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  buffer = cogl_attribute_buffer_new (ctx, sizeof (verts), verts);
+
+  /* Drawing twice reuses the derived pipeline */
+  pipeline = cogl_pipeline_new ();
+  draw_quad (fb, pipeline, buffer, 0);
+  draw_quad (fb, pipeline, buffer, 10);
+  test_utils_check_pixel (5, 5, 0x0000ffff);
+  test_utils_check_pixel (15, 5, 0x0000ffff);
+
+  /* Modifying the source throws away the derived pipeline while it
+   * is still the current pipeline */
+  draw_quad (fb, pipeline, buffer, 20);
+  cogl_pipeline_set_color4ub (pipeline, 0xff, 0x00, 0x00, 0xff);
+  draw_quad (fb, pipeline, buffer, 30);
+  test_utils_check_pixel (25, 5, 0x0000ffff);
+  test_utils_check_pixel (35, 5, 0x0000ffff);
+
+  /* Freeing the source while the derived pipeline is still current
+   * must not free it twice */
+  draw_quad (fb, pipeline, buffer, 40);
+  cogl_object_unref (pipeline);
+
+  /* Drawing with something else replaces the current pipeline and
+   * drops the last reference on the derived one */
+  other = cogl_pipeline_new ();
+  cogl_pipeline_set_color4ub (other, 0x00, 0xff, 0x00, 0xff);
+  cogl_push_framebuffer (fb);
+  cogl_set_source (other);
+  cogl_rectangle (50, 0, 60, 10);
+  cogl_pop_framebuffer ();
+  draw_quad (fb, other, buffer, 60);
+  cogl_object_unref (other);
+
+  test_utils_check_pixel (45, 5, 0x0000ffff);
+  test_utils_check_pixel (55, 5, 0x00ff00ff);
+  test_utils_check_pixel (65, 5, 0x0000ffff);
+
+  cogl_object_unref (buffer);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
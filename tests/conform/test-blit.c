@@ -0,0 +1,209 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define N_TEXTURES 32
+
+#define OPACITY_FOR_ROW(y) \
+  (0xff - ((y) & 0xf) * 0x10)
+
+static const guint8 colors[][3] =
+  { { 0xff, 0x00, 0x00 },
+    { 0x00, 0xff, 0x00 },
+    { 0x00, 0x00, 0xff } };
+
+static void
+fill_texture_data (guint8 *data, int size)
+{
+  const guint8 *color = colors[size % G_N_ELEMENTS (colors)];
+  int x, y;
+
+  /* Fade the opacity out with increasing y coordinates so that a
+     blit that blends with garbage in the destination is noticed */
+  for (y = 0; y < size; y++)
+    {
+      int opacity = OPACITY_FOR_ROW (y);
+
+      for (x = 0; x < size; x++)
+        {
+          data[0] = color[0] * opacity / 255;
+          data[1] = color[1] * opacity / 255;
+          data[2] = color[2] * opacity / 255;
+          data[3] = opacity;
+          data += 4;
+        }
+    }
+}
+
+static CoglHandle
+create_texture (int size)
+{
+  CoglHandle texture;
+  guint8 *data = g_malloc (size * size * 4);
+
+  fill_texture_data (data, size);
+
+  /* These will end up in the atlas so creating lots of them makes it
+     get reorganized which is done with a blit */
+  texture = cogl_texture_new_from_data (size, size,
+                                        COGL_TEXTURE_NONE,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        size * 4,
+                                        data);
+
+  g_free (data);
+
+  return texture;
+}
+
+static void
+verify_texture (CoglHandle texture, int size)
+{
+  guint8 *expected = g_malloc (size * size * 4);
+  guint8 *data = g_malloc (size * size * 4);
+  int i;
+
+  fill_texture_data (expected, size);
+
+  cogl_texture_get_data (texture,
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         size * 4,
+                         data);
+
+  for (i = 0; i < size * size * 4; i++)
+    g_assert_cmpint (data[i], ==, expected[i]);
+
+  g_free (expected);
+  g_free (data);
+}
+
+static void
+migrate_texture (CoglFramebuffer *fb, CoglHandle texture)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new ();
+
+  /* The atlas can't be mipmapped so painting the texture with a
+     mipmap filter copies it out of the atlas with a blit from the
+     atlas texture */
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR_MIPMAP_NEAREST,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+
+  cogl_push_framebuffer (fb);
+  cogl_set_source (pipeline);
+  cogl_rectangle (0, 0, 1, 1);
+  cogl_pop_framebuffer ();
+
+  cogl_object_unref (pipeline);
+}
+
+static void
+test_blit_mode (TestUtilsSharedState *shared_state,
+                const char *mode,
+                gboolean check_memory)
+{
+  CoglHandle textures[N_TEXTURES];
+  GTimer *timer = g_timer_new ();
+  double grow_time = 0.0, migrate_time = 0.0;
+  size_t base_usage;
+  int i, tex_num;
+
+  /* The blit mode is only looked up the first time a blit is done
+     so this only has an effect when the test is run on its own */
+  g_setenv ("COGL_ATLAS_DEFAULT_BLIT_MODE", mode, TRUE);
+
+  cogl_framebuffer_orthographic (shared_state->fb, 0, 0,
+                                 cogl_framebuffer_get_width (shared_state->fb),
+                                 cogl_framebuffer_get_height (shared_state->fb),
+                                 -1, 100);
+
+  base_usage =
+    cogl_context_get_memory_usage (shared_state->ctx,
+                                   COGL_MEMORY_USAGE_TYPE_TEXTURE_2D);
+
+  /* Grow the atlas a few times over so that textures for which a
+     framebuffer has been cached keep being replaced */
+  for (i = 0; i < 3; i++)
+    {
+      /* The atlas is reorganized several times while these are
+         created */
+      g_timer_start (timer);
+      for (tex_num = 0; tex_num < N_TEXTURES; tex_num++)
+        textures[tex_num] = create_texture (tex_num + 1);
+      grow_time += g_timer_elapsed (timer, NULL);
+
+      for (tex_num = 0; tex_num < N_TEXTURES; tex_num++)
+        verify_texture (textures[tex_num], tex_num + 1);
+
+      /* Every migration blits from the same atlas texture so after
+         the first one the framebuffer should come from the cache */
+      g_timer_start (timer);
+      for (tex_num = 0; tex_num < N_TEXTURES; tex_num += 4)
+        migrate_texture (shared_state->fb, textures[tex_num]);
+      /* The migration only happens once the journal is flushed */
+      if (g_test_perf ())
+        cogl_flush ();
+      migrate_time += g_timer_elapsed (timer, NULL);
+
+      for (tex_num = 0; tex_num < N_TEXTURES; tex_num++)
+        {
+          verify_texture (textures[tex_num], tex_num + 1);
+          cogl_object_unref (textures[tex_num]);
+        }
+
+      /* Nothing cached for blitting should keep the atlas textures
+         alive once all of the textures using them are gone */
+      if (check_memory)
+        g_assert_cmpint (cogl_context_get_memory_usage
+                         (shared_state->ctx,
+                          COGL_MEMORY_USAGE_TYPE_TEXTURE_2D),
+                         ==,
+                         base_usage);
+    }
+
+  if (g_test_perf ())
+    g_print ("blit %s: %.2fms growing the atlas, %.2fms migrating\n",
+             mode, grow_time * 1000.0, migrate_time * 1000.0);
+
+  g_timer_destroy (timer);
+}
+
+void
+test_cogl_blit_copy_image (TestUtilsGTestFixture *fixture,
+                           void *data)
+{
+  /* If glCopyImageSubData isn't available this falls back to the
+     texture-render mode which keeps the last destination texture
+     attached to its pipeline so the memory can't be checked */
+  test_blit_mode (data, "copy-image", FALSE);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+void
+test_cogl_blit_texture_render (TestUtilsGTestFixture *fixture,
+                               void *data)
+{
+  /* This mode creates a new framebuffer for the destination texture
+     for every blit session. It keeps the last destination texture
+     attached to its pipeline so the memory can't be checked */
+  test_blit_mode (data, "texture-render", FALSE);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+void
+test_cogl_blit_cached_fbo (TestUtilsGTestFixture *fixture,
+                           void *data)
+{
+  /* This mode only needs a framebuffer for the source texture which
+     is the one that gets cached */
+  test_blit_mode (data, "copy-tex-sub-image", TRUE);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,111 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+#define FB_SIZE 128
+
+/* A pixel that is outside of the damage we report */
+#define OUTSIDE_X 100
+#define OUTSIDE_Y 100
+
+static void
+read_pixel (int x, int y, guint8 *pixel)
+{
+  cogl_read_pixels (x, y, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixel);
+}
+
+static gboolean
+is_full_region (const int *region)
+{
+  return (region[0] == 0 && region[1] == 0 &&
+          region[2] == FB_SIZE && region[3] == FB_SIZE);
+}
+
+void
+test_cogl_buffer_age (TestUtilsGTestFixture *fixture,
+                      void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglOnscreen *onscreen;
+  CoglFramebuffer *fb;
+  GError *error = NULL;
+  int damage[4] = { 16, 16, 32, 32 };
+  int region[4];
+  guint8 outside_before[4];
+  guint8 outside_after[4];
+  int age;
+
+  onscreen = cogl_onscreen_new (shared_state->ctx, FB_SIZE, FB_SIZE);
+  fb = COGL_FRAMEBUFFER (onscreen);
+
+  if (!cogl_framebuffer_allocate (fb, &error))
+    g_critical ("Failed to allocate onscreen framebuffer: %s",
+                error->message);
+
+  cogl_onscreen_show (onscreen);
+  cogl_framebuffer_orthographic (fb, 0, 0, FB_SIZE, FB_SIZE, -1, 100);
+
+  cogl_push_framebuffer (fb);
+
+  /* Without any damage the whole frame has to be repainted */
+  cogl_onscreen_get_repaint_region (onscreen, region);
+  g_assert (is_full_region (region));
+
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 1, 0, 0, 1);
+  cogl_framebuffer_swap_buffers (fb);
+
+  cogl_onscreen_add_damage (onscreen, damage, 1);
+
+  age = cogl_onscreen_get_buffer_age (onscreen);
+  if (!cogl_has_feature (shared_state->ctx, COGL_FEATURE_ID_BUFFER_AGE))
+    g_assert_cmpint (age, ==, 0);
+
+  if (g_test_verbose ())
+    g_print ("Buffer age: %i\n", age);
+
+  /* If the back buffer contains the previous frame then only the
+   * damage needs repainting. The frame before that was never drawn by
+   * us and the age can be unknown so in any other case everything has
+   * to be repainted */
+  cogl_onscreen_get_repaint_region (onscreen, region);
+  if (age == 1)
+    g_assert (memcmp (region, damage, sizeof (damage)) == 0);
+  else
+    g_assert (is_full_region (region));
+
+  read_pixel (OUTSIDE_X, OUTSIDE_Y, outside_before);
+
+  /* Everything drawn should be scissored to the repaint region */
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 1, 0, 1);
+  cogl_set_source_color4ub (0, 0, 255, 255);
+  cogl_rectangle (0, 0, FB_SIZE, FB_SIZE / 4);
+
+  test_utils_check_pixel (damage[0] + 1, damage[1] + 1, 0x0000ffff);
+  test_utils_check_pixel (damage[0] + damage[2] - 1,
+                          damage[1] + damage[3] - 1,
+                          0x00ff00ff);
+
+  read_pixel (OUTSIDE_X, OUTSIDE_Y, outside_after);
+  if (is_full_region (region))
+    test_utils_compare_pixel (outside_after, 0x00ff00ff);
+  else
+    g_assert (memcmp (outside_before, outside_after, 4) == 0);
+
+  cogl_framebuffer_swap_buffers (fb);
+
+  /* The repaint region only lasts until the swap */
+  cogl_onscreen_get_repaint_region (onscreen, region);
+  g_assert (is_full_region (region));
+
+  cogl_pop_framebuffer ();
+
+  cogl_object_unref (onscreen);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
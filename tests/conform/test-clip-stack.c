@@ -0,0 +1,104 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define N_PERF_ITERATIONS 10000
+#define N_PERF_DEPTH 8
+
+static void
+push_and_pop_clips (CoglFramebuffer *fb, int depth)
+{
+  int i;
+
+  for (i = 0; i < depth; i++)
+    {
+      cogl_framebuffer_push_matrix (fb);
+      cogl_framebuffer_translate (fb, 1, 1, 0);
+      cogl_framebuffer_push_rectangle_clip (fb, 0, 0, 100, 100);
+    }
+
+  for (i = 0; i < depth; i++)
+    {
+      cogl_framebuffer_pop_clip (fb);
+      cogl_framebuffer_pop_matrix (fb);
+    }
+}
+
+static void
+run_benchmark (CoglFramebuffer *fb)
+{
+  GTimer *timer = g_timer_new ();
+  int i;
+
+  /* Nothing is drawn inside the clips so their bounds should never
+   * need to be calculated */
+  for (i = 0; i < N_PERF_ITERATIONS; i++)
+    push_and_pop_clips (fb, N_PERF_DEPTH);
+
+  g_print ("clip stack: %.2fus per push and pop\n",
+           g_timer_elapsed (timer, NULL) * 1e6 /
+           (N_PERF_ITERATIONS * N_PERF_DEPTH));
+
+  g_timer_destroy (timer);
+}
+
+void
+test_cogl_clip_stack (TestUtilsGTestFixture *fixture,
+                      void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  /* The bounds of the clips are calculated lazily so they need to use
+   * the projection that was current when they were pushed rather than
+   * when they are flushed */
+  cogl_framebuffer_push_rectangle_clip (fb, 10, 10, 40, 40);
+  cogl_framebuffer_push_scissor_clip (fb, 20, 0, 100, 100);
+  cogl_framebuffer_push_matrix (fb);
+  cogl_framebuffer_translate (fb, 0, 15, 0);
+  cogl_framebuffer_push_rectangle_clip (fb, 0, 0, 100, 10);
+  cogl_framebuffer_pop_matrix (fb);
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb) * 2,
+                                 cogl_framebuffer_get_height (fb) * 2,
+                                 -1, 100);
+
+  /* Pushing and popping unused clips on top shouldn't affect the
+   * result */
+  push_and_pop_clips (fb, N_PERF_DEPTH);
+
+  cogl_push_framebuffer (fb);
+  cogl_set_source_color4ub (0xff, 0, 0, 0xff);
+  cogl_rectangle (0, 0, 200, 200);
+  cogl_pop_framebuffer ();
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  cogl_framebuffer_pop_clip (fb);
+  cogl_framebuffer_pop_clip (fb);
+  cogl_framebuffer_pop_clip (fb);
+
+  /* Only the intersection of the three clips should be drawn */
+  test_utils_check_pixel (25, 20, 0xff0000ff);
+  test_utils_check_pixel (15, 20, 0x000000ff);
+  test_utils_check_pixel (25, 12, 0x000000ff);
+  test_utils_check_pixel (25, 27, 0x000000ff);
+  test_utils_check_pixel (45, 20, 0x000000ff);
+
+  if (g_test_perf ())
+    run_benchmark (fb);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
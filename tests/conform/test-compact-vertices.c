@@ -0,0 +1,118 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define QUAD_SIZE 16
+#define N_PERF_RECTS 1000
+#define N_PERF_FRAMES 100
+
+static CoglTexture *
+create_texture (void)
+{
+  static const guint8 data[] =
+    {
+      0xff, 0x00, 0x00, 0xff,   0x00, 0xff, 0x00, 0xff,
+      0x00, 0x00, 0xff, 0xff,   0xff, 0xff, 0xff, 0xff
+    };
+
+  return cogl_texture_new_from_data (2, 2,
+                                     COGL_TEXTURE_NO_ATLAS,
+                                     COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                     COGL_PIXEL_FORMAT_ANY,
+                                     8, /* rowstride */
+                                     data);
+}
+
+static void
+check_quad (int x)
+{
+  test_utils_check_pixel (x + QUAD_SIZE / 4, QUAD_SIZE / 4, 0xff0000ff);
+  test_utils_check_pixel (x + QUAD_SIZE * 3 / 4, QUAD_SIZE / 4, 0x00ff00ff);
+  test_utils_check_pixel (x + QUAD_SIZE / 4, QUAD_SIZE * 3 / 4, 0x0000ffff);
+  test_utils_check_pixel (x + QUAD_SIZE * 3 / 4, QUAD_SIZE * 3 / 4,
+                          0xffffffff);
+}
+
+static double
+time_frames (CoglFramebuffer *fb, float offset)
+{
+  GTimer *timer = g_timer_new ();
+  double elapsed;
+  int frame, i;
+
+  for (frame = 0; frame < N_PERF_FRAMES; frame++)
+    {
+      cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+      for (i = 0; i < N_PERF_RECTS; i++)
+        {
+          float x = (i % 32) * 2 + offset;
+          float y = (i / 32) * 2 + offset;
+
+          cogl_rectangle_with_texture_coords (x, y, x + 2, y + 2,
+                                              0, 0, 1, 1);
+        }
+
+      cogl_flush ();
+    }
+
+  cogl_framebuffer_finish (fb);
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  return elapsed * 1e6 / N_PERF_FRAMES;
+}
+
+void
+test_cogl_compact_vertices (TestUtilsGTestFixture *fixture,
+                            void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+  CoglTexture *tex = create_texture ();
+  CoglPipeline *pipeline = cogl_pipeline_new ();
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, tex);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+  cogl_set_source (pipeline);
+
+  /* Pixel aligned rectangles with whole number texture coordinates
+   * should be uploaded as compact vertices, including the one that
+   * has been transformed by a whole number translation and scale */
+  cogl_rectangle_with_texture_coords (0, 0, QUAD_SIZE, QUAD_SIZE,
+                                      0, 0, 1, 1);
+
+  cogl_push_matrix ();
+  cogl_translate (QUAD_SIZE * 2, 0, 0);
+  cogl_scale (2, 2, 1);
+  cogl_rectangle_with_texture_coords (0, 0, QUAD_SIZE / 2, QUAD_SIZE / 2,
+                                      0, 0, 1, 1);
+  cogl_pop_matrix ();
+
+  check_quad (0);
+  check_quad (QUAD_SIZE * 2);
+
+  if (g_test_perf ())
+    {
+      /* Offsetting by half a pixel forces float vertices */
+      double compact_time = time_frames (fb, 0.0f);
+      double float_time = time_frames (fb, 0.5f);
+
+      g_print ("%i rectangles: compact: %.2fus, float: %.2fus per frame\n",
+               N_PERF_RECTS, compact_time, float_time);
+    }
+
+  cogl_object_unref (pipeline);
+  cogl_object_unref (tex);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -141,6 +141,29 @@ main (int argc, char **argv)
   ADD_TEST ("/cogl", test_cogl_depth_test);
   ADD_TEST ("/cogl", test_cogl_color_mask);
   ADD_TEST ("/cogl", test_cogl_backface_culling);
+  ADD_TEST ("/cogl", test_cogl_buffer_age);
+  ADD_TEST ("/cogl", test_cogl_depth_sorting);
+  ADD_TEST ("/cogl", test_cogl_occlusion_culling);
+  ADD_TEST ("/cogl", test_cogl_frame_clock);
+  ADD_TEST ("/cogl", test_cogl_fence);
+  ADD_TEST ("/cogl", test_cogl_pipeline_layers);
+  ADD_TEST ("/cogl", test_cogl_journal_transform);
+  ADD_TEST ("/cogl", test_cogl_compact_vertices);
+  ADD_TEST ("/cogl", test_cogl_clip_stack);
+  ADD_TEST ("/cogl", test_cogl_region_clip);
+  ADD_TEST ("/cogl", test_cogl_transient_offscreen);
+  ADD_TEST ("/cogl", test_cogl_texture_memory);
+  ADD_TEST ("/cogl", test_cogl_sparse_texture);
+  ADD_TEST ("/cogl", test_cogl_texture_slicing);
+  ADD_TEST ("/cogl", test_cogl_offscreen_multisample);
+  ADD_TEST ("/cogl", test_cogl_texture_readback);
+  ADD_TEST ("/cogl", test_cogl_float_textures);
+  ADD_TEST ("/cogl", test_cogl_red_textures);
+  ADD_TEST ("/cogl", test_cogl_pango_red_atlas);
+  ADD_TEST ("/cogl", test_cogl_texture_batch_uploads);
+  ADD_TEST ("/cogl", test_cogl_blit_copy_image);
+  ADD_TEST ("/cogl", test_cogl_blit_cached_fbo);
+  ADD_TEST ("/cogl", test_cogl_blit_texture_render);
 
   UNPORTED_TEST ("/cogl/texture", test_cogl_npot_texture);
   UNPORTED_TEST ("/cogl/texture", test_cogl_multitexture);
@@ -150,6 +173,7 @@ main (int argc, char **argv)
   UNPORTED_TEST ("/cogl/texture", test_cogl_texture_rectangle);
   UNPORTED_TEST ("/cogl/texture", test_cogl_texture_3d);
   ADD_TEST ("/cogl/texture", test_cogl_wrap_modes);
+  ADD_TEST ("/cogl/texture", test_cogl_layer_samplers);
   UNPORTED_TEST ("/cogl/texture", test_cogl_texture_pixmap_x11);
   UNPORTED_TEST ("/cogl/texture", test_cogl_texture_get_set_data);
   UNPORTED_TEST ("/cogl/texture", test_cogl_atlas_migration);
@@ -159,6 +183,8 @@ main (int argc, char **argv)
   UNPORTED_TEST ("/cogl/vertex-buffer", test_cogl_vertex_buffer_mutability);
 
   ADD_TEST ("/cogl/vertex-array", test_cogl_primitive);
+  ADD_TEST ("/cogl/vertex-array", test_cogl_viewport_culling);
+  ADD_TEST ("/cogl/vertex-array", test_cogl_attribute_overrides);
 
   ADD_TEST ("/cogl/shaders", test_cogl_just_vertex_shader);
   ADD_TEST ("/cogl/shaders", test_cogl_pipeline_uniforms);
@@ -0,0 +1,144 @@
+#include <cogl/cogl.h>
+
+#include <string.h>
+
+#include "test-utils.h"
+
+#define RECT_SIZE 16
+#define N_RECTS 6
+#define SCENE_WIDTH (RECT_SIZE * (N_RECTS + 1))
+#define SCENE_HEIGHT (RECT_SIZE * 2)
+
+static void
+draw_scene (CoglFramebuffer *fb)
+{
+  CoglPipeline *opaque = cogl_pipeline_new ();
+  CoglPipeline *translucent = cogl_pipeline_new ();
+  int i;
+
+  cogl_framebuffer_clear4f (fb,
+                            COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_DEPTH,
+                            0, 0, 0, 1);
+
+  /* Alternate between opaque and translucent rectangles that each
+   * overlap the previous one so that the result depends on the order
+   * they are drawn in */
+  for (i = 0; i < N_RECTS; i++)
+    {
+      float x = i * RECT_SIZE;
+      float y = (i & 1) ? RECT_SIZE / 2 : 0;
+
+      if (i & 1)
+        {
+          cogl_pipeline_set_color4ub (translucent, 0, 0x40 * i, 0x80, 0x80);
+          cogl_set_source (translucent);
+        }
+      else
+        {
+          cogl_pipeline_set_color4ub (opaque, 0xff, 0x30 * i, 0, 0xff);
+          cogl_set_source (opaque);
+        }
+
+      cogl_rectangle (x, y, x + RECT_SIZE * 2, y + RECT_SIZE * 1.5);
+    }
+
+  /* An opaque rectangle on top of everything else */
+  cogl_pipeline_set_color4ub (opaque, 0xff, 0xff, 0xff, 0xff);
+  cogl_set_source (opaque);
+  cogl_rectangle (RECT_SIZE, RECT_SIZE / 2,
+                  RECT_SIZE * 3, RECT_SIZE);
+
+  cogl_object_unref (opaque);
+  cogl_object_unref (translucent);
+}
+
+static guint8 *
+read_scene (void)
+{
+  guint8 *pixels = g_malloc (SCENE_WIDTH * SCENE_HEIGHT * 4);
+
+  cogl_read_pixels (0, 0, SCENE_WIDTH, SCENE_HEIGHT,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixels);
+
+  return pixels;
+}
+
+static void
+draw_cached_pipeline (CoglFramebuffer *fb,
+                      CoglPipeline *pipeline)
+{
+  cogl_framebuffer_clear4f (fb,
+                            COGL_BUFFER_BIT_COLOR | COGL_BUFFER_BIT_DEPTH,
+                            0, 0, 0, 1);
+  cogl_set_source (pipeline);
+  cogl_rectangle (0, 0, RECT_SIZE, RECT_SIZE);
+  cogl_rectangle (RECT_SIZE / 2, 0, RECT_SIZE * 2, RECT_SIZE);
+}
+
+/* The depth sorted version of a pipeline is cached on it so this
+ * checks that modifying or destroying the pipeline is picked up */
+static void
+check_cached_pipelines (CoglFramebuffer *fb)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new ();
+  CoglPipeline *other = cogl_pipeline_new ();
+
+  cogl_pipeline_set_color4ub (pipeline, 0xff, 0x00, 0x00, 0xff);
+  draw_cached_pipeline (fb, pipeline);
+  test_utils_check_pixel (RECT_SIZE, RECT_SIZE / 2, 0xff0000ff);
+
+  cogl_pipeline_set_color4ub (pipeline, 0x00, 0xff, 0x00, 0xff);
+  draw_cached_pipeline (fb, pipeline);
+  test_utils_check_pixel (RECT_SIZE, RECT_SIZE / 2, 0x00ff00ff);
+
+  /* Leave the journal holding the last reference on the pipeline */
+  cogl_pipeline_set_color4ub (pipeline, 0x00, 0x00, 0xff, 0xff);
+  draw_cached_pipeline (fb, pipeline);
+  cogl_set_source (other);
+  cogl_object_unref (pipeline);
+  test_utils_check_pixel (RECT_SIZE, RECT_SIZE / 2, 0x0000ffff);
+
+  cogl_object_unref (other);
+}
+
+void
+test_cogl_depth_sorting (TestUtilsGTestFixture *fixture,
+                         void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+  guint8 *expected, *sorted;
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  g_assert (!cogl_framebuffer_get_depth_sorting_enabled (fb));
+
+  draw_scene (fb);
+  expected = read_scene ();
+
+  cogl_framebuffer_set_depth_sorting_enabled (fb, TRUE);
+  g_assert (cogl_framebuffer_get_depth_sorting_enabled (fb));
+
+  /* Drawing the scene twice checks that the depths handed out are
+   * reset when the depth buffer is cleared */
+  draw_scene (fb);
+  draw_scene (fb);
+  sorted = read_scene ();
+
+  check_cached_pipelines (fb);
+
+  cogl_framebuffer_set_depth_sorting_enabled (fb, FALSE);
+
+  g_assert (memcmp (expected, sorted, SCENE_WIDTH * SCENE_HEIGHT * 4) == 0);
+
+  g_free (expected);
+  g_free (sorted);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,102 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* Give up waiting for a fence after this many microseconds */
+#define FENCE_TIMEOUT (5 * G_USEC_PER_SEC)
+
+static int fired_count;
+static gboolean cancelled_fired;
+
+static void
+fence_cb (CoglFence *fence,
+          void *user_data)
+{
+  g_assert (cogl_fence_get_user_data (fence) == user_data);
+
+  if (user_data == &cancelled_fired)
+    cancelled_fired = TRUE;
+  else
+    fired_count++;
+}
+
+static void
+iterate (CoglContext *ctx)
+{
+  CoglPollFD *poll_fds;
+  int n_poll_fds;
+  gint64 timeout;
+
+  cogl_poll_get_info (ctx, &poll_fds, &n_poll_fds, &timeout);
+
+  /* Never sleep for too long so the test can time out */
+  if (timeout == -1 || timeout > 10000)
+    timeout = 10000;
+
+  g_poll ((GPollFD *) poll_fds, n_poll_fds, timeout / 1000);
+
+  cogl_poll_dispatch (ctx, poll_fds, n_poll_fds);
+}
+
+void
+test_cogl_fence (TestUtilsGTestFixture *fixture,
+                 void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglFramebuffer *fb = shared_state->fb;
+  CoglFence *fence, *cancelled;
+  gint64 start, latency;
+
+  if (!cogl_has_feature (ctx, COGL_FEATURE_ID_FENCE))
+    {
+      g_assert (cogl_framebuffer_add_fence_callback (fb, fence_cb,
+                                                     NULL) == NULL);
+
+      if (g_test_verbose ())
+        g_print ("Skipping: fences aren't supported\n");
+      return;
+    }
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  /* The rectangle is still in the journal so the fence has to wait
+   * for it to be flushed */
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_push_framebuffer (fb);
+  cogl_set_source_color4ub (0xff, 0, 0, 0xff);
+  cogl_rectangle (0, 0, 16, 16);
+  cogl_pop_framebuffer ();
+
+  start = g_get_monotonic_time ();
+
+  fence = cogl_framebuffer_add_fence_callback (fb, fence_cb, &fired_count);
+  g_assert (fence != NULL);
+
+  cancelled = cogl_framebuffer_add_fence_callback (fb, fence_cb,
+                                                   &cancelled_fired);
+  g_assert (cancelled != NULL);
+  cogl_framebuffer_cancel_fence_callback (fb, cancelled);
+
+  cogl_flush ();
+
+  while (fired_count == 0 &&
+         g_get_monotonic_time () - start < FENCE_TIMEOUT)
+    iterate (ctx);
+
+  latency = g_get_monotonic_time () - start;
+
+  g_assert_cmpint (fired_count, ==, 1);
+  g_assert (!cancelled_fired);
+
+  test_utils_check_pixel (8, 8, 0xff0000ff);
+
+  if (g_test_perf ())
+    g_print ("fence callback latency: %.2fms\n", latency / 1000.0);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,135 @@
+#include <cogl/cogl.h>
+#include <math.h>
+
+#include "test-utils.h"
+
+#define TEXTURE_SIZE 8
+
+static void
+check_float_pixels (const float *pixels,
+                    const float *expected,
+                    float tolerance)
+{
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE * 4; i++)
+    if (fabsf (pixels[i] - expected[i % 4]) > tolerance)
+      {
+        g_print ("Component %i is %f, expected %f\n",
+                 i, pixels[i], expected[i % 4]);
+        g_assert_not_reached ();
+      }
+}
+
+static void
+test_half_upload (CoglContext *ctx)
+{
+  /* Unpremultiplied (1.0, 0.5, 0.25, 0.5) as half floats */
+  static const guint16 half_pixel[4] = { 0x3c00, 0x3800, 0x3400, 0x3800 };
+  static const float expected[4] = { 0.5f, 0.25f, 0.125f, 0.5f };
+  guint16 data[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  float pixels[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  CoglTexture2D *texture;
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE * 4; i++)
+    data[i] = half_pixel[i % 4];
+
+  /* The data has to be premultiplied before it is uploaded */
+  texture = cogl_texture_2d_new_from_data (ctx,
+                                           TEXTURE_SIZE, TEXTURE_SIZE,
+                                           COGL_PIXEL_FORMAT_RGBA_16F,
+                                           COGL_PIXEL_FORMAT_RGBA_16F_PRE,
+                                           TEXTURE_SIZE * 8,
+                                           (guint8 *) data,
+                                           NULL);
+  g_assert (texture != NULL);
+
+  cogl_texture_get_data (COGL_TEXTURE (texture),
+                         COGL_PIXEL_FORMAT_RGBA_32F_PRE,
+                         TEXTURE_SIZE * 16,
+                         (guint8 *) pixels);
+  /* All of the values are exactly representable as half floats */
+  check_float_pixels (pixels, expected, 0.0f);
+
+  cogl_object_unref (texture);
+}
+
+static void
+test_accumulation (CoglContext *ctx)
+{
+  static const float expected[4] = {
+    2 * 0xc0 / 255.0f, 2 * 0xc0 / 255.0f, 2 * 0xc0 / 255.0f, 2 * 0xc0 / 255.0f
+  };
+  float pixels[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  CoglTexture2D *texture;
+  CoglHandle offscreen;
+  CoglPipeline *pipeline;
+
+  texture = cogl_texture_2d_new_with_size (ctx,
+                                           TEXTURE_SIZE, TEXTURE_SIZE,
+                                           COGL_PIXEL_FORMAT_RGBA_16F_PRE,
+                                           NULL);
+  g_assert (texture != NULL);
+
+  offscreen = cogl_offscreen_new_to_texture (COGL_TEXTURE (texture));
+  if (offscreen == COGL_INVALID_HANDLE)
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping accumulation: can't render to half floats\n");
+      cogl_object_unref (texture);
+      return;
+    }
+
+  cogl_framebuffer_orthographic (offscreen, 0, 0,
+                                 TEXTURE_SIZE, TEXTURE_SIZE,
+                                 -1, 100);
+  cogl_framebuffer_clear4f (offscreen, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 0);
+
+  /* Adding the same colour twice should go past 1.0 without being
+   * clamped */
+  pipeline = cogl_pipeline_new ();
+  cogl_pipeline_set_color4ub (pipeline, 0xc0, 0xc0, 0xc0, 0xc0);
+  cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, DST_COLOR)",
+                           NULL);
+
+  cogl_push_framebuffer (offscreen);
+  cogl_set_source (pipeline);
+  cogl_rectangle (0, 0, TEXTURE_SIZE, TEXTURE_SIZE);
+  cogl_rectangle (0, 0, TEXTURE_SIZE, TEXTURE_SIZE);
+  cogl_pop_framebuffer ();
+
+  cogl_object_unref (pipeline);
+
+  cogl_texture_get_data (COGL_TEXTURE (texture),
+                         COGL_PIXEL_FORMAT_RGBA_32F_PRE,
+                         TEXTURE_SIZE * 16,
+                         (guint8 *) pixels);
+  check_float_pixels (pixels, expected, 0.01f);
+
+  cogl_object_unref (offscreen);
+  cogl_object_unref (texture);
+}
+
+void
+test_cogl_float_textures (TestUtilsGTestFixture *fixture,
+                          void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+
+  if (!cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_HALF_FLOAT))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: half float textures aren't supported\n");
+      return;
+    }
+
+  test_half_upload (ctx);
+
+  if (cogl_has_feature (ctx, COGL_FEATURE_ID_OFFSCREEN))
+    test_accumulation (ctx);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,126 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define FB_SIZE 64
+#define N_FRAMES 30
+
+typedef struct
+{
+  CoglFramebuffer *fb;
+  int n_frames;
+  gint64 last_target_time;
+  gint64 total_latency;
+  gint64 total_period;
+} TestState;
+
+static void
+frame_cb (CoglOnscreen *onscreen,
+          gint64 target_time,
+          void *user_data)
+{
+  TestState *state = user_data;
+  gint64 now = g_get_monotonic_time ();
+
+  g_assert (COGL_FRAMEBUFFER (onscreen) == state->fb);
+
+  /* Every frame must aim for a later presentation than the last */
+  if (state->n_frames > 0)
+    {
+      g_assert_cmpint (target_time, >, state->last_target_time);
+      state->total_period += target_time - state->last_target_time;
+    }
+
+  /* This is how long it will take for anything sampled now to get
+   * to the screen */
+  if (target_time > now)
+    state->total_latency += target_time - now;
+
+  state->last_target_time = target_time;
+  state->n_frames++;
+
+  cogl_framebuffer_clear4f (state->fb, COGL_BUFFER_BIT_COLOR,
+                            0, (state->n_frames & 1), 0, 1);
+  cogl_framebuffer_swap_buffers (state->fb);
+
+  if (state->n_frames < N_FRAMES)
+    cogl_onscreen_schedule_frame (onscreen);
+}
+
+static void
+iterate (CoglContext *ctx)
+{
+  CoglPollFD *poll_fds;
+  int n_poll_fds;
+  gint64 timeout;
+
+  cogl_poll_get_info (ctx, &poll_fds, &n_poll_fds, &timeout);
+
+  g_poll ((GPollFD *) poll_fds, n_poll_fds,
+          timeout == -1 ? 100 : (timeout + 999) / 1000);
+
+  cogl_poll_dispatch (ctx, poll_fds, n_poll_fds);
+}
+
+void
+test_cogl_frame_clock (TestUtilsGTestFixture *fixture,
+                       void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglOnscreen *onscreen;
+  TestState state;
+  GError *error = NULL;
+  gint64 end_time;
+  unsigned int id;
+  int n_frames;
+
+  onscreen = cogl_onscreen_new (shared_state->ctx, FB_SIZE, FB_SIZE);
+
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (onscreen), &error))
+    g_critical ("Failed to allocate onscreen framebuffer: %s",
+                error->message);
+
+  cogl_onscreen_show (onscreen);
+
+  state.fb = COGL_FRAMEBUFFER (onscreen);
+  state.n_frames = 0;
+  state.last_target_time = 0;
+  state.total_latency = 0;
+  state.total_period = 0;
+
+  id = cogl_onscreen_add_frame_callback (onscreen, frame_cb, &state);
+
+  /* Nothing should be drawn until a frame is scheduled */
+  iterate (shared_state->ctx);
+  g_assert_cmpint (state.n_frames, ==, 0);
+
+  cogl_onscreen_schedule_frame (onscreen);
+
+  end_time = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+  while (state.n_frames < N_FRAMES && g_get_monotonic_time () < end_time)
+    iterate (shared_state->ctx);
+
+  g_assert_cmpint (state.n_frames, ==, N_FRAMES);
+
+  if (g_test_perf ())
+    {
+      /* Drawing straight after the previous frame was shown would
+       * make the latency a whole frame period */
+      g_print ("average latency: %.2fms, frame period: %.2fms\n",
+               state.total_latency / (double) N_FRAMES / 1000.0,
+               state.total_period / (double) (N_FRAMES - 1) / 1000.0);
+    }
+
+  /* Once the frame callback stops scheduling frames nothing else
+   * should be drawn */
+  n_frames = state.n_frames;
+  iterate (shared_state->ctx);
+  g_assert_cmpint (state.n_frames, ==, n_frames);
+
+  cogl_onscreen_remove_frame_callback (onscreen, id);
+
+  cogl_object_unref (onscreen);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,107 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define SQUARE_SIZE 4
+#define N_ROWS 16
+#define N_COLUMNS 16
+#define N_PERF_FRAMES 100
+
+static void
+get_square_color (int x, int y, guint8 *color)
+{
+  color[0] = x * 0x10;
+  color[1] = y * 0x10;
+  color[2] = (x ^ y) * 0x10;
+  color[3] = 0xff;
+}
+
+/* Draws enough rectangles that the journal should decide to
+ * transform them on the GPU. Each row has its own modelview. The
+ * rows are offset by a fraction of a pixel so that the rectangles
+ * can't be uploaded as compact vertices instead */
+static void
+draw_grid (void)
+{
+  int x, y;
+
+  for (y = 0; y < N_ROWS; y++)
+    {
+      cogl_push_matrix ();
+      cogl_translate (0.25f, y * SQUARE_SIZE + 0.25f, 0);
+
+      for (x = 0; x < N_COLUMNS; x++)
+        {
+          guint8 color[4];
+
+          get_square_color (x, y, color);
+          cogl_set_source_color4ub (color[0], color[1], color[2], color[3]);
+          cogl_rectangle (x * SQUARE_SIZE, 0,
+                          (x + 1) * SQUARE_SIZE, SQUARE_SIZE);
+        }
+
+      cogl_pop_matrix ();
+    }
+}
+
+static void
+check_grid (void)
+{
+  int x, y;
+
+  for (y = 0; y < N_ROWS; y++)
+    for (x = 0; x < N_COLUMNS; x++)
+      {
+        guint8 color[4];
+
+        get_square_color (x, y, color);
+        test_utils_check_pixel_rgb (x * SQUARE_SIZE + SQUARE_SIZE / 2,
+                                    y * SQUARE_SIZE + SQUARE_SIZE / 2,
+                                    color[0], color[1], color[2]);
+      }
+}
+
+static void
+run_benchmark (CoglFramebuffer *fb)
+{
+  GTimer *timer = g_timer_new ();
+  int i;
+
+  for (i = 0; i < N_PERF_FRAMES; i++)
+    {
+      cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+      draw_grid ();
+      cogl_flush ();
+    }
+
+  cogl_framebuffer_finish (fb);
+
+  g_print ("journal flush: %.2fus per frame of %i rectangles\n",
+           g_timer_elapsed (timer, NULL) * 1e6 / N_PERF_FRAMES,
+           N_ROWS * N_COLUMNS);
+
+  g_timer_destroy (timer);
+}
+
+void
+test_cogl_journal_transform (TestUtilsGTestFixture *fixture,
+                             void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  draw_grid ();
+  check_grid ();
+
+  if (g_test_perf ())
+    run_benchmark (fb);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
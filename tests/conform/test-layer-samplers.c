@@ -0,0 +1,187 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* Each texel is drawn as a square this big */
+#define TEXEL_SIZE 10
+
+/* A 2x1 texture with a red texel on the left and a blue texel on the
+   right */
+static const guint8 tex_data[] = { 0xff, 0x00, 0x00, 0xff,
+                                   0x00, 0x00, 0xff, 0xff };
+
+static CoglPipeline *
+create_pipeline (CoglTexture *texture,
+                 CoglPipelineFilter min_filter,
+                 CoglPipelineFilter mag_filter,
+                 CoglPipelineWrapMode wrap_mode)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new ();
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+  cogl_pipeline_set_layer_filters (pipeline, 0, min_filter, mag_filter);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0, wrap_mode);
+
+  return pipeline;
+}
+
+static void
+draw_texels (CoglPipeline *pipeline,
+             int y,
+             float s_2)
+{
+  cogl_set_source (pipeline);
+  cogl_rectangle_with_texture_coords (0, y,
+                                      TEXEL_SIZE * 2 * s_2, y + TEXEL_SIZE,
+                                      0.0f, 0.0f,
+                                      s_2, 1.0f);
+}
+
+static void
+test_shared_texture (CoglContext *ctx,
+                     CoglFramebuffer *fb)
+{
+  CoglTexture *texture;
+  CoglPipeline *nearest, *linear, *repeat, *clamp;
+  guint8 pixel[4];
+
+  texture = COGL_TEXTURE (cogl_texture_2d_new_from_data (ctx,
+                                                         2, 1,
+                                                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                                         COGL_PIXEL_FORMAT_ANY,
+                                                         8,
+                                                         tex_data,
+                                                         NULL));
+
+  nearest = create_pipeline (texture,
+                             COGL_PIPELINE_FILTER_NEAREST,
+                             COGL_PIPELINE_FILTER_NEAREST,
+                             COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+  linear = create_pipeline (texture,
+                            COGL_PIPELINE_FILTER_LINEAR,
+                            COGL_PIPELINE_FILTER_LINEAR,
+                            COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+  repeat = create_pipeline (texture,
+                            COGL_PIPELINE_FILTER_NEAREST,
+                            COGL_PIPELINE_FILTER_NEAREST,
+                            COGL_PIPELINE_WRAP_MODE_REPEAT);
+  clamp = create_pipeline (texture,
+                           COGL_PIPELINE_FILTER_NEAREST,
+                           COGL_PIPELINE_FILTER_NEAREST,
+                           COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+  /* All of the rows are drawn in one batch so the texture is flushed
+     with alternating filters and wrap modes */
+  cogl_push_framebuffer (fb);
+  draw_texels (nearest, 0, 1.0f);
+  draw_texels (linear, TEXEL_SIZE, 1.0f);
+  draw_texels (repeat, TEXEL_SIZE * 2, 2.0f);
+  draw_texels (clamp, TEXEL_SIZE * 3, 2.0f);
+  cogl_pop_framebuffer ();
+
+  /* The nearest row has a hard edge in the middle */
+  test_utils_check_pixel (TEXEL_SIZE - 1, TEXEL_SIZE / 2, 0xff0000ff);
+  test_utils_check_pixel (TEXEL_SIZE, TEXEL_SIZE / 2, 0x0000ffff);
+
+  /* The linear row blends the two texels in the middle */
+  cogl_read_pixels (TEXEL_SIZE, TEXEL_SIZE * 3 / 2, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixel);
+  g_assert_cmpint (pixel[0], >, 0x40);
+  g_assert_cmpint (pixel[0], <, 0xc0);
+  g_assert_cmpint (pixel[2], >, 0x40);
+  g_assert_cmpint (pixel[2], <, 0xc0);
+
+  /* The repeat row starts the texture again in its second half but
+     the clamped row keeps using the edge texel */
+  test_utils_check_pixel (TEXEL_SIZE * 5 / 2, TEXEL_SIZE * 5 / 2,
+                          0xff0000ff);
+  test_utils_check_pixel (TEXEL_SIZE * 5 / 2, TEXEL_SIZE * 7 / 2,
+                          0x0000ffff);
+
+  cogl_object_unref (nearest);
+  cogl_object_unref (linear);
+  cogl_object_unref (repeat);
+  cogl_object_unref (clamp);
+  cogl_object_unref (texture);
+}
+
+static void
+test_rectangle_texture (CoglContext *ctx,
+                        CoglFramebuffer *fb)
+{
+  CoglTexture *texture_2d, *texture_rect;
+  CoglPipeline *mipmap, *rect;
+
+  if (!cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_RECTANGLE))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping rectangle textures\n");
+      return;
+    }
+
+  texture_2d = COGL_TEXTURE (cogl_texture_2d_new_from_data (ctx,
+                                                            2, 1,
+                                                            COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                                            COGL_PIXEL_FORMAT_ANY,
+                                                            8,
+                                                            tex_data,
+                                                            NULL));
+  texture_rect =
+    COGL_TEXTURE (cogl_texture_rectangle_new_with_size (ctx, 2, 1,
+                                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                                        NULL));
+  cogl_texture_set_region (texture_rect,
+                           0, 0, 0, 0, 2, 1, 2, 1,
+                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                           8,
+                           tex_data);
+
+  /* A mipmap filter and repeat wrap mode on the same unit just before
+     the rectangle texture must not leak into its sampling state,
+     otherwise the rectangle texture is incomplete and samples
+     black */
+  mipmap = create_pipeline (texture_2d,
+                            COGL_PIPELINE_FILTER_LINEAR_MIPMAP_NEAREST,
+                            COGL_PIPELINE_FILTER_NEAREST,
+                            COGL_PIPELINE_WRAP_MODE_REPEAT);
+  rect = create_pipeline (texture_rect,
+                          COGL_PIPELINE_FILTER_NEAREST,
+                          COGL_PIPELINE_FILTER_NEAREST,
+                          COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+  cogl_push_framebuffer (fb);
+  draw_texels (mipmap, TEXEL_SIZE * 4, 1.0f);
+  draw_texels (rect, TEXEL_SIZE * 5, 1.0f);
+  cogl_pop_framebuffer ();
+
+  test_utils_check_pixel (TEXEL_SIZE / 2, TEXEL_SIZE * 11 / 2, 0xff0000ff);
+  test_utils_check_pixel (TEXEL_SIZE * 3 / 2, TEXEL_SIZE * 11 / 2,
+                          0x0000ffff);
+
+  cogl_object_unref (mipmap);
+  cogl_object_unref (rect);
+  cogl_object_unref (texture_2d);
+  cogl_object_unref (texture_rect);
+}
+
+void
+test_cogl_layer_samplers (TestUtilsGTestFixture *fixture,
+                          void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+
+  cogl_framebuffer_orthographic (shared_state->fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (shared_state->fb),
+                                 cogl_framebuffer_get_height (shared_state->fb),
+                                 -1,
+                                 100);
+
+  test_shared_texture (shared_state->ctx, shared_state->fb);
+  test_rectangle_texture (shared_state->ctx, shared_state->fb);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,115 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define RECT_SIZE 16
+
+static void
+draw_rect (float x, float y,
+           float width, float height,
+           guint8 red, guint8 green, guint8 blue, guint8 alpha)
+{
+  cogl_set_source_color4ub (red, green, blue, alpha);
+  cogl_rectangle (x, y, x + width, y + height);
+}
+
+static void
+test_hidden_entries (CoglFramebuffer *fb)
+{
+  cogl_push_framebuffer (fb);
+
+  /* A red rectangle that is completely hidden by the green one drawn
+     after it */
+  draw_rect (0, 0, RECT_SIZE, RECT_SIZE, 0xff, 0x00, 0x00, 0xff);
+  /* A blue rectangle that is only partly covered by the green one so
+     it must not be culled */
+  draw_rect (RECT_SIZE, 0, RECT_SIZE * 2, RECT_SIZE,
+             0x00, 0x00, 0xff, 0xff);
+  draw_rect (0, 0, RECT_SIZE * 2, RECT_SIZE, 0x00, 0xff, 0x00, 0xff);
+
+  cogl_pop_framebuffer ();
+
+  test_utils_check_pixel (RECT_SIZE / 2, RECT_SIZE / 2, 0x00ff00ff);
+  test_utils_check_pixel (RECT_SIZE * 3 / 2, RECT_SIZE / 2, 0x00ff00ff);
+  test_utils_check_pixel (RECT_SIZE * 5 / 2, RECT_SIZE / 2, 0x0000ffff);
+}
+
+static void
+test_translucent_occluder (CoglFramebuffer *fb)
+{
+  guint8 pixel[4];
+
+  cogl_push_framebuffer (fb);
+
+  draw_rect (0, RECT_SIZE, RECT_SIZE, RECT_SIZE,
+             0xff, 0x00, 0x00, 0xff);
+  /* A half transparent green rectangle blends with the red one so it
+     must not hide it */
+  draw_rect (0, RECT_SIZE, RECT_SIZE, RECT_SIZE,
+             0x00, 0x80, 0x00, 0x80);
+
+  cogl_pop_framebuffer ();
+
+  cogl_read_pixels (RECT_SIZE / 2, RECT_SIZE * 3 / 2, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixel);
+  g_assert_cmpint (pixel[0], >, 0x40);
+  g_assert_cmpint (pixel[0], <, 0xc0);
+  g_assert_cmpint (pixel[1], >, 0x40);
+  g_assert_cmpint (pixel[1], <, 0xc0);
+}
+
+static void
+test_clipped_occluder (CoglFramebuffer *fb)
+{
+  cogl_push_framebuffer (fb);
+
+  draw_rect (0, RECT_SIZE * 2, RECT_SIZE * 2, RECT_SIZE,
+             0xff, 0x00, 0x00, 0xff);
+
+  /* The green rectangle covers the whole red one but it is clipped to
+     the left half so the right half of the red rectangle must still be
+     drawn */
+  cogl_framebuffer_push_rectangle_clip (fb,
+                                        0, RECT_SIZE * 2,
+                                        RECT_SIZE, RECT_SIZE * 3);
+  draw_rect (0, RECT_SIZE * 2, RECT_SIZE * 2, RECT_SIZE,
+             0x00, 0xff, 0x00, 0xff);
+  cogl_framebuffer_pop_clip (fb);
+
+  cogl_pop_framebuffer ();
+
+  test_utils_check_pixel (RECT_SIZE / 2, RECT_SIZE * 5 / 2, 0x00ff00ff);
+  test_utils_check_pixel (RECT_SIZE * 3 / 2, RECT_SIZE * 5 / 2, 0xff0000ff);
+}
+
+void
+test_cogl_occlusion_culling (TestUtilsGTestFixture *fixture,
+                             void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+
+  cogl_framebuffer_orthographic (fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1,
+                                 100);
+
+  /* Culling has to be asked for explicitly */
+  g_assert (!cogl_framebuffer_get_occlusion_culling_enabled (fb));
+
+  cogl_framebuffer_set_occlusion_culling_enabled (fb, TRUE);
+  g_assert (cogl_framebuffer_get_occlusion_culling_enabled (fb));
+
+  test_hidden_entries (fb);
+  test_translucent_occluder (fb);
+  test_clipped_occluder (fb);
+
+  cogl_framebuffer_set_occlusion_culling_enabled (fb, FALSE);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,170 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define TARGET_SIZE 32
+
+static void
+check_texture (CoglTexture *texture,
+               int x,
+               int y,
+               guint32 expected)
+{
+  guint8 pixels[TARGET_SIZE * TARGET_SIZE * 4];
+
+  cogl_texture_get_data (texture,
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         TARGET_SIZE * 4,
+                         pixels);
+
+  test_utils_compare_pixel (pixels + (y * TARGET_SIZE + x) * 4, expected);
+}
+
+static void
+draw_rectangle (CoglFramebuffer *offscreen,
+                float x_1, float y_1, float x_2, float y_2,
+                guint8 red, guint8 green, guint8 blue)
+{
+  cogl_push_framebuffer (offscreen);
+  cogl_set_source_color4ub (red, green, blue, 0xff);
+  cogl_rectangle (x_1, y_1, x_2, y_2);
+  cogl_pop_framebuffer ();
+}
+
+void
+test_cogl_offscreen_multisample (TestUtilsGTestFixture *fixture,
+                                 void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglTexture2D *texture, *foreign;
+  CoglFramebuffer *offscreen;
+  GLuint gl_handle;
+  guint8 pixel[4];
+
+  if (!cogl_has_feature (ctx, COGL_FEATURE_ID_OFFSCREEN_MULTISAMPLE))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: multisampled offscreens aren't supported\n");
+      return;
+    }
+
+  texture = cogl_texture_2d_new_with_size (ctx,
+                                           TARGET_SIZE, TARGET_SIZE,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                           NULL);
+  offscreen = cogl_offscreen_new_to_texture (COGL_TEXTURE (texture));
+  cogl_framebuffer_set_samples_per_pixel (offscreen, 4);
+
+  if (!cogl_framebuffer_allocate (offscreen, NULL))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: couldn't allocate a multisampled offscreen\n");
+      cogl_object_unref (offscreen);
+      cogl_object_unref (texture);
+      return;
+    }
+
+  g_assert_cmpint (cogl_framebuffer_get_samples_per_pixel (offscreen), >, 0);
+
+  cogl_framebuffer_orthographic (offscreen, 0, 0,
+                                 TARGET_SIZE, TARGET_SIZE,
+                                 -1, 100);
+
+  /* Sampling the texture should implicitly resolve everything drawn
+   * so far */
+  cogl_framebuffer_clear4f (offscreen, COGL_BUFFER_BIT_COLOR, 1, 0, 0, 1);
+  draw_rectangle (offscreen, 0, 0, TARGET_SIZE / 2, TARGET_SIZE, 0, 0xff, 0);
+  check_texture (COGL_TEXTURE (texture), 4, 4, 0x00ff00ff);
+  check_texture (COGL_TEXTURE (texture), TARGET_SIZE - 4, 4, 0xff0000ff);
+
+  /* A clipped update only damages the clipped region but the rest of
+   * the texture must keep its contents */
+  cogl_framebuffer_push_scissor_clip (offscreen,
+                                      TARGET_SIZE / 2, 0,
+                                      TARGET_SIZE / 4, TARGET_SIZE / 4);
+  draw_rectangle (offscreen, 0, 0, TARGET_SIZE, TARGET_SIZE, 0, 0, 0xff);
+  cogl_framebuffer_pop_clip (offscreen);
+  check_texture (COGL_TEXTURE (texture), TARGET_SIZE / 2 + 2, 2, 0x0000ffff);
+  check_texture (COGL_TEXTURE (texture), 4, 4, 0x00ff00ff);
+  check_texture (COGL_TEXTURE (texture),
+                 TARGET_SIZE - 4, TARGET_SIZE - 4,
+                 0xff0000ff);
+
+  /* Reading from the framebuffer has to resolve the samples too */
+  draw_rectangle (offscreen, 0, TARGET_SIZE / 2, TARGET_SIZE, TARGET_SIZE,
+                  0xff, 0xff, 0xff);
+  cogl_push_framebuffer (offscreen);
+  cogl_read_pixels (4, TARGET_SIZE - 4, 1, 1,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixel);
+  cogl_pop_framebuffer ();
+  test_utils_compare_pixel (pixel, 0xffffffff);
+
+  /* Discarding the buffers must not lose anything that hasn't been
+   * resolved yet */
+  draw_rectangle (offscreen, 0, 0, TARGET_SIZE / 4, TARGET_SIZE / 4,
+                  0xff, 0xff, 0);
+  cogl_framebuffer_discard_buffers (offscreen,
+                                    COGL_BUFFER_BIT_COLOR |
+                                    COGL_BUFFER_BIT_DEPTH |
+                                    COGL_BUFFER_BIT_STENCIL);
+  check_texture (COGL_TEXTURE (texture), 2, 2, 0xffff00ff);
+
+  /* Resolving a region must only update that region of the texture.
+   * Reading the texture would resolve the rest of the damage so it is
+   * read back through a foreign texture wrapping the same GL object
+   * which isn't associated with the framebuffer */
+  cogl_framebuffer_clear4f (offscreen, COGL_BUFFER_BIT_COLOR, 1, 0, 0, 1);
+  check_texture (COGL_TEXTURE (texture), 4, 4, 0xff0000ff);
+  draw_rectangle (offscreen, 0, 0, TARGET_SIZE / 4, TARGET_SIZE / 4,
+                  0, 0xff, 0);
+  draw_rectangle (offscreen,
+                  TARGET_SIZE - TARGET_SIZE / 4,
+                  TARGET_SIZE - TARGET_SIZE / 4,
+                  TARGET_SIZE, TARGET_SIZE,
+                  0, 0xff, 0);
+  cogl_framebuffer_resolve_samples_region (offscreen,
+                                           0, 0,
+                                           TARGET_SIZE / 4, TARGET_SIZE / 4);
+  cogl_texture_get_gl_texture (COGL_TEXTURE (texture), &gl_handle, NULL);
+  foreign = cogl_texture_2d_new_from_foreign (ctx, gl_handle,
+                                              TARGET_SIZE, TARGET_SIZE,
+                                              COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                              NULL);
+  if (foreign)
+    {
+      check_texture (COGL_TEXTURE (foreign), 2, 2, 0x00ff00ff);
+      check_texture (COGL_TEXTURE (foreign),
+                     TARGET_SIZE - 2, TARGET_SIZE - 2,
+                     0xff0000ff);
+      cogl_object_unref (foreign);
+    }
+  else if (g_test_verbose ())
+    g_print ("Skipping partial resolve check: "
+             "couldn't create a foreign texture\n");
+
+  /* The rest of the damage must still be resolved when the texture is
+   * used */
+  check_texture (COGL_TEXTURE (texture),
+                 TARGET_SIZE - 2, TARGET_SIZE - 2,
+                 0x00ff00ff);
+
+  /* Destroying the framebuffer must resolve what was drawn since the
+   * texture was last used */
+  cogl_framebuffer_clear4f (offscreen, COGL_BUFFER_BIT_COLOR, 0, 0, 1, 1);
+  draw_rectangle (offscreen, 0, 0, TARGET_SIZE / 2, TARGET_SIZE / 2,
+                  0xff, 0, 0xff);
+  cogl_flush ();
+  cogl_object_unref (offscreen);
+  check_texture (COGL_TEXTURE (texture), 4, 4, 0xff00ffff);
+  check_texture (COGL_TEXTURE (texture),
+                 TARGET_SIZE - 4, TARGET_SIZE - 4,
+                 0x0000ffff);
+
+  cogl_object_unref (texture);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
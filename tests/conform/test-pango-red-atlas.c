@@ -0,0 +1,278 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#ifdef HAVE_COGL_PANGO
+
+#include <cogl-pango/cogl-pango.h>
+
+/* The glyph cache is internal to cogl-pango but its symbols are
+   exported so a cache can be created to check which format it puts
+   glyphs in */
+#include <cogl-pango/cogl-pango-glyph-cache.h>
+
+#define TEXT_X 10
+#define TEXT_Y 10
+
+/* Roughly the number of distinct ideographs an application showing
+   CJK text would end up caching */
+#define N_CJK_GLYPHS 2000
+#define FIRST_CJK_CHAR 0x4e00
+
+static void
+check_glyph_format (CoglContext *ctx, PangoLayout *layout)
+{
+  PangoLayoutLine *line = pango_layout_get_line_readonly (layout, 0);
+  PangoGlyphItem *run = line->runs->data;
+  CoglPangoGlyphCache *cache;
+  CoglPangoGlyphCacheValue *value;
+  CoglPixelFormat expected_format;
+
+  cache = cogl_pango_glyph_cache_new (FALSE);
+  value = cogl_pango_glyph_cache_lookup (cache,
+                                         TRUE, /* create */
+                                         run->item->analysis.font,
+                                         run->glyphs->glyphs[0].glyph);
+  g_assert (value != NULL);
+  g_assert (value->texture != NULL);
+
+  /* Glyphs only go in a red atlas if the red component can be
+     swizzled into the alpha with a snippet */
+  if (cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_RG) &&
+      cogl_has_feature (ctx, COGL_FEATURE_ID_GLSL))
+    expected_format = COGL_PIXEL_FORMAT_R_8;
+  else
+    expected_format = COGL_PIXEL_FORMAT_A_8;
+
+  g_assert_cmpint (cogl_texture_get_format (value->texture),
+                   ==,
+                   expected_format);
+
+  cogl_pango_glyph_cache_free (cache);
+}
+
+static size_t
+get_texture_memory (CoglContext *ctx)
+{
+  return cogl_context_get_memory_usage (ctx,
+                                        COGL_MEMORY_USAGE_TYPE_TEXTURE_2D);
+}
+
+static void
+check_atlas_memory (CoglContext *ctx, PangoContext *pango_context)
+{
+  PangoLayout *layout;
+  PangoFontDescription *font_desc;
+  PangoLayoutLine *line;
+  GString *text;
+  GSList *l;
+  GHashTable *values;
+  GList *value_list, *vl;
+  GList *textures = NULL;
+  CoglPangoGlyphCache *cache;
+  size_t base_usage, red_usage, rgba_usage;
+  guint8 *data;
+  int i;
+
+  /* The memory saving only applies when the glyph cache can use a red
+     atlas */
+  if (!cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_RG) ||
+      !cogl_has_feature (ctx, COGL_FEATURE_ID_GLSL))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping memory comparison: red atlases aren't used\n");
+      return;
+    }
+
+  text = g_string_new (NULL);
+  for (i = 0; i < N_CJK_GLYPHS; i++)
+    g_string_append_unichar (text, FIRST_CJK_CHAR + i);
+
+  layout = pango_layout_new (pango_context);
+  font_desc = pango_font_description_from_string ("Sans 16");
+  pango_layout_set_font_description (layout, font_desc);
+  pango_font_description_free (font_desc);
+  pango_layout_set_text (layout, text->str, text->len);
+  g_string_free (text, TRUE);
+
+  /* Put every glyph through a glyph cache. This uses the local red
+     atlases of the cache */
+  cache = cogl_pango_glyph_cache_new (FALSE);
+  values = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  base_usage = get_texture_memory (ctx);
+
+  line = pango_layout_get_line_readonly (layout, 0);
+  for (l = line->runs; l; l = l->next)
+    {
+      PangoGlyphItem *run = l->data;
+
+      for (i = 0; i < run->glyphs->num_glyphs; i++)
+        {
+          CoglPangoGlyphCacheValue *value =
+            cogl_pango_glyph_cache_lookup (cache,
+                                           TRUE, /* create */
+                                           run->item->analysis.font,
+                                           run->glyphs->glyphs[i].glyph);
+
+          if (value && value->texture)
+            g_hash_table_insert (values, value, value);
+        }
+    }
+
+  red_usage = get_texture_memory (ctx) - base_usage;
+
+  g_assert_cmpint (g_hash_table_size (values), >, 0);
+  g_assert_cmpuint (red_usage, >, 0);
+
+  /* Put the same glyph rectangles in the global atlas. This is what
+     the glyph cache does when it can't use a red atlas except that it
+     creates the textures with RGBA_8888_PRE as the internal format */
+  value_list = g_hash_table_get_keys (values);
+  data = g_malloc0 (256 * 256 * 4);
+
+  base_usage = get_texture_memory (ctx);
+
+  for (vl = value_list; vl; vl = vl->next)
+    {
+      CoglPangoGlyphCacheValue *value = vl->data;
+      CoglHandle texture;
+
+      g_assert_cmpint (value->draw_width, <=, 256);
+      g_assert_cmpint (value->draw_height, <=, 256);
+
+      texture = cogl_texture_new_from_data (value->draw_width,
+                                            value->draw_height,
+                                            COGL_TEXTURE_NONE,
+                                            COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                            COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                            value->draw_width * 4,
+                                            data);
+      g_assert (texture != COGL_INVALID_HANDLE);
+      textures = g_list_prepend (textures, texture);
+    }
+
+  rgba_usage = get_texture_memory (ctx) - base_usage;
+
+  if (g_test_perf ())
+    g_print ("%u glyphs: %lu bytes in red atlases, "
+             "%lu bytes in the RGBA atlas\n",
+             g_hash_table_size (values),
+             (unsigned long) red_usage,
+             (unsigned long) rgba_usage);
+
+  /* A red atlas only needs one byte per texel instead of four. The
+     glyphs get less padding in the local atlases than in the global
+     atlas so they shouldn't need any more texels but allow some slack
+     for the rectangles being packed differently */
+  g_assert_cmpuint (red_usage * 4, <=, rgba_usage + rgba_usage / 4);
+
+  g_list_foreach (textures, (GFunc) cogl_handle_unref, NULL);
+  g_list_free (textures);
+  g_list_free (value_list);
+  g_free (data);
+  g_hash_table_destroy (values);
+  cogl_pango_glyph_cache_free (cache);
+  g_object_unref (layout);
+}
+
+static void
+check_rendered_text (PangoLayout *layout)
+{
+  PangoRectangle ink;
+  guint8 *pixels, *p;
+  int max_green = 0;
+  int i;
+
+  pango_layout_get_pixel_extents (layout, &ink, NULL);
+  g_assert_cmpint (ink.width, >, 0);
+  g_assert_cmpint (ink.height, >, 0);
+
+  pixels = g_malloc (ink.width * ink.height * 4);
+  cogl_read_pixels (TEXT_X + ink.x, TEXT_Y + ink.y,
+                    ink.width, ink.height,
+                    COGL_READ_PIXELS_COLOR_BUFFER,
+                    COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                    pixels);
+
+  /* The text is green on black so if the red component of the glyph
+     leaked through instead of being used as the coverage then the
+     other components would be wrong */
+  for (i = 0, p = pixels; i < ink.width * ink.height; i++, p += 4)
+    {
+      g_assert_cmpint (p[0], ==, 0x00);
+      g_assert_cmpint (p[2], ==, 0x00);
+      max_green = MAX (max_green, p[1]);
+    }
+
+  /* The inside of the strokes should be fully covered... */
+  g_assert_cmpint (max_green, ==, 0xff);
+
+  /* ...but the corners of an 'O' shouldn't be covered at all. If the
+     coverage wasn't taken from the glyph then the whole rectangle of
+     the glyph would be filled */
+  test_utils_compare_pixel (pixels, 0x000000ff);
+  test_utils_compare_pixel (pixels + (ink.width * ink.height - 1) * 4,
+                            0x000000ff);
+
+  g_free (pixels);
+}
+
+void
+test_cogl_pango_red_atlas (TestUtilsGTestFixture *fixture,
+                           void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+  PangoFontMap *font_map;
+  PangoContext *pango_context;
+  PangoFontDescription *font_desc;
+  PangoLayout *layout;
+  CoglColor color;
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  font_map = cogl_pango_font_map_new ();
+  pango_context =
+    cogl_pango_font_map_create_context (COGL_PANGO_FONT_MAP (font_map));
+
+  layout = pango_layout_new (pango_context);
+  font_desc = pango_font_description_from_string ("Sans Bold 48");
+  pango_layout_set_font_description (layout, font_desc);
+  pango_font_description_free (font_desc);
+  pango_layout_set_text (layout, "O", -1);
+
+  check_glyph_format (shared_state->ctx, layout);
+  check_atlas_memory (shared_state->ctx, pango_context);
+
+  cogl_color_init_from_4ub (&color, 0x00, 0xff, 0x00, 0xff);
+
+  cogl_push_framebuffer (fb);
+  cogl_pango_render_layout (layout, TEXT_X, TEXT_Y, &color, 0);
+  cogl_pop_framebuffer ();
+
+  check_rendered_text (layout);
+
+  g_object_unref (layout);
+  g_object_unref (pango_context);
+  g_object_unref (font_map);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+#else /* HAVE_COGL_PANGO */
+
+void
+test_cogl_pango_red_atlas (TestUtilsGTestFixture *fixture,
+                           void *data)
+{
+  if (g_test_verbose ())
+    g_print ("Skipping: cogl-pango isn't being built\n");
+}
+
+#endif /* HAVE_COGL_PANGO */
@@ -0,0 +1,163 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define SQUARE_SIZE 8
+#define MAX_LAYERS 8
+/* Only the first few layers are drawn when checking the results
+ * because fixed function GL may have very few texture units */
+#define MAX_CHECKED_LAYERS 4
+#define N_PERF_PIPELINES 1000
+
+static void
+add_layers (CoglPipeline *pipeline,
+            int first,
+            int n_layers,
+            const CoglColor *constant)
+{
+  int i;
+
+  for (i = first; i < first + n_layers; i++)
+    {
+      cogl_pipeline_set_layer_combine (pipeline, i,
+                                       "RGB = ADD (PREVIOUS, CONSTANT) "
+                                       "A = REPLACE (PREVIOUS)",
+                                       NULL);
+      cogl_pipeline_set_layer_combine_constant (pipeline, i, constant);
+    }
+}
+
+static void
+draw_square (CoglPipeline *pipeline, int x, int y)
+{
+  cogl_push_source (pipeline);
+  cogl_rectangle (x * SQUARE_SIZE, y * SQUARE_SIZE,
+                  (x + 1) * SQUARE_SIZE, (y + 1) * SQUARE_SIZE);
+  cogl_pop_source ();
+}
+
+static void
+check_square (int x, int y, int r, int g, int b)
+{
+  test_utils_check_pixel_rgb (x * SQUARE_SIZE + SQUARE_SIZE / 2,
+                              y * SQUARE_SIZE + SQUARE_SIZE / 2,
+                              r, g, b);
+}
+
+static void
+test_siblings (void)
+{
+  CoglColor red, green, blue;
+  int n_layers;
+
+  cogl_color_init_from_4ub (&red, 0x10, 0, 0, 0xff);
+  cogl_color_init_from_4ub (&green, 0, 0x10, 0, 0xff);
+  cogl_color_init_from_4ub (&blue, 0, 0, 0x10, 0xff);
+
+  for (n_layers = 1; n_layers <= MAX_CHECKED_LAYERS; n_layers++)
+    {
+      CoglPipeline *parent = cogl_pipeline_new ();
+      CoglPipeline *replaced, *added;
+
+      cogl_pipeline_set_color4ub (parent, 0, 0, 0, 0xff);
+      add_layers (parent, 0, n_layers, &red);
+
+      /* Two siblings derived from the same parent which share its
+       * layers but each change them differently */
+      replaced = cogl_pipeline_copy (parent);
+      add_layers (replaced, n_layers - 1, 1, &green);
+
+      added = cogl_pipeline_copy (parent);
+      if (n_layers < MAX_CHECKED_LAYERS)
+        add_layers (added, n_layers, 1, &blue);
+
+      g_assert_cmpint (cogl_pipeline_get_n_layers (parent), ==, n_layers);
+      g_assert_cmpint (cogl_pipeline_get_n_layers (replaced), ==, n_layers);
+
+      draw_square (added, 2, n_layers);
+      draw_square (replaced, 1, n_layers);
+      draw_square (parent, 0, n_layers);
+
+      check_square (0, n_layers, n_layers * 0x10, 0, 0);
+      check_square (1, n_layers, (n_layers - 1) * 0x10, 0x10, 0);
+      if (n_layers < MAX_CHECKED_LAYERS)
+        check_square (2, n_layers, n_layers * 0x10, 0, 0x10);
+
+      cogl_object_unref (added);
+      cogl_object_unref (replaced);
+      cogl_object_unref (parent);
+    }
+}
+
+static void
+run_benchmark (void)
+{
+  CoglPipeline **pipelines = g_new (CoglPipeline *, N_PERF_PIPELINES);
+  GTimer *timer = g_timer_new ();
+  CoglColor constant;
+  int n_layers;
+  int i;
+
+  for (n_layers = 1; n_layers <= MAX_LAYERS; n_layers++)
+    {
+      CoglPipeline *parent = cogl_pipeline_new ();
+      double create_time, flush_time;
+
+      cogl_color_init_from_4ub (&constant, 0x10, 0, 0, 0xff);
+      add_layers (parent, 0, n_layers, &constant);
+
+      g_timer_start (timer);
+
+      for (i = 0; i < N_PERF_PIPELINES; i++)
+        {
+          pipelines[i] = cogl_pipeline_copy (parent);
+          cogl_color_init_from_4ub (&constant, i & 0xff, 0, 0, 0xff);
+          cogl_pipeline_set_layer_combine_constant (pipelines[i],
+                                                    i % n_layers,
+                                                    &constant);
+        }
+
+      create_time = g_timer_elapsed (timer, NULL);
+
+      g_timer_start (timer);
+
+      for (i = 0; i < N_PERF_PIPELINES; i++)
+        draw_square (pipelines[i], 0, 0);
+      cogl_flush ();
+
+      flush_time = g_timer_elapsed (timer, NULL);
+
+      g_print ("layers: %i, create: %.2fus, flush: %.2fus per pipeline\n",
+               n_layers,
+               create_time * 1e6 / N_PERF_PIPELINES,
+               flush_time * 1e6 / N_PERF_PIPELINES);
+
+      for (i = 0; i < N_PERF_PIPELINES; i++)
+        cogl_object_unref (pipelines[i]);
+      cogl_object_unref (parent);
+    }
+
+  g_timer_destroy (timer);
+  g_free (pipelines);
+}
+
+void
+test_cogl_pipeline_layers (TestUtilsGTestFixture *fixture,
+                           void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  test_siblings ();
+
+  if (g_test_perf ())
+    run_benchmark ();
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
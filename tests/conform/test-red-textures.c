@@ -0,0 +1,114 @@
+#include <cogl/cogl.h>
+#include <string.h>
+
+#include "test-utils.h"
+
+#define TEXTURE_SIZE 16
+
+static CoglTexture *
+create_texture (CoglContext *ctx,
+                CoglPixelFormat format,
+                int bpp,
+                const guint8 *pixel)
+{
+  guint8 data[TEXTURE_SIZE * TEXTURE_SIZE * 2];
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++)
+    memcpy (data + i * bpp, pixel, bpp);
+
+  return COGL_TEXTURE (cogl_texture_2d_new_from_data (ctx,
+                                                      TEXTURE_SIZE,
+                                                      TEXTURE_SIZE,
+                                                      format,
+                                                      format,
+                                                      TEXTURE_SIZE * bpp,
+                                                      data,
+                                                      NULL));
+}
+
+static void
+draw_texture (CoglPipeline *pipeline, CoglTexture *texture, int x)
+{
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+  cogl_set_source (pipeline);
+  cogl_rectangle (x, 0, x + TEXTURE_SIZE, TEXTURE_SIZE);
+}
+
+void
+test_cogl_red_textures (TestUtilsGTestFixture *fixture,
+                        void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglFramebuffer *fb = shared_state->fb;
+  static const guint8 red_pixel[] = { 0x80 };
+  static const guint8 rg_pixel[] = { 0x40, 0xc0 };
+  CoglTexture *red_texture, *rg_texture;
+  CoglPipeline *pipeline;
+
+  if (!cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_RG))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: red-green textures aren't supported\n");
+      return;
+    }
+
+  red_texture = create_texture (ctx, COGL_PIXEL_FORMAT_R_8, 1, red_pixel);
+  rg_texture = create_texture (ctx, COGL_PIXEL_FORMAT_RG_88, 2, rg_pixel);
+  g_assert (red_texture != NULL);
+  g_assert (rg_texture != NULL);
+  g_assert_cmpint (cogl_texture_get_format (red_texture),
+                   ==,
+                   COGL_PIXEL_FORMAT_R_8);
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  cogl_push_framebuffer (fb);
+
+  /* The missing components should read as 0 and the alpha as 1 */
+  pipeline = cogl_pipeline_new ();
+  draw_texture (pipeline, red_texture, 0);
+  draw_texture (pipeline, rg_texture, TEXTURE_SIZE);
+  cogl_object_unref (pipeline);
+
+  /* Glyph masks swizzle the red component into the alpha */
+  if (cogl_has_feature (ctx, COGL_FEATURE_ID_GLSL))
+    {
+      CoglSnippet *snippet =
+        cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                          NULL,
+                          "cogl_texel = "
+                          "vec4 (0.0, 0.0, 0.0, cogl_texel.r);\n");
+
+      pipeline = cogl_pipeline_new ();
+      cogl_pipeline_set_color4ub (pipeline, 0x00, 0xff, 0x00, 0xff);
+      cogl_pipeline_set_layer_combine (pipeline, 0,
+                                       "RGBA = MODULATE (PREVIOUS, "
+                                       "TEXTURE[A])",
+                                       NULL);
+      cogl_pipeline_add_layer_snippet (pipeline, 0, snippet);
+      cogl_object_unref (snippet);
+      draw_texture (pipeline, red_texture, TEXTURE_SIZE * 2);
+      cogl_object_unref (pipeline);
+    }
+
+  cogl_pop_framebuffer ();
+
+  test_utils_check_pixel (TEXTURE_SIZE / 2, TEXTURE_SIZE / 2,
+                          0x800000ff);
+  test_utils_check_pixel (TEXTURE_SIZE * 3 / 2, TEXTURE_SIZE / 2,
+                          0x40c000ff);
+  if (cogl_has_feature (ctx, COGL_FEATURE_ID_GLSL))
+    test_utils_check_pixel_rgb (TEXTURE_SIZE * 5 / 2, TEXTURE_SIZE / 2,
+                                0x00, 0x80, 0x00);
+
+  cogl_object_unref (rg_texture);
+  cogl_object_unref (red_texture);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
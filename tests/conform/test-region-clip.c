@@ -0,0 +1,81 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* An L shape made of overlapping rectangles. Each rectangle is x, y,
+ * width and height */
+static const int l_shape[] =
+  {
+    0, 0, 32, 16,
+    0, 16, 16, 16,
+    8, 8, 16, 16
+  };
+
+static void
+draw_red (CoglFramebuffer *fb)
+{
+  cogl_push_framebuffer (fb);
+  cogl_set_source_color4ub (0xff, 0, 0, 0xff);
+  cogl_rectangle (0, 0, 64, 64);
+  cogl_pop_framebuffer ();
+}
+
+void
+test_cogl_region_clip (TestUtilsGTestFixture *fixture,
+                       void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+  const int square[] = { 24, 0, 8, 64 };
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  cogl_framebuffer_push_region_clip (fb, l_shape,
+                                     G_N_ELEMENTS (l_shape) / 4);
+  draw_red (fb);
+
+  /* Clearing within the region should only affect the region */
+  cogl_framebuffer_push_scissor_clip (fb, 0, 24, 64, 8);
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 1, 1);
+  cogl_framebuffer_pop_clip (fb);
+
+  cogl_framebuffer_pop_clip (fb);
+
+  test_utils_check_pixel (4, 4, 0xff0000ff);
+  test_utils_check_pixel (28, 4, 0xff0000ff);
+  test_utils_check_pixel (20, 20, 0xff0000ff);
+  test_utils_check_pixel (4, 28, 0x0000ffff);
+  /* Inside the bounds of the region but outside of it */
+  test_utils_check_pixel (28, 28, 0x000000ff);
+  test_utils_check_pixel (28, 20, 0x000000ff);
+  /* Outside of the bounds */
+  test_utils_check_pixel (40, 4, 0x000000ff);
+
+  /* Intersecting two regions */
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+  cogl_framebuffer_push_region_clip (fb, l_shape,
+                                     G_N_ELEMENTS (l_shape) / 4);
+  cogl_framebuffer_push_region_clip (fb, square, 1);
+  draw_red (fb);
+  cogl_framebuffer_pop_clip (fb);
+  cogl_framebuffer_pop_clip (fb);
+
+  test_utils_check_pixel (28, 4, 0xff0000ff);
+  test_utils_check_pixel (20, 4, 0x000000ff);
+  test_utils_check_pixel (28, 20, 0x000000ff);
+
+  /* An empty region clips everything */
+  cogl_framebuffer_push_region_clip (fb, NULL, 0);
+  draw_red (fb);
+  cogl_framebuffer_pop_clip (fb);
+
+  test_utils_check_pixel (4, 4, 0x000000ff);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -419,6 +419,27 @@ paint (TestState *state)
   cogl_pop_source ();
   cogl_object_unref (pipeline);
 
+  /* Separately created snippets with the same source should be able
+     to share a program while a snippet with a different source must
+     not */
+  for (i = 0; i < 3; i++)
+    {
+      pipeline = cogl_pipeline_new ();
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                  NULL,
+                                  i < 2 ?
+                                  "cogl_color_out = vec4 (1, 0, 1, 1);" :
+                                  "cogl_color_out = vec4 (0, 1, 1, 1);");
+      cogl_pipeline_add_snippet (pipeline, snippet);
+      cogl_object_unref (snippet);
+
+      cogl_push_source (pipeline);
+      cogl_rectangle (170 + i * 10, 0, 180 + i * 10, 10);
+      cogl_pop_source ();
+      cogl_object_unref (pipeline);
+    }
+
   /* Sanity check modifying the snippet */
   snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT, "foo", "bar");
   g_assert_cmpstr (cogl_snippet_get_declarations (snippet), ==, "foo");
@@ -475,6 +496,9 @@ validate_result (void)
   test_utils_check_pixel (145, 5, 0x00ff00ff);
   test_utils_check_pixel (155, 5, 0xff00ffff);
   test_utils_check_pixel (165, 5, 0x80ff00ff);
+  test_utils_check_pixel (175, 5, 0xff00ffff);
+  test_utils_check_pixel (185, 5, 0xff00ffff);
+  test_utils_check_pixel (195, 5, 0x00ffffff);
 }
 
 void
@@ -0,0 +1,133 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define IMAGE_SIZE 64
+#define TILE_SIZE 16
+
+static const guint32 quadrant_colors[] =
+  {
+    0xff0000ff, 0x00ff00ff,
+    0x0000ffff, 0xffff00ff
+  };
+
+static guint8 *
+create_image (void)
+{
+  guint8 *data = g_malloc (IMAGE_SIZE * IMAGE_SIZE * 4);
+  int x, y;
+
+  for (y = 0; y < IMAGE_SIZE; y++)
+    for (x = 0; x < IMAGE_SIZE; x++)
+      {
+        int quadrant = (y >= IMAGE_SIZE / 2) * 2 + (x >= IMAGE_SIZE / 2);
+        guint32 color = quadrant_colors[quadrant];
+        guint8 *p = data + (y * IMAGE_SIZE + x) * 4;
+
+        p[0] = color >> 24;
+        p[1] = color >> 16;
+        p[2] = color >> 8;
+        p[3] = color;
+      }
+
+  return data;
+}
+
+static void
+paint (CoglFramebuffer *fb,
+       CoglSparseTexture *texture,
+       float x_1, float y_1, float x_2, float y_2,
+       float tx_1, float ty_1, float tx_2, float ty_2)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new ();
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, COGL_TEXTURE (texture));
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+
+  cogl_push_framebuffer (fb);
+  cogl_set_source (pipeline);
+  cogl_rectangle_with_texture_coords (x_1, y_1, x_2, y_2,
+                                      tx_1, ty_1, tx_2, ty_2);
+  cogl_pop_framebuffer ();
+
+  cogl_object_unref (pipeline);
+}
+
+void
+test_cogl_sparse_texture (TestUtilsGTestFixture *fixture,
+                          void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglFramebuffer *fb = shared_state->fb;
+  CoglSparseTexture *texture;
+  unsigned int n_hits, n_misses;
+  guint8 *image;
+  int i;
+
+  image = create_image ();
+
+  /* The cache can only hold a quarter of the image */
+  texture = cogl_sparse_texture_new_from_data (ctx,
+                                               IMAGE_SIZE, IMAGE_SIZE,
+                                               COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                               0, /* rowstride */
+                                               image,
+                                               TILE_SIZE,
+                                               4, /* n_cache_tiles */
+                                               NULL);
+  g_assert (texture != NULL);
+  g_assert (cogl_is_sparse_texture (texture));
+  g_assert_cmpint (cogl_texture_get_width (COGL_TEXTURE (texture)),
+                   ==, IMAGE_SIZE);
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  /* Draw the whole image even though it doesn't fit in the cache */
+  paint (fb, texture, 0, 0, IMAGE_SIZE, IMAGE_SIZE, 0, 0, 1, 1);
+
+  for (i = 0; i < 4; i++)
+    test_utils_check_pixel ((i % 2) * IMAGE_SIZE / 2 + IMAGE_SIZE / 4,
+                            (i / 2) * IMAGE_SIZE / 2 + IMAGE_SIZE / 4,
+                            quadrant_colors[i]);
+
+  cogl_sparse_texture_get_tile_stats (texture, &n_hits, &n_misses);
+  g_assert_cmpint (n_misses, >=, (IMAGE_SIZE / TILE_SIZE) *
+                   (IMAGE_SIZE / TILE_SIZE));
+
+  /* Drawing the same single tile twice should only load it once */
+  cogl_sparse_texture_reset_tile_stats (texture);
+  for (i = 0; i < 2; i++)
+    paint (fb, texture,
+           0, 0, TILE_SIZE, TILE_SIZE,
+           0, 0,
+           TILE_SIZE / (float) IMAGE_SIZE,
+           TILE_SIZE / (float) IMAGE_SIZE);
+  test_utils_check_pixel (TILE_SIZE / 2, TILE_SIZE / 2, quadrant_colors[0]);
+
+  cogl_sparse_texture_get_tile_stats (texture, &n_hits, &n_misses);
+  g_assert_cmpint (n_misses, <=, 1);
+  g_assert_cmpint (n_hits, >=, 1);
+
+  /* Repeating only loads the tiles that are visible */
+  cogl_sparse_texture_reset_tile_stats (texture);
+  paint (fb, texture,
+         0, 0, TILE_SIZE * 2, TILE_SIZE,
+         0, 0,
+         TILE_SIZE * 2 / (float) IMAGE_SIZE + 1.0f,
+         TILE_SIZE / (float) IMAGE_SIZE);
+  cogl_sparse_texture_get_tile_stats (texture, &n_hits, &n_misses);
+  g_assert_cmpint (n_hits + n_misses, <, (IMAGE_SIZE / TILE_SIZE) *
+                   (IMAGE_SIZE / TILE_SIZE));
+
+  cogl_object_unref (texture);
+  g_free (image);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,234 @@
+#include <cogl/cogl.h>
+#include <string.h>
+
+#include "test-utils.h"
+
+#define TEXTURE_SIZE 64
+#define BLOCK_SIZE 4
+#define N_PERF_FRAMES 100
+
+static void
+fill_block (guint8 *data, guint32 color)
+{
+  int i;
+
+  for (i = 0; i < BLOCK_SIZE * BLOCK_SIZE; i++)
+    {
+      data[i * 4 + 0] = color >> 24;
+      data[i * 4 + 1] = color >> 16;
+      data[i * 4 + 2] = color >> 8;
+      data[i * 4 + 3] = color;
+    }
+}
+
+static CoglTexture2D *
+create_texture (CoglContext *ctx, guint32 color)
+{
+  guint8 *data = g_malloc (TEXTURE_SIZE * TEXTURE_SIZE * 4);
+  CoglTexture2D *texture;
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++)
+    {
+      data[i * 4 + 0] = color >> 24;
+      data[i * 4 + 1] = color >> 16;
+      data[i * 4 + 2] = color >> 8;
+      data[i * 4 + 3] = color;
+    }
+
+  texture = cogl_texture_2d_new_from_data (ctx,
+                                           TEXTURE_SIZE, TEXTURE_SIZE,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                           TEXTURE_SIZE * 4,
+                                           data,
+                                           NULL);
+
+  g_free (data);
+
+  return texture;
+}
+
+static void
+write_block (CoglTexture2D *texture, int x, int y, guint32 color)
+{
+  guint8 data[BLOCK_SIZE * BLOCK_SIZE * 4];
+
+  fill_block (data, color);
+
+  cogl_texture_set_region (COGL_TEXTURE (texture),
+                           0, 0, /* src_x/y */
+                           x, y, /* dst_x/y */
+                           BLOCK_SIZE, BLOCK_SIZE,
+                           BLOCK_SIZE, BLOCK_SIZE,
+                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                           BLOCK_SIZE * 4,
+                           data);
+}
+
+/* Writes a diagonal line of blocks so that most pairs of blocks can't
+ * be merged without including texels that weren't written */
+static void
+write_diagonal (CoglTexture2D *texture, guint32 color)
+{
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE / BLOCK_SIZE; i += 2)
+    write_block (texture, i * BLOCK_SIZE, i * BLOCK_SIZE, color);
+}
+
+static void
+draw_texture (CoglFramebuffer *fb, CoglTexture2D *texture)
+{
+  CoglPipeline *pipeline = cogl_pipeline_new ();
+
+  cogl_pipeline_set_layer_texture (pipeline, 0, COGL_TEXTURE (texture));
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_NEAREST,
+                                   COGL_PIPELINE_FILTER_NEAREST);
+  cogl_push_framebuffer (fb);
+  cogl_set_source (pipeline);
+  cogl_rectangle (0, 0, TEXTURE_SIZE, TEXTURE_SIZE);
+  cogl_pop_framebuffer ();
+  cogl_object_unref (pipeline);
+}
+
+static void
+check_diagonal (guint32 background, guint32 color)
+{
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE / BLOCK_SIZE; i++)
+    {
+      /* The written blocks must have landed */
+      test_utils_check_pixel (i * BLOCK_SIZE + BLOCK_SIZE / 2,
+                              i * BLOCK_SIZE + BLOCK_SIZE / 2,
+                              (i & 1) ? background : color);
+      /* ...and the texels in between must not have been touched */
+      test_utils_check_pixel (i * BLOCK_SIZE + BLOCK_SIZE / 2,
+                              TEXTURE_SIZE - 1 - i * BLOCK_SIZE,
+                              background);
+    }
+}
+
+static void
+run_benchmark (CoglContext *ctx, CoglFramebuffer *fb)
+{
+  GTimer *timer = g_timer_new ();
+  double times[2];
+  int batch;
+
+  for (batch = 0; batch < 2; batch++)
+    {
+      CoglTexture2D *texture = create_texture (ctx, 0x000000ff);
+      int frame, x, y;
+
+      cogl_texture_2d_set_batch_uploads (texture, batch);
+
+      g_timer_start (timer);
+
+      for (frame = 0; frame < N_PERF_FRAMES; frame++)
+        {
+          for (y = 0; y < TEXTURE_SIZE; y += BLOCK_SIZE)
+            for (x = 0; x < TEXTURE_SIZE; x += BLOCK_SIZE)
+              write_block (texture, x, y,
+                           (frame & 1) ? 0xff0000ff : 0x0000ffff);
+
+          draw_texture (fb, texture);
+          cogl_framebuffer_finish (fb);
+        }
+
+      times[batch] = g_timer_elapsed (timer, NULL);
+
+      cogl_object_unref (texture);
+    }
+
+  g_print ("%i set_region calls per frame: "
+           "direct %.2fus, batched %.2fus per frame\n",
+           (TEXTURE_SIZE / BLOCK_SIZE) * (TEXTURE_SIZE / BLOCK_SIZE),
+           times[0] * 1e6 / N_PERF_FRAMES,
+           times[1] * 1e6 / N_PERF_FRAMES);
+
+  g_timer_destroy (timer);
+}
+
+void
+test_cogl_texture_batch_uploads (TestUtilsGTestFixture *fixture,
+                                 void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglFramebuffer *fb = shared_state->fb;
+  guint8 pixels[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  CoglTexture2D *texture;
+  guint8 block[BLOCK_SIZE * BLOCK_SIZE * 4];
+
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  /* The shadow copy doesn't know the contents from when the texture
+   * was created so only the written texels may be uploaded */
+  texture = create_texture (ctx, 0xff0000ff);
+  cogl_texture_2d_set_batch_uploads (texture, TRUE);
+  write_diagonal (texture, 0x00ff00ff);
+  draw_texture (fb, texture);
+  check_diagonal (0xff0000ff, 0x00ff00ff);
+
+  /* Reading the texture back should see the pending writes */
+  write_block (texture, 0, TEXTURE_SIZE - BLOCK_SIZE, 0x0000ffff);
+  cogl_texture_get_data (COGL_TEXTURE (texture),
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         TEXTURE_SIZE * 4,
+                         pixels);
+  test_utils_compare_pixel (pixels + (TEXTURE_SIZE - 1) * TEXTURE_SIZE * 4,
+                            0x0000ffff);
+  test_utils_compare_pixel (pixels + (TEXTURE_SIZE - BLOCK_SIZE - 1) *
+                            TEXTURE_SIZE * 4,
+                            0xff0000ff);
+
+  cogl_object_unref (texture);
+
+  /* Once the whole texture has been written, the shadow copy is
+   * complete and blocks can be merged across the gaps */
+  texture = cogl_texture_2d_new_with_size (ctx, TEXTURE_SIZE, TEXTURE_SIZE,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                           NULL);
+  cogl_texture_2d_set_batch_uploads (texture, TRUE);
+  memset (pixels, 0xff, sizeof (pixels));
+  cogl_texture_set_region (COGL_TEXTURE (texture),
+                           0, 0, 0, 0,
+                           TEXTURE_SIZE, TEXTURE_SIZE,
+                           TEXTURE_SIZE, TEXTURE_SIZE,
+                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                           TEXTURE_SIZE * 4,
+                           pixels);
+  write_diagonal (texture, 0x00ff00ff);
+  draw_texture (fb, texture);
+  check_diagonal (0xffffffff, 0x00ff00ff);
+
+  /* Writes to unpremultiplied data are converted on the way in */
+  fill_block (block, 0xff000080);
+  cogl_texture_set_region (COGL_TEXTURE (texture),
+                           0, 0, 0, 0,
+                           BLOCK_SIZE, BLOCK_SIZE,
+                           BLOCK_SIZE, BLOCK_SIZE,
+                           COGL_PIXEL_FORMAT_RGBA_8888,
+                           BLOCK_SIZE * 4,
+                           block);
+  cogl_texture_2d_set_batch_uploads (texture, FALSE);
+  cogl_texture_get_data (COGL_TEXTURE (texture),
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         TEXTURE_SIZE * 4,
+                         pixels);
+  test_utils_compare_pixel (pixels, 0x80000080);
+
+  cogl_object_unref (texture);
+
+  if (g_test_perf ())
+    run_benchmark (ctx, fb);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
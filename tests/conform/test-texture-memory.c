@@ -0,0 +1,128 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define TEXTURE_SIZE 16
+
+static int n_regenerations = 0;
+
+static void
+regenerate_cb (CoglTexture2D *texture,
+               void *user_data)
+{
+  guint8 data[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  int i;
+
+  /* Fill the texture with green which is different from what it was
+   * created with so that we can tell it was regenerated */
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++)
+    {
+      data[i * 4 + 0] = 0x00;
+      data[i * 4 + 1] = 0xff;
+      data[i * 4 + 2] = 0x00;
+      data[i * 4 + 3] = 0xff;
+    }
+
+  cogl_texture_set_region (COGL_TEXTURE (texture),
+                           0, 0, /* src_x/y */
+                           0, 0, /* dst_x/y */
+                           TEXTURE_SIZE, TEXTURE_SIZE,
+                           TEXTURE_SIZE, TEXTURE_SIZE,
+                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                           TEXTURE_SIZE * 4,
+                           data);
+
+  n_regenerations++;
+}
+
+static CoglTexture2D *
+create_red_texture (CoglContext *ctx)
+{
+  guint8 data[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++)
+    {
+      data[i * 4 + 0] = 0xff;
+      data[i * 4 + 1] = 0x00;
+      data[i * 4 + 2] = 0x00;
+      data[i * 4 + 3] = 0xff;
+    }
+
+  return cogl_texture_2d_new_from_data (ctx,
+                                        TEXTURE_SIZE, TEXTURE_SIZE,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                        TEXTURE_SIZE * 4,
+                                        data,
+                                        NULL);
+}
+
+void
+test_cogl_texture_memory (TestUtilsGTestFixture *fixture,
+                          void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglFramebuffer *fb = shared_state->fb;
+  size_t texture_size = TEXTURE_SIZE * TEXTURE_SIZE * 4;
+  size_t base_usage;
+  CoglTexture2D *texture;
+  CoglPipeline *pipeline;
+
+  base_usage = cogl_context_get_memory_usage (ctx,
+                                              COGL_MEMORY_USAGE_TYPE_TEXTURE_2D);
+
+  texture = create_red_texture (ctx);
+  g_assert_cmpint (cogl_context_get_memory_usage
+                   (ctx, COGL_MEMORY_USAGE_TYPE_TEXTURE_2D),
+                   ==,
+                   base_usage + texture_size);
+
+  cogl_texture_2d_set_regenerate_callback (texture,
+                                           regenerate_cb,
+                                           NULL, /* user_data */
+                                           NULL /* destroy */);
+
+  /* Going over the budget should evict the texture because it hasn't
+   * been used yet */
+  cogl_context_set_texture_memory_budget (ctx, 1);
+  g_assert_cmpint (cogl_context_get_memory_usage
+                   (ctx, COGL_MEMORY_USAGE_TYPE_TEXTURE_2D),
+                   ==,
+                   base_usage);
+  g_assert_cmpint (n_regenerations, ==, 0);
+
+  /* Painting with the texture should bring it back */
+  cogl_framebuffer_orthographic (fb, 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1, 100);
+
+  pipeline = cogl_pipeline_new ();
+  cogl_pipeline_set_layer_texture (pipeline, 0, COGL_TEXTURE (texture));
+  cogl_push_framebuffer (fb);
+  cogl_set_source (pipeline);
+  cogl_rectangle (0, 0, TEXTURE_SIZE, TEXTURE_SIZE);
+  cogl_pop_framebuffer ();
+  cogl_object_unref (pipeline);
+
+  test_utils_check_pixel (TEXTURE_SIZE / 2, TEXTURE_SIZE / 2, 0x00ff00ff);
+  g_assert_cmpint (n_regenerations, ==, 1);
+  g_assert_cmpint (cogl_context_get_memory_usage
+                   (ctx, COGL_MEMORY_USAGE_TYPE_TEXTURE_2D),
+                   ==,
+                   base_usage + texture_size);
+
+  cogl_context_set_texture_memory_budget (ctx, 0);
+
+  cogl_object_unref (texture);
+
+  g_assert_cmpint (cogl_context_get_memory_usage
+                   (ctx, COGL_MEMORY_USAGE_TYPE_TEXTURE_2D),
+                   ==,
+                   base_usage);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,140 @@
+#include <cogl/cogl.h>
+#include <string.h>
+
+#include "test-utils.h"
+
+#define TEXTURE_SIZE 2048
+#define SUB_X 100
+#define SUB_Y 300
+#define SUB_SIZE 512
+#define N_PERF_READS 10
+
+static guint8 *
+create_data (void)
+{
+  guint8 *data = g_malloc (TEXTURE_SIZE * TEXTURE_SIZE * 4);
+  guint8 *p = data;
+  int x, y;
+
+  for (y = 0; y < TEXTURE_SIZE; y++)
+    for (x = 0; x < TEXTURE_SIZE; x++)
+      {
+        *(p++) = x;
+        *(p++) = y;
+        *(p++) = x ^ y;
+        *(p++) = 0xff;
+      }
+
+  return data;
+}
+
+static void
+check_region (const guint8 *read_data,
+              int rowstride,
+              int x_offset,
+              int y_offset,
+              int width,
+              int height)
+{
+  int x, y;
+
+  for (y = 0; y < height; y += 7)
+    for (x = 0; x < width; x += 5)
+      {
+        const guint8 *p = read_data + y * rowstride + x * 4;
+        int tex_x = x + x_offset;
+        int tex_y = y + y_offset;
+
+        g_assert_cmpint (p[0], ==, tex_x & 0xff);
+        g_assert_cmpint (p[1], ==, tex_y & 0xff);
+        g_assert_cmpint (p[2], ==, (tex_x ^ tex_y) & 0xff);
+        g_assert_cmpint (p[3], ==, 0xff);
+      }
+}
+
+static double
+time_reads (CoglTexture *texture, guint8 *read_data)
+{
+  GTimer *timer = g_timer_new ();
+  double elapsed;
+  int i;
+
+  for (i = 0; i < N_PERF_READS; i++)
+    cogl_texture_get_data (texture,
+                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                           0, /* rowstride */
+                           read_data);
+
+  elapsed = g_timer_elapsed (timer, NULL) * 1000.0 / N_PERF_READS;
+
+  g_timer_destroy (timer);
+
+  return elapsed;
+}
+
+void
+test_cogl_texture_readback (TestUtilsGTestFixture *fixture,
+                            void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglTexture2D *texture;
+  CoglTexture *sub_texture;
+  guint8 *tex_data, *read_data;
+
+  tex_data = create_data ();
+  texture = cogl_texture_2d_new_from_data (ctx,
+                                           TEXTURE_SIZE, TEXTURE_SIZE,
+                                           COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                           COGL_PIXEL_FORMAT_ANY,
+                                           TEXTURE_SIZE * 4,
+                                           tex_data,
+                                           NULL);
+  g_free (tex_data);
+
+  if (texture == NULL)
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: the texture is too big\n");
+      return;
+    }
+
+  read_data = g_malloc (TEXTURE_SIZE * TEXTURE_SIZE * 4);
+
+  cogl_texture_get_data (COGL_TEXTURE (texture),
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         TEXTURE_SIZE * 4,
+                         read_data);
+  check_region (read_data, TEXTURE_SIZE * 4,
+                0, 0, TEXTURE_SIZE, TEXTURE_SIZE);
+
+  /* Reading a sub-region of a texture can't use glGetTexImage so it
+   * goes through the fbo path even on big GL */
+  sub_texture = COGL_TEXTURE (cogl_sub_texture_new (ctx,
+                                                    COGL_TEXTURE (texture),
+                                                    SUB_X, SUB_Y,
+                                                    SUB_SIZE, SUB_SIZE));
+  memset (read_data, 0, SUB_SIZE * SUB_SIZE * 4);
+  cogl_texture_get_data (sub_texture,
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         SUB_SIZE * 4,
+                         read_data);
+  check_region (read_data, SUB_SIZE * 4, SUB_X, SUB_Y, SUB_SIZE, SUB_SIZE);
+
+  if (g_test_perf ())
+    {
+      double full_time = time_reads (COGL_TEXTURE (texture), read_data);
+      double sub_time = time_reads (sub_texture, read_data);
+
+      g_print ("readback: %ix%i %.2fms, %ix%i sub-region %.2fms\n",
+               TEXTURE_SIZE, TEXTURE_SIZE, full_time,
+               SUB_SIZE, SUB_SIZE, sub_time);
+    }
+
+  cogl_object_unref (sub_texture);
+  cogl_object_unref (texture);
+  g_free (read_data);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,262 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+/* The slice planners are internal to Cogl and the power-of-two one is
+   only used when the driver doesn't support NPOT textures so, as in
+   test-bitmask, the source is included directly to test it */
+
+#include <cogl/cogl-spans.h>
+#include <cogl/cogl-spans.c>
+
+/* A selection of image sizes that are typical of icons, photos and
+ * UI assets, most of which aren't a power of two */
+static const int corpus_sizes[][2] =
+  {
+    { 16, 16 }, { 48, 48 }, { 100, 75 }, { 129, 129 },
+    { 200, 300 }, { 257, 31 }, { 320, 240 }, { 500, 375 },
+    { 640, 480 }, { 800, 600 }, { 1000, 1 }, { 1025, 769 }
+  };
+
+typedef struct
+{
+  int n_slices;
+  int allocated_texels;
+  float covered_texels;
+} SliceState;
+
+static void
+count_slice_cb (CoglTexture *sub_texture,
+                const float *sub_texture_coords,
+                const float *meta_coords,
+                void *user_data)
+{
+  SliceState *state = user_data;
+  int width = cogl_texture_get_width (sub_texture);
+  int height = cogl_texture_get_height (sub_texture);
+
+  state->n_slices++;
+  state->allocated_texels += width * height;
+  state->covered_texels += ((sub_texture_coords[2] - sub_texture_coords[0]) *
+                            width *
+                            (sub_texture_coords[3] - sub_texture_coords[1]) *
+                            height);
+}
+
+/* Span sizes to plan with. Zero means the next power of two up from
+ * the size, which is what is used unless the driver can't create a
+ * texture that big */
+static const int max_span_sizes[] = { 0, 256 };
+
+static int
+next_pot (int size)
+{
+  int pot = 1;
+
+  while (pot < size)
+    pot *= 2;
+
+  return pot;
+}
+
+/* This is the power-of-two planner that was used before the current
+ * one. It returns the total size of the spans and stores the number
+ * of spans in @n_spans_out */
+static int
+old_pot_slices_for_size (int size_to_fill,
+                         int max_span_size,
+                         int max_waste,
+                         int *n_spans_out)
+{
+  int span_size = max_span_size;
+  int total_size = 0;
+  int n_spans = 0;
+
+  while (TRUE)
+    {
+      if (size_to_fill > span_size)
+        {
+          total_size += span_size;
+          size_to_fill -= span_size;
+          n_spans++;
+        }
+      else if (span_size - size_to_fill <= max_waste)
+        {
+          total_size += next_pot (size_to_fill);
+          *n_spans_out = n_spans + 1;
+          return total_size;
+        }
+      else
+        {
+          while (span_size - size_to_fill > max_waste)
+            span_size /= 2;
+        }
+    }
+}
+
+/* Checks the spans planned for one axis and returns their total
+ * size */
+static int
+check_pot_plan (int size, int max_span_size)
+{
+  GArray *spans = g_array_new (FALSE, FALSE, sizeof (CoglSpan));
+  int n_spans, old_n_spans;
+  int total_size = 0, old_total_size;
+  int i;
+
+  n_spans = _cogl_pot_slices_for_size (size,
+                                       max_span_size,
+                                       COGL_TEXTURE_MAX_WASTE,
+                                       spans);
+  g_assert_cmpint (n_spans, ==, spans->len);
+  g_assert_cmpint (_cogl_pot_slices_for_size (size,
+                                              max_span_size,
+                                              COGL_TEXTURE_MAX_WASTE,
+                                              NULL),
+                   ==,
+                   n_spans);
+
+  for (i = 0; i < n_spans; i++)
+    {
+      CoglSpan *span = &g_array_index (spans, CoglSpan, i);
+      int span_size = span->size;
+
+      /* The spans must be contiguous powers of two and only the last
+         one may have any waste */
+      g_assert_cmpfloat (span->start, ==, total_size);
+      g_assert_cmpint (span_size, <=, max_span_size);
+      g_assert_cmpint (span_size & (span_size - 1), ==, 0);
+      if (i < n_spans - 1)
+        g_assert_cmpfloat (span->waste, ==, 0.0f);
+      else
+        g_assert_cmpfloat (span->waste, <=, COGL_TEXTURE_MAX_WASTE);
+
+      total_size += span_size;
+    }
+
+  g_assert_cmpint (total_size - size,
+                   ==,
+                   (int) g_array_index (spans, CoglSpan, n_spans - 1).waste);
+
+  /* The old plan is one of the plans that the planner chooses from so
+     its cost can never be lower */
+  old_total_size = old_pot_slices_for_size (size,
+                                            max_span_size,
+                                            COGL_TEXTURE_MAX_WASTE,
+                                            &old_n_spans);
+  g_assert_cmpint (total_size - size + n_spans * COGL_TEXTURE_SLICE_COST,
+                   <=,
+                   old_total_size - size +
+                   old_n_spans * COGL_TEXTURE_SLICE_COST);
+
+  g_array_free (spans, TRUE);
+
+  return total_size;
+}
+
+static void
+check_pot_planner (void)
+{
+  int total_waste = 0, old_total_waste = 0;
+  int i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (corpus_sizes); i++)
+    for (j = 0; j < G_N_ELEMENTS (max_span_sizes); j++)
+      {
+        int width = corpus_sizes[i][0];
+        int height = corpus_sizes[i][1];
+        int max_width = max_span_sizes[j] ? max_span_sizes[j] : next_pot (width);
+        int max_height =
+          max_span_sizes[j] ? max_span_sizes[j] : next_pot (height);
+        int old_n_spans;
+        int waste, old_waste;
+
+        waste = (check_pot_plan (width, max_width) *
+                 check_pot_plan (height, max_height) -
+                 width * height);
+        old_waste = (old_pot_slices_for_size (width, max_width,
+                                              COGL_TEXTURE_MAX_WASTE,
+                                              &old_n_spans) *
+                     old_pot_slices_for_size (height, max_height,
+                                              COGL_TEXTURE_MAX_WASTE,
+                                              &old_n_spans) -
+                     width * height);
+
+        if (g_test_perf ())
+          g_print ("%4ix%-4i max %4ix%-4i %7i texels wasted, %7i before\n",
+                   width, height, max_width, max_height, waste, old_waste);
+
+        total_waste += waste;
+        old_total_waste += old_waste;
+      }
+
+  /* Over the whole corpus the planner must not waste more than the
+     old one did */
+  g_assert_cmpint (total_waste, <=, old_total_waste);
+}
+
+void
+test_cogl_texture_slicing (TestUtilsGTestFixture *fixture,
+                           void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  gboolean has_npot = cogl_has_feature (ctx, COGL_FEATURE_ID_TEXTURE_NPOT);
+  int total_area = 0, total_allocated = 0;
+  GTimer *timer = g_timer_new ();
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (corpus_sizes); i++)
+    {
+      int width = corpus_sizes[i][0];
+      int height = corpus_sizes[i][1];
+      CoglTexture2DSliced *texture;
+      SliceState state = { 0, 0, 0.0f };
+
+      texture = cogl_texture_2d_sliced_new_with_size (ctx,
+                                                      width, height,
+                                                      COGL_TEXTURE_MAX_WASTE,
+                                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                                      NULL);
+      g_assert (texture != NULL);
+
+      cogl_meta_texture_foreach_in_region (COGL_META_TEXTURE (texture),
+                                           0, 0, 1, 1,
+                                           COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                           COGL_PIPELINE_WRAP_MODE_REPEAT,
+                                           count_slice_cb,
+                                           &state);
+
+      /* The slices must cover the whole image exactly once */
+      g_assert_cmpfloat (ABS (state.covered_texels - width * height), <, 1.0f);
+      g_assert_cmpint (state.allocated_texels, >=, width * height);
+
+      /* With NPOT textures there's no reason to waste anything */
+      if (has_npot)
+        g_assert_cmpint (state.allocated_texels, ==, width * height);
+
+      if (g_test_perf ())
+        g_print ("%4ix%-4i %2i slices, %3.1f%% wasted\n",
+                 width, height,
+                 state.n_slices,
+                 (state.allocated_texels - width * height) * 100.0f /
+                 state.allocated_texels);
+
+      total_area += width * height;
+      total_allocated += state.allocated_texels;
+
+      cogl_object_unref (texture);
+    }
+
+  if (g_test_perf ())
+    g_print ("slicing: %.1f%% wasted over corpus, %.2fms\n",
+             (total_allocated - total_area) * 100.0f / total_allocated,
+             g_timer_elapsed (timer, NULL) * 1000.0);
+
+  g_timer_destroy (timer);
+
+  check_pot_planner ();
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
@@ -0,0 +1,139 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define TARGET_SIZE 32
+#define N_PERF_FRAMES 200
+
+static void
+check_texture_color (CoglTexture *texture, guint32 expected)
+{
+  guint8 pixel[TARGET_SIZE * TARGET_SIZE * 4];
+
+  cogl_texture_get_data (texture,
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         TARGET_SIZE * 4,
+                         pixel);
+
+  test_utils_compare_pixel (pixel + (TARGET_SIZE * TARGET_SIZE / 2 +
+                                     TARGET_SIZE / 2) * 4,
+                            expected);
+}
+
+static void
+run_benchmark (CoglContext *ctx)
+{
+  GTimer *timer = g_timer_new ();
+  double fresh_time, pooled_time;
+  int i;
+
+  for (i = 0; i < N_PERF_FRAMES; i++)
+    {
+      CoglTexture2D *texture =
+        cogl_texture_2d_new_with_size (ctx, 256, 256,
+                                       COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                       NULL);
+      CoglHandle offscreen =
+        cogl_offscreen_new_to_texture (COGL_TEXTURE (texture));
+
+      cogl_framebuffer_clear4f (offscreen, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+      cogl_framebuffer_finish (offscreen);
+
+      cogl_object_unref (offscreen);
+      cogl_object_unref (texture);
+    }
+
+  fresh_time = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+
+  for (i = 0; i < N_PERF_FRAMES; i++)
+    {
+      CoglFramebuffer *offscreen =
+        cogl_context_acquire_transient_offscreen
+        (ctx, 256, 256,
+         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+         COGL_TRANSIENT_OFFSCREEN_FLAG_NONE,
+         NULL);
+
+      cogl_framebuffer_clear4f (offscreen, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+      cogl_framebuffer_finish (offscreen);
+
+      cogl_context_release_transient_offscreen (ctx, offscreen);
+    }
+
+  pooled_time = g_timer_elapsed (timer, NULL);
+
+  g_print ("offscreen: fresh %.2fus, pooled %.2fus per frame\n",
+           fresh_time * 1e6 / N_PERF_FRAMES,
+           pooled_time * 1e6 / N_PERF_FRAMES);
+
+  g_timer_destroy (timer);
+}
+
+void
+test_cogl_transient_offscreen (TestUtilsGTestFixture *fixture,
+                               void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglContext *ctx = shared_state->ctx;
+  CoglFramebuffer *first, *second, *recycled;
+  CoglTexture *first_texture, *texture;
+
+  first = cogl_context_acquire_transient_offscreen
+    (ctx, TARGET_SIZE, TARGET_SIZE,
+     COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+     COGL_TRANSIENT_OFFSCREEN_FLAG_NONE,
+     &first_texture);
+  g_assert (first != NULL);
+  g_assert (cogl_is_offscreen (first));
+  g_assert_cmpint (cogl_texture_get_width (first_texture), ==, TARGET_SIZE);
+
+  cogl_framebuffer_clear4f (first, COGL_BUFFER_BIT_COLOR, 1, 0, 0, 1);
+  check_texture_color (first_texture, 0xff0000ff);
+
+  /* A framebuffer that is in use can't be handed out twice */
+  second = cogl_context_acquire_transient_offscreen
+    (ctx, TARGET_SIZE, TARGET_SIZE,
+     COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+     COGL_TRANSIENT_OFFSCREEN_FLAG_NONE,
+     NULL);
+  g_assert (second != NULL);
+  g_assert (second != first);
+
+  cogl_context_release_transient_offscreen (ctx, first);
+  cogl_context_release_transient_offscreen (ctx, second);
+
+  /* A released framebuffer with the same parameters is recycled */
+  recycled = cogl_context_acquire_transient_offscreen
+    (ctx, TARGET_SIZE, TARGET_SIZE,
+     COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+     COGL_TRANSIENT_OFFSCREEN_FLAG_NONE,
+     &texture);
+  g_assert (recycled == first || recycled == second);
+
+  cogl_framebuffer_clear4f (recycled, COGL_BUFFER_BIT_COLOR, 0, 1, 0, 1);
+  check_texture_color (texture, 0x00ff00ff);
+
+  /* Different flags need a different framebuffer */
+  second = cogl_context_acquire_transient_offscreen
+    (ctx, TARGET_SIZE, TARGET_SIZE,
+     COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+     COGL_TRANSIENT_OFFSCREEN_FLAG_DEPTH_STENCIL,
+     NULL);
+  g_assert (second != NULL);
+  g_assert (second != recycled);
+
+  cogl_context_release_transient_offscreen (ctx, second);
+  cogl_context_release_transient_offscreen (ctx, recycled);
+
+  if (g_test_perf ())
+    run_benchmark (ctx);
+
+  /* Throw away everything that isn't being used */
+  cogl_context_set_transient_offscreen_budget (ctx, 0);
+  cogl_context_set_transient_offscreen_budget (ctx, 32 * 1024 * 1024);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
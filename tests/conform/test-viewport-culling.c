@@ -0,0 +1,156 @@
+#include <cogl/cogl.h>
+
+#include "test-utils.h"
+
+#define SQUARE_SIZE 16
+
+static CoglPrimitive *
+create_square (CoglContext *ctx, float x, float y)
+{
+  CoglVertexP2 verts[] =
+    { { x, y },
+      { x, y + SQUARE_SIZE },
+      { x + SQUARE_SIZE, y },
+      { x + SQUARE_SIZE, y + SQUARE_SIZE } };
+
+  return cogl_primitive_new_p2 (ctx,
+                                COGL_VERTICES_MODE_TRIANGLE_STRIP,
+                                4, /* n_vertices */
+                                verts);
+}
+
+static void
+check_square (int x, int y, guint32 expected_color)
+{
+  test_utils_check_pixel (x + SQUARE_SIZE / 2, y + SQUARE_SIZE / 2,
+                          expected_color);
+}
+
+static void
+test_primitives (CoglContext *ctx,
+                 CoglFramebuffer *fb,
+                 CoglPipeline *pipeline)
+{
+  int fb_width = cogl_framebuffer_get_width (fb);
+  CoglPrimitive *prim;
+
+  /* The bounds don't really have to match the vertices so giving a
+     primitive bounds that lie outside of the framebuffer shows
+     whether it was skipped */
+  prim = create_square (ctx, 0, 0);
+  cogl_primitive_set_bounds (prim,
+                             fb_width + 10, 0, 0,
+                             fb_width + 10 + SQUARE_SIZE, SQUARE_SIZE, 0);
+  cogl_framebuffer_draw_primitive (fb, pipeline, prim);
+  cogl_object_unref (prim);
+
+  /* The same for bounds that are inside the framebuffer but outside
+     of the clip */
+  prim = create_square (ctx, SQUARE_SIZE, 0);
+  cogl_primitive_set_bounds (prim,
+                             SQUARE_SIZE * 3, 0, 0,
+                             SQUARE_SIZE * 4, SQUARE_SIZE, 0);
+  cogl_framebuffer_push_rectangle_clip (fb,
+                                        0, 0,
+                                        SQUARE_SIZE * 2, SQUARE_SIZE);
+  cogl_framebuffer_draw_primitive (fb, pipeline, prim);
+  cogl_framebuffer_pop_clip (fb);
+  cogl_object_unref (prim);
+
+  /* Bounds that are only partly inside of the framebuffer must not
+     cause the primitive to be skipped */
+  prim = create_square (ctx, 0, SQUARE_SIZE);
+  cogl_primitive_set_bounds (prim,
+                             -SQUARE_SIZE, SQUARE_SIZE, 0,
+                             SQUARE_SIZE, SQUARE_SIZE * 2, 0);
+  cogl_framebuffer_draw_primitive (fb, pipeline, prim);
+  cogl_object_unref (prim);
+
+  /* Neither should clearing the bounds again */
+  prim = create_square (ctx, SQUARE_SIZE, SQUARE_SIZE);
+  cogl_primitive_set_bounds (prim,
+                             fb_width + 10, 0, 0,
+                             fb_width + 10 + SQUARE_SIZE, SQUARE_SIZE, 0);
+  cogl_primitive_clear_bounds (prim);
+  cogl_framebuffer_draw_primitive (fb, pipeline, prim);
+  cogl_object_unref (prim);
+
+  /* A primitive without bounds is always drawn */
+  prim = create_square (ctx, SQUARE_SIZE * 2, SQUARE_SIZE);
+  cogl_framebuffer_draw_primitive (fb, pipeline, prim);
+  cogl_object_unref (prim);
+
+  check_square (0, 0, 0x000000ff);
+  check_square (SQUARE_SIZE, 0, 0x000000ff);
+  check_square (0, SQUARE_SIZE, 0xff0000ff);
+  check_square (SQUARE_SIZE, SQUARE_SIZE, 0xff0000ff);
+  check_square (SQUARE_SIZE * 2, SQUARE_SIZE, 0xff0000ff);
+}
+
+static void
+test_rectangles (CoglFramebuffer *fb,
+                 CoglPipeline *pipeline)
+{
+  int fb_width = cogl_framebuffer_get_width (fb);
+  int y = SQUARE_SIZE * 2;
+
+  cogl_push_framebuffer (fb);
+  cogl_set_source (pipeline);
+
+  /* Rectangles that are completely outside of the framebuffer are
+     batched together with visible ones so these check that skipping
+     them doesn't disturb the rest of the batch */
+  cogl_rectangle (-SQUARE_SIZE * 2, y, -SQUARE_SIZE, y + SQUARE_SIZE);
+
+  /* Rectangles that hang over the left and right edges */
+  cogl_rectangle (-SQUARE_SIZE / 2, y,
+                  SQUARE_SIZE, y + SQUARE_SIZE);
+  cogl_rectangle (fb_width - SQUARE_SIZE, y,
+                  fb_width + SQUARE_SIZE / 2, y + SQUARE_SIZE);
+
+  cogl_rectangle (fb_width + SQUARE_SIZE, y,
+                  fb_width + SQUARE_SIZE * 2, y + SQUARE_SIZE);
+
+  /* A rectangle that is only visible because of the modelview
+     transform */
+  cogl_push_matrix ();
+  cogl_translate (fb_width, 0, 0);
+  cogl_rectangle (-fb_width + SQUARE_SIZE, y,
+                  -fb_width + SQUARE_SIZE * 2, y + SQUARE_SIZE);
+  cogl_pop_matrix ();
+
+  cogl_pop_framebuffer ();
+
+  check_square (0, y, 0xff0000ff);
+  check_square (SQUARE_SIZE, y, 0xff0000ff);
+  check_square (SQUARE_SIZE * 2, y, 0x000000ff);
+  check_square (fb_width - SQUARE_SIZE, y, 0xff0000ff);
+}
+
+void
+test_cogl_viewport_culling (TestUtilsGTestFixture *fixture,
+                            void *data)
+{
+  TestUtilsSharedState *shared_state = data;
+  CoglFramebuffer *fb = shared_state->fb;
+  CoglPipeline *pipeline;
+
+  cogl_framebuffer_orthographic (fb,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (fb),
+                                 cogl_framebuffer_get_height (fb),
+                                 -1,
+                                 100);
+  cogl_framebuffer_clear4f (fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  pipeline = cogl_pipeline_new ();
+  cogl_pipeline_set_color4ub (pipeline, 0xff, 0x00, 0x00, 0xff);
+
+  test_primitives (shared_state->ctx, fb, pipeline);
+  test_rectangles (fb, pipeline);
+
+  cogl_object_unref (pipeline);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}